@@ -5,10 +5,19 @@
 #include "RandGen.h"
 
 #include "JsonFile.h"
+#include "Profiler.h"
+#include "SceneStressTest.h"
+#include "MathBenchmark.h"
+#include "Replay.h"
+#include "MemoryTracker.h"
+#include "FrameAllocator.h"
+#include "Logger.h"
+#include "JobSystem.h"
 
 #include "AllModules.h"
 
 #include <iostream>
+#include <algorithm>
 
 //-----------------------------------------------
 
@@ -24,6 +33,275 @@ struct C_Quit : public Command
 }c_Quit;
 //-----------------------------------------------
 
+struct C_ProfilerExport : public Command
+{
+	C_ProfilerExport() : Command("Export profiler trace", "profiler_export", "Save the profiled frames as a Chrome trace. -f file name")
+	{}
+
+	void Function(std::vector< std::string>& args)override
+	{
+		std::string file = "trace.json";
+
+		std::vector<std::string>::iterator it = std::find(args.begin(), args.end(), "-f");
+		if (it != args.end() && ++it != args.end())
+			file = *it;
+
+		if (!Profiler::SaveChromeTrace((PROFILER_PATH + file).c_str()))
+			_LOG(LOG_ERROR, "Could not save the profiler trace.");
+	}
+}c_ProfilerExport;
+//-----------------------------------------------
+
+struct C_FrameStats : public Command
+{
+	C_FrameStats() : Command("Frame stats", "frame_stats", "Log the frame time stats. -t hitch threshold ms, -r reset, -f save them as json")
+	{}
+
+	void Function(std::vector< std::string>& args)override
+	{
+		if (!app) return;
+
+		std::vector<std::string>::iterator it = std::find(args.begin(), args.end(), "-t");
+		if (it != args.end() && ++it != args.end())
+			app->clock->SetHitchThreshold((float)atof(it->c_str()));
+
+		FrameStats stats;
+		app->clock->GetFrameStats(stats);
+
+		_LOG(LOG_INFO, "Frame stats (%u frames): p50 %.2f ms, p90 %.2f ms, p99 %.2f ms, max %.2f ms, avg %.2f ms.",
+			stats.frames, stats.p50Ms, stats.p90Ms, stats.p99Ms, stats.maxMs, stats.avgMs);
+		_LOG(LOG_INFO, "Frame stats: cpu %.2f ms / wall %.2f ms, hitches over %.1f ms: %u (%u total).",
+			stats.avgCpuMs, stats.avgWallMs, stats.hitchThresholdMs, stats.hitches, stats.totalHitches);
+
+		it = std::find(args.begin(), args.end(), "-f");
+		if (it != args.end() && ++it != args.end())
+		{
+			JsonFile file;
+			file.AddUInt("frames", stats.frames);
+			file.AddFloat("p50_ms", stats.p50Ms);
+			file.AddFloat("p90_ms", stats.p90Ms);
+			file.AddFloat("p99_ms", stats.p99Ms);
+			file.AddFloat("max_ms", stats.maxMs);
+			file.AddFloat("avg_ms", stats.avgMs);
+			file.AddFloat("avg_cpu_ms", stats.avgCpuMs);
+			file.AddFloat("avg_wall_ms", stats.avgWallMs);
+			file.AddFloat("hitch_threshold_ms", stats.hitchThresholdMs);
+			file.AddUInt("hitches", stats.hitches);
+			file.AddUInt("total_hitches", stats.totalHitches);
+
+			std::string buffer = file.Write(true);
+			if (app->fs->Save(it->c_str(), buffer.c_str(), buffer.size()) != buffer.size())
+				_LOG(LOG_ERROR, "Could not save the frame stats to [%s].", it->c_str());
+		}
+
+		if (std::find(args.begin(), args.end(), "-r") != args.end())
+			app->clock->ResetFrameStats();
+	}
+}c_FrameStats;
+//-----------------------------------------------
+
+struct C_StressTest : public Command
+{
+	C_StressTest() : Command("Scene stress test", "stress_test", "Fill the scene and time its frames. -n objects, -d depth, -s static ratio, -q quad ratio, -m moving ratio, -f frames, -seed, -o json file, -k keep objects, -stop")
+	{}
+
+	void Function(std::vector< std::string>& args)override
+	{
+		if (!app || !app->stressTest) return;
+
+		if (std::find(args.begin(), args.end(), "-stop") != args.end())
+		{
+			app->stressTest->Stop();
+			return;
+		}
+
+		StressTestSettings settings;
+		settings.objects = (uint)MAX(0, atoi(GetArg(args, "-n", "1000")));
+		settings.depth = (uint)MAX(1, atoi(GetArg(args, "-d", "1")));
+		settings.staticRatio = (float)atof(GetArg(args, "-s", "0.5"));
+		settings.quadRatio = (float)atof(GetArg(args, "-q", "0"));
+		settings.movingRatio = (float)atof(GetArg(args, "-m", "0.1"));
+		settings.frames = (uint)MAX(1, atoi(GetArg(args, "-f", "300")));
+		settings.seed = (uint)atoi(GetArg(args, "-seed", "1"));
+		settings.output = GetArg(args, "-o", "");
+		settings.keepObjects = std::find(args.begin(), args.end(), "-k") != args.end();
+
+		app->stressTest->Start(settings);
+	}
+
+	/** Value following the flag, or the default if the flag is missing. */
+	const char* GetArg(const std::vector<std::string>& args, const char* flag, const char* def)const
+	{
+		std::vector<std::string>::const_iterator it = std::find(args.begin(), args.end(), flag);
+		if (it != args.end() && ++it != args.end())
+			return it->c_str();
+		return def;
+	}
+}c_StressTest;
+//-----------------------------------------------
+
+struct C_BenchMath : public Command
+{
+	C_BenchMath() : Command("Math benchmark", "bench_math", "Time the MathGeoLib operations used per frame. -n batch, -w warmup, -r repetitions, -o json file")
+	{}
+
+	void Function(std::vector< std::string>& args)override
+	{
+		MathBenchSettings settings;
+
+		std::vector<std::string>::iterator it = std::find(args.begin(), args.end(), "-n");
+		if (it != args.end() && ++it != args.end())
+			settings.batch = (uint)MAX(2, atoi(it->c_str()));
+
+		it = std::find(args.begin(), args.end(), "-w");
+		if (it != args.end() && ++it != args.end())
+			settings.warmup = (uint)MAX(0, atoi(it->c_str()));
+
+		it = std::find(args.begin(), args.end(), "-r");
+		if (it != args.end() && ++it != args.end())
+			settings.repetitions = (uint)MAX(1, atoi(it->c_str()));
+
+		std::vector<MathBenchResult> results;
+		MathBenchmark::Run(settings, results);
+
+		_LOG(LOG_INFO, "Math benchmark: %s build%s, batch %u, %u repetitions, ns per operation:", MathBenchmark::GetSimdLevel(),
+			MathBenchmark::IsAutomaticSimd() ? " (automatic SIMD)" : "", settings.batch, settings.repetitions);
+		for (std::vector<MathBenchResult>::const_iterator res = results.begin(); res != results.end(); ++res)
+			_LOG(LOG_INFO, "  %-34s median %8.2f, min %8.2f, max %8.2f", res->name.c_str(), res->medianNs, res->minNs, res->maxNs);
+
+		it = std::find(args.begin(), args.end(), "-o");
+		if (it != args.end() && ++it != args.end())
+		{
+			if (!MathBenchmark::Save(it->c_str(), settings, results))
+				_LOG(LOG_ERROR, "Could not save the math benchmark to [%s].", it->c_str());
+		}
+	}
+}c_BenchMath;
+//-----------------------------------------------
+
+struct C_Replay : public Command
+{
+	C_Replay() : Command("Replay", "replay", "Record or play the input, dt, commands and scene events. -record file, -play file, -trace json file, -dt fixed dt, -stop")
+	{}
+
+	void Function(std::vector< std::string>& args)override
+	{
+		if (!app || !app->replay) return;
+
+		if (std::find(args.begin(), args.end(), "-stop") != args.end())
+		{
+			app->replay->Stop();
+			return;
+		}
+
+		std::vector<std::string>::iterator it = std::find(args.begin(), args.end(), "-record");
+		if (it != args.end() && ++it != args.end())
+		{
+			app->replay->StartRecording(it->c_str());
+			return;
+		}
+
+		it = std::find(args.begin(), args.end(), "-play");
+		if (it != args.end() && ++it != args.end())
+		{
+			std::string file = *it;
+			std::string trace;
+			float dt = 0.f;
+
+			it = std::find(args.begin(), args.end(), "-trace");
+			if (it != args.end() && ++it != args.end())
+				trace = *it;
+
+			it = std::find(args.begin(), args.end(), "-dt");
+			if (it != args.end() && ++it != args.end())
+				dt = (float)atof(it->c_str());
+
+			app->replay->StartPlaying(file.c_str(), trace.c_str(), dt);
+		}
+	}
+}c_Replay;
+//-----------------------------------------------
+
+struct C_MemoryStats : public Command
+{
+	C_MemoryStats() : Command("Memory stats", "memory_stats", "Log the memory used per tag and by the loaded resources. -f save them as json")
+	{}
+
+	void Function(std::vector< std::string>& args)override
+	{
+		if (!app) return;
+
+		JsonFile file;
+		JsonFile tags;
+
+		MemoryTagStats stats;
+		for (uint i = 0; i <= MEM_TAG_COUNT; ++i)
+		{
+			const char* name = "Total";
+			if (i < MEM_TAG_COUNT)
+			{
+				MemoryTracker::GetStats((MemoryTag)i, stats);
+				name = MemoryTracker::GetTagName((MemoryTag)i);
+			}
+			else
+			{
+				MemoryTracker::GetTotal(stats);
+			}
+
+			_LOG(LOG_INFO, "Memory: %-20s %10.1f KB, peak %10.1f KB, %u allocations (%u total).", name, stats.bytes / 1024.0,
+				stats.peakBytes / 1024.0, (uint)stats.allocations, (uint)stats.totalAllocations);
+
+			JsonFile tag;
+			tag.AddUInt64("bytes", stats.bytes);
+			tag.AddUInt64("peak_bytes", stats.peakBytes);
+			tag.AddUInt64("allocations", stats.allocations);
+			tag.AddUInt64("total_allocations", stats.totalAllocations);
+			tags.AddSection(name, tag);
+		}
+
+		ResourceMemory resMemory;
+		app->resources->GetMemoryUsage(resMemory);
+
+		_LOG(LOG_INFO, "Memory: %u meshes, %.1f KB CPU, %.1f KB VRAM. %u textures, %.1f KB VRAM (estimated).", resMemory.meshes,
+			resMemory.meshCpuBytes / 1024.0, resMemory.meshVramBytes / 1024.0, resMemory.textures, resMemory.textureVramBytes / 1024.0);
+		if (!MemoryTracker::IsTrackingNew())
+			_LOG(LOG_WARN, "Memory: new is not hooked in this build, only the explicit allocations are counted.");
+
+		FrameAllocatorStats frameStats;
+		FrameAllocator::GetStats(frameStats);
+
+		_LOG(LOG_INFO, "Memory: frame allocator %.1f KB of %.1f KB (peak %.1f KB), %u allocations, %u overflow blocks, %u hot path heap allocations.",
+			frameStats.usedBytes / 1024.0, frameStats.capacity / 1024.0, frameStats.peakBytes / 1024.0, frameStats.allocations,
+			frameStats.overflowBlocks, frameStats.hotPathHeapAllocations);
+
+		std::vector<std::string>::iterator it = std::find(args.begin(), args.end(), "-f");
+		if (it != args.end() && ++it != args.end())
+		{
+			file.AddBool("tracking_new", MemoryTracker::IsTrackingNew());
+			file.AddSection("tags", tags);
+			file.AddUInt("meshes", resMemory.meshes);
+			file.AddUInt64("mesh_cpu_bytes", resMemory.meshCpuBytes);
+			file.AddUInt64("mesh_vram_bytes", resMemory.meshVramBytes);
+			file.AddUInt("textures", resMemory.textures);
+			file.AddUInt64("texture_vram_bytes", resMemory.textureVramBytes);
+
+			JsonFile frame;
+			frame.AddUInt64("capacity", frameStats.capacity);
+			frame.AddUInt64("used_bytes", frameStats.usedBytes);
+			frame.AddUInt64("peak_bytes", frameStats.peakBytes);
+			frame.AddUInt("allocations", frameStats.allocations);
+			frame.AddUInt("overflow_blocks", frameStats.overflowBlocks);
+			frame.AddUInt("hot_path_heap_allocations", frameStats.hotPathHeapAllocations);
+			file.AddSection("frame_allocator", frame);
+
+			std::string buffer = file.Write(true);
+			if (app->fs->Save(it->c_str(), buffer.c_str(), buffer.size()) != buffer.size())
+				_LOG(LOG_ERROR, "Could not save the memory stats to [%s].", it->c_str());
+		}
+	}
+}c_MemoryStats;
+//-----------------------------------------------
+
 /**
 *	- App constructor.
 *	- Read arguments.
@@ -40,32 +318,46 @@ App::App(int argv, char** argc) : currentConfigSaveFileDir(CONFIG_PATH + (std::s
 	}
 	ReadArgs();
 
+	PROFILE_THREAD("Main");
+
 	clock = new GG_Clock();
 	info = new HrdInfo();
 	console = new Console();
 	random = new RandGen();
+	stressTest = new SceneStressTest();
+	replay = new Replay();
 	//TODO: Let user pass an arg for the seed??
 
 	console->AddCommand(&c_Quit);
+	console->AddCommand(&c_ProfilerExport);
+	console->AddCommand(&c_FrameStats);
+	console->AddCommand(&c_StressTest);
+	console->AddCommand(&c_BenchMath);
+	console->AddCommand(&c_Replay);
+	console->AddCommand(&c_MemoryStats);
 
 	//Create modules
-	editor = new M_Editor("module_editor");
+	//Headless runs without window, input and editor. The editor camera is kept, disabled, to cull from it.
+	if (!headless)
+	{
+		editor = new M_Editor("module_editor");
+		win = new M_Window("module_window");
+		input = new M_Input("module_input");
+	}
 	fs = new M_FileSystem("module_file_system");
-	win = new M_Window("module_window");
-	input = new M_Input("module_input");
 	resources = new M_ResourceManager("module_resource_manager");
 	goManager = new M_GoManager("module_go_manager");
-	camera = new M_Camera3D("module_camera_editor");
+	camera = new M_Camera3D("module_camera_editor", !headless);
 
 
 
 	renderer = new M_Renderer("module_renderer");
 
 
-	modules.push_back(editor);
+	if (editor) modules.push_back(editor);
 	modules.push_back(fs);
-	modules.push_back(win);
-	modules.push_back(input);
+	if (win) modules.push_back(win);
+	if (input) modules.push_back(input);
 	modules.push_back(resources);
 	modules.push_back(goManager);
 	modules.push_back(camera);
@@ -88,6 +380,8 @@ App::~App()
 	RELEASE(console);
 	RELEASE(random);
 	RELEASE(clock);
+	RELEASE(stressTest);
+	RELEASE(replay);
 }
 
 /**
@@ -107,6 +401,9 @@ bool App::Init()
 	JsonFile config(buffer);
 	ReadConfig(&config.GetSection("app"));
 
+	//Before the modules, the resources are loaded with it
+	JobSystem::Start(config.GetSection("app").GetInt("job_workers", 0));
+
 	for (std::vector<Module*>::iterator it = modules.begin(); it != modules.end() && ret; ++it)
 	{
 		if((*it)->configuration & M_INIT)
@@ -125,6 +422,28 @@ bool App::Init()
 	if (ret)
 		info->SetInfo();
 
+	//Before loading the scene so the load is recorded
+	if (ret && !recordFile.empty())
+		replay->StartRecording(recordFile.c_str());
+
+	if (ret && !replayFile.empty())
+		ret = replay->StartPlaying(replayFile.c_str(), replayTrace.c_str(), replayDt);
+
+	if (ret && loadScene)
+		goManager->LoadScene();
+
+	if (ret && runStressTest)
+		c_StressTest.Function(argc); //Takes its flags from the command line.
+
+	if (ret && std::find(argc.begin(), argc.end(), "-bench_math") != argc.end())
+	{
+		c_BenchMath.Function(argc);
+		quit = true;
+	}
+
+	if (headless)
+		_LOG(LOG_INFO, "App: Running headless, frames to run: %u (0 runs until quit).", runFrames);
+
 	return ret;
 }
 
@@ -137,31 +456,55 @@ UpdateReturn App::Update()
 {
 	UpdateReturn ret = UPDT_CONTINUE;
 
+	PROFILE_FRAME_BEGIN();
+
+	replay->OnFrameBegin();
+
 	PrepareUpdate();
 
+	stressTest->OnFrameBegin();
+
 	std::vector<Module*>::iterator it;
-	for (it = modules.begin(); it != modules.end() && ret == UPDT_CONTINUE; ++it)
 	{
-		if ((*it)->configuration & M_PRE_UPDATE && (*it)->IsEnable())
-			ret = (*it)->PreUpdate(clock->DT()); //TODO: Dont pass dt, let each module get each dt
+		PROFILE_SCOPE("PreUpdate");
+		for (it = modules.begin(); it != modules.end() && ret == UPDT_CONTINUE; ++it)
+		{
+			if ((*it)->configuration & M_PRE_UPDATE && (*it)->IsEnable())
+			{
+				PROFILE_SCOPE((*it)->name.c_str());
+				ret = (*it)->PreUpdate(clock->DT()); //TODO: Dont pass dt, let each module get each dt
+			}
+		}
 	}
 
 	if (ret == UPDT_ERROR)
 		_LOG(LOG_ERROR, "Exit preupdate with errors.");
 
-	for (it = modules.begin(); it != modules.end() && ret == UPDT_CONTINUE; ++it)
 	{
-		if ((*it)->configuration & M_UPDATE && (*it)->IsEnable())
-			ret = (*it)->Update(clock->DT()); //TODO: Dont pass dt, let each module get each dt
+		PROFILE_SCOPE("Update");
+		for (it = modules.begin(); it != modules.end() && ret == UPDT_CONTINUE; ++it)
+		{
+			if ((*it)->configuration & M_UPDATE && (*it)->IsEnable())
+			{
+				PROFILE_SCOPE((*it)->name.c_str());
+				ret = (*it)->Update(clock->DT()); //TODO: Dont pass dt, let each module get each dt
+			}
+		}
 	}
 
 	if (ret == UPDT_ERROR)
 		_LOG(LOG_ERROR, "Exit update with errors.");
 
-	for (it = modules.begin(); it != modules.end() && ret == UPDT_CONTINUE; ++it)
 	{
-		if ((*it)->configuration & M_POST_UPDATE && (*it)->IsEnable())
-			ret = (*it)->PostUpdate(clock->DT()); //TODO: Dont pass dt, let each module get each dt
+		PROFILE_SCOPE("PostUpdate");
+		for (it = modules.begin(); it != modules.end() && ret == UPDT_CONTINUE; ++it)
+		{
+			if ((*it)->configuration & M_POST_UPDATE && (*it)->IsEnable())
+			{
+				PROFILE_SCOPE((*it)->name.c_str());
+				ret = (*it)->PostUpdate(clock->DT()); //TODO: Dont pass dt, let each module get each dt
+			}
+		}
 	}
 
 	if (ret == UPDT_ERROR)
@@ -169,6 +512,8 @@ UpdateReturn App::Update()
 
 	FinishUpdate();
 
+	PROFILE_FRAME_END();
+
 	if (quit)
 	{
 		ret = UPDT_STOP;
@@ -186,12 +531,16 @@ bool App::CleanUp()
 	bool ret = true;
 	_LOG(LOG_INFO, "App: CleanUp  =======================");
 
+	replay->Stop(); //Saves the recording while the file system is up
+
 	for (std::vector<Module*>::reverse_iterator it = modules.rbegin(); it != modules.rend(); ++it)
 	{
 		if((*it)->configuration & M_CLEAN_UP)
 			ret = (*it)->CleanUp();
 	}
 
+	JobSystem::Stop();
+
 	return ret;
 }
 
@@ -372,6 +721,16 @@ bool App::IsStop() const
 	return state == AppState::STOP;
 }
 
+bool App::IsHeadless() const
+{
+	return headless;
+}
+
+bool App::IsRecordingGL() const
+{
+	return headless && recordGL;
+}
+
 void App::Play()
 {
 	if (state == AppState::STOP)
@@ -403,6 +762,11 @@ void App::UnPause()
 */
 void App::PrepareUpdate()
 {
+	//The log thread leaves the console lines for the main thread
+	LogLine line;
+	while (Logger::PopConsoleLine(line))
+		Log(line.text, line.type);
+
 	clock->OnPrepareUpdate(state);
 
 	//TODO: Broadcast events on play, pause, unpause and stop
@@ -434,6 +798,14 @@ void App::PrepareUpdate()
 */
 void App::FinishUpdate()
 {
+	stressTest->OnFrameEnd();
+	if (runStressTest && stressTest->HasFinished())
+		quit = true;
+
+	replay->OnFrameEnd();
+	if (!replayFile.empty() && replay->HasFinished())
+		quit = true;
+
 	if (saveNextFrame)
 	{
 		SaveNow();
@@ -454,6 +826,22 @@ void App::FinishUpdate()
 
 	if (editor)
 		editor->LogFPS((float)clock->LastFPS(), (float)clock->LastFrameMs());
+
+	if (runFrames > 0 && clock->RealFrameCount() >= runFrames && !quit)
+	{
+		std::vector<std::string> args;
+		if (!statsFile.empty())
+		{
+			args.push_back("-f");
+			args.push_back(statsFile);
+		}
+		c_FrameStats.Function(args);
+
+		quit = true;
+	}
+
+	//Nothing allocated this frame from the frame allocator can be used from here
+	FrameAllocator::Reset();
 }
 
 /**
@@ -464,12 +852,24 @@ void App::ReadConfig(JsonFile* config)
 	if (!config)return;
 
 	SetMaxFPS(config->GetInt("fps_limit", 0));
+	clock->SetHitchThreshold(config->GetFloat("hitch_threshold_ms", DEFAULT_HITCH_THRESHOLD_MS));
 	SetTitle(config->GetString("app_title", "GitGud").c_str());
 	SetOrganitzation(config->GetString("app_organitzation", "Josef21296").c_str());
 }
 
 /**
 *	- ReadArgs: Read args and set parameters.
+*		- -headless: Run without window, input, editor nor GL.
+*		- -record_gl: Headless, execute the packets against the recording backend.
+*		- -frames N: Quit after N frames, logging the frame stats.
+*		- -stats file: Save the frame stats as json when quitting after -frames.
+*		- -load_scene: Load the saved scene on start.
+*		- -stress: Run the scene stress test on start, with the stress_test command flags, and quit when it finishes.
+*		- -bench_math: Run the math benchmark on start, with the bench_math command flags, and quit.
+*		- -record file: Record the run into the replay file, saved on quit.
+*		- -replay file: Play the replay file and quit when it ends.
+*		- -trace file: Save the frame times of the replay as json.
+*		- -fixed_dt s: Replay with this dt instead of the recorded one.
 */
 void App::ReadArgs()
 {
@@ -477,6 +877,37 @@ void App::ReadArgs()
 	{
 		std::cout << "Arg " << i << ": " << argc[i] << std::endl;
 	}
+
+	std::vector<std::string>::iterator it;
+
+	headless = std::find(argc.begin(), argc.end(), "-headless") != argc.end();
+	recordGL = std::find(argc.begin(), argc.end(), "-record_gl") != argc.end();
+	loadScene = std::find(argc.begin(), argc.end(), "-load_scene") != argc.end();
+	runStressTest = std::find(argc.begin(), argc.end(), "-stress") != argc.end();
+
+	it = std::find(argc.begin(), argc.end(), "-record");
+	if (it != argc.end() && ++it != argc.end())
+		recordFile = *it;
+
+	it = std::find(argc.begin(), argc.end(), "-replay");
+	if (it != argc.end() && ++it != argc.end())
+		replayFile = *it;
+
+	it = std::find(argc.begin(), argc.end(), "-trace");
+	if (it != argc.end() && ++it != argc.end())
+		replayTrace = *it;
+
+	it = std::find(argc.begin(), argc.end(), "-fixed_dt");
+	if (it != argc.end() && ++it != argc.end())
+		replayDt = (float)atof(it->c_str());
+
+	it = std::find(argc.begin(), argc.end(), "-frames");
+	if (it != argc.end() && ++it != argc.end())
+		runFrames = (uint)MAX(0, atoi(it->c_str()));
+
+	it = std::find(argc.begin(), argc.end(), "-stats");
+	if (it != argc.end() && ++it != argc.end())
+		statsFile = *it;
 }
 
 /**
@@ -489,6 +920,7 @@ bool App::SaveNow()
 	JsonFile file;
 	JsonFile app;
 	app.AddInt("fps_limit", GetMaxFPS());
+	app.AddFloat("hitch_threshold_ms", clock->GetHitchThreshold());
 	app.AddString("app_title", title.c_str());
 	app.AddString("app_organitzation", organitzation.c_str());
 	file.AddSection("app", app);
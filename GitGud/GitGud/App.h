@@ -15,6 +15,8 @@ struct Command;
 class HrdInfo;
 class Console;
 class RandGen;
+class SceneStressTest;
+class Replay;
 class JsonFile;
 
 class Module;
@@ -67,6 +69,8 @@ public:
 	bool IsPlay()const;
 	bool IsPause()const;
 	bool IsStop()const;
+	bool IsHeadless()const;
+	bool IsRecordingGL()const;
 
 	void Play();
 	void Pause();
@@ -91,6 +95,8 @@ public:
 	HrdInfo* info = nullptr;
 	Console* console = nullptr;
 	RandGen* random = nullptr;
+	SceneStressTest* stressTest = nullptr;
+	Replay* replay = nullptr;
 
 	M_FileSystem* fs = nullptr;
 	M_Window* win = nullptr;
@@ -124,6 +130,18 @@ private:
 	AppState state = AppState::STOP; //TODO: Args??
 	uint32	cappedMs = 0;
 
+	//Args -----------
+	bool headless = false;		//No window, input, editor nor GL. The renderer still culls and builds the draw packets.
+	uint runFrames = 0;			//Quit after these frames, 0 runs until quit.
+	bool recordGL = false;		//Headless only, the packets are executed against the recording backend logging every call.
+	bool loadScene = false;
+	bool runStressTest = false;	//Quit when the stress test started from the args finishes.
+	std::string recordFile;		//Replay recorded during the run.
+	std::string replayFile;		//Replay played on start, quits when it ends.
+	std::string replayTrace;	//Frame times of the replay.
+	float replayDt = 0.f;		//Fixed dt for the replay, the recorded ones if 0.
+	std::string statsFile;		//Frame stats saved on quit when running a fixed amount of frames.
+
 
 };
 extern App* app;
@@ -8,6 +8,8 @@ ComponentResource::~ComponentResource()
 {
 }
 
+/** ComponentResource - SetResource: Sets the resource and adds an instance of it. Meshes and textures load asynchronously, so their data
+										may not be ready yet, check IsReady before using it. */
 bool ComponentResource::SetResource(UID resUID)
 {
 	bool ret = false;
@@ -17,7 +19,7 @@ bool ComponentResource::SetResource(UID resUID)
 		auto res = app->resources->GetResourceFromUID(resUID);
 		if(res && res->GetType() == GetComponentType())
 		{
-			if(res->LoadToMemory())
+			if(app->resources->LoadToMemoryAsync(res))
 			{
 				OnResourceChanged();
 				resource = resUID;
@@ -0,0 +1,466 @@
+#include "Compression.h"
+
+#include "App.h"
+#include "M_FileSystem.h"
+#include "JobSystem.h"
+#include "MemoryTracker.h"
+#include "PerfTimer.h"
+
+#include <string.h>
+#include <vector>
+#include <atomic>
+
+#define LZ_MIN_MATCH 4
+#define LZ_LAST_LITERALS 5	//The last bytes of a block are always literals.
+#define LZ_MF_LIMIT 12		//No match can start closer than this to the end of the block.
+#define LZ_MAX_OFFSET 65535
+#define LZ_HASH_LOG 16
+
+static inline uint32 Read32(const uchar* p)
+{
+	uint32 ret;
+	memcpy(&ret, p, sizeof(ret));
+	return ret;
+}
+
+static inline uint32 Hash4(uint32 sequence)
+{
+	return (sequence * 2654435761U) >> (32 - LZ_HASH_LOG);
+}
+
+/** Writes a literal run and a match (none if matchLength is 0, the last sequence). False if it does not fit. */
+static bool EmitSequence(uchar*& op, const uchar* opEnd, const uchar* literals, uint numLiterals, uint offset, uint matchLength)
+{
+	uint needed = 1 + numLiterals + numLiterals / 255 + 1;
+	if (matchLength > 0)
+		needed += 2 + matchLength / 255 + 1;
+	if (needed > (uint)(opEnd - op))
+		return false;
+
+	uchar* token = op++;
+	*token = (uchar)((numLiterals < 15 ? numLiterals : 15) << 4);
+
+	if (numLiterals >= 15)
+	{
+		uint length = numLiterals - 15;
+		for (; length >= 255; length -= 255)
+			*op++ = 255;
+		*op++ = (uchar)length;
+	}
+
+	memcpy(op, literals, numLiterals);
+	op += numLiterals;
+
+	if (matchLength > 0)
+	{
+		*op++ = (uchar)(offset & 0xFF);
+		*op++ = (uchar)(offset >> 8);
+
+		uint length = matchLength - LZ_MIN_MATCH;
+		*token |= (uchar)(length < 15 ? length : 15);
+		if (length >= 15)
+		{
+			length -= 15;
+			for (; length >= 255; length -= 255)
+				*op++ = 255;
+			*op++ = (uchar)length;
+		}
+	}
+
+	return true;
+}
+
+/** LZ4 block compression. Returns the compressed size, 0 if it does not fit in dstCapacity. */
+static uint LZCompress(const uchar* src, uint srcSize, uchar* dst, uint dstCapacity, int level)
+{
+	//Scratch of the chunk compression, reused by every chunk compressed on this thread
+	static thread_local std::vector<int> head;
+	static thread_local std::vector<uint16> chain;
+
+	head.assign(1 << LZ_HASH_LOG, -1);
+	chain.resize(srcSize);
+
+	const uint maxAttempts = level <= 1 ? 1 : 1 << (level + 1);
+	const bool insertAll = level > 1;
+
+	uchar* op = dst;
+	const uchar* opEnd = dst + dstCapacity;
+
+	uint ip = 0;
+	uint anchor = 0;
+
+	if (srcSize > LZ_MF_LIMIT)
+	{
+		const uint matchLimit = srcSize - LZ_LAST_LITERALS;
+		const uint lastMatchStart = srcSize - LZ_MF_LIMIT;
+
+		auto insert = [&](uint pos)
+		{
+			uint32 h = Hash4(Read32(src + pos));
+			int previous = head[h];
+			chain[pos] = (previous >= 0 && pos - previous <= LZ_MAX_OFFSET) ? (uint16)(pos - previous) : 0;
+			head[h] = pos;
+		};
+
+		while (ip <= lastMatchStart)
+		{
+			uint32 sequence = Read32(src + ip);
+			int candidate = head[Hash4(sequence)];
+
+			uint bestLength = 0;
+			uint bestPos = 0;
+			for (uint attempts = maxAttempts; candidate >= 0 && ip - candidate <= LZ_MAX_OFFSET && attempts > 0; --attempts)
+			{
+				if (Read32(src + candidate) == sequence)
+				{
+					uint length = LZ_MIN_MATCH;
+					while (ip + length < matchLimit && src[ip + length] == src[candidate + length])
+						++length;
+
+					if (length > bestLength)
+					{
+						bestLength = length;
+						bestPos = candidate;
+					}
+				}
+
+				uint16 delta = chain[candidate];
+				if (delta == 0)
+					break;
+				candidate -= delta;
+			}
+
+			insert(ip);
+
+			if (bestLength < LZ_MIN_MATCH)
+			{
+				//The fast level steps faster over data that does not match
+				ip += insertAll ? 1 : 1 + ((ip - anchor) >> 6);
+				continue;
+			}
+
+			if (!EmitSequence(op, opEnd, src + anchor, ip - anchor, ip - bestPos, bestLength))
+				return 0;
+
+			if (insertAll)
+			{
+				for (uint pos = ip + 1; pos < ip + bestLength; ++pos)
+					insert(pos);
+			}
+
+			ip += bestLength;
+			anchor = ip;
+		}
+	}
+
+	if (!EmitSequence(op, opEnd, src + anchor, srcSize - anchor, 0, 0))
+		return 0;
+
+	return op - dst;
+}
+
+/** LZ4 block decompression. False on corrupted data, it never reads or writes out of the buffers. */
+static bool LZDecompress(const uchar* src, uint srcSize, uchar* dst, uint dstSize)
+{
+	const uchar* ip = src;
+	const uchar* ipEnd = src + srcSize;
+	uchar* op = dst;
+	uchar* opEnd = dst + dstSize;
+
+	while (ip < ipEnd)
+	{
+		uchar token = *ip++;
+
+		uint numLiterals = token >> 4;
+		if (numLiterals == 15)
+		{
+			uchar b;
+			do
+			{
+				if (ip >= ipEnd)
+					return false;
+				b = *ip++;
+				numLiterals += b;
+			} while (b == 255);
+		}
+
+		if (numLiterals > (uint)(ipEnd - ip) || numLiterals > (uint)(opEnd - op))
+			return false;
+		memcpy(op, ip, numLiterals);
+		ip += numLiterals;
+		op += numLiterals;
+
+		if (ip == ipEnd)
+			break; //Last sequence, only literals
+
+		if (ipEnd - ip < 2)
+			return false;
+		uint offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if (offset == 0 || offset > (uint)(op - dst))
+			return false;
+
+		uint matchLength = token & 15;
+		if (matchLength == 15)
+		{
+			uchar b;
+			do
+			{
+				if (ip >= ipEnd)
+					return false;
+				b = *ip++;
+				matchLength += b;
+			} while (b == 255);
+		}
+		matchLength += LZ_MIN_MATCH;
+
+		if (matchLength > (uint)(opEnd - op))
+			return false;
+
+		const uchar* match = op - offset;
+		if (offset >= matchLength)
+		{
+			memcpy(op, match, matchLength);
+			op += matchLength;
+		}
+		else
+		{
+			//Overlapped copy repeats the last offset bytes
+			for (uint i = 0; i < matchLength; ++i)
+				*op++ = match[i];
+		}
+	}
+
+	return op == opEnd;
+}
+
+//-----------------------------------------------------------------------------------------------------
+
+static void ShuffleDelta(const uchar* src, uint size, uchar* dst)
+{
+	uint count = size / 4;
+	for (uint b = 0; b < 4; ++b)
+	{
+		uchar* plane = dst + b * count;
+		uchar previous = 0;
+		for (uint i = 0; i < count; ++i)
+		{
+			uchar value = src[i * 4 + b];
+			plane[i] = value - previous;
+			previous = value;
+		}
+	}
+
+	memcpy(dst + count * 4, src + count * 4, size - count * 4);
+}
+
+static void UnshuffleDelta(const uchar* src, uint size, uchar* dst)
+{
+	uint count = size / 4;
+	for (uint b = 0; b < 4; ++b)
+	{
+		const uchar* plane = src + b * count;
+		uchar value = 0;
+		for (uint i = 0; i < count; ++i)
+		{
+			value += plane[i];
+			dst[i * 4 + b] = value;
+		}
+	}
+
+	memcpy(dst + count * 4, src + count * 4, size - count * 4);
+}
+
+static void AddChunks(std::vector<CompressionChunk>& chunks, uint offset, uint size, CompressionFilter filter)
+{
+	while (size > 0)
+	{
+		CompressionChunk chunk;
+		chunk.rawOffset = offset;
+		chunk.rawSize = size < COMPRESSION_CHUNK_SIZE ? size : COMPRESSION_CHUNK_SIZE;
+		chunk.filter = filter;
+		chunks.push_back(chunk);
+
+		offset += chunk.rawSize;
+		size -= chunk.rawSize;
+	}
+}
+
+//-----------------------------------------------------------------------------------------------------
+
+/** Compression - SaveFile: Saves the data compressed with the level, from 1 (fastest) to COMPRESSION_MAX_LEVEL. Level 0
+	saves it as it is. Sections must be sorted, the data not in any section is compressed unfiltered. */
+bool Compression::SaveFile(const char * file, const char * data, uint size, int level, const CompressionSection * sections, uint numSections, CompressionStats * stats)
+{
+	if (level <= 0)
+		return app->fs->Save(file, data, size) == size;
+
+	MEMORY_TAG(MEM_FS_BUFFERS);
+
+	if (level > COMPRESSION_MAX_LEVEL)
+		level = COMPRESSION_MAX_LEVEL;
+
+	PerfTimer timer;
+	timer.Start();
+
+	std::vector<CompressionChunk> chunks;
+	uint cursor = 0;
+	for (uint i = 0; i < numSections; ++i)
+	{
+		uint start = sections[i].offset > cursor ? sections[i].offset : cursor;
+		uint end = sections[i].offset + sections[i].size;
+		if (end > size)
+			end = size;
+		if (start >= end)
+			continue;
+
+		AddChunks(chunks, cursor, start - cursor, FILTER_NONE);
+		AddChunks(chunks, start, end - start, sections[i].filter);
+		cursor = end;
+	}
+	AddChunks(chunks, cursor, size - cursor, FILTER_NONE);
+
+	std::vector<std::vector<uchar>> compressed(chunks.size());
+	JobSystem::ParallelFor(chunks.size(), [&](uint i)
+	{
+		CompressionChunk& chunk = chunks[i];
+		const uchar* src = (const uchar*)data + chunk.rawOffset;
+
+		static thread_local std::vector<uchar> filtered;
+		if (chunk.filter == FILTER_SHUFFLE_DELTA)
+		{
+			filtered.resize(chunk.rawSize);
+			ShuffleDelta(src, chunk.rawSize, filtered.data());
+			src = filtered.data();
+		}
+
+		//Only worth it if it shrinks
+		compressed[i].resize(chunk.rawSize);
+		chunk.size = chunk.rawSize > 1 ? LZCompress(src, chunk.rawSize, compressed[i].data(), chunk.rawSize - 1, level) : 0;
+		if (chunk.size == 0)
+		{
+			chunk.size = chunk.rawSize;
+			chunk.filter = FILTER_NONE;
+			memcpy(compressed[i].data(), data + chunk.rawOffset, chunk.rawSize);
+		}
+	});
+
+	CompressionHeader header;
+	memcpy(header.magic, COMPRESSION_MAGIC, sizeof(header.magic));
+	header.rawSize = size;
+	header.numChunks = chunks.size();
+
+	uint fileSize = sizeof(header) + sizeof(CompressionChunk) * chunks.size();
+	for (uint i = 0; i < chunks.size(); ++i)
+	{
+		chunks[i].offset = fileSize;
+		fileSize += chunks[i].size;
+	}
+
+	char* buffer = new char[fileSize];
+	memcpy(buffer, &header, sizeof(header));
+	if (!chunks.empty())
+		memcpy(buffer + sizeof(header), chunks.data(), sizeof(CompressionChunk) * chunks.size());
+	for (uint i = 0; i < chunks.size(); ++i)
+		memcpy(buffer + chunks[i].offset, compressed[i].data(), chunks[i].size);
+
+	timer.Stop();
+
+	bool ret = app->fs->Save(file, buffer, fileSize) == fileSize;
+	RELEASE_ARRAY(buffer);
+
+	if (stats)
+	{
+		stats->rawBytes += size;
+		stats->compressedBytes += fileSize;
+		stats->encodeMs += timer.ReadMs();
+	}
+
+	return ret;
+}
+
+/** Compression - IsCompressed: True if the data starts with the compressed file header. */
+bool Compression::IsCompressed(const char * data, uint size)
+{
+	return data && size >= sizeof(CompressionHeader) && memcmp(data, COMPRESSION_MAGIC, 4) == 0;
+}
+
+/** Compression - GetRawSize: Size of the data once decompressed, 0 if it is not compressed. */
+uint Compression::GetRawSize(const char * data, uint size)
+{
+	if (!IsCompressed(data, size))
+		return 0;
+
+	CompressionHeader header;
+	memcpy(&header, data, sizeof(header));
+	return header.version == COMPRESSION_VERSION ? header.rawSize : 0;
+}
+
+/** Compression - Decompress: Decodes the chunks in parallel into dst, of GetRawSize bytes. False if the data is corrupted. */
+bool Compression::Decompress(const char * data, uint size, char * dst, uint rawSize, CompressionStats * stats)
+{
+	if (GetRawSize(data, size) != rawSize || dst == nullptr)
+		return false;
+
+	PerfTimer timer;
+	timer.Start();
+
+	CompressionHeader header;
+	memcpy(&header, data, sizeof(header));
+
+	if (header.numChunks > (size - sizeof(header)) / sizeof(CompressionChunk))
+		return false;
+
+	std::vector<CompressionChunk> chunks(header.numChunks);
+	if (header.numChunks > 0)
+		memcpy(chunks.data(), data + sizeof(header), sizeof(CompressionChunk) * header.numChunks);
+
+	//The chunks must cover the raw data in order
+	uint rawCursor = 0;
+	for (uint i = 0; i < chunks.size(); ++i)
+	{
+		const CompressionChunk& chunk = chunks[i];
+		if (chunk.rawOffset != rawCursor || chunk.rawSize > rawSize - rawCursor || chunk.offset > size || chunk.size > size - chunk.offset
+			|| chunk.filter > FILTER_SHUFFLE_DELTA || (chunk.size == chunk.rawSize && chunk.filter != FILTER_NONE))
+			return false;
+		rawCursor += chunk.rawSize;
+	}
+	if (rawCursor != rawSize)
+		return false;
+
+	std::atomic<bool> valid(true);
+	JobSystem::ParallelFor(chunks.size(), [&](uint i)
+	{
+		const CompressionChunk& chunk = chunks[i];
+		const uchar* src = (const uchar*)data + chunk.offset;
+		uchar* out = (uchar*)dst + chunk.rawOffset;
+
+		if (chunk.size == chunk.rawSize)
+		{
+			memcpy(out, src, chunk.size);
+		}
+		else if (chunk.filter == FILTER_SHUFFLE_DELTA)
+		{
+			static thread_local std::vector<uchar> filtered;
+			filtered.resize(chunk.rawSize);
+			if (LZDecompress(src, chunk.size, filtered.data(), chunk.rawSize))
+				UnshuffleDelta(filtered.data(), chunk.rawSize, out);
+			else
+				valid = false;
+		}
+		else if (!LZDecompress(src, chunk.size, out, chunk.rawSize))
+		{
+			valid = false;
+		}
+	});
+
+	timer.Stop();
+
+	if (stats)
+	{
+		stats->decodedBytes += rawSize;
+		stats->decodeMs += timer.ReadMs();
+	}
+
+	return valid;
+}
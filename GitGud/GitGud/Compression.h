@@ -0,0 +1,69 @@
+#ifndef __COMPRESSION_H__
+#define __COMPRESSION_H__
+
+#include "Globals.h"
+
+#define COMPRESSION_MAGIC "GGLZ"
+#define COMPRESSION_VERSION 1
+#define COMPRESSION_CHUNK_SIZE (256 * 1024)
+#define COMPRESSION_MAX_LEVEL 9
+
+/** Transform applied to a section before compressing it. */
+enum CompressionFilter
+{
+	FILTER_NONE,
+	FILTER_SHUFFLE_DELTA //Bytes of 4 byte values split in planes and delta coded. Good for float and index arrays.
+};
+
+/** Part of the data to compress with the same filter. */
+struct CompressionSection
+{
+	uint offset = 0;
+	uint size = 0;
+	CompressionFilter filter = FILTER_NONE;
+};
+
+/** Header of the compressed files, followed by the chunk table and the chunks. */
+struct CompressionHeader
+{
+	char magic[4];
+	uint version = COMPRESSION_VERSION;
+	uint rawSize = 0;
+	uint numChunks = 0;
+};
+
+/** Each chunk decodes independently. Chunks that did not shrink are stored raw, with size equal to rawSize. */
+struct CompressionChunk
+{
+	uint rawOffset = 0;
+	uint rawSize = 0;
+	uint offset = 0; //From the start of the file.
+	uint size = 0;
+	uint filter = FILTER_NONE;
+};
+
+struct CompressionStats
+{
+	uint64 rawBytes = 0;
+	uint64 compressedBytes = 0;
+	double encodeMs = 0.0;
+	uint64 decodedBytes = 0;
+	double decodeMs = 0.0;
+};
+
+/**
+*	- Block compression of the library files. LZ4 block format codec (fast, decoding is a copy loop), the higher levels only
+*	  search longer match chains.
+*	- The data is split in chunks of up to COMPRESSION_CHUNK_SIZE, compressed and decompressed in parallel with the job system.
+*/
+class Compression
+{
+public:
+	static bool SaveFile(const char* file, const char* data, uint size, int level, const CompressionSection* sections = nullptr, uint numSections = 0, CompressionStats* stats = nullptr);
+
+	static bool IsCompressed(const char* data, uint size);
+	static uint GetRawSize(const char* data, uint size);
+	static bool Decompress(const char* data, uint size, char* dst, uint rawSize, CompressionStats* stats = nullptr);
+};
+
+#endif // !__COMPRESSION_H__
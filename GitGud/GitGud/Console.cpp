@@ -1,6 +1,7 @@
 #include "Console.h"
 #include "Globals.h"
 #include "App.h"
+#include "Replay.h"
 
 
 Console::Console()
@@ -55,6 +56,7 @@ void Console::OnCmdSubmision(const char * str)
 		if (c)
 		{
 			_LOG(LOG_CMD, cmd.c_str());
+			app->replay->RecordCommand(str);
 			args.erase(args.begin());
 			c->Function(args);
 			//TODO: Push command to vector
@@ -0,0 +1,327 @@
+#include "DDS.h"
+
+#include "OpenGL.h"
+
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#define DDS_MAGIC 0x20534444 //"DDS "
+#define DDS_HEADER_SIZE 124
+#define DDS_PIXELFORMAT_SIZE 32
+#define DDS_DX10_HEADER_SIZE 20
+
+#define DDSD_CAPS 0x1
+#define DDSD_HEIGHT 0x2
+#define DDSD_WIDTH 0x4
+#define DDSD_PIXELFORMAT 0x1000
+#define DDSD_MIPMAPCOUNT 0x20000
+#define DDSD_LINEARSIZE 0x80000
+#define DDPF_FOURCC 0x4
+#define DDSCAPS_COMPLEX 0x8
+#define DDSCAPS_TEXTURE 0x1000
+#define DDSCAPS_MIPMAP 0x400000
+#define DDSCAPS2_CUBEMAP 0x200
+#define DDSCAPS2_VOLUME 0x200000
+#define DDS_DIMENSION_TEXTURE2D 3
+
+#define DXGI_FORMAT_BC1_UNORM 71
+#define DXGI_FORMAT_BC2_UNORM 74
+#define DXGI_FORMAT_BC3_UNORM 77
+#define DXGI_FORMAT_BC4_UNORM 80
+#define DXGI_FORMAT_BC5_UNORM 83
+#define DXGI_FORMAT_BC7_UNORM 98
+
+#define FOURCC(a, b, c, d) ((uint)(a) | ((uint)(b) << 8) | ((uint)(c) << 16) | ((uint)(d) << 24))
+#define DDS_BOTTOM_UP FOURCC('G', 'G', 'B', 'U') //In the first reserved field of the files the engine writes.
+
+struct DDSPixelFormat
+{
+	uint size;
+	uint flags;
+	uint fourCC;
+	uint rgbBitCount;
+	uint masks[4];
+};
+
+struct DDSHeader
+{
+	uint size;
+	uint flags;
+	uint height;
+	uint width;
+	uint pitchOrLinearSize;
+	uint depth;
+	uint mipMapCount;
+	uint reserved1[11];
+	DDSPixelFormat pixelFormat;
+	uint caps[4];
+	uint reserved2;
+};
+
+struct DDSHeaderDX10
+{
+	uint dxgiFormat;
+	uint resourceDimension;
+	uint miscFlag;
+	uint arraySize;
+	uint miscFlags2;
+};
+
+static DDSFormat GetFormatFromFourCC(uint fourCC)
+{
+	switch (fourCC)
+	{
+	case FOURCC('D', 'X', 'T', '1'): return DDS_BC1;
+	case FOURCC('D', 'X', 'T', '3'): return DDS_BC2;
+	case FOURCC('D', 'X', 'T', '5'): return DDS_BC3;
+	case FOURCC('A', 'T', 'I', '1'):
+	case FOURCC('B', 'C', '4', 'U'): return DDS_BC4;
+	case FOURCC('A', 'T', 'I', '2'):
+	case FOURCC('B', 'C', '5', 'U'): return DDS_BC5;
+	}
+
+	return DDS_UNSUPPORTED;
+}
+
+static DDSFormat GetFormatFromDXGI(uint dxgiFormat)
+{
+	switch (dxgiFormat)
+	{
+	case DXGI_FORMAT_BC1_UNORM: return DDS_BC1;
+	case DXGI_FORMAT_BC2_UNORM: return DDS_BC2;
+	case DXGI_FORMAT_BC3_UNORM: return DDS_BC3;
+	case DXGI_FORMAT_BC4_UNORM: return DDS_BC4;
+	case DXGI_FORMAT_BC5_UNORM: return DDS_BC5;
+	case DXGI_FORMAT_BC7_UNORM: return DDS_BC7;
+	}
+
+	return DDS_UNSUPPORTED;
+}
+
+bool ParseDDS(const char * data, uint size, DDSImage & image)
+{
+	image = DDSImage();
+
+	if (!data || size < 4 + DDS_HEADER_SIZE)
+		return false;
+
+	uint magic;
+	memcpy(&magic, data, sizeof(magic));
+
+	DDSHeader header;
+	memcpy(&header, data + 4, sizeof(header));
+
+	if (magic != DDS_MAGIC || header.size != DDS_HEADER_SIZE || header.pixelFormat.size != DDS_PIXELFORMAT_SIZE)
+		return false;
+
+	if ((header.caps[1] & (DDSCAPS2_CUBEMAP | DDSCAPS2_VOLUME)) != 0 || (header.pixelFormat.flags & DDPF_FOURCC) == 0)
+		return false;
+
+	uint offset = 4 + DDS_HEADER_SIZE;
+
+	if (header.pixelFormat.fourCC == FOURCC('D', 'X', '1', '0'))
+	{
+		if (size < offset + DDS_DX10_HEADER_SIZE)
+			return false;
+
+		DDSHeaderDX10 dx10;
+		memcpy(&dx10, data + offset, sizeof(dx10));
+		offset += DDS_DX10_HEADER_SIZE;
+
+		if (dx10.resourceDimension != DDS_DIMENSION_TEXTURE2D || dx10.arraySize > 1)
+			return false;
+
+		image.format = GetFormatFromDXGI(dx10.dxgiFormat);
+	}
+	else
+	{
+		image.format = GetFormatFromFourCC(header.pixelFormat.fourCC);
+	}
+
+	if (image.format == DDS_UNSUPPORTED || header.width == 0 || header.height == 0)
+		return false;
+
+	image.width = header.width;
+	image.height = header.height;
+	image.bottomUp = header.reserved1[0] == DDS_BOTTOM_UP;
+
+	uint levels = (header.flags & DDSD_MIPMAPCOUNT) && header.mipMapCount > 0 ? header.mipMapCount : 1;
+	if (levels > DDS_MAX_LEVELS)
+		levels = DDS_MAX_LEVELS;
+
+	uint blockBytes = GetDDSBlockBytes(image.format);
+	uint w = image.width;
+	uint h = image.height;
+
+	for (uint i = 0; i < levels; ++i)
+	{
+		uint64 levelSize = (uint64)((w + 3) / 4) * ((h + 3) / 4) * blockBytes;
+
+		//Files with fewer levels than they claim keep the complete ones
+		if (offset + levelSize > size)
+			break;
+
+		DDSLevel& level = image.levels[image.numLevels++];
+		level.width = w;
+		level.height = h;
+		level.offset = offset;
+		level.size = (uint)levelSize;
+
+		offset += level.size;
+		image.dataSize += level.size;
+
+		if (w == 1 && h == 1)
+			break;
+
+		w = w > 1 ? w / 2 : 1;
+		h = h > 1 ? h / 2 : 1;
+	}
+
+	return image.numLevels > 0;
+}
+
+bool WriteDDSHeader(char * dst, DDSFormat format, uint width, uint height, uint numLevels)
+{
+	uint fourCC = 0;
+	switch (format)
+	{
+	case DDS_BC1: fourCC = FOURCC('D', 'X', 'T', '1'); break;
+	case DDS_BC2: fourCC = FOURCC('D', 'X', 'T', '3'); break;
+	case DDS_BC3: fourCC = FOURCC('D', 'X', 'T', '5'); break;
+	case DDS_BC4: fourCC = FOURCC('A', 'T', 'I', '1'); break;
+	case DDS_BC5: fourCC = FOURCC('A', 'T', 'I', '2'); break;
+	default: return false;
+	}
+
+	uint magic = DDS_MAGIC;
+
+	DDSHeader header;
+	memset(&header, 0, sizeof(header));
+	header.size = DDS_HEADER_SIZE;
+	header.flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+	header.height = height;
+	header.width = width;
+	header.pitchOrLinearSize = ((width + 3) / 4) * ((height + 3) / 4) * GetDDSBlockBytes(format);
+	header.mipMapCount = numLevels;
+	header.reserved1[0] = DDS_BOTTOM_UP;
+	header.pixelFormat.size = DDS_PIXELFORMAT_SIZE;
+	header.pixelFormat.flags = DDPF_FOURCC;
+	header.pixelFormat.fourCC = fourCC;
+	header.caps[0] = DDSCAPS_TEXTURE | (numLevels > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0);
+
+	memcpy(dst, &magic, sizeof(magic));
+	memcpy(dst + 4, &header, sizeof(header));
+
+	return true;
+}
+
+/** Reverses the first rows of a BC1 color block, a byte of indices per row. */
+static void FlipColorBlock(uchar* block, uint rows)
+{
+	std::reverse(block + 4, block + 4 + rows);
+}
+
+/** Reverses the first rows of a BC2 alpha block, two bytes per row. */
+static void FlipExplicitAlphaBlock(uchar* block, uint rows)
+{
+	for (uint r = 0; r < rows / 2; ++r)
+	{
+		std::swap(block[r * 2], block[(rows - 1 - r) * 2]);
+		std::swap(block[r * 2 + 1], block[(rows - 1 - r) * 2 + 1]);
+	}
+}
+
+/** Reverses the first rows of a BC4 block (also the alpha of BC3), 12 bits of indices per row after the two endpoints. */
+static void FlipChannelBlock(uchar* block, uint rows)
+{
+	uint64 bits = 0;
+	for (uint i = 0; i < 6; ++i)
+		bits |= (uint64)block[2 + i] << (8 * i);
+
+	uint64 flipped = bits;
+	for (uint r = 0; r < rows; ++r)
+	{
+		uint64 row = (bits >> (12 * r)) & 0xFFF;
+		flipped &= ~((uint64)0xFFF << (12 * (rows - 1 - r)));
+		flipped |= row << (12 * (rows - 1 - r));
+	}
+
+	for (uint i = 0; i < 6; ++i)
+		block[2 + i] = (uchar)(flipped >> (8 * i));
+}
+
+static void FlipBlock(DDSFormat format, uchar* block, uint rows)
+{
+	switch (format)
+	{
+	case DDS_BC1: FlipColorBlock(block, rows); break;
+	case DDS_BC2: FlipExplicitAlphaBlock(block, rows); FlipColorBlock(block + 8, rows); break;
+	case DDS_BC3: FlipChannelBlock(block, rows); FlipColorBlock(block + 8, rows); break;
+	case DDS_BC4: FlipChannelBlock(block, rows); break;
+	case DDS_BC5: FlipChannelBlock(block, rows); FlipChannelBlock(block + 8, rows); break;
+	}
+}
+
+bool FlipDDSRows(char * data, DDSImage & image)
+{
+	if (image.format == DDS_UNSUPPORTED || image.format == DDS_BC7)
+		return false;
+
+	for (uint i = 0; i < image.numLevels; ++i)
+	{
+		if (image.levels[i].height > 4 && image.levels[i].height % 4 != 0)
+			return false;
+	}
+
+	uint blockBytes = GetDDSBlockBytes(image.format);
+	std::vector<uchar> rowBlocks;
+
+	for (uint i = 0; i < image.numLevels; ++i)
+	{
+		const DDSLevel& level = image.levels[i];
+		uchar* levelData = (uchar*)data + level.offset;
+		uint blocksWide = (level.width + 3) / 4;
+		uint blocksHigh = (level.height + 3) / 4;
+		uint rowBytes = blocksWide * blockBytes;
+		uint rows = std::min(level.height, 4u); //Short levels only use the first rows of their blocks
+
+		//Swap the block rows, then the rows inside every block
+		rowBlocks.resize(rowBytes);
+		for (uint y = 0; y < blocksHigh / 2; ++y)
+		{
+			uchar* top = levelData + y * rowBytes;
+			uchar* bottom = levelData + (blocksHigh - 1 - y) * rowBytes;
+			memcpy(rowBlocks.data(), top, rowBytes);
+			memcpy(top, bottom, rowBytes);
+			memcpy(bottom, rowBlocks.data(), rowBytes);
+		}
+
+		for (uint b = 0; b < blocksWide * blocksHigh; ++b)
+			FlipBlock(image.format, levelData + b * blockBytes, rows);
+	}
+
+	image.bottomUp = !image.bottomUp;
+
+	return true;
+}
+
+uint GetDDSFormatGL(DDSFormat format)
+{
+	switch (format)
+	{
+	case DDS_BC1: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+	case DDS_BC2: return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+	case DDS_BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	case DDS_BC4: return GL_COMPRESSED_RED_RGTC1;
+	case DDS_BC5: return GL_COMPRESSED_RG_RGTC2;
+	case DDS_BC7: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+	}
+
+	return 0;
+}
+
+uint GetDDSBlockBytes(DDSFormat format)
+{
+	return (format == DDS_BC1 || format == DDS_BC4) ? 8 : 16;
+}
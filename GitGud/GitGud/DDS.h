@@ -0,0 +1,60 @@
+#ifndef __DDS_H__
+#define __DDS_H__
+
+#include "Globals.h"
+
+#define DDS_MAX_LEVELS 16
+#define DDS_FILE_HEADER_SIZE 128 //Magic and header, without the DX10 extension.
+
+/** Block compressed formats the engine uploads without decoding. */
+enum DDSFormat
+{
+	DDS_UNSUPPORTED = 0,
+	DDS_BC1,	//DXT1
+	DDS_BC2,	//DXT3
+	DDS_BC3,	//DXT5
+	DDS_BC4,	//ATI1, one channel
+	DDS_BC5,	//ATI2, two channels (normal maps)
+	DDS_BC7
+};
+
+/** A mip level, its data is a range of the file. */
+struct DDSLevel
+{
+	uint width = 0;
+	uint height = 0;
+	uint offset = 0;
+	uint size = 0;
+};
+
+/** Layout of a block compressed DDS file: format and the stored mip levels, from the largest. */
+struct DDSImage
+{
+	DDSFormat format = DDS_UNSUPPORTED;
+	uint width = 0;
+	uint height = 0;
+	uint numLevels = 0;
+	DDSLevel levels[DDS_MAX_LEVELS];
+	uint dataSize = 0;		//All the levels, what they take on the GPU.
+	bool bottomUp = false;	//Rows stored from the bottom like GL takes them. Only the files the engine writes, the rest are top down.
+};
+
+/** Parses the header of a 2D DDS file. False if it is not one or its format is not block compressed, the uncompressed and
+	cube or volume files go through DevIL. */
+bool ParseDDS(const char* data, uint size, DDSImage& image);
+
+/** GL internal format of a DDS format, 0 for the unsupported one. */
+uint GetDDSFormatGL(DDSFormat format);
+
+/** Writes the magic and header of a 2D DDS file with the levels, DDS_FILE_HEADER_SIZE bytes. The levels must be stored from the
+	bottom row, the header is marked so. False for the formats without a legacy four CC (BC7). */
+bool WriteDDSHeader(char* dst, DDSFormat format, uint width, uint height, uint numLevels);
+
+/** Reverses the row order of every level in the file data, swapping the rows of blocks without decoding them. False without touching
+	the data if a level can't be flipped so: BC7 or heights over 4 that are not a multiple of 4. */
+bool FlipDDSRows(char* data, DDSImage& image);
+
+/** Bytes of a 4x4 block of the format. */
+uint GetDDSBlockBytes(DDSFormat format);
+
+#endif // !__DDS_H__
@@ -0,0 +1,267 @@
+#include "DebugRenderer.h"
+
+#include "RenderPacket.h"
+#include "GLState.h"
+#include "RenderBackend.h"
+
+#include "OpenGL.h"
+
+#define DEBUG_MIN_CAPACITY 4096
+
+static const char* debugVertexShader =
+"#version 330 core\n"
+"layout(location = 0) in vec3 position;\n"
+"layout(location = 1) in vec4 color;\n"
+"uniform mat4 view;\n"
+"uniform mat4 projection;\n"
+"out vec4 lineColor;\n"
+"void main()\n"
+"{\n"
+"	gl_Position = projection * view * vec4(position, 1.0);\n"
+"	lineColor = color;\n"
+"}\n";
+
+static const char* debugFragmentShader =
+"#version 330 core\n"
+"in vec4 lineColor;\n"
+"out vec4 color;\n"
+"void main()\n"
+"{\n"
+"	color = lineColor;\n"
+"}\n";
+
+static uchar ToByte(float c)
+{
+	return (uchar)((c <= 0.0f) ? 0 : (c >= 1.0f) ? 255 : (uint)(c * 255.0f + 0.5f));
+}
+
+static void SetVertex(DebugVertex& vertex, const float3& position, const Color& color)
+{
+	vertex.position[0] = position.x;
+	vertex.position[1] = position.y;
+	vertex.position[2] = position.z;
+	vertex.color[0] = ToByte(color.r);
+	vertex.color[1] = ToByte(color.g);
+	vertex.color[2] = ToByte(color.b);
+	vertex.color[3] = ToByte(color.a);
+}
+
+/** Sets the debug vertex layout on the bound VAO and array buffer. */
+static void SetupAttributes()
+{
+	RenderBackend::Get()->VertexAttribute(0, 3, GL_FLOAT, false, sizeof(DebugVertex), 0);
+	RenderBackend::Get()->VertexAttribute(1, 4, GL_UNSIGNED_BYTE, true, sizeof(DebugVertex), sizeof(float) * 3);
+}
+
+static uint CompileShader(GLenum type, const char* code)
+{
+	std::string log;
+	uint shader = RenderBackend::Get()->CompileShader(type, code, log);
+	if (shader == 0)
+		_LOG(LOG_ERROR, "Debug renderer: Shader compilation error: %s.", log.c_str());
+
+	return shader;
+}
+
+//=============================================================================
+
+/** DebugDrawData - AddLine: Appends a line to the group of its width. */
+void DebugDrawData::AddLine(const float3& origin, const float3& destination, const Color& color, float width)
+{
+	DebugLineBatch* batch = nullptr;
+	for (uint i = 0; i < numBatches && batch == nullptr; ++i)
+	{
+		if (batches[i].width == width)
+			batch = &batches[i];
+	}
+
+	if (batch == nullptr)
+	{
+		if (batches.size() <= numBatches)
+			batches.push_back(DebugLineBatch());
+
+		batch = &batches[numBatches++];
+		batch->width = width;
+		batch->vertices.clear();
+	}
+
+	batch->vertices.resize(batch->vertices.size() + 2);
+	DebugVertex* v = &batch->vertices[batch->vertices.size() - 2];
+	SetVertex(v[0], origin, color);
+	SetVertex(v[1], destination, color);
+}
+
+void DebugDrawData::Clear()
+{
+	numBatches = 0;
+	grid = false;
+}
+
+uint DebugDrawData::GetVertexCount() const
+{
+	uint ret = 0;
+	for (uint i = 0; i < numBatches; ++i)
+		ret += batches[i].vertices.size();
+	return ret;
+}
+
+//=============================================================================
+
+DebugRenderer::DebugRenderer()
+{
+}
+
+DebugRenderer::~DebugRenderer()
+{
+}
+
+/** DebugRenderer - Draw: Draws the grid and uploads all the lines at once, then draws each width group. */
+void DebugRenderer::Draw(const DebugDrawData & data, const float * view, const float * projection)
+{
+	const uint numVertices = data.GetVertexCount();
+	if (!data.grid && numVertices == 0)
+		return;
+
+	if (program == 0 && !CreateObjects())
+		return;
+
+	RenderBackend* backend = RenderBackend::Get();
+
+	GLState::UseProgram(program);
+	backend->UniformMatrix4(viewLoc, view);
+	backend->UniformMatrix4(projLoc, projection);
+
+	if (data.grid)
+	{
+		const Color& c = data.gridColor;
+		if (idGridContainer == 0 || c.r != gridColor.r || c.g != gridColor.g || c.b != gridColor.b || c.a != gridColor.a)
+			BuildGrid(c);
+
+		GLState::BindVertexArray(idGridContainer);
+		GLState::LineWidth(1.0f);
+		backend->DrawArrays(GL_LINES, 0, gridVertices);
+	}
+
+	if (numVertices > 0)
+	{
+		GLState::BindVertexArray(idContainer);
+		GLState::BindBuffer(GL_ARRAY_BUFFER, idVertices);
+
+		if (numVertices > capacity)
+			capacity = MAX(numVertices + numVertices / 2, DEBUG_MIN_CAPACITY);
+
+		//Orphan the previous storage so the upload doesn't wait for the last frame draws
+		backend->BufferData(GL_ARRAY_BUFFER, sizeof(DebugVertex) * capacity, nullptr, GL_STREAM_DRAW);
+		char* dst = (char*)backend->MapBufferRange(GL_ARRAY_BUFFER, 0, sizeof(DebugVertex) * numVertices, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		if (dst)
+		{
+			for (uint i = 0; i < data.numBatches; ++i)
+			{
+				const std::vector<DebugVertex>& vertices = data.batches[i].vertices;
+				if (!vertices.empty())
+				{
+					memcpy(dst, vertices.data(), sizeof(DebugVertex) * vertices.size());
+					dst += sizeof(DebugVertex) * vertices.size();
+				}
+			}
+			backend->UnmapBuffer(GL_ARRAY_BUFFER);
+
+			uint first = 0;
+			for (uint i = 0; i < data.numBatches; ++i)
+			{
+				const uint count = data.batches[i].vertices.size();
+				if (count > 0)
+				{
+					GLState::LineWidth(data.batches[i].width);
+					backend->DrawArrays(GL_LINES, first, count);
+					first += count;
+				}
+			}
+		}
+	}
+}
+
+/** DebugRenderer - CleanUp: Deletes the GL objects. Must run with the render context current. */
+void DebugRenderer::CleanUp()
+{
+	GLState::DeleteProgram(program);
+	GLState::DeleteBuffer(idVertices);
+	GLState::DeleteVertexArray(idContainer);
+	GLState::DeleteBuffer(idGridVertices);
+	GLState::DeleteVertexArray(idGridContainer);
+
+	program = idVertices = idContainer = idGridVertices = idGridContainer = 0;
+	capacity = gridVertices = 0;
+	failed = false;
+}
+
+/** DebugRenderer - CreateObjects: Compiles the line shader and creates the lines buffer. Only tried once. */
+bool DebugRenderer::CreateObjects()
+{
+	if (failed)
+		return false;
+
+	RenderBackend* backend = RenderBackend::Get();
+
+	uint shaders[2] = { CompileShader(GL_VERTEX_SHADER, debugVertexShader), CompileShader(GL_FRAGMENT_SHADER, debugFragmentShader) };
+
+	if (shaders[0] != 0 && shaders[1] != 0)
+	{
+		std::string log;
+		program = backend->LinkProgram(shaders, 2, log);
+		if (program == 0)
+			_LOG(LOG_ERROR, "Debug renderer: Shader link error: %s.", log.c_str());
+	}
+
+	if (shaders[0] != 0) backend->DeleteShader(shaders[0]);
+	if (shaders[1] != 0) backend->DeleteShader(shaders[1]);
+
+	if (program == 0)
+	{
+		failed = true;
+		return false;
+	}
+
+	viewLoc = backend->GetUniformLocation(program, "view");
+	projLoc = backend->GetUniformLocation(program, "projection");
+
+	idContainer = backend->GenVertexArray();
+	idVertices = backend->GenBuffer();
+
+	GLState::BindVertexArray(idContainer);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, idVertices);
+	SetupAttributes();
+
+	return true;
+}
+
+/** DebugRenderer - BuildGrid: Uploads the grid lines into their own static buffer. */
+void DebugRenderer::BuildGrid(const Color & color)
+{
+	gridColor = color;
+
+	std::vector<DebugVertex> vertices;
+	vertices.reserve((DEBUG_GRID_SIZE * 2 + 1) * 4);
+
+	const float d = (float)DEBUG_GRID_SIZE;
+	DebugVertex v;
+	for (float i = -d; i <= d; i += 1.f)
+	{
+		SetVertex(v, float3(i, 0.0f, -d), color); vertices.push_back(v);
+		SetVertex(v, float3(i, 0.0f, d), color); vertices.push_back(v);
+		SetVertex(v, float3(-d, 0.0f, i), color); vertices.push_back(v);
+		SetVertex(v, float3(d, 0.0f, i), color); vertices.push_back(v);
+	}
+	gridVertices = vertices.size();
+
+	if (idGridContainer == 0)
+	{
+		idGridContainer = RenderBackend::Get()->GenVertexArray();
+		idGridVertices = RenderBackend::Get()->GenBuffer();
+	}
+
+	GLState::BindVertexArray(idGridContainer);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, idGridVertices);
+	RenderBackend::Get()->BufferData(GL_ARRAY_BUFFER, sizeof(DebugVertex) * vertices.size(), vertices.data(), GL_STATIC_DRAW);
+	SetupAttributes();
+}
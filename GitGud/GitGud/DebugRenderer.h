@@ -0,0 +1,45 @@
+#ifndef __DEBUG_RENDERER_H__
+#define __DEBUG_RENDERER_H__
+
+#include "Globals.h"
+#include "Color.h"
+
+struct DebugDrawData;
+
+#define DEBUG_GRID_SIZE 200 //Half size of the grid, in units.
+
+/**
+*	- Render side of the debug draws. All the frame lines go into a single streamed VBO and each width group
+*	  is drawn with one glDrawArrays. The grid is built once into its own VBO.
+*	- Owns its own small line shader so it doesn't depend on the fixed pipeline.
+*/
+class DebugRenderer
+{
+public:
+	DebugRenderer();
+	~DebugRenderer();
+
+	void Draw(const DebugDrawData& data, const float* view, const float* projection);
+	void CleanUp();
+
+private:
+	bool CreateObjects();
+	void BuildGrid(const Color& color);
+
+private:
+	uint program = 0;
+	int viewLoc = -1;
+	int projLoc = -1;
+	bool failed = false;
+
+	uint idContainer = 0;
+	uint idVertices = 0;
+	uint capacity = 0; //Vertices that fit in the lines buffer.
+
+	uint idGridContainer = 0;
+	uint idGridVertices = 0;
+	uint gridVertices = 0;
+	Color gridColor;
+};
+
+#endif // !__DEBUG_RENDERER_H__
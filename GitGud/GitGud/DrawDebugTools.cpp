@@ -1,9 +1,7 @@
 #include "DrawDebugTools.h"
-#include "M_Camera3D.h"
-#include "Camera.h"
-#include "App.h"
+#include "RenderPacket.h"
 
-#include "OpenGL.h"
+DebugDrawData* DrawDebug::target = nullptr;
 
 DrawDebug::DrawDebug()
 {
@@ -13,206 +11,64 @@ DrawDebug::~DrawDebug()
 {
 }
 
-void DrawDebug::DrawGrid(Color color)
+/** DrawDebug - SetTarget: Sets where the lines are collected. With no target the debug draws are ignored. */
+void DrawDebug::SetTarget(DebugDrawData* data)
 {
-	StartDrawDebug();
-
-	glLineWidth(1.0f);
-	glColor3f(color.r, color.g, color.b);
-
-	glBegin(GL_LINES);
+	target = data;
+}
 
-	float d = 200.f;
-	for (float i = -d; i <= d; i += 1.f)
+/** DrawDebug - DrawGrid: The grid never changes, the render side keeps it cached and it is only flagged here. */
+void DrawDebug::DrawGrid(Color color)
+{
+	if (target)
 	{
-		glVertex3f(i, 0.0f, -d);
-		glVertex3f(i, 0.0f, d);
-		glVertex3f(-d, 0.0f, i);
-		glVertex3f(d, 0.0f, i);
+		target->grid = true;
+		target->gridColor = color;
 	}
-
-	glEnd();
-
-	EndDrawDebug();
 }
 
 void DrawDebug::DrawAABB(AABB & box, Color color)
 {
-	StartDrawDebug();
-
-	float3 vertices[8];
-	box.GetCornerPoints(vertices);
-
-	glColor4f(color.r, color.g, color.b, color.a);
-
-	glBegin(GL_QUADS);
-
-	glVertex3fv((GLfloat*)&vertices[1]);
-	glVertex3fv((GLfloat*)&vertices[5]);
-	glVertex3fv((GLfloat*)&vertices[7]);
-	glVertex3fv((GLfloat*)&vertices[3]);
-
-	glVertex3fv((GLfloat*)&vertices[4]);
-	glVertex3fv((GLfloat*)&vertices[0]);
-	glVertex3fv((GLfloat*)&vertices[2]);
-	glVertex3fv((GLfloat*)&vertices[6]);
-
-	glVertex3fv((GLfloat*)&vertices[5]);
-	glVertex3fv((GLfloat*)&vertices[4]);
-	glVertex3fv((GLfloat*)&vertices[6]);
-	glVertex3fv((GLfloat*)&vertices[7]);
-
-	glVertex3fv((GLfloat*)&vertices[0]);
-	glVertex3fv((GLfloat*)&vertices[1]);
-	glVertex3fv((GLfloat*)&vertices[3]);
-	glVertex3fv((GLfloat*)&vertices[2]);
-
-	glVertex3fv((GLfloat*)&vertices[3]);
-	glVertex3fv((GLfloat*)&vertices[7]);
-	glVertex3fv((GLfloat*)&vertices[6]);
-	glVertex3fv((GLfloat*)&vertices[2]);
-
-	glVertex3fv((GLfloat*)&vertices[0]);
-	glVertex3fv((GLfloat*)&vertices[4]);
-	glVertex3fv((GLfloat*)&vertices[5]);
-	glVertex3fv((GLfloat*)&vertices[1]);
-
-	glEnd();
-
-	EndDrawDebug();
+	for (int i = 0; i < 12; ++i)
+	{
+		LineSegment edge = box.Edge(i);
+		DrawLine(edge.a, edge.b, 1.f, color);
+	}
 }
 
 void DrawDebug::DrawFrustumDebug(Frustum & frust, Color color)
 {
-	StartDrawDebug();
-
-	float3 vertices[8];
-	frust.GetCornerPoints(vertices);
-
-	glColor4f(color.r, color.g, color.b, color.a);
-
-	glBegin(GL_QUADS);
-
-	glVertex3fv((GLfloat*)&vertices[1]);
-	glVertex3fv((GLfloat*)&vertices[5]);
-	glVertex3fv((GLfloat*)&vertices[7]);
-	glVertex3fv((GLfloat*)&vertices[3]);
-
-	glVertex3fv((GLfloat*)&vertices[4]);
-	glVertex3fv((GLfloat*)&vertices[0]);
-	glVertex3fv((GLfloat*)&vertices[2]);
-	glVertex3fv((GLfloat*)&vertices[6]);
-
-	glVertex3fv((GLfloat*)&vertices[5]);
-	glVertex3fv((GLfloat*)&vertices[4]);
-	glVertex3fv((GLfloat*)&vertices[6]);
-	glVertex3fv((GLfloat*)&vertices[7]);
-
-	glVertex3fv((GLfloat*)&vertices[0]);
-	glVertex3fv((GLfloat*)&vertices[1]);
-	glVertex3fv((GLfloat*)&vertices[3]);
-	glVertex3fv((GLfloat*)&vertices[2]);
-
-	glVertex3fv((GLfloat*)&vertices[3]);
-	glVertex3fv((GLfloat*)&vertices[7]);
-	glVertex3fv((GLfloat*)&vertices[6]);
-	glVertex3fv((GLfloat*)&vertices[2]);
-
-	glVertex3fv((GLfloat*)&vertices[0]);
-	glVertex3fv((GLfloat*)&vertices[4]);
-	glVertex3fv((GLfloat*)&vertices[5]);
-	glVertex3fv((GLfloat*)&vertices[1]);
-
-	glEnd();
-
-	EndDrawDebug();
+	for (int i = 0; i < 12; ++i)
+	{
+		LineSegment edge = frust.Edge(i);
+		DrawLine(edge.a, edge.b, 1.f, color);
+	}
 }
 
 void DrawDebug::DrawAxis(float3 position)
 {
-	StartDrawDebug();
-	
-	float4x4 model = float4x4::FromTRS(position, Quat::identity, float3::one);
-	glPushMatrix();
-	glMultMatrixf(model.Transposed().ptr());
-
-	//---------------------------------------------
-
-	glLineWidth(2.0f);
-
-	glBegin(GL_LINES);
-
-	glColor4f(1.0f, 0.0f, 0.0f, 1.0f);
-
-	glVertex3f(0.0f, 0.0f, 0.0f); glVertex3f(1.0f, 0.0f, 0.0f);
-	glVertex3f(1.0f, 0.1f, 0.0f); glVertex3f(1.1f, -0.1f, 0.0f);
-	glVertex3f(1.1f, 0.1f, 0.0f); glVertex3f(1.0f, -0.1f, 0.0f);
-
-	glColor4f(0.0f, 1.0f, 0.0f, 1.0f);
-
-	glVertex3f(0.0f, 0.0f, 0.0f); glVertex3f(0.0f, 1.0f, 0.0f);
-	glVertex3f(-0.05f, 1.25f, 0.0f); glVertex3f(0.0f, 1.15f, 0.0f);
-	glVertex3f(0.05f, 1.25f, 0.0f); glVertex3f(0.0f, 1.15f, 0.0f);
-	glVertex3f(0.0f, 1.15f, 0.0f); glVertex3f(0.0f, 1.05f, 0.0f);
-
-	glColor4f(0.0f, 0.0f, 1.0f, 1.0f);
-
-	glVertex3f(0.0f, 0.0f, 0.0f); glVertex3f(0.0f, 0.0f, 1.0f);
-	glVertex3f(-0.05f, 0.1f, 1.05f); glVertex3f(0.05f, 0.1f, 1.05f);
-	glVertex3f(0.05f, 0.1f, 1.05f); glVertex3f(-0.05f, -0.1f, 1.05f);
-	glVertex3f(-0.05f, -0.1f, 1.05f); glVertex3f(0.05f, -0.1f, 1.05f);
-
-	glEnd();
-
-	//---------------------------------------------
-
-	glPopMatrix();
-	
-	EndDrawDebug();
+	const Color red(1.0f, 0.0f, 0.0f, 1.0f);
+	const Color green(0.0f, 1.0f, 0.0f, 1.0f);
+	const Color blue(0.0f, 0.0f, 1.0f, 1.0f);
+	const float3& p = position;
+
+	DrawLine(p + float3(0.0f, 0.0f, 0.0f), p + float3(1.0f, 0.0f, 0.0f), 2.0f, red);
+	DrawLine(p + float3(1.0f, 0.1f, 0.0f), p + float3(1.1f, -0.1f, 0.0f), 2.0f, red);
+	DrawLine(p + float3(1.1f, 0.1f, 0.0f), p + float3(1.0f, -0.1f, 0.0f), 2.0f, red);
+
+	DrawLine(p + float3(0.0f, 0.0f, 0.0f), p + float3(0.0f, 1.0f, 0.0f), 2.0f, green);
+	DrawLine(p + float3(-0.05f, 1.25f, 0.0f), p + float3(0.0f, 1.15f, 0.0f), 2.0f, green);
+	DrawLine(p + float3(0.05f, 1.25f, 0.0f), p + float3(0.0f, 1.15f, 0.0f), 2.0f, green);
+	DrawLine(p + float3(0.0f, 1.15f, 0.0f), p + float3(0.0f, 1.05f, 0.0f), 2.0f, green);
+
+	DrawLine(p + float3(0.0f, 0.0f, 0.0f), p + float3(0.0f, 0.0f, 1.0f), 2.0f, blue);
+	DrawLine(p + float3(-0.05f, 0.1f, 1.05f), p + float3(0.05f, 0.1f, 1.05f), 2.0f, blue);
+	DrawLine(p + float3(0.05f, 0.1f, 1.05f), p + float3(-0.05f, -0.1f, 1.05f), 2.0f, blue);
+	DrawLine(p + float3(-0.05f, -0.1f, 1.05f), p + float3(0.05f, -0.1f, 1.05f), 2.0f, blue);
 }
 
 void DrawDebug::DrawLine(float3 origin, float3 destination, float width, Color color)
 {
-	StartDrawDebug();
-
-	glLineWidth(width);
-
-	glBegin(GL_LINES);
-
-	glColor3f(color.r, color.g, color.b);
-
-	glVertex3f(origin.x, origin.y, origin.z);
-	glVertex3f(destination.x, destination.y, destination.z);
-
-	glEnd();
-
-	EndDrawDebug();
-}
-
-void DrawDebug::StartDrawDebug()
-{
-	glUseProgram(0);
-
-	glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-
-	Camera* cam = app->camera->GetEditorCamera();
-
-	if (cam)
-	{
-		glPushMatrix();
-		glMultMatrixf(cam->GetGLProjectionMatrix());
-		glPushMatrix();
-		glMultMatrixf(cam->GetGLViewMatrix());
-	}
-}
-
-void DrawDebug::EndDrawDebug()
-{
-	glPopMatrix();
-	glPopMatrix();
-
-	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-
-	glLineWidth(1.f);
-	glColor4f(1.f, 1.f, 1.f, 1.f);
+	if (target)
+		target->AddLine(origin, destination, color, width);
 }
@@ -4,12 +4,17 @@
 #include "Math.h"
 #include "Color.h"
 
+struct DebugDrawData;
+
+/** Debug shapes are not drawn here, their lines are collected into the target (the render packet of the frame) and drawn in batches by the render side. */
 static class DrawDebug
 {
 public:
 	DrawDebug();
 	~DrawDebug();
 
+	static void SetTarget(DebugDrawData* data);
+
 	static void DrawGrid(Color color = White);
 	static void DrawAABB(AABB& box, Color color = White);
 	static void DrawFrustumDebug(Frustum& frust, Color color = White);
@@ -17,8 +22,7 @@ public:
 	static void DrawLine(float3 origin, float3 destination, float width = 1.f, Color color = White);
 
 private:
-	static void StartDrawDebug();
-	static void EndDrawDebug();
+	static DebugDrawData* target;
 
 };
 
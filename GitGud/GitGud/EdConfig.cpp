@@ -12,10 +12,16 @@
 #endif // _DEBUG
 
 #include "M_Renderer.h"
+#include "StaticBatcher.h"
+#include "GLState.h"
+#include "RenderThread.h"
 #include "M_Window.h"
 #include "M_Input.h"
 #include "M_FileSystem.h"
 #include "M_GoManager.h"
+#include "M_ResourceManager.h"
+#include "MemoryTracker.h"
+#include "FrameAllocator.h"
 #include "GameObject.h"
 #include "Camera.h"
 
@@ -97,6 +103,68 @@ void EdConfig::Draw()
 #endif //_DEBUG
 		}
 
+		if (ImGui::CollapsingHeader("Memory"))
+		{
+			if (MemoryTracker::IsTrackingNew())
+				ImGui::Text("Tracking every allocation.");
+			else
+				ImGui::TextColored(ImVec4(1, 0.5f, 0, 1), "Tracking only the explicit allocations (ImGui...), new is not hooked in this build.");
+
+			ImGui::Columns(4, "MemoryTags");
+			ImGui::Text("Tag"); ImGui::NextColumn();
+			ImGui::Text("KB"); ImGui::NextColumn();
+			ImGui::Text("Peak KB"); ImGui::NextColumn();
+			ImGui::Text("Allocations"); ImGui::NextColumn();
+			ImGui::Separator();
+
+			MemoryTagStats stats;
+			for (uint i = 0; i < MEM_TAG_COUNT; ++i)
+			{
+				MemoryTracker::GetStats((MemoryTag)i, stats);
+				ImGui::Text("%s", MemoryTracker::GetTagName((MemoryTag)i)); ImGui::NextColumn();
+				ImGui::TextColored(ImVec4(1, 1, 0, 1), "%.1f", stats.bytes / 1024.0); ImGui::NextColumn();
+				ImGui::Text("%.1f", stats.peakBytes / 1024.0); ImGui::NextColumn();
+				ImGui::Text("%llu (%llu total)", stats.allocations, stats.totalAllocations); ImGui::NextColumn();
+			}
+
+			ImGui::Separator();
+			MemoryTracker::GetTotal(stats);
+			ImGui::Text("Total"); ImGui::NextColumn();
+			ImGui::TextColored(ImVec4(1, 1, 0, 1), "%.1f", stats.bytes / 1024.0); ImGui::NextColumn();
+			ImGui::Text("%.1f", stats.peakBytes / 1024.0); ImGui::NextColumn();
+			ImGui::Text("%llu (%llu total)", stats.allocations, stats.totalAllocations); ImGui::NextColumn();
+			ImGui::Columns(1);
+
+			ResourceMemory resMemory;
+			app->resources->GetMemoryUsage(resMemory);
+
+			ImGui::Separator();
+			ImGui::Text("Meshes in memory: %u", resMemory.meshes);
+			ImGui::Text("Mesh CPU:");
+			ImGui::SameLine();
+			ImGui::TextColored(ImVec4(1, 1, 0, 1), "%.1f KB", resMemory.meshCpuBytes / 1024.0);
+			ImGui::Text("Mesh VRAM:");
+			ImGui::SameLine();
+			ImGui::TextColored(ImVec4(1, 1, 0, 1), "%.1f KB", resMemory.meshVramBytes / 1024.0);
+			ImGui::Text("Textures in memory: %u", resMemory.textures);
+			ImGui::Text("Texture VRAM (estimated):");
+			ImGui::SameLine();
+			ImGui::TextColored(ImVec4(1, 1, 0, 1), "%.1f KB", resMemory.textureVramBytes / 1024.0);
+
+			FrameAllocatorStats frameStats;
+			FrameAllocator::GetStats(frameStats);
+
+			ImGui::Separator();
+			ImGui::Text("Frame allocator: %.1f KB of %.1f KB (peak %.1f KB), %u allocations.", frameStats.usedBytes / 1024.0,
+				frameStats.capacity / 1024.0, frameStats.peakBytes / 1024.0, frameStats.allocations);
+			ImGui::Text("Overflow blocks:");
+			ImGui::SameLine();
+			ImGui::TextColored(frameStats.overflowBlocks > 0 ? ImVec4(1, 0.5f, 0, 1) : ImVec4(1, 1, 0, 1), "%u", frameStats.overflowBlocks);
+			ImGui::Text("Hot path heap allocations:");
+			ImGui::SameLine();
+			ImGui::TextColored(frameStats.hotPathHeapAllocations > 0 ? ImVec4(1, 0, 0, 1) : ImVec4(1, 1, 0, 1), "%u", frameStats.hotPathHeapAllocations);
+		}
+
 		if (ImGui::CollapsingHeader("Window"))
 		{
 			ImGui::Text("Icon:");//TODO: add functionality to change app icon
@@ -143,6 +211,69 @@ void EdConfig::Draw()
 		{
 			bool vsync = app->renderer->GetVSync();
 			if (ImGui::Checkbox("VSyc", &vsync)) app->renderer->SetVSync(vsync);
+
+			ImGui::Checkbox("Static batching", &app->renderer->staticBatching);
+			const StaticBatcher* batcher = app->renderer->GetStaticBatcher();
+			if (batcher)
+			{
+				ImGui::Text("Batches: ");
+				ImGui::SameLine();
+				ImGui::TextColored(ImVec4(1, 1, 0, 1), "%u", batcher->GetBatchCount());
+
+				ImGui::Text("Batched objects: ");
+				ImGui::SameLine();
+				ImGui::TextColored(ImVec4(1, 1, 0, 1), "%u", batcher->GetBatchedObjects());
+
+				ImGui::Text("Batched triangles: ");
+				ImGui::SameLine();
+				ImGui::TextColored(ImVec4(1, 1, 0, 1), "%u", batcher->GetBatchedTriangles());
+
+				ImGui::Text("Batch draw calls: ");
+				ImGui::SameLine();
+				ImGui::TextColored(ImVec4(1, 1, 0, 1), "%u", batcher->GetLastDrawCalls());
+			}
+
+			ImGui::Separator();
+
+			uint issued = GLState::GetIssuedCalls();
+			uint skipped = GLState::GetSkippedCalls();
+
+			ImGui::Text("GL state calls issued: ");
+			ImGui::SameLine();
+			ImGui::TextColored(ImVec4(1, 1, 0, 1), "%u", issued);
+
+			ImGui::Text("GL state calls skipped: ");
+			ImGui::SameLine();
+			ImGui::TextColored(ImVec4(1, 1, 0, 1), "%u (%.1f%%)", skipped, (issued + skipped > 0) ? 100.0f * skipped / (issued + skipped) : 0.0f);
+
+			const RenderThread* renderThread = app->renderer->GetRenderThread();
+			if (renderThread)
+			{
+				ImGui::Separator();
+
+				ImGui::Text("Render thread: ");
+				ImGui::SameLine();
+				ImGui::TextColored(ImVec4(1, 1, 0, 1), renderThread->IsThreaded() ? "On" : "Off (set render_thread in the config)");
+
+				ImGui::Text("Render busy: ");
+				ImGui::SameLine();
+				ImGui::TextColored(ImVec4(1, 1, 0, 1), "%.2f ms", renderThread->GetRenderBusyMs());
+
+				if (renderThread->IsThreaded())
+				{
+					ImGui::Text("Render idle: ");
+					ImGui::SameLine();
+					ImGui::TextColored(ImVec4(1, 1, 0, 1), "%.2f ms", renderThread->GetRenderIdleMs());
+
+					ImGui::Text("Main thread waiting: ");
+					ImGui::SameLine();
+					ImGui::TextColored(ImVec4(1, 1, 0, 1), "%.2f ms", renderThread->GetMainWaitMs());
+
+					ImGui::Text("Frames in flight: ");
+					ImGui::SameLine();
+					ImGui::TextColored(ImVec4(1, 1, 0, 1), "%u", renderThread->GetFramesInFlight());
+				}
+			}
 		}
 
 		if(ImGui::CollapsingHeader("FileSystem"))
@@ -312,7 +443,7 @@ void EdConfig::Draw()
 
 			if (ImGui::TreeNodeEx("Static objects"))
 			{
-				std::vector<GameObject*> stc;
+				FrameVector<GameObject*> stc;
 				app->goManager->GetToDrawStaticObjects(stc, app->camera->GetEditorCamera());
 
 				for (auto it : stc)
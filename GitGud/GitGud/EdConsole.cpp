@@ -7,6 +7,8 @@
 
 EdConsole::EdConsole(bool startEnabled) : EdWin(startEnabled)
 {
+	colors.resize(CONSOLE_MAX_LINES);
+	log.resize(CONSOLE_MAX_LINES);
 }
 
 
@@ -35,17 +37,23 @@ void EdConsole::Draw()
 		if (ImGui::Button("Clear"))
 		{
 			//logs.clear();
-			log.clear();
-			colors.clear();
+			firstLine = 0;
+			numLines = 0;
 		}
 
 		ImGui::BeginChild("", ImVec2(sclx - 20, scly - 75), true);
 		{
 			//ImGui::TextUnformatted(logs.begin());
 
-			for (uint i = 0; i < colors.size(); ++i)
+			//Only the visible lines are drawn
+			ImGuiListClipper clipper(numLines);
+			while (clipper.Step())
 			{
-				ImGui::TextColored(colors[i], log[i].c_str());
+				for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
+				{
+					uint line = (firstLine + i) % CONSOLE_MAX_LINES;
+					ImGui::TextColored(colors[line], "%s", log[line].c_str());
+				}
 			}
 
 			if (scrollDown)
@@ -100,7 +108,13 @@ void EdConsole::PushMessage(const char * str, LogType type)
 			break;
 		}
 
-		log.push_back(str);
-		colors.push_back(lastColor);
+		uint line = (firstLine + numLines) % CONSOLE_MAX_LINES;
+		if (numLines == CONSOLE_MAX_LINES)
+			firstLine = (firstLine + 1) % CONSOLE_MAX_LINES;
+		else
+			++numLines;
+
+		log[line].assign(str);
+		colors[line] = lastColor;
 	}
 }
@@ -6,6 +6,8 @@
 #include <vector>
 #include <string>
 
+#define CONSOLE_MAX_LINES 1000 //Older lines are overwritten.
+
 class EdConsole : public EdWin
 {
 public:
@@ -20,8 +22,12 @@ private:
 	ImGuiTextBuffer logs;
 	bool scrollDown = true;
 	ImColor lastColor;
+
+	//Ring buffer of the last lines, the strings keep their capacity when overwritten
 	std::vector<ImColor> colors;
 	std::vector<std::string> log;
+	uint firstLine = 0;
+	uint numLines = 0;
 };
 
 #endif //!__EDCONSOLE_H__
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include "EdProfiler.h"
+#include "App.h"
+#include "GG_Clock.h"
+
+#include "imGUI\imgui.h"
+
+#include <map>
+#include <algorithm>
+
+#define FLAME_ROW_HEIGHT 18.0f
+
+/** Returns a stable color for a scope name. */
+static ImU32 ScopeColor(const char* name)
+{
+	uint hash = 2166136261u;
+	for (const char* c = name; c && *c != '\0'; ++c)
+		hash = (hash ^ (uchar)*c) * 16777619u;
+
+	return ImColor::HSV((hash % 360) / 360.0f, 0.45f, 0.75f);
+}
+
+EdProfiler::EdProfiler(bool startEnabled) : EdWin(startEnabled)
+{
+}
+
+
+EdProfiler::~EdProfiler()
+{
+}
+
+void EdProfiler::Draw()
+{
+	ImGui::Begin("Profiler", &active);
+	{
+#if GG_PROFILER
+		bool paused = Profiler::IsPaused();
+		if (ImGui::Checkbox("Pause", &paused))
+		{
+			Profiler::SetPaused(paused);
+			selectedFrame = 0;
+		}
+
+		ImGui::SameLine();
+		if (ImGui::Button("Export trace"))
+		{
+			std::string file = PROFILER_PATH + std::string("trace_") + std::to_string(app->clock->RealFrameCount()) + ".json";
+			Profiler::SaveChromeTrace(file.c_str());
+		}
+
+		Profiler::GetFrames(frames);
+		if (frames.empty())
+		{
+			ImGui::Text("No frames recorded.");
+		}
+		else
+		{
+			frameMs.resize(frames.size());
+			for (uint i = 0; i < frames.size(); ++i)
+				frameMs[i] = (float)Profiler::TicksToMs(frames[i].end - frames[i].start);
+
+			ImGui::PlotHistogram("##frames", frameMs.data(), frameMs.size(), 0, "Frames", 0.0f, 50.0f, ImVec2(ImGui::GetContentRegionAvailWidth(), 60));
+
+			//Only a paused capture can be browsed, otherwise the newest frame is shown
+			if (!paused) selectedFrame = 0;
+			int maxFrame = frames.size() - 1;
+			selectedFrame = MIN(selectedFrame, maxFrame);
+			if (paused) ImGui::SliderInt("Frames back", &selectedFrame, 0, maxFrame);
+
+			const ProfilerFrame& frame = frames[maxFrame - selectedFrame];
+
+			ImGui::Text("Frame: ");
+			ImGui::SameLine();
+			ImGui::TextColored(ImVec4(1, 1, 0, 1), "%u (%.3f ms)", frame.index, Profiler::TicksToMs(frame.end - frame.start));
+
+			ImGui::SliderFloat("Zoom", &zoom, 1.0f, 20.0f, "%.1f");
+
+			Profiler::GetEvents(frame.start, frame.end, threads);
+
+			for (std::vector<ProfilerThreadEvents>::const_iterator it = threads.begin(); it != threads.end(); ++it)
+			{
+				if (!it->events.empty() && ImGui::CollapsingHeader((it->name + " scopes").c_str()))
+					DrawScopes(*it);
+			}
+
+			DrawFlame(frame);
+		}
+#else
+		ImGui::Text("Profiler compiled out (GG_PROFILER is 0).");
+#endif
+	}
+	ImGui::End();
+}
+
+/** EdProfiler - DrawScopes: Lists the scopes of a thread in the selected frame, aggregated by name and sorted by time. */
+void EdProfiler::DrawScopes(const ProfilerThreadEvents & thread)
+{
+	struct ScopeStats
+	{
+		std::string name;
+		double ms = 0.0;
+		uint calls = 0;
+	};
+
+	std::map<std::string, ScopeStats> stats;
+	for (std::vector<ProfilerEvent>::const_iterator e = thread.events.begin(); e != thread.events.end(); ++e)
+	{
+		ScopeStats& s = stats[e->name];
+		s.name = e->name;
+		s.ms += Profiler::TicksToMs(e->end - e->start);
+		++s.calls;
+	}
+
+	std::vector<ScopeStats> sorted;
+	for (std::map<std::string, ScopeStats>::const_iterator it = stats.begin(); it != stats.end(); ++it)
+		sorted.push_back(it->second);
+	std::sort(sorted.begin(), sorted.end(), [](const ScopeStats& a, const ScopeStats& b) { return a.ms > b.ms; });
+
+	ImGui::Columns(3, thread.name.c_str());
+	ImGui::Text("Scope"); ImGui::NextColumn();
+	ImGui::Text("Ms"); ImGui::NextColumn();
+	ImGui::Text("Calls"); ImGui::NextColumn();
+	ImGui::Separator();
+
+	for (std::vector<ScopeStats>::const_iterator it = sorted.begin(); it != sorted.end(); ++it)
+	{
+		ImGui::Text("%s", it->name.c_str()); ImGui::NextColumn();
+		ImGui::TextColored(ImVec4(1, 1, 0, 1), "%.3f", it->ms); ImGui::NextColumn();
+		ImGui::Text("%u", it->calls); ImGui::NextColumn();
+	}
+
+	ImGui::Columns(1);
+}
+
+/** EdProfiler - DrawFlame: Draws the scopes of every thread over the selected frame time, one row per depth. */
+void EdProfiler::DrawFlame(const ProfilerFrame & frame)
+{
+	ImGui::BeginChild("Flame", ImVec2(0, 0), true, ImGuiWindowFlags_HorizontalScrollbar);
+	{
+		const float width = ImGui::GetContentRegionAvailWidth() * zoom;
+		const double frameTicks = (double)MAX(frame.end - frame.start, (uint64)1);
+		ImDrawList* drawList = ImGui::GetWindowDrawList();
+
+		for (std::vector<ProfilerThreadEvents>::const_iterator t = threads.begin(); t != threads.end(); ++t)
+		{
+			if (t->events.empty())
+				continue;
+
+			ImGui::Text("%s", t->name.c_str());
+
+			uint maxDepth = 0;
+			for (std::vector<ProfilerEvent>::const_iterator e = t->events.begin(); e != t->events.end(); ++e)
+				maxDepth = MAX(maxDepth, e->depth);
+
+			const ImVec2 origin = ImGui::GetCursorScreenPos();
+
+			for (std::vector<ProfilerEvent>::const_iterator e = t->events.begin(); e != t->events.end(); ++e)
+			{
+				//Scopes of other threads may cross the frame limits
+				uint64 start = MAX(e->start, frame.start);
+				uint64 end = MIN(e->end, frame.end);
+
+				float x0 = origin.x + (float)((start - frame.start) / frameTicks) * width;
+				float x1 = origin.x + (float)((end - frame.start) / frameTicks) * width;
+				if (x1 - x0 < 1.0f) x1 = x0 + 1.0f;
+
+				ImVec2 min(x0, origin.y + e->depth * FLAME_ROW_HEIGHT);
+				ImVec2 max(x1, min.y + FLAME_ROW_HEIGHT - 1.0f);
+
+				drawList->AddRectFilled(min, max, ScopeColor(e->name));
+
+				ImVec4 clip(min.x, min.y, max.x, max.y);
+				drawList->AddText(ImGui::GetFont(), ImGui::GetFontSize(), ImVec2(min.x + 2.0f, min.y + 1.0f), 0xFF000000, e->name, nullptr, 0.0f, &clip);
+
+				if (ImGui::IsMouseHoveringRect(min, max))
+					ImGui::SetTooltip("%s\n%.3f ms", e->name, Profiler::TicksToMs(e->end - e->start));
+			}
+
+			ImGui::Dummy(ImVec2(width, (maxDepth + 1) * FLAME_ROW_HEIGHT));
+		}
+	}
+	ImGui::EndChild();
+}
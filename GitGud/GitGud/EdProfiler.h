@@ -0,0 +1,28 @@
+#ifndef __EDPROFILER_H__
+#define __EDPROFILER_H__
+
+#include "EdWin.h"
+#include "Profiler.h"
+
+class EdProfiler : public EdWin
+{
+public:
+	EdProfiler(bool startEnabled = false);
+	virtual ~EdProfiler();
+
+	void Draw()override;
+
+private:
+	void DrawScopes(const ProfilerThreadEvents& thread);
+	void DrawFlame(const ProfilerFrame& frame);
+
+private:
+	int selectedFrame = 0; //Frames back from the newest one.
+	float zoom = 1.f;
+
+	std::vector<ProfilerFrame> frames;
+	std::vector<ProfilerThreadEvents> threads;
+	std::vector<float> frameMs;
+};
+
+#endif // !__EDPROFILER_H__
@@ -4,6 +4,8 @@
 #include "M_Editor.h"
 #include "EdShaderEditor.h"
 #include "M_ResourceManager.h"
+#include "ImporterMesh.h"
+#include "ImporterTexture.h"
 #include "Resource.h"
 
 #include "ResourceMesh.h"
@@ -17,6 +19,13 @@
 #include "OpenGL.h"
 
 
+/** Name of a resource load state. */
+static const char* GetLoadStateStr(ResourceLoadState state)
+{
+	static const char* states[] = { "unloaded", "loading", "loaded", "load failed" };
+	return states[state];
+}
+
 EdResources::EdResources(bool startEnabled) : EdWin(startEnabled)
 {
 }
@@ -36,12 +45,14 @@ void EdResources::Draw()
 
 	ImGui::Begin("Resources", &active);
 	{
-		std::vector<Resource*> resources;
+		FrameVector<UID> resources;
+
+		ImGui::Text("Loading: %u, uploads %.2f ms.", app->resources->GetPendingLoads(), app->resources->GetLastUploadMs());
 
 		if (ImGui::CollapsingHeader("Meshes"))
 		{
 			resources.clear();
-			app->resources->GetResourcesOfType(resources, RES_MESH);
+			app->resources->GetUIDsOfType(resources, RES_MESH);
 
 			MeshResource(resources);
 		}
@@ -49,7 +60,7 @@ void EdResources::Draw()
 		if (ImGui::CollapsingHeader("Materials"))
 		{
 			resources.clear();
-			app->resources->GetResourcesOfType(resources, RES_MATERIAL);
+			app->resources->GetUIDsOfType(resources, RES_MATERIAL);
 
 			MaterialResource(resources);
 		}
@@ -57,7 +68,7 @@ void EdResources::Draw()
 		if (ImGui::CollapsingHeader("Textures"))
 		{
 			resources.clear();
-			app->resources->GetResourcesOfType(resources, RES_TEXTURE);
+			app->resources->GetUIDsOfType(resources, RES_TEXTURE);
 
 			TextureResource(resources);
 		}
@@ -65,7 +76,7 @@ void EdResources::Draw()
 		if (ImGui::CollapsingHeader("Scenes"))
 		{
 			resources.clear();
-			app->resources->GetResourcesOfType(resources, RES_SCENE);
+			app->resources->GetUIDsOfType(resources, RES_SCENE);
 
 			SceneResource(resources);
 		}
@@ -73,386 +84,475 @@ void EdResources::Draw()
 		if (ImGui::CollapsingHeader("Shader"))
 		{
 			resources.clear();
-			app->resources->GetResourcesOfType(resources, RES_SHADER);
+			app->resources->GetUIDsOfType(resources, RES_SHADER);
 
 			ShaderResource(resources);
 		}
 
+		if (ImGui::CollapsingHeader("Residency"))
+		{
+			const ResidencyStats& stats = app->resources->GetResidencyStats();
+			const double mb = 1024.0 * 1024.0;
+			uint64 loads = stats.hits + stats.misses;
+
+			ImGui::Text("Hits: %llu, misses: %llu (%.1f%% hit rate).", stats.hits, stats.misses, loads > 0 ? 100.0 * stats.hits / loads : 0.0);
+			ImGui::Text("Evictions: %llu.", stats.evictions);
+			ImGui::Text("CPU: %.2f / %.0f MB.", stats.cpuBytes / mb, app->resources->GetCpuBudget() / mb);
+			ImGui::Text("GPU: %.2f / %.0f MB.", stats.gpuBytes / mb, app->resources->GetGpuBudget() / mb);
+			ImGui::Text("Cached: %u resources, %.2f MB CPU, %.2f MB GPU.", stats.cached, stats.cachedCpuBytes / mb, stats.cachedGpuBytes / mb);
+		}
+
+		if (ImGui::CollapsingHeader("Library compression"))
+		{
+			ImGui::Columns(5, "compression");
+			ImGui::Text("Importer"); ImGui::NextColumn();
+			ImGui::Text("Level"); ImGui::NextColumn();
+			ImGui::Text("Ratio"); ImGui::NextColumn();
+			ImGui::Text("Encode MB/s"); ImGui::NextColumn();
+			ImGui::Text("Decode MB/s"); ImGui::NextColumn();
+			ImGui::Separator();
+
+			CompressionStatsRow("Meshes", app->resources->meshImporter->compressionStats, app->resources->meshImporter->compressionLevel);
+			CompressionStatsRow("Textures", app->resources->textureImporter->compressionStats, app->resources->textureImporter->compressionLevel);
+
+			ImGui::Columns(1);
+		}
 
 		ImGui::End();
 	}
 }
 
-void EdResources::MeshResource(std::vector<Resource*> meshes)
+void EdResources::MeshResource(const FrameVector<UID>& meshes)
 {
 	static int mS = -1;
 
-	for (uint i = 0; i < meshes.size(); ++i)
+	//Only the rows in view get their resource, the rest are not created.
+	ImGuiListClipper clipper(meshes.size());
+	while (clipper.Step())
 	{
-		ResourceMesh* mesh = (ResourceMesh*)meshes[i];
-		if (mesh)
+		for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
 		{
-			ImGuiTreeNodeFlags nodeFlags = 0;
-			if (mS == i)
-			{
-				nodeFlags |= ImGuiTreeNodeFlags_Selected;
-				nodeFlags |= ImGuiTreeNodeFlags_OpenOnArrow;
-				nodeFlags |= ImGuiTreeNodeFlags_OpenOnDoubleClick;
-			}
-			else
-			{
-				nodeFlags |= ImGuiTreeNodeFlags_Leaf;
-			}
-
-			if (ImGui::TreeNodeEx(mesh->name.c_str(), nodeFlags))
+			ResourceMesh* mesh = (ResourceMesh*)app->resources->GetResourceFromUID(meshes[i]);
+			if (mesh)
 			{
+				ImGuiTreeNodeFlags nodeFlags = 0;
 				if (mS == i)
 				{
-					ImGui::PushStyleVar(ImGuiStyleVar_ChildWindowRounding, 5.0f);
+					nodeFlags |= ImGuiTreeNodeFlags_Selected;
+					nodeFlags |= ImGuiTreeNodeFlags_OpenOnArrow;
+					nodeFlags |= ImGuiTreeNodeFlags_OpenOnDoubleClick;
+				}
+				else
+				{
+					nodeFlags |= ImGuiTreeNodeFlags_Leaf;
+				}
 
-					ImGui::BeginChild("meshes", ImVec2(infoW, infoH));
+				if (ImGui::TreeNodeEx(mesh->name.c_str(), nodeFlags))
+				{
+					if (mS == i)
 					{
-						//---- Should be generic??
+						ImGui::PushStyleVar(ImGuiStyleVar_ChildWindowRounding, 5.0f);
 
-						ImGui::Text("Original file: ");
-						ImGui::SameLine();
-						ImGui::TextColored(ImVec4(1, 1, 0, 1), mesh->originalFile.GetFile());
+						ImGui::BeginChild("meshes", ImVec2(infoW, infoH));
+						{
+							//---- Should be generic??
 
-						ImGui::Text("Exported file: ");
-						ImGui::SameLine();
-						ImGui::TextColored(ImVec4(1, 1, 0, 1), mesh->exportedFile.GetFile());
+							ImGui::Text("Original file: ");
+							ImGui::SameLine();
+							ImGui::TextColored(ImVec4(1, 1, 0, 1), mesh->originalFile.GetFile());
 
-						ImGui::Text("Instances in memory: ");
-						ImGui::SameLine();
-						ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d", mesh->Count());
+							ImGui::Text("Exported file: ");
+							ImGui::SameLine();
+							ImGui::TextColored(ImVec4(1, 1, 0, 1), mesh->exportedFile.GetFile());
 
-						ImGui::Text("ID: ");
-						ImGui::SameLine();
-						ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d", mesh->GetUID());
+							ImGui::Text("Instances in memory: ");
+							ImGui::SameLine();
+							ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d", mesh->Count());
 
-						//----------------------------------
+							ImGui::Text("ID: ");
+							ImGui::SameLine();
+							ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d", mesh->GetUID());
 
-						if (mesh->IsInMemory())
-						{
+							ImGui::Text("State: ");
+							ImGui::SameLine();
+							ImGui::TextColored(ImVec4(1, 1, 0, 1), GetLoadStateStr(mesh->GetLoadState()));
 
-						}
+							//----------------------------------
 
-						ImGui::Text("Num vertices:");
-						ImGui::SameLine();
-						ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d.", mesh->numVertices);
+							if (mesh->IsInMemory())
+							{
 
-						ImGui::Text("Num indices:");
-						ImGui::SameLine();
-						ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d.", mesh->numIndices);
+							}
 
-						ImGui::Separator();
+							ImGui::Text("Num vertices:");
+							ImGui::SameLine();
+							ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d.", mesh->numVertices);
 
-						//-------------------
+							ImGui::Text("Num indices:");
+							ImGui::SameLine();
+							ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d.", mesh->numIndices);
+
+							ImGui::Text("Vertex format:");
+							ImGui::SameLine();
+							ImGui::TextColored(ImVec4(1, 1, 0, 1), "%s%s%s%s%s",
+								(mesh->vertexFormat & VF_INTERLEAVED) ? "interleaved " : "",
+								(mesh->vertexFormat & VF_HALF_UVS) ? "half_uvs " : "",
+								(mesh->vertexFormat & VF_SNORM_NORMALS) ? "snorm_normals " : "",
+								(mesh->vertexFormat & VF_UNORM8_COLORS) ? "unorm8_colors " : "",
+								mesh->shortIndices ? "short_indices" : "");
+
+							ImGui::Text("VRAM:");
+							ImGui::SameLine();
+							ImGui::TextColored(ImVec4(1, 1, 0, 1), "%u bytes (%u with float layout).", mesh->vramBytes, mesh->GetFloatLayoutBytes());
+
+							ImGui::Separator();
+
+							//-------------------
 
-						ImGui::Text("Indices GL buffer id: ");
-						ImGui::SameLine();
-						ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d.", mesh->idIndices);
+							ImGui::Text("Indices GL buffer id: ");
+							ImGui::SameLine();
+							ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d.", mesh->idIndices);
 
-						ImGui::Text("Vertices GL buffer id: ");
-						ImGui::SameLine();
-						ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d.", mesh->idVertices);
+							ImGui::Text("Vertices GL buffer id: ");
+							ImGui::SameLine();
+							ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d.", mesh->idVertices);
 
-						ImGui::Text("Normals GL buffer id: ");
-						ImGui::SameLine();
-						ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d.", mesh->idNormals);
+							ImGui::Text("Normals GL buffer id: ");
+							ImGui::SameLine();
+							ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d.", mesh->idNormals);
 
-						ImGui::Text("Colors GL buffer id: ");
-						ImGui::SameLine();
-						ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d.", mesh->idColors);
+							ImGui::Text("Colors GL buffer id: ");
+							ImGui::SameLine();
+							ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d.", mesh->idColors);
 
-						ImGui::Text("Texture coords GL buffer id: ");
-						ImGui::SameLine();
-						ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d.", mesh->idUvs);
+							ImGui::Text("Texture coords GL buffer id: ");
+							ImGui::SameLine();
+							ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d.", mesh->idUvs);
 
-						ImGui::Text("Container GL buffer id: ");
-						ImGui::SameLine();
-						ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d.", mesh->idContainer);
+							//-------------------
 
-						//-------------------
+							//TODO: Attach etc.
 
-						//TODO: Attach etc.
+						}
 
+						ImGui::EndChild();
+						ImGui::PopStyleVar();
 					}
 
-					ImGui::EndChild();
-					ImGui::PopStyleVar();
-				}
+					if (ImGui::IsItemClicked())
+						mS = i;
 
-				if (ImGui::IsItemClicked())
-					mS = i;
+					ImGui::TreePop();
+				}
 
-				ImGui::TreePop();
 			}
-
 		}
 	}
 }
 
-void EdResources::MaterialResource(std::vector<Resource*> materials)
+void EdResources::MaterialResource(const FrameVector<UID>& materials)
 {
 	static int maS = -1;
 
-	for (uint i = 0; i < materials.size(); ++i)
+	//Only the rows in view get their resource, the rest are not created.
+	ImGuiListClipper clipper(materials.size());
+	while (clipper.Step())
 	{
-		ResourceMesh* material = (ResourceMesh*)materials[i];
-		if (material)
+		for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
 		{
-			ImGuiTreeNodeFlags nodeFlags = 0;
-			if (maS == i)
-			{
-				nodeFlags |= ImGuiTreeNodeFlags_Selected;
-				nodeFlags |= ImGuiTreeNodeFlags_OpenOnArrow;
-				nodeFlags |= ImGuiTreeNodeFlags_OpenOnDoubleClick;
-			}
-			else
-			{
-				nodeFlags |= ImGuiTreeNodeFlags_Leaf;
-			}
-
-			if (ImGui::TreeNodeEx(material->name.c_str(), nodeFlags))
+			ResourceMesh* material = (ResourceMesh*)app->resources->GetResourceFromUID(materials[i]);
+			if (material)
 			{
+				ImGuiTreeNodeFlags nodeFlags = 0;
 				if (maS == i)
 				{
-					ImGui::PushStyleVar(ImGuiStyleVar_ChildWindowRounding, 5.0f);
+					nodeFlags |= ImGuiTreeNodeFlags_Selected;
+					nodeFlags |= ImGuiTreeNodeFlags_OpenOnArrow;
+					nodeFlags |= ImGuiTreeNodeFlags_OpenOnDoubleClick;
+				}
+				else
+				{
+					nodeFlags |= ImGuiTreeNodeFlags_Leaf;
+				}
 
-					ImGui::BeginChild("materials", ImVec2(infoW, infoH));
+				if (ImGui::TreeNodeEx(material->name.c_str(), nodeFlags))
+				{
+					if (maS == i)
 					{
-						//---- Should be generic??
+						ImGui::PushStyleVar(ImGuiStyleVar_ChildWindowRounding, 5.0f);
 
-						ImGui::Text("Original file: ");
-						ImGui::SameLine();
-						ImGui::TextColored(ImVec4(1, 1, 0, 1), material->originalFile.GetFile());
+						ImGui::BeginChild("materials", ImVec2(infoW, infoH));
+						{
+							//---- Should be generic??
 
-						ImGui::Text("Exported file: ");
-						ImGui::SameLine();
-						ImGui::TextColored(ImVec4(1, 1, 0, 1), material->exportedFile.GetFile());
+							ImGui::Text("Original file: ");
+							ImGui::SameLine();
+							ImGui::TextColored(ImVec4(1, 1, 0, 1), material->originalFile.GetFile());
 
-						ImGui::Text("Instances in memory: ");
-						ImGui::SameLine();
-						ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d", material->GetUID());
+							ImGui::Text("Exported file: ");
+							ImGui::SameLine();
+							ImGui::TextColored(ImVec4(1, 1, 0, 1), material->exportedFile.GetFile());
 
-						//----------------------------------
+							ImGui::Text("Instances in memory: ");
+							ImGui::SameLine();
+							ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d", material->GetUID());
 
-						if (material->IsInMemory())
-						{
+							//----------------------------------
+
+							if (material->IsInMemory())
+							{
+
+							}
 
-						}
 
+							ImGui::Separator();
 
-						ImGui::Separator();
+							//-------------------
 
-						//-------------------
 
+							//-------------------
 
-						//-------------------
+							//TODO: Attach etc.
 
-						//TODO: Attach etc.
+						}
 
+						ImGui::EndChild();
+						ImGui::PopStyleVar();
 					}
 
-					ImGui::EndChild();
-					ImGui::PopStyleVar();
-				}
+					if (ImGui::IsItemClicked())
+						maS = i;
 
-				if (ImGui::IsItemClicked())
-					maS = i;
+					ImGui::TreePop();
+				}
 
-				ImGui::TreePop();
 			}
-
 		}
 	}
 }
 
-void EdResources::TextureResource(std::vector<Resource*> textures)
+void EdResources::TextureResource(const FrameVector<UID>& textures)
 {
 	static int tS = -1;
 
-	for (uint i = 0; i < textures.size(); ++i)
+	//Only the rows in view get their resource, the rest are not created.
+	ImGuiListClipper clipper(textures.size());
+	while (clipper.Step())
 	{
-		ResourceTexture* text = (ResourceTexture*)textures[i];
-		if (text)
+		for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
 		{
-			ImGuiTreeNodeFlags nodeFlags = 0;
-			if (tS == i)
-				nodeFlags |= ImGuiTreeNodeFlags_Selected | ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_OpenOnDoubleClick;
-
-			else
-				nodeFlags |= ImGuiTreeNodeFlags_Leaf;
-
-			if (ImGui::TreeNodeEx(text->name.c_str(), nodeFlags))
+			ResourceTexture* text = (ResourceTexture*)app->resources->GetResourceFromUID(textures[i]);
+			if (text)
 			{
+				ImGuiTreeNodeFlags nodeFlags = 0;
 				if (tS == i)
-				{
-					ImGui::PushStyleVar(ImGuiStyleVar_ChildWindowRounding, 5.0f);
-
-					ImGui::BeginChild("textures", ImVec2(infoW, infoH));
-					{
-						ImGui::Text("Original file: ");
-						ImGui::SameLine();
-						ImGui::TextColored(ImVec4(1, 1, 0, 1), text->originalFile.GetFile());
-
-						ImGui::Text("Exported file: ");
-						ImGui::SameLine();
-						ImGui::TextColored(ImVec4(1, 1, 0, 1), text->exportedFile.GetFile());
+					nodeFlags |= ImGuiTreeNodeFlags_Selected | ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_OpenOnDoubleClick;
 
-						ImGui::Text("Instances in memory: ");
-						ImGui::SameLine();
-						ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d", text->Count());
+				else
+					nodeFlags |= ImGuiTreeNodeFlags_Leaf;
 
-						ImGui::Text("ID: ");
-						ImGui::SameLine();
-						ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d", text->GetUID());
-
-						//------------------------------------------------------------------------
+				if (ImGui::TreeNodeEx(text->name.c_str(), nodeFlags))
+				{
+					if (tS == i)
+					{
+						ImGui::PushStyleVar(ImGuiStyleVar_ChildWindowRounding, 5.0f);
 
-						if (text->IsInMemory())
+						ImGui::BeginChild("textures", ImVec2(infoW, infoH));
 						{
-							ImGui::Separator();
-
-							ImGui::Text("Width:");
+							ImGui::Text("Original file: ");
 							ImGui::SameLine();
-							ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d.", text->width);
+							ImGui::TextColored(ImVec4(1, 1, 0, 1), text->originalFile.GetFile());
 
-							ImGui::Text("Height:");
+							ImGui::Text("Exported file: ");
 							ImGui::SameLine();
-							ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d.", text->height);
+							ImGui::TextColored(ImVec4(1, 1, 0, 1), text->exportedFile.GetFile());
 
-							ImGui::Text("Depth:");
+							ImGui::Text("Instances in memory: ");
 							ImGui::SameLine();
-							ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d.", text->depth);
+							ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d", text->Count());
 
-							ImGui::Text("Bpp:");
+							ImGui::Text("ID: ");
 							ImGui::SameLine();
-							ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d.", text->bpp);
+							ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d", text->GetUID());
 
-							ImGui::Text("Mips:");
+							ImGui::Text("State: ");
 							ImGui::SameLine();
-							ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d.", text->mips);
+							ImGui::TextColored(ImVec4(1, 1, 0, 1), GetLoadStateStr(text->GetLoadState()));
 
-							ImGui::Text("Bytes:");
-							ImGui::SameLine();
-							ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d.", text->bytes);
+							//------------------------------------------------------------------------
 
-							ImGui::Text("Format:");
-							ImGui::SameLine();
-							ImGui::TextColored(ImVec4(1, 1, 0, 1), text->GetTextureFormatStr());
-
-							ImGui::Text("Type:");
-							ImGui::SameLine();
-							ImGui::TextColored(ImVec4(1, 1, 0, 1), text->GetTextureTypeStr());
-
-							uint texIndex = text->texID;
-							glBindTexture(GL_TEXTURE_2D, texIndex);
-							ImTextureID texId = (void*)texIndex;
-							ImVec2 texSize(64, 64);
-							ImGui::Image(texId, texSize, ImVec2(0, 0), ImVec2(1, 1), ImColor(255, 255, 255, 255), ImColor(255, 255, 255, 255));
-							
-							if (ImGui::IsItemHovered())
+							if (text->IsInMemory())
 							{
-								//TODO: This tool only zoom full size image.
-
-								ImGui::BeginTooltip();
-
-								ImVec2 texScreenPos = ImGui::GetCursorScreenPos();
-								float focusSZ = 64.0f;
-								float focusX = ImGui::GetMousePos().x - texScreenPos.x - focusSZ * 0.5f;
-								if (focusX < 0.0f) focusX = 0.0f;
-								else if (focusX > texSize.x - focusSZ) focusX = texSize.x - focusSZ;
-								float focusY = ImGui::GetMousePos().y - texScreenPos.y - focusSZ * 0.5f;
-								if (focusY < 0.0f) focusY = 0.0f;
-								else if (focusY > texSize.y - focusSZ) focusY = texSize.y - focusSZ;
-
-								ImVec2 uv0 = ImVec2((focusX) / texSize.x, (focusY) / texSize.y);
-								ImVec2 uv1 = ImVec2((focusX + focusSZ) / texSize.x, (focusY + focusSZ) / texSize.y);
-
-								ImGui::Image(texId, ImVec2(256, 256), uv0, uv1, ImColor(255, 255, 255, 255), ImColor(255, 255, 255, 255));
-
-								ImGui::EndTooltip();
+								ImGui::Separator();
+
+								ImGui::Text("Width:");
+								ImGui::SameLine();
+								ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d.", text->width);
+
+								ImGui::Text("Height:");
+								ImGui::SameLine();
+								ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d.", text->height);
+
+								ImGui::Text("Depth:");
+								ImGui::SameLine();
+								ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d.", text->depth);
+
+								ImGui::Text("Bpp:");
+								ImGui::SameLine();
+								ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d.", text->bpp);
+
+								ImGui::Text("Mips:");
+								ImGui::SameLine();
+								ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d.", text->mips);
+
+								ImGui::Text("Bytes:");
+								ImGui::SameLine();
+								ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d.", text->bytes);
+
+								ImGui::Text("Format:");
+								ImGui::SameLine();
+								ImGui::TextColored(ImVec4(1, 1, 0, 1), text->GetTextureFormatStr());
+
+								ImGui::Text("Type:");
+								ImGui::SameLine();
+								ImGui::TextColored(ImVec4(1, 1, 0, 1), text->GetTextureTypeStr());
+
+								uint texIndex = text->GetDrawTextureID();
+								ImTextureID texId = (void*)texIndex;
+								ImVec2 texSize(64, 64);
+								ImGui::Image(texId, texSize, ImVec2(0, 0), ImVec2(1, 1), ImColor(255, 255, 255, 255), ImColor(255, 255, 255, 255));
+								
+								if (ImGui::IsItemHovered())
+								{
+									//TODO: This tool only zoom full size image.
+
+									ImGui::BeginTooltip();
+
+									ImVec2 texScreenPos = ImGui::GetCursorScreenPos();
+									float focusSZ = 64.0f;
+									float focusX = ImGui::GetMousePos().x - texScreenPos.x - focusSZ * 0.5f;
+									if (focusX < 0.0f) focusX = 0.0f;
+									else if (focusX > texSize.x - focusSZ) focusX = texSize.x - focusSZ;
+									float focusY = ImGui::GetMousePos().y - texScreenPos.y - focusSZ * 0.5f;
+									if (focusY < 0.0f) focusY = 0.0f;
+									else if (focusY > texSize.y - focusSZ) focusY = texSize.y - focusSZ;
+
+									ImVec2 uv0 = ImVec2((focusX) / texSize.x, (focusY) / texSize.y);
+									ImVec2 uv1 = ImVec2((focusX + focusSZ) / texSize.x, (focusY + focusSZ) / texSize.y);
+
+									ImGui::Image(texId, ImVec2(256, 256), uv0, uv1, ImColor(255, 255, 255, 255), ImColor(255, 255, 255, 255));
+
+									ImGui::EndTooltip();
+								}
 							}
-							
-							glBindTexture(GL_TEXTURE_2D, 0);
 						}
-					}
 
-					ImGui::EndChild();
-					ImGui::PopStyleVar();
-				}
+						ImGui::EndChild();
+						ImGui::PopStyleVar();
+					}
 
-				if (ImGui::IsItemClicked()) tS = i;
+					if (ImGui::IsItemClicked()) tS = i;
 
-				ImGui::TreePop();
+					ImGui::TreePop();
+				}
 			}
 		}
 	}
 }
 
-void EdResources::SceneResource(std::vector<Resource*> textures)
+void EdResources::SceneResource(const FrameVector<UID>& scenes)
 {
 }
 
-void EdResources::ShaderResource(std::vector<Resource*> shaders)
+void EdResources::ShaderResource(const FrameVector<UID>& shaders)
 {
 	static int shS = -1;
 
-	for (uint i = 0; i < shaders.size(); ++i)
+	//Only the rows in view get their resource, the rest are not created.
+	ImGuiListClipper clipper(shaders.size());
+	while (clipper.Step())
 	{
-		ResourceShader* sh = (ResourceShader*)shaders[i];
-		if (sh)
+		for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
 		{
-			ImGuiTreeNodeFlags nodeFlags = 0;
-			if (shS == i)
-				nodeFlags |= ImGuiTreeNodeFlags_Selected | ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_OpenOnDoubleClick;
-
-			else
-				nodeFlags |= ImGuiTreeNodeFlags_Leaf;
-
-			if (ImGui::TreeNodeEx(sh->name.c_str(), nodeFlags))
+			ResourceShader* sh = (ResourceShader*)app->resources->GetResourceFromUID(shaders[i]);
+			if (sh)
 			{
+				ImGuiTreeNodeFlags nodeFlags = 0;
 				if (shS == i)
-				{
-					ImGui::PushStyleVar(ImGuiStyleVar_ChildWindowRounding, 5.0f);
+					nodeFlags |= ImGuiTreeNodeFlags_Selected | ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_OpenOnDoubleClick;
 
-					ImGui::BeginChild("shaders", ImVec2(infoW, infoH));
+				else
+					nodeFlags |= ImGuiTreeNodeFlags_Leaf;
+
+				if (ImGui::TreeNodeEx(sh->name.c_str(), nodeFlags))
+				{
+					if (shS == i)
 					{
-						ImGui::Text("Original file: ");
-						ImGui::SameLine();
-						ImGui::TextColored(ImVec4(1, 1, 0, 1), sh->originalFile.GetFile());
+						ImGui::PushStyleVar(ImGuiStyleVar_ChildWindowRounding, 5.0f);
+
+						ImGui::BeginChild("shaders", ImVec2(infoW, infoH));
+						{
+							ImGui::Text("Original file: ");
+							ImGui::SameLine();
+							ImGui::TextColored(ImVec4(1, 1, 0, 1), sh->originalFile.GetFile());
 
-						ImGui::Text("Exported file: ");
-						ImGui::SameLine();
-						ImGui::TextColored(ImVec4(1, 1, 0, 1), sh->exportedFile.GetFile());
+							ImGui::Text("Exported file: ");
+							ImGui::SameLine();
+							ImGui::TextColored(ImVec4(1, 1, 0, 1), sh->exportedFile.GetFile());
 
-						ImGui::Text("Instances in memory: ");
-						ImGui::SameLine();
-						ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d", sh->Count());
+							ImGui::Text("Instances in memory: ");
+							ImGui::SameLine();
+							ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d", sh->Count());
 
-						ImGui::Text("ID: ");
-						ImGui::SameLine();
-						ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d", sh->GetUID());
+							ImGui::Text("ID: ");
+							ImGui::SameLine();
+							ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d", sh->GetUID());
 
-						//--------------------------------------------------------------------------
+							//--------------------------------------------------------------------------
 
-						ImGui::Separator();
+							ImGui::Separator();
 
-						if (ImGui::Button("Edit shader")) app->editor->shaderEditor->SetShader(sh);
+							if (ImGui::Button("Edit shader")) app->editor->shaderEditor->SetShader(sh);
 
-						//TODO: Shader editor and shader attach
-					}
+							//TODO: Shader editor and shader attach
+						}
 
-					ImGui::EndChild();
-					ImGui::PopStyleVar;
-				}
+						ImGui::EndChild();
+						ImGui::PopStyleVar;
+					}
 
-				if(ImGui::IsItemClicked()) shS = i;
+					if(ImGui::IsItemClicked()) shS = i;
 
-				ImGui::TreePop();
+					ImGui::TreePop();
+				}
 			}
 		}
 	}
 }
+
+/** EdResources - CompressionStatsRow: Ratio of the library files saved and speed of the ones saved and loaded by an importer. */
+void EdResources::CompressionStatsRow(const char * name, const CompressionStats & stats, int level)
+{
+	const double mb = 1024.0 * 1024.0;
+
+	ImGui::Text(name); ImGui::NextColumn();
+	ImGui::Text("%d", level); ImGui::NextColumn();
+
+	if (stats.compressedBytes > 0)
+		ImGui::Text("%.2f", (double)stats.rawBytes / stats.compressedBytes);
+	else
+		ImGui::Text("-");
+	ImGui::NextColumn();
+
+	if (stats.encodeMs > 0.0)
+		ImGui::Text("%.1f", (stats.rawBytes / mb) / (stats.encodeMs / 1000.0));
+	else
+		ImGui::Text("-");
+	ImGui::NextColumn();
+
+	if (stats.decodeMs > 0.0)
+		ImGui::Text("%.1f", (stats.decodedBytes / mb) / (stats.decodeMs / 1000.0));
+	else
+		ImGui::Text("-");
+	ImGui::NextColumn();
+}
@@ -2,6 +2,7 @@
 #define __ED_RESOURCES_H__
 
 #include "EdWin.h"
+#include "FrameAllocator.h"
 #include <vector>
 
 class Resource;
@@ -9,6 +10,7 @@ class ResourceMesh;
 class ResourceMaterial;
 class ResourceTexture;
 class ResourceShader;
+struct CompressionStats;
 
 class EdResources : public EdWin
 {
@@ -19,11 +21,12 @@ public:
 	void Draw()override;
 
 private:
-	void MeshResource(std::vector<Resource*> meshes);
-	void MaterialResource(std::vector<Resource*> materials);
-	void TextureResource(std::vector<Resource*> textures);
-	void SceneResource(std::vector<Resource*> scenes);
-	void ShaderResource(std::vector<Resource*> shaders);
+	void MeshResource(const FrameVector<UID>& meshes);
+	void MaterialResource(const FrameVector<UID>& materials);
+	void TextureResource(const FrameVector<UID>& textures);
+	void SceneResource(const FrameVector<UID>& scenes);
+	void ShaderResource(const FrameVector<UID>& shaders);
+	void CompressionStatsRow(const char* name, const CompressionStats& stats, int level);
 
 	int infoW = 300;
 	int infoH = 150; //TODO: Should calc this with the window size??
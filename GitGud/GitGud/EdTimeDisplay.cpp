@@ -54,6 +54,59 @@ void EdTimeDisplay::Draw()
 		ImGui::SameLine();
 		ImGui::TextColored(ImVec4(1, 1, 0, 1), "%d", app->clock->FPS());
 
+		ImGui::Text("Frame stats ----------");
+		ImGui::Separator();
+
+		FrameStats stats;
+		app->clock->GetFrameStats(stats);
+
+		ImGui::Text("Frames: ");
+		ImGui::SameLine();
+		ImGui::TextColored(ImVec4(1, 1, 0, 1), "%u", stats.frames);
+
+		ImGui::Text("p50: ");
+		ImGui::SameLine();
+		ImGui::TextColored(ImVec4(1, 1, 0, 1), "%.2f ms", stats.p50Ms);
+
+		ImGui::SameLine();
+
+		ImGui::Text("p90: ");
+		ImGui::SameLine();
+		ImGui::TextColored(ImVec4(1, 1, 0, 1), "%.2f ms", stats.p90Ms);
+
+		ImGui::SameLine();
+
+		ImGui::Text("p99: ");
+		ImGui::SameLine();
+		ImGui::TextColored(ImVec4(1, 1, 0, 1), "%.2f ms", stats.p99Ms);
+
+		ImGui::SameLine();
+
+		ImGui::Text("Max: ");
+		ImGui::SameLine();
+		ImGui::TextColored(ImVec4(1, 1, 0, 1), "%.2f ms", stats.maxMs);
+
+		ImGui::Text("Cpu: ");
+		ImGui::SameLine();
+		ImGui::TextColored(ImVec4(1, 1, 0, 1), "%.2f ms", stats.avgCpuMs);
+
+		ImGui::SameLine();
+
+		ImGui::Text("Wall: ");
+		ImGui::SameLine();
+		ImGui::TextColored(ImVec4(1, 1, 0, 1), "%.2f ms", stats.avgWallMs);
+
+		ImGui::Text("Hitches: ");
+		ImGui::SameLine();
+		ImGui::TextColored(stats.hitches > 0 ? ImVec4(1, 0, 0, 1) : ImVec4(1, 1, 0, 1), "%u (%u total)", stats.hitches, stats.totalHitches);
+
+		float threshold = app->clock->GetHitchThreshold();
+		if (ImGui::DragFloat("Hitch threshold", &threshold, 0.1f, 1.0f, 1000.0f, "%.1f ms"))
+			app->clock->SetHitchThreshold(threshold);
+
+		if (ImGui::Button("Reset stats"))
+			app->clock->ResetFrameStats();
+
 		ImGui::Text("Game time clock ----------");
 		ImGui::Separator();
 
@@ -0,0 +1,124 @@
+#include "FrameAllocator.h"
+
+#include <stdlib.h>
+
+/** Header of a block allocated once the arena is full. They are chained so tracking them needs no heap memory. */
+struct OverflowBlock
+{
+	OverflowBlock* next = nullptr;
+};
+
+/** The arena of a thread. Blocks come from malloc so they don't count as hot path heap allocations. */
+struct FrameArena
+{
+	char* block = nullptr;
+	size_t capacity = 0;
+	size_t offset = 0;
+
+	OverflowBlock* overflow = nullptr;
+	uint overflowBlocks = 0;
+	size_t overflowBytes = 0;
+	uint allocations = 0;
+	uint hotPathHeapAllocations = 0;
+
+	FrameAllocatorStats stats; //Of the last finished frame.
+
+	~FrameArena()
+	{
+		FreeOverflow();
+		free(block);
+	}
+
+	void FreeOverflow()
+	{
+		while (overflow)
+		{
+			OverflowBlock* next = overflow->next;
+			free(overflow);
+			overflow = next;
+		}
+		overflowBlocks = 0;
+	}
+};
+
+static thread_local FrameArena arena;
+
+/** FrameAllocator - Alloc: Bumps the calling thread arena. Alignment must be a power of two. */
+void * FrameAllocator::Alloc(size_t size, size_t alignment)
+{
+	if (arena.block == nullptr)
+	{
+		arena.block = (char*)malloc(FRAME_ALLOCATOR_SIZE);
+		arena.capacity = FRAME_ALLOCATOR_SIZE;
+	}
+
+	++arena.allocations;
+
+	size_t aligned = (arena.offset + alignment - 1) & ~(alignment - 1);
+	if (aligned + size <= arena.capacity)
+	{
+		arena.offset = aligned + size;
+		return arena.block + aligned;
+	}
+
+	//Out of arena, the extra block is freed and the arena grown on Reset
+	char* block = (char*)malloc(sizeof(OverflowBlock) + size + alignment);
+	if (block == nullptr)
+		return nullptr;
+
+	OverflowBlock* header = (OverflowBlock*)block;
+	header->next = arena.overflow;
+	arena.overflow = header;
+	++arena.overflowBlocks;
+	arena.overflowBytes += size + alignment;
+
+	char* data = block + sizeof(OverflowBlock);
+	return (char*)(((size_t)data + alignment - 1) & ~(alignment - 1));
+}
+
+/** FrameAllocator - Reset: Frees everything the calling thread allocated this frame and keeps the frame stats. */
+void FrameAllocator::Reset()
+{
+	FrameAllocatorStats& stats = arena.stats;
+	stats.usedBytes = arena.offset + arena.overflowBytes;
+	stats.peakBytes = MAX(stats.peakBytes, stats.usedBytes);
+	stats.allocations = arena.allocations;
+	stats.overflowBlocks = arena.overflowBlocks;
+	stats.hotPathHeapAllocations = arena.hotPathHeapAllocations;
+
+	if (arena.overflow)
+	{
+		arena.FreeOverflow();
+
+		//Grow to the next power of two that fits the whole frame
+		size_t capacity = arena.capacity;
+		while (capacity < stats.usedBytes)
+			capacity *= 2;
+
+		char* block = (char*)malloc(capacity);
+		if (block)
+		{
+			free(arena.block);
+			arena.block = block;
+			arena.capacity = capacity;
+		}
+	}
+
+	stats.capacity = arena.capacity;
+
+	arena.offset = 0;
+	arena.overflowBytes = 0;
+	arena.allocations = 0;
+	arena.hotPathHeapAllocations = 0;
+}
+
+/** FrameAllocator - GetStats: Stats of the last frame of the calling thread arena. */
+void FrameAllocator::GetStats(FrameAllocatorStats & stats)
+{
+	stats = arena.stats;
+}
+
+void FrameAllocator::AddHotPathHeapAllocations(uint count)
+{
+	arena.hotPathHeapAllocations += count;
+}
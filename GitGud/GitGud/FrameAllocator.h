@@ -0,0 +1,110 @@
+#ifndef __FRAME_ALLOCATOR_H__
+#define __FRAME_ALLOCATOR_H__
+
+#include "Globals.h"
+#include "MemoryTracker.h"
+
+#include <vector>
+#include <map>
+#include <string>
+#include <functional>
+
+#define FRAME_ALLOCATOR_SIZE (256 * 1024) //Initial size of every thread arena, it grows to fit the biggest frame.
+
+#define FRAME_HEAP_CHECK_CONCAT_IMPL(a, b) a##b
+#define FRAME_HEAP_CHECK_CONCAT(a, b) FRAME_HEAP_CHECK_CONCAT_IMPL(a, b)
+#define FRAME_HEAP_CHECK() FrameHeapCheck FRAME_HEAP_CHECK_CONCAT(frameHeapCheck, __LINE__)
+
+struct FrameAllocatorStats
+{
+	uint64 capacity = 0;
+	uint64 usedBytes = 0;			//Last frame.
+	uint64 peakBytes = 0;
+	uint allocations = 0;			//Last frame.
+	uint overflowBlocks = 0;		//Heap blocks the arena needed last frame, 0 once it fits the frame.
+	uint hotPathHeapAllocations = 0;	//General heap allocations made inside FRAME_HEAP_CHECK scopes last frame.
+};
+
+/**
+*	- Per thread bump allocator for the data that only lives during the frame. Alloc only moves an offset and nothing is
+*	  freed until Reset, called by the app at the end of every frame for the main thread. Other threads using it must reset
+*	  their own arena.
+*	- If a frame needs more than the arena the rest comes from heap blocks and the arena grows to fit it on Reset, so after
+*	  a few frames the transient data does not touch the general heap at all.
+*	- Never keep frame memory across frames: use FrameVector, FrameMap and FrameString only for locals.
+*/
+class FrameAllocator
+{
+public:
+	static void* Alloc(size_t size, size_t alignment);
+	static void Reset();
+
+	static void GetStats(FrameAllocatorStats& stats);
+	static void AddHotPathHeapAllocations(uint count);
+};
+
+/** STL adapter for FrameAllocator. Deallocate does nothing, the memory goes back on Reset. */
+template<typename T>
+class FrameStlAllocator
+{
+public:
+	typedef T value_type;
+
+	template<typename U>
+	struct rebind
+	{
+		typedef FrameStlAllocator<U> other;
+	};
+
+	FrameStlAllocator()
+	{}
+	template<typename U>
+	FrameStlAllocator(const FrameStlAllocator<U>&)
+	{}
+
+	T* allocate(size_t n)
+	{
+		return (T*)FrameAllocator::Alloc(n * sizeof(T), alignof(T));
+	}
+
+	void deallocate(T*, size_t)
+	{}
+};
+
+template<typename T, typename U>
+inline bool operator==(const FrameStlAllocator<T>&, const FrameStlAllocator<U>&)
+{
+	return true;
+}
+
+template<typename T, typename U>
+inline bool operator!=(const FrameStlAllocator<T>&, const FrameStlAllocator<U>&)
+{
+	return false;
+}
+
+template<typename T>
+using FrameVector = std::vector<T, FrameStlAllocator<T>>;
+
+template<typename K, typename V>
+using FrameMap = std::map<K, V, std::less<K>, FrameStlAllocator<std::pair<const K, V>>>;
+
+typedef std::basic_string<char, std::char_traits<char>, FrameStlAllocator<char>> FrameString;
+
+/** Counts the general heap allocations the calling thread makes while alive. Only new is counted and only where the
+	memory tracker hooks it (release builds). Use it through FRAME_HEAP_CHECK. */
+class FrameHeapCheck
+{
+public:
+	FrameHeapCheck() : start(MemoryTracker::GetThreadAllocations())
+	{}
+	~FrameHeapCheck()
+	{
+		FrameAllocator::AddHotPathHeapAllocations((uint)(MemoryTracker::GetThreadAllocations() - start));
+	}
+
+private:
+	uint64 start;
+};
+
+#endif // !__FRAME_ALLOCATOR_H__
@@ -63,7 +63,8 @@ public:
 		}
 	}
 
-	void CollectCandidates(std::vector<GameObject*>& vec, const Frustum& collector)
+	template<typename ALLOC>
+	void CollectCandidates(std::vector<GameObject*, ALLOC>& vec, const Frustum& collector)
 	{
 		if (collector.Intersects(box))
 		{
@@ -96,10 +97,10 @@ public:
 		}
 	}
 
-	template<typename TYPE>
-	void CollectIntersections(std::map<float, GameObject*>& objects, const TYPE& primitive)const;
-	template<typename TYPE>
-	void CollectIntersections(std::vector<GameObject*>& objects, const TYPE& primitive)const;
+	template<typename TYPE, typename ALLOC>
+	void CollectIntersections(std::map<float, GameObject*, std::less<float>, ALLOC>& objects, const TYPE& primitive)const;
+	template<typename TYPE, typename ALLOC>
+	void CollectIntersections(std::vector<GameObject*, ALLOC>& objects, const TYPE& primitive)const;
 
 private:
 	void DivideNode()
@@ -230,7 +231,8 @@ public:
 			root->Erase(obj);
 	}
 
-	void CollectCandidates(std::vector<GameObject*>& vec, const Frustum& collector)
+	template<typename ALLOC>
+	void CollectCandidates(std::vector<GameObject*, ALLOC>& vec, const Frustum& collector)
 	{
 		if (root)
 			if(collector.Intersects(root->box))
@@ -243,10 +245,10 @@ public:
 			root->CollectBoxes(vec);
 	}
 
-	template<typename TYPE>
-	void CollectIntersections(std::map<float, GameObject*>& objects, const TYPE& primitive)const;
-	template<typename TYPE>
-	void CollectIntersections(std::vector<GameObject*>& objects, const TYPE& primitive)const;
+	template<typename TYPE, typename ALLOC>
+	void CollectIntersections(std::map<float, GameObject*, std::less<float>, ALLOC>& objects, const TYPE& primitive)const;
+	template<typename TYPE, typename ALLOC>
+	void CollectIntersections(std::vector<GameObject*, ALLOC>& objects, const TYPE& primitive)const;
 
 private:
 	void Clear()
@@ -262,15 +264,15 @@ public:
 
 //-------------------------------------------------------
 
-template<typename TYPE>
-inline void GGOctree::CollectIntersections(std::map<float, GameObject*>& objects, const TYPE& primitive)const
+template<typename TYPE, typename ALLOC>
+inline void GGOctree::CollectIntersections(std::map<float, GameObject*, std::less<float>, ALLOC>& objects, const TYPE& primitive)const
 {
 	if (root)
 		root->CollectIntersections(objects, primitive);
 }
 
-template<typename TYPE>
-inline void GGOctree::CollectIntersections(std::vector<GameObject*>& objects, const TYPE& primitive)const
+template<typename TYPE, typename ALLOC>
+inline void GGOctree::CollectIntersections(std::vector<GameObject*, ALLOC>& objects, const TYPE& primitive)const
 {
 	if (root)
 		root->CollectIntersections(objects, primitive);
@@ -278,8 +280,8 @@ inline void GGOctree::CollectIntersections(std::vector<GameObject*>& objects, co
 
 
 
-template<typename TYPE>
-inline void GGOctreeNode::CollectIntersections(std::map<float, GameObject*>& objects, const TYPE& primitive)const
+template<typename TYPE, typename ALLOC>
+inline void GGOctreeNode::CollectIntersections(std::map<float, GameObject*, std::less<float>, ALLOC>& objects, const TYPE& primitive)const
 {
 	if (primitive.Intersects(box))
 	{
@@ -295,8 +297,8 @@ inline void GGOctreeNode::CollectIntersections(std::map<float, GameObject*>& obj
 	}
 }
 
-template<typename TYPE>
-inline void GGOctreeNode::CollectIntersections(std::vector<GameObject*>& objects, const TYPE& primitive)const
+template<typename TYPE, typename ALLOC>
+inline void GGOctreeNode::CollectIntersections(std::vector<GameObject*, ALLOC>& objects, const TYPE& primitive)const
 {
 	if (primitive.Intersects(box))
 	{
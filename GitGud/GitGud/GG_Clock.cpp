@@ -1,6 +1,28 @@
 #include "GG_Clock.h"
 #include "PerfTimer.h"
 
+#include <algorithm>
+
+/** Returns the cpu time, user and kernel, consumed by the calling thread in 100ns units. */
+static uint64 ThreadCpuTime()
+{
+	FILETIME creation, exit, kernel, user;
+	if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+		return 0;
+
+	uint64 k = ((uint64)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime;
+	uint64 u = ((uint64)user.dwHighDateTime << 32) | user.dwLowDateTime;
+	return k + u;
+}
+
+/** Returns the value at the percentile (0-1) of the values, they get partially sorted. */
+static float Percentile(std::vector<float>& values, float percentile)
+{
+	uint n = (uint)((values.size() - 1) * percentile + 0.5f);
+	std::nth_element(values.begin(), values.begin() + n, values.end());
+	return values[n];
+}
+
 
 GG_Clock::GG_Clock()
 {
@@ -21,7 +43,9 @@ GG_Clock::~GG_Clock()
 *		- Add the elapsed time.
 *		- Recal real dt.
 *		- Add one frame to counter.
+*		- Store the last frame wall and cpu time for the frame stats.
 *		- If app state is PLAY do the same with the game timer.
+*		- A forced dt replaces the measured one, the frame stats keep the measured time.
 */
 void GG_Clock::OnPrepareUpdate(AppState appState)
 {
@@ -29,17 +53,33 @@ void GG_Clock::OnPrepareUpdate(AppState appState)
 	timeSinceAppStart += realDt;
 	timeSinceLevelLoaded += realDt;
 	//2. Calc dt
-	realDt = (float)(msTimer->ReadMs() / 1000.0f);
+	float frameMs = (float)msTimer->ReadMs();
+	realDt = frameMs / 1000.0f;
 	if (realDt > maximumDT) realDt = 1 / 30.0f;
+	if (forcedDt > 0.f) realDt = forcedDt;
 	msTimer->Start();
 	//3. Add a frame
 	++realFrameCount;
+	//4. Store the last frame stats, with the unclamped time
+	uint64 cpuTime = ThreadCpuTime();
+	if (statsStarted)
+	{
+		uint index = statsFrames % FRAME_STATS_WINDOW;
+		frameWallMs[index] = frameMs;
+		frameCpuMs[index] = (float)(cpuTime - lastCpuTime) / 10000.0f;
+		++statsFrames;
+
+		if (frameMs > hitchThresholdMs)
+			++totalHitches;
+	}
+	lastCpuTime = cpuTime;
+	statsStarted = true;
 
 	if (appState == AppState::PLAY)
 	{
 		gameTimeSinceLevelLoaded += gameDt;
 
-		gameDt = ((float)(msGameTimer->ReadMs() / 1000.0f)) * scale;
+		gameDt = ((forcedDt > 0.f) ? forcedDt : (float)(msGameTimer->ReadMs() / 1000.0f)) * scale;
 		msGameTimer->Start();
 
 		++gameFrameCount;
@@ -182,6 +222,81 @@ float GG_Clock::LastFrameMs() const
 	return lastFrameMs;
 }
 
+/**
+*	- LastFrameWallMs: Return the last full frame ms, including the fps cap delay and any wait.
+*/
+float GG_Clock::LastFrameWallMs() const
+{
+	return statsFrames > 0 ? frameWallMs[(statsFrames - 1) % FRAME_STATS_WINDOW] : 0.f;
+}
+
+/**
+*	- LastFrameCpuMs: Return the cpu time the main thread consumed in the last full frame.
+*/
+float GG_Clock::LastFrameCpuMs() const
+{
+	return statsFrames > 0 ? frameCpuMs[(statsFrames - 1) % FRAME_STATS_WINDOW] : 0.f;
+}
+
+/**
+*	- GetFrameStats: Calculate the percentiles, hitches and cpu/wall split of the frames in the window.
+*/
+void GG_Clock::GetFrameStats(FrameStats & stats) const
+{
+	stats = FrameStats();
+	stats.totalHitches = totalHitches;
+	stats.hitchThresholdMs = hitchThresholdMs;
+	stats.frames = MIN(statsFrames, (uint)FRAME_STATS_WINDOW);
+
+	if (stats.frames == 0)
+		return;
+
+	std::vector<float> sorted(frameWallMs, frameWallMs + stats.frames);
+
+	float totalWall = 0.f, totalCpu = 0.f;
+	for (uint i = 0; i < stats.frames; ++i)
+	{
+		totalWall += frameWallMs[i];
+		totalCpu += frameCpuMs[i];
+		stats.maxMs = MAX(stats.maxMs, frameWallMs[i]);
+		if (frameWallMs[i] > hitchThresholdMs)
+			++stats.hitches;
+	}
+
+	stats.avgMs = stats.avgWallMs = totalWall / stats.frames;
+	stats.avgCpuMs = totalCpu / stats.frames;
+
+	stats.p50Ms = Percentile(sorted, 0.5f);
+	stats.p90Ms = Percentile(sorted, 0.9f);
+	stats.p99Ms = Percentile(sorted, 0.99f);
+}
+
+/**
+*	- ResetFrameStats: Clear the frame stats window and the hitch counter.
+*/
+void GG_Clock::ResetFrameStats()
+{
+	statsFrames = 0;
+	totalHitches = 0;
+}
+
+/**
+*	- GetHitchThreshold: Return the ms a frame must exceed to count as a hitch.
+*/
+float GG_Clock::GetHitchThreshold() const
+{
+	return hitchThresholdMs;
+}
+
+/**
+*	- SetHitchThreshold: Set the ms a frame must exceed to count as a hitch.
+*/
+void GG_Clock::SetHitchThreshold(float ms)
+{
+	if (ms > 0.0f)
+		hitchThresholdMs = ms;
+}
+
 /**
 *	- SetScale: Set the game time scale.
 */
@@ -192,3 +307,16 @@ void GG_Clock::SetScale(float scl)
 	else
 		scale = 0.0f;
 }
+
+/**
+*	- SetForcedDT: Use this dt, in seconds, instead of the measured one from the next frame on. 0 measures it again.
+*/
+void GG_Clock::SetForcedDT(float dt)
+{
+	forcedDt = MAX(0.f, dt);
+}
+
+float GG_Clock::GetForcedDT() const
+{
+	return forcedDt;
+}
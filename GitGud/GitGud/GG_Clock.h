@@ -2,9 +2,32 @@
 #define __GG_CLOCK_H__
 
 #include "Globals.h"
+#include <vector>
+
+#define FRAME_STATS_WINDOW 600
+#define DEFAULT_HITCH_THRESHOLD_MS 33.3f
 
 class PerfTimer;
 
+/** Frame time statistics over the rolling window of the last frames. */
+struct FrameStats
+{
+	uint frames = 0;
+
+	float p50Ms = 0.f;
+	float p90Ms = 0.f;
+	float p99Ms = 0.f;
+	float maxMs = 0.f;
+	float avgMs = 0.f;
+
+	float avgCpuMs = 0.f;	//Main thread cpu time, the rest of the wall time was spent waiting (vsync, fps cap, render thread...).
+	float avgWallMs = 0.f;
+
+	uint hitches = 0;		//Frames in the window over the hitch threshold.
+	uint totalHitches = 0;	//Since start up or the last reset.
+	float hitchThresholdMs = 0.f;
+};
+
 class GG_Clock
 {
 public:
@@ -37,9 +60,21 @@ public:
 	float GetScale()const;
 
 	float LastFrameMs()const;
+	float LastFrameWallMs()const;
+	float LastFrameCpuMs()const;
 
 	void SetScale(float scl);
 
+	void SetForcedDT(float dt);
+	float GetForcedDT()const;
+
+	//Frame stats---------------
+	void GetFrameStats(FrameStats& stats)const;
+	void ResetFrameStats();
+
+	float GetHitchThreshold()const;
+	void SetHitchThreshold(float ms);
+
 
 private:
 	//Real -------------------------
@@ -65,6 +100,16 @@ private:
 
 	float lastFrameMs = 0;
 	float maximumDT = 1.0f;
+	float forcedDt = 0.f;	//Replaces the measured dt when set, to replay a run deterministically.
+
+	//Frame stats -------------------
+	float frameWallMs[FRAME_STATS_WINDOW];	//Ring of the last frames wall time, from begin to begin.
+	float frameCpuMs[FRAME_STATS_WINDOW];
+	uint statsFrames = 0;
+	uint totalHitches = 0;
+	float hitchThresholdMs = DEFAULT_HITCH_THRESHOLD_MS;
+	uint64 lastCpuTime = 0;
+	bool statsStarted = false;
 };
 
 #endif // !__GG_CLOCK_H__
\ No newline at end of file
@@ -0,0 +1,260 @@
+#include "GLBackend.h"
+
+#include "OpenGL.h"
+
+#define GL_BACKEND_LOG_SIZE 1024
+
+const char * GLBackend::GetName() const
+{
+	return "OpenGL";
+}
+
+void GLBackend::UseProgram(uint program)
+{
+	glUseProgram(program);
+}
+
+void GLBackend::BindVertexArray(uint vao)
+{
+	glBindVertexArray(vao);
+}
+
+void GLBackend::BindBuffer(uint target, uint buffer)
+{
+	glBindBuffer(target, buffer);
+}
+
+void GLBackend::ActiveTexture(uint unit)
+{
+	glActiveTexture(unit);
+}
+
+void GLBackend::BindTexture(uint target, uint texture)
+{
+	glBindTexture(target, texture);
+}
+
+void GLBackend::SetCapability(uint cap, bool enable)
+{
+	if (enable) glEnable(cap);
+	else glDisable(cap);
+}
+
+void GLBackend::BlendFunc(uint src, uint dst)
+{
+	glBlendFunc(src, dst);
+}
+
+void GLBackend::CullFace(uint mode)
+{
+	glCullFace(mode);
+}
+
+void GLBackend::DepthFunc(uint func)
+{
+	glDepthFunc(func);
+}
+
+void GLBackend::DepthMask(bool write)
+{
+	glDepthMask(write ? GL_TRUE : GL_FALSE);
+}
+
+void GLBackend::Viewport(int x, int y, int w, int h)
+{
+	glViewport(x, y, w, h);
+}
+
+void GLBackend::LineWidth(float width)
+{
+	glLineWidth(width);
+}
+
+void GLBackend::PolygonMode(uint mode)
+{
+	glPolygonMode(GL_FRONT_AND_BACK, mode);
+}
+
+void GLBackend::ClearColor(float r, float g, float b, float a)
+{
+	glClearColor(r, g, b, a);
+}
+
+void GLBackend::Clear(uint mask)
+{
+	glClear(mask);
+}
+
+uint GLBackend::GenBuffer()
+{
+	uint buffer = 0;
+	glGenBuffers(1, &buffer);
+	return buffer;
+}
+
+void GLBackend::DeleteBuffer(uint buffer)
+{
+	glDeleteBuffers(1, &buffer);
+}
+
+void GLBackend::BufferData(uint target, uint size, const void * data, uint usage)
+{
+	glBufferData(target, size, data, usage);
+}
+
+void GLBackend::BufferSubData(uint target, uint offset, uint size, const void * data)
+{
+	glBufferSubData(target, offset, size, data);
+}
+
+void * GLBackend::MapBufferRange(uint target, uint offset, uint size, uint access)
+{
+	return glMapBufferRange(target, offset, size, access);
+}
+
+void GLBackend::UnmapBuffer(uint target)
+{
+	glUnmapBuffer(target);
+}
+
+uint GLBackend::GenVertexArray()
+{
+	uint vao = 0;
+	glGenVertexArrays(1, &vao);
+	return vao;
+}
+
+void GLBackend::DeleteVertexArray(uint vao)
+{
+	glDeleteVertexArrays(1, &vao);
+}
+
+/** GLBackend - VertexAttribute: Points the attribute to the bound array buffer and enables it. */
+void GLBackend::VertexAttribute(uint location, int components, uint type, bool normalized, int stride, uint offset)
+{
+	glVertexAttribPointer(location, components, type, normalized ? GL_TRUE : GL_FALSE, stride, (GLvoid*)(size_t)offset);
+	glEnableVertexAttribArray(location);
+}
+
+uint GLBackend::GenTexture()
+{
+	uint texture = 0;
+	glGenTextures(1, &texture);
+	return texture;
+}
+
+void GLBackend::DeleteTexture(uint texture)
+{
+	glDeleteTextures(1, &texture);
+}
+
+void GLBackend::PixelStore(uint name, int value)
+{
+	glPixelStorei(name, value);
+}
+
+void GLBackend::TexParameter(uint target, uint name, int value)
+{
+	glTexParameteri(target, name, value);
+}
+
+void GLBackend::TexImage2D(uint target, int level, int internalFormat, int width, int height, uint format, uint type, const void * data)
+{
+	glTexImage2D(target, level, internalFormat, width, height, 0, format, type, data);
+}
+
+void GLBackend::CompressedTexImage2D(uint target, int level, uint internalFormat, int width, int height, uint size, const void * data)
+{
+	glCompressedTexImage2D(target, level, internalFormat, width, height, 0, size, data);
+}
+
+/** GLBackend - CompileShader: Returns the compiled shader, or 0 with the info log filled. */
+uint GLBackend::CompileShader(uint type, const char * code, std::string & log)
+{
+	uint shader = glCreateShader(type);
+	if (shader == 0)
+		return 0;
+
+	glShaderSource(shader, 1, &code, NULL);
+	glCompileShader(shader);
+
+	GLint succes = 0;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &succes);
+	if (!succes)
+	{
+		GLchar infoLog[GL_BACKEND_LOG_SIZE];
+		glGetShaderInfoLog(shader, GL_BACKEND_LOG_SIZE, NULL, infoLog);
+		log = infoLog;
+
+		glDeleteShader(shader);
+		shader = 0;
+	}
+
+	return shader;
+}
+
+/** GLBackend - LinkProgram: Returns the linked program, or 0 with the info log filled. The shaders are detached but not deleted. */
+uint GLBackend::LinkProgram(const uint * shaders, uint count, std::string & log)
+{
+	uint program = glCreateProgram();
+
+	for (uint i = 0; i < count; ++i)
+		if (shaders[i] != 0) glAttachShader(program, shaders[i]);
+
+	glLinkProgram(program);
+
+	GLint succes = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &succes);
+	if (!succes)
+	{
+		GLchar infoLog[GL_BACKEND_LOG_SIZE];
+		glGetProgramInfoLog(program, GL_BACKEND_LOG_SIZE, NULL, infoLog);
+		log = infoLog;
+	}
+
+	for (uint i = 0; i < count; ++i)
+		if (shaders[i] != 0) glDetachShader(program, shaders[i]);
+
+	if (!succes)
+	{
+		glDeleteProgram(program);
+		program = 0;
+	}
+
+	return program;
+}
+
+void GLBackend::DeleteShader(uint shader)
+{
+	glDeleteShader(shader);
+}
+
+void GLBackend::DeleteProgram(uint program)
+{
+	glDeleteProgram(program);
+}
+
+int GLBackend::GetUniformLocation(uint program, const char * name)
+{
+	return glGetUniformLocation(program, name);
+}
+
+void GLBackend::UniformMatrix4(int location, const float * matrix)
+{
+	glUniformMatrix4fv(location, 1, GL_FALSE, matrix);
+}
+
+void GLBackend::DrawElements(uint mode, int count, uint type, uint offset)
+{
+	glDrawElements(mode, count, type, (GLvoid*)(size_t)offset);
+}
+
+void GLBackend::MultiDrawElements(uint mode, const int * counts, uint type, const void * const * offsets, int drawCount)
+{
+	glMultiDrawElements(mode, counts, type, offsets, drawCount);
+}
+
+void GLBackend::DrawArrays(uint mode, int first, int count)
+{
+	glDrawArrays(mode, first, count);
+}
@@ -0,0 +1,58 @@
+#ifndef __GL_BACKEND_H__
+#define __GL_BACKEND_H__
+
+#include "RenderBackend.h"
+
+/** Forwards everything to OpenGL. It holds no state, so a single instance serves every context and thread. */
+class GLBackend : public RenderBackend
+{
+public:
+	const char* GetName()const override;
+
+	void UseProgram(uint program)override;
+	void BindVertexArray(uint vao)override;
+	void BindBuffer(uint target, uint buffer)override;
+	void ActiveTexture(uint unit)override;
+	void BindTexture(uint target, uint texture)override;
+	void SetCapability(uint cap, bool enable)override;
+	void BlendFunc(uint src, uint dst)override;
+	void CullFace(uint mode)override;
+	void DepthFunc(uint func)override;
+	void DepthMask(bool write)override;
+	void Viewport(int x, int y, int w, int h)override;
+	void LineWidth(float width)override;
+	void PolygonMode(uint mode)override;
+	void ClearColor(float r, float g, float b, float a)override;
+	void Clear(uint mask)override;
+
+	uint GenBuffer()override;
+	void DeleteBuffer(uint buffer)override;
+	void BufferData(uint target, uint size, const void* data, uint usage)override;
+	void BufferSubData(uint target, uint offset, uint size, const void* data)override;
+	void* MapBufferRange(uint target, uint offset, uint size, uint access)override;
+	void UnmapBuffer(uint target)override;
+
+	uint GenVertexArray()override;
+	void DeleteVertexArray(uint vao)override;
+	void VertexAttribute(uint location, int components, uint type, bool normalized, int stride, uint offset)override;
+
+	uint GenTexture()override;
+	void DeleteTexture(uint texture)override;
+	void PixelStore(uint name, int value)override;
+	void TexParameter(uint target, uint name, int value)override;
+	void TexImage2D(uint target, int level, int internalFormat, int width, int height, uint format, uint type, const void* data)override;
+	void CompressedTexImage2D(uint target, int level, uint internalFormat, int width, int height, uint size, const void* data)override;
+
+	uint CompileShader(uint type, const char* code, std::string& log)override;
+	uint LinkProgram(const uint* shaders, uint count, std::string& log)override;
+	void DeleteShader(uint shader)override;
+	void DeleteProgram(uint program)override;
+	int GetUniformLocation(uint program, const char* name)override;
+	void UniformMatrix4(int location, const float* matrix)override;
+
+	void DrawElements(uint mode, int count, uint type, uint offset)override;
+	void MultiDrawElements(uint mode, const int* counts, uint type, const void* const* offsets, int drawCount)override;
+	void DrawArrays(uint mode, int first, int count)override;
+};
+
+#endif // !__GL_BACKEND_H__
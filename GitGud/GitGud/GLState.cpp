@@ -0,0 +1,299 @@
+#include "GLState.h"
+
+#include "RenderBackend.h"
+
+#include "OpenGL.h"
+
+#include <atomic>
+
+#define GL_STATE_UNKNOWN 0xFFFFFFFF
+#define GL_STATE_CAPS 4
+
+struct GLStateData
+{
+	GLStateData()
+	{
+		Reset();
+	}
+
+	void Reset()
+	{
+		program = vao = arrayBuffer = elementBuffer = activeUnit = GL_STATE_UNKNOWN;
+		for (uint i = 0; i < GL_STATE_TEXTURE_UNITS; ++i) textures[i] = GL_STATE_UNKNOWN;
+		for (uint i = 0; i < GL_STATE_CAPS; ++i) caps[i] = -1;
+		blendSrc = blendDst = cullMode = depthFunc = polygonMode = GL_STATE_UNKNOWN;
+		depthMask = -1;
+		viewportKnown = clearColorKnown = false;
+		lineWidth = -1.0f;
+	}
+
+	uint program, vao, arrayBuffer, elementBuffer, activeUnit;
+	uint textures[GL_STATE_TEXTURE_UNITS]; //Only GL_TEXTURE_2D bindings are tracked.
+
+	int caps[GL_STATE_CAPS];
+	uint blendSrc, blendDst, cullMode, depthFunc, polygonMode;
+	int depthMask;
+
+	int viewport[4];
+	bool viewportKnown;
+	float clearColor[4];
+	bool clearColorKnown;
+	float lineWidth;
+
+	uint issued = 0;
+	uint skipped = 0;
+};
+
+static thread_local GLStateData state;
+
+static std::atomic<uint> lastIssued(0);
+static std::atomic<uint> lastSkipped(0);
+
+/** Returns true if the value changed and must be sent to GL, updating the cached one. */
+template<class T>
+static bool Changed(T& cached, T value)
+{
+	if (cached == value)
+	{
+		++state.skipped;
+		return false;
+	}
+
+	cached = value;
+	++state.issued;
+	return true;
+}
+
+static int CapIndex(uint cap)
+{
+	switch (cap)
+	{
+	case GL_DEPTH_TEST: return 0;
+	case GL_BLEND: return 1;
+	case GL_CULL_FACE: return 2;
+	case GL_SCISSOR_TEST: return 3;
+	}
+	return -1;
+}
+
+void GLState::UseProgram(uint program)
+{
+	if (Changed(state.program, program))
+		RenderBackend::Get()->UseProgram(program);
+}
+
+/** GLState - BindVertexArray: The element buffer binding belongs to the VAO, so it becomes unknown. */
+void GLState::BindVertexArray(uint vao)
+{
+	if (Changed(state.vao, vao))
+	{
+		RenderBackend::Get()->BindVertexArray(vao);
+		state.elementBuffer = GL_STATE_UNKNOWN;
+	}
+}
+
+void GLState::BindBuffer(uint target, uint buffer)
+{
+	switch (target)
+	{
+	case GL_ARRAY_BUFFER:
+		if (Changed(state.arrayBuffer, buffer)) RenderBackend::Get()->BindBuffer(target, buffer);
+		break;
+	case GL_ELEMENT_ARRAY_BUFFER:
+		if (Changed(state.elementBuffer, buffer)) RenderBackend::Get()->BindBuffer(target, buffer);
+		break;
+	default:
+		++state.issued;
+		RenderBackend::Get()->BindBuffer(target, buffer);
+		break;
+	}
+}
+
+/** GLState - ActiveTexture: Expects the GL enum (GL_TEXTURE0 + n). */
+void GLState::ActiveTexture(uint unit)
+{
+	if (Changed(state.activeUnit, unit))
+		RenderBackend::Get()->ActiveTexture(unit);
+}
+
+void GLState::BindTexture(uint target, uint texture)
+{
+	uint unit = (state.activeUnit == GL_STATE_UNKNOWN) ? GL_STATE_TEXTURE_UNITS : state.activeUnit - GL_TEXTURE0;
+
+	if (target == GL_TEXTURE_2D && unit < GL_STATE_TEXTURE_UNITS)
+	{
+		if (Changed(state.textures[unit], texture))
+			RenderBackend::Get()->BindTexture(target, texture);
+	}
+	else
+	{
+		++state.issued;
+		RenderBackend::Get()->BindTexture(target, texture);
+	}
+}
+
+void GLState::SetCapability(uint cap, bool enable)
+{
+	int index = CapIndex(cap);
+	if (index < 0 || Changed(state.caps[index], enable ? 1 : 0))
+	{
+		if (index < 0) ++state.issued;
+
+		RenderBackend::Get()->SetCapability(cap, enable);
+	}
+}
+
+void GLState::BlendFunc(uint src, uint dst)
+{
+	if (state.blendSrc == src && state.blendDst == dst)
+	{
+		++state.skipped;
+	}
+	else
+	{
+		state.blendSrc = src;
+		state.blendDst = dst;
+		++state.issued;
+		RenderBackend::Get()->BlendFunc(src, dst);
+	}
+}
+
+void GLState::CullFace(uint mode)
+{
+	if (Changed(state.cullMode, mode))
+		RenderBackend::Get()->CullFace(mode);
+}
+
+void GLState::DepthFunc(uint func)
+{
+	if (Changed(state.depthFunc, func))
+		RenderBackend::Get()->DepthFunc(func);
+}
+
+void GLState::DepthMask(bool write)
+{
+	if (Changed(state.depthMask, write ? 1 : 0))
+		RenderBackend::Get()->DepthMask(write);
+}
+
+void GLState::Viewport(int x, int y, int w, int h)
+{
+	if (state.viewportKnown && state.viewport[0] == x && state.viewport[1] == y && state.viewport[2] == w && state.viewport[3] == h)
+	{
+		++state.skipped;
+	}
+	else
+	{
+		state.viewport[0] = x; state.viewport[1] = y; state.viewport[2] = w; state.viewport[3] = h;
+		state.viewportKnown = true;
+		++state.issued;
+		RenderBackend::Get()->Viewport(x, y, w, h);
+	}
+}
+
+void GLState::LineWidth(float width)
+{
+	if (Changed(state.lineWidth, width))
+		RenderBackend::Get()->LineWidth(width);
+}
+
+void GLState::PolygonMode(uint mode)
+{
+	if (Changed(state.polygonMode, mode))
+		RenderBackend::Get()->PolygonMode(mode);
+}
+
+void GLState::ClearColor(float r, float g, float b, float a)
+{
+	if (state.clearColorKnown && state.clearColor[0] == r && state.clearColor[1] == g && state.clearColor[2] == b && state.clearColor[3] == a)
+	{
+		++state.skipped;
+	}
+	else
+	{
+		state.clearColor[0] = r; state.clearColor[1] = g; state.clearColor[2] = b; state.clearColor[3] = a;
+		state.clearColorKnown = true;
+		++state.issued;
+		RenderBackend::Get()->ClearColor(r, g, b, a);
+	}
+}
+
+/** GLState - DeleteProgram: Deletes the program and forgets it if it was the bound one. */
+void GLState::DeleteProgram(uint program)
+{
+	if (program == 0) return;
+
+	RenderBackend::Get()->DeleteProgram(program);
+	if (state.program == program) state.program = GL_STATE_UNKNOWN;
+}
+
+/** GLState - DeleteVertexArray: Deleting the bound VAO makes GL bind the 0 one. */
+void GLState::DeleteVertexArray(uint vao)
+{
+	if (vao == 0) return;
+
+	RenderBackend::Get()->DeleteVertexArray(vao);
+	if (state.vao == vao)
+	{
+		state.vao = 0;
+		state.elementBuffer = GL_STATE_UNKNOWN;
+	}
+}
+
+/** GLState - DeleteBuffer: Deleting a bound buffer makes GL bind the 0 one. */
+void GLState::DeleteBuffer(uint buffer)
+{
+	if (buffer == 0) return;
+
+	RenderBackend::Get()->DeleteBuffer(buffer);
+	if (state.arrayBuffer == buffer) state.arrayBuffer = 0;
+	if (state.elementBuffer == buffer) state.elementBuffer = 0;
+}
+
+/** GLState - DeleteTexture: Deleting a bound texture makes GL bind the 0 one. */
+void GLState::DeleteTexture(uint texture)
+{
+	if (texture == 0) return;
+
+	RenderBackend::Get()->DeleteTexture(texture);
+	for (uint i = 0; i < GL_STATE_TEXTURE_UNITS; ++i)
+	{
+		if (state.textures[i] == texture) state.textures[i] = 0;
+	}
+}
+
+/** GLState - Invalidate: Forgets all the cached state. The next call of each kind is always issued. */
+void GLState::Invalidate()
+{
+	state.Reset();
+}
+
+/** GLState - InvalidateTextures: Forgets the texture bindings, for code that binds textures on its own. */
+void GLState::InvalidateTextures()
+{
+	state.activeUnit = GL_STATE_UNKNOWN;
+	for (uint i = 0; i < GL_STATE_TEXTURE_UNITS; ++i) state.textures[i] = GL_STATE_UNKNOWN;
+}
+
+/** GLState - EndFrame: Publishes the counters of the calling thread for this frame and resets them, and ends the backend frame. */
+void GLState::EndFrame()
+{
+	RenderBackend::Get()->EndFrame();
+
+	lastIssued = state.issued;
+	lastSkipped = state.skipped;
+	state.issued = 0;
+	state.skipped = 0;
+}
+
+/** GLState - GetIssuedCalls: Calls sent to GL during the last frame. */
+uint GLState::GetIssuedCalls()
+{
+	return lastIssued;
+}
+
+/** GLState - GetSkippedCalls: Calls elided during the last frame because they changed nothing. */
+uint GLState::GetSkippedCalls()
+{
+	return lastSkipped;
+}
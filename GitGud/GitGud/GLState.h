@@ -0,0 +1,45 @@
+#ifndef __GLSTATE_H__
+#define __GLSTATE_H__
+
+#include "Globals.h"
+
+#define GL_STATE_TEXTURE_UNITS 16
+
+/**
+*	- Thin layer between the engine and the render backend that remembers the bound state and skips the calls that change nothing.
+*	- The state is kept per thread, as every thread works with its own GL context.
+*	- Code that touches GL behind it (DevIL, other libs) must call Invalidate or InvalidateTextures afterwards.
+*/
+class GLState
+{
+public:
+	static void UseProgram(uint program);
+	static void BindVertexArray(uint vao);
+	static void BindBuffer(uint target, uint buffer);
+	static void ActiveTexture(uint unit);
+	static void BindTexture(uint target, uint texture);
+
+	static void SetCapability(uint cap, bool enable);
+	static void BlendFunc(uint src, uint dst);
+	static void CullFace(uint mode);
+	static void DepthFunc(uint func);
+	static void DepthMask(bool write);
+	static void Viewport(int x, int y, int w, int h);
+	static void LineWidth(float width);
+	static void PolygonMode(uint mode);
+	static void ClearColor(float r, float g, float b, float a);
+
+	static void DeleteProgram(uint program);
+	static void DeleteVertexArray(uint vao);
+	static void DeleteBuffer(uint buffer);
+	static void DeleteTexture(uint texture);
+
+	static void Invalidate();
+	static void InvalidateTextures();
+
+	static void EndFrame();
+	static uint GetIssuedCalls();
+	static uint GetSkippedCalls();
+};
+
+#endif // !__GLSTATE_H__
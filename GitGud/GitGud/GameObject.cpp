@@ -4,6 +4,7 @@
 #include "M_GoManager.h"
 #include "RandGen.h"
 #include "JsonFile.h"
+#include "MemoryTracker.h"
 
 #include "Transform.h"
 #include "Mesh.h"
@@ -43,6 +44,7 @@ void GameObject::SetName(const char * str)
 
 GameObject * GameObject::CreateChild()
 {
+	MEMORY_TAG(MEM_SCENE);
 	GameObject* ret = nullptr;
 
 	ret = new GameObject(this, app->random->GetRandInt());
@@ -54,6 +56,7 @@ GameObject * GameObject::CreateChild()
 
 Component * GameObject::CreateComponent(ComponentType type)
 {
+	MEMORY_TAG(MEM_SCENE);
 	Component* ret = nullptr;
 	//TODO: Send error message if already have unique components
 
@@ -459,16 +462,7 @@ void GameObject::RecCalcTransform(const float4x4 & parentTrans, bool force)
 void GameObject::RecCalcBoxes()
 {
 	if (wasDirty)
-	{
-		RecalcBox();
-
-		orientedBox = enclosingBox;
-		if (orientedBox.IsFinite() && transform)
-		{
-			orientedBox.Transform(transform->GetGlobalTransform());
-			enclosingBox.SetFrom(orientedBox);
-		}
-	}
+		UpdateGlobalBox();
 
 	for (auto go : childs)
 	{
@@ -477,6 +471,31 @@ void GameObject::RecCalcBoxes()
 	}
 }
 
+/** GameObject - RefreshBox: Recalculates the boxes after a component changed its size without moving the object, like a mesh that
+							 finished loading. Static objects keep static and are moved in the octree. */
+void GameObject::RefreshBox()
+{
+	if (isStatic)
+		app->goManager->EraseFromTree(this);
+
+	UpdateGlobalBox();
+
+	if (isStatic)
+		app->goManager->InsertToTree(this);
+}
+
+void GameObject::UpdateGlobalBox()
+{
+	RecalcBox();
+
+	orientedBox = enclosingBox;
+	if (orientedBox.IsFinite() && transform)
+	{
+		orientedBox.Transform(transform->GetGlobalTransform());
+		enclosingBox.SetFrom(orientedBox);
+	}
+}
+
 void GameObject::RecalcBox()
 {
 	enclosingBox.SetNegativeInfinity();
@@ -93,6 +93,7 @@ public:
 	void RecCalcTransform(const float4x4& parentTrans, bool force = false);
 	void RecCalcBoxes();
 	void RecalcBox();
+	void RefreshBox();
 
 	//--------------------------
 
@@ -112,6 +113,7 @@ public:
 
 
 private:
+	void UpdateGlobalBox();
 
 public:
 	std::vector<Component*> components;
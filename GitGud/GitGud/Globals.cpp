@@ -1,32 +1,15 @@
 #include "Globals.h"
-#include <SDL.h>
-#include "App.h"
+#include "Logger.h"
 #include <assert.h>
-#include "MathGeoLib\include\Time\Clock.h"
 
+/** _log: Queues the message for the log thread, which writes it to the output and the console. Thread safe. */
 void _log(LogType type, const char file[], int line, const char* format, ...)
 {
-	static char tmpString[4096];
-	static char tmpString2[4096];
-	static char timeStr[1024];
-	static va_list ap;
+	va_list ap;
 
 	va_start(ap, format);
-	vsprintf_s(tmpString, 4096, format, ap);
+	Logger::Push(type, file, line, format, ap);
 	va_end(ap);
-
-	sprintf_s(timeStr, 1024, "(%d-%d-%d %d:%d:%d)", Clock::Day(), Clock::Month(), Clock::Year(), Clock::Hour(), Clock::Min(), Clock::Sec());
-
-	sprintf_s(tmpString2, 4096, "\n%s %s::%s(%d): %s", timeStr, GetLogTypeStr(type), file, line, tmpString);
-
-	//OutputDebugString(tmpString2);
-	SDL_Log(tmpString2);
-
-	if (app)
-	{
-		sprintf_s(tmpString2, 4096, "%s %s::%s\n", timeStr, GetLogTypeStr(type), tmpString);
-		app->Log(tmpString2, type);
-	}
 }
 
 const char* GetLogTypeStr(LogType type)
@@ -14,7 +14,12 @@ enum LogType
 	LOG_MAX = 4
 };
 
-#define _LOG(type, format, ...) _log(type, __FILE__, __LINE__, format, __VA_ARGS__);
+//Logs under GG_LOG_LEVEL are compiled out. Define it as LOG_WARN or LOG_ERROR to strip the info logs from a build.
+#ifndef GG_LOG_LEVEL
+#define GG_LOG_LEVEL LOG_INFO
+#endif
+
+#define _LOG(type, format, ...) do { if ((type) >= GG_LOG_LEVEL) _log(type, __FILE__, __LINE__, format, __VA_ARGS__); } while (0);
 
 void _log(LogType type, const char file[], int line, const char* format, ...);
 
@@ -48,6 +53,8 @@ const char* GetLogTypeStr(LogType type);
 #define PI 3.14159265358979323846264338327950288
 
 typedef unsigned int uint;
+typedef unsigned __int16 uint16;
+typedef __int16 int16;
 typedef unsigned __int32 uint32;
 typedef unsigned __int64 uint64;
 typedef unsigned char uchar;
@@ -106,6 +113,7 @@ enum DATA_TYPE
 
 #define CONFIG_PATH "Data/Configuration/"
 #define RESOURCES_PATH "Data/Resources/"
+#define PROFILER_PATH "Data/Profiling/"
 
 #define MESH_EXTENSION "ggmesh"
 #define TEXTURE_EXTENSION "dds"//"ggtex"
@@ -0,0 +1,179 @@
+#include "Hash.h"
+
+#include <string.h>
+
+#define XXH_PRIME32_1 0x9E3779B1U
+#define XXH_PRIME32_2 0x85EBCA77U
+#define XXH_PRIME32_3 0xC2B2AE3DU
+#define XXH_PRIME32_4 0x27D4EB2FU
+#define XXH_PRIME32_5 0x165667B1U
+
+#define XXH_PRIME64_1 0x9E3779B185EBCA87ULL
+#define XXH_PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define XXH_PRIME64_3 0x165667B19E3779F9ULL
+#define XXH_PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define XXH_PRIME64_5 0x27D4EB2F165667C5ULL
+
+static inline uint32 RotL32(uint32 x, uint32 r)
+{
+	return (x << r) | (x >> (32 - r));
+}
+
+//Unaligned little endian read
+static inline uint32 Read32(const uchar* p)
+{
+	uint32 ret;
+	memcpy(&ret, p, sizeof(ret));
+	return ret;
+}
+
+static inline uint32 Round32(uint32 acc, uint32 input)
+{
+	acc += input * XXH_PRIME32_2;
+	acc = RotL32(acc, 13);
+	return acc * XXH_PRIME32_1;
+}
+
+uint32 XXHash32(const void * data, size_t size, uint32 seed)
+{
+	const uchar* p = (const uchar*)data;
+	const uchar* end = p + size;
+	uint32 hash;
+
+	if (size >= 16)
+	{
+		const uchar* limit = end - 16;
+		uint32 v1 = seed + XXH_PRIME32_1 + XXH_PRIME32_2;
+		uint32 v2 = seed + XXH_PRIME32_2;
+		uint32 v3 = seed;
+		uint32 v4 = seed - XXH_PRIME32_1;
+
+		do
+		{
+			v1 = Round32(v1, Read32(p)); p += 4;
+			v2 = Round32(v2, Read32(p)); p += 4;
+			v3 = Round32(v3, Read32(p)); p += 4;
+			v4 = Round32(v4, Read32(p)); p += 4;
+		} while (p <= limit);
+
+		hash = RotL32(v1, 1) + RotL32(v2, 7) + RotL32(v3, 12) + RotL32(v4, 18);
+	}
+	else
+	{
+		hash = seed + XXH_PRIME32_5;
+	}
+
+	hash += (uint32)size;
+
+	while (p + 4 <= end)
+	{
+		hash += Read32(p) * XXH_PRIME32_3;
+		hash = RotL32(hash, 17) * XXH_PRIME32_4;
+		p += 4;
+	}
+
+	while (p < end)
+	{
+		hash += (*p) * XXH_PRIME32_5;
+		hash = RotL32(hash, 11) * XXH_PRIME32_1;
+		++p;
+	}
+
+	hash ^= hash >> 15;
+	hash *= XXH_PRIME32_2;
+	hash ^= hash >> 13;
+	hash *= XXH_PRIME32_3;
+	hash ^= hash >> 16;
+
+	return hash;
+}
+
+static inline uint64 RotL64(uint64 x, uint32 r)
+{
+	return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64 Read64(const uchar* p)
+{
+	uint64 ret;
+	memcpy(&ret, p, sizeof(ret));
+	return ret;
+}
+
+static inline uint64 Round64(uint64 acc, uint64 input)
+{
+	acc += input * XXH_PRIME64_2;
+	acc = RotL64(acc, 31);
+	return acc * XXH_PRIME64_1;
+}
+
+static inline uint64 MergeRound64(uint64 acc, uint64 val)
+{
+	acc ^= Round64(0, val);
+	return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+uint64 XXHash64(const void * data, size_t size, uint64 seed)
+{
+	const uchar* p = (const uchar*)data;
+	const uchar* end = p + size;
+	uint64 hash;
+
+	if (size >= 32)
+	{
+		const uchar* limit = end - 32;
+		uint64 v1 = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+		uint64 v2 = seed + XXH_PRIME64_2;
+		uint64 v3 = seed;
+		uint64 v4 = seed - XXH_PRIME64_1;
+
+		do
+		{
+			v1 = Round64(v1, Read64(p)); p += 8;
+			v2 = Round64(v2, Read64(p)); p += 8;
+			v3 = Round64(v3, Read64(p)); p += 8;
+			v4 = Round64(v4, Read64(p)); p += 8;
+		} while (p <= limit);
+
+		hash = RotL64(v1, 1) + RotL64(v2, 7) + RotL64(v3, 12) + RotL64(v4, 18);
+		hash = MergeRound64(hash, v1);
+		hash = MergeRound64(hash, v2);
+		hash = MergeRound64(hash, v3);
+		hash = MergeRound64(hash, v4);
+	}
+	else
+	{
+		hash = seed + XXH_PRIME64_5;
+	}
+
+	hash += (uint64)size;
+
+	while (p + 8 <= end)
+	{
+		hash ^= Round64(0, Read64(p));
+		hash = RotL64(hash, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+		p += 8;
+	}
+
+	if (p + 4 <= end)
+	{
+		hash ^= (uint64)Read32(p) * XXH_PRIME64_1;
+		hash = RotL64(hash, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+		p += 4;
+	}
+
+	while (p < end)
+	{
+		hash ^= (*p) * XXH_PRIME64_5;
+		hash = RotL64(hash, 11) * XXH_PRIME64_1;
+		++p;
+	}
+
+	hash ^= hash >> 33;
+	hash *= XXH_PRIME64_2;
+	hash ^= hash >> 29;
+	hash *= XXH_PRIME64_3;
+	hash ^= hash >> 32;
+
+	return hash;
+}
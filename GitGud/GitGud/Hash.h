@@ -0,0 +1,12 @@
+#ifndef __HASH_H__
+#define __HASH_H__
+
+#include "Globals.h"
+
+/** xxHash32 of a buffer. Fast non cryptographic hash, used to validate the data files. */
+uint32 XXHash32(const void* data, size_t size, uint32 seed = 0);
+
+/** xxHash64 of a buffer. Faster on big buffers than the 32 bit one, used to identify the contents of the asset files. */
+uint64 XXHash64(const void* data, size_t size, uint64 seed = 0);
+
+#endif // !__HASH_H__
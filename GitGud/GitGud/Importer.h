@@ -2,6 +2,8 @@
 #define __IMPORTER_H__
 
 #include "Globals.h"
+#include "Compression.h"
+#include <mutex>
 
 class Resource;
 
@@ -15,6 +17,30 @@ public:
 	{}
 
 	virtual bool LoadResource(Resource* resource) = 0;
+
+	/** Importer - AddSaveStats: Adds a saved library file to the stats and logs its compression ratio and speed. Imports may save from the workers. */
+	void AddSaveStats(const char* file, const CompressionStats& last)
+	{
+		{
+			std::lock_guard<std::mutex> lock(statsMutex);
+			compressionStats.rawBytes += last.rawBytes;
+			compressionStats.compressedBytes += last.compressedBytes;
+			compressionStats.encodeMs += last.encodeMs;
+		}
+
+		if (compressionLevel > 0 && last.compressedBytes > 0)
+		{
+			double mbs = last.encodeMs > 0.0 ? (last.rawBytes / (1024.0 * 1024.0)) / (last.encodeMs / 1000.0) : 0.0;
+			_LOG(LOG_INFO, "Saved %s: %u -> %u bytes, ratio %.2f, encoded at %.1f MB/s.", file, (uint)last.rawBytes, (uint)last.compressedBytes, (double)last.rawBytes / last.compressedBytes, mbs);
+		}
+	}
+
+public:
+	int compressionLevel = 0; //Of the library files. 0 saves them uncompressed.
+	CompressionStats compressionStats; //Totals of the files saved and loaded since the start.
+
+private:
+	std::mutex statsMutex;
 };
 
 #endif // !__IMPORTER_H__
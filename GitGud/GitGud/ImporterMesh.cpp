@@ -5,6 +5,9 @@
 #include "ResourceMesh.h"
 #include "M_ResourceManager.h"
 #include "M_FileSystem.h"
+#include "MemoryTracker.h"
+#include "MappedFile.h"
+#include "Hash.h"
 
 #include <string>
 
@@ -13,9 +16,13 @@
 #include <postprocess.h>
 #include <cfileio.h>
 
+#include "GLState.h"
+#include "RenderBackend.h"
+#include "RenderPacket.h"
+
 #include "OpenGL.h"
 
-ImporterMesh::ImporterMesh() : Importer()
+ImporterMesh::ImporterMesh() : Importer(), vertexFormat(VF_COMPACT)
 {
 	_LOG(LOG_INFO, "Mesh importer: Created.");
 }
@@ -24,13 +31,17 @@ ImporterMesh::~ImporterMesh()
 {
 }
 
-bool ImporterMesh::ImportMesh(const aiMesh * mesh, Path& output, UID & id)
+/** ImporterMesh - ImportMesh: Converts the mesh and saves it into the library. With forceUID it is saved with that UID instead of a new one,
+							   then it only touches the mesh and its file and can run on a worker thread. */
+bool ImporterMesh::ImportMesh(const aiMesh * mesh, Path& output, UID & id, UID forceUID)
 {
+	MEMORY_TAG(MEM_MESHES);
 	if (!mesh) return false;
 
 	ResourceMesh m(0);
 
 	m.name = (mesh->mName.length > 0) ? mesh->mName.C_Str() : "unamed_mesh";
+	m.vertexFormat = vertexFormat;
 
 	m.numVertices = mesh->mNumVertices;
 	m.vertices = new float[m.numVertices * 3];
@@ -58,7 +69,12 @@ bool ImporterMesh::ImportMesh(const aiMesh * mesh, Path& output, UID & id)
 	if (mesh->HasVertexColors(0))
 	{
 		m.colors = new float[m.numVertices * 3];
-		memcpy(m.colors, mesh->mColors, sizeof(float) * m.numVertices * 3);
+		for (uint i = 0; i < m.numVertices; ++i)
+		{
+			m.colors[i * 3] = mesh->mColors[0][i].r;
+			m.colors[i * 3 + 1] = mesh->mColors[0][i].g;
+			m.colors[i * 3 + 2] = mesh->mColors[0][i].b;
+		}
 	}
 
 	//TODO: Maybe 3d uvs
@@ -77,225 +93,610 @@ bool ImporterMesh::ImportMesh(const aiMesh * mesh, Path& output, UID & id)
 	m.aabb.SetNegativeInfinity();
 	m.aabb.Enclose((float3*)m.vertices, m.numVertices);
 
-	id = SaveResource(&m, output);
+	id = SaveResource(&m, output, forceUID);
 
 	return (id > 0);
 }
 
-bool ImporterMesh::LoadResource(Resource * resource)
+/** Copies the sections of the version 1 and headerless files into new mesh arrays. */
+static bool LoadCopy(ResourceMesh* res, const char* buffer, uint size)
 {
-	if(!resource || resource->GetType() != RES_MESH || resource->exportedFile.Empty())
-		return false;
+	const char* cursor = buffer;
 
-	bool ret = false;
+	//Header, the old files only have the ranges
+	uint ranges[5];
+	uint bytes = sizeof(ranges);
+	if (size < bytes)
+		return false;
 
-	ResourceMesh* res = (ResourceMesh*)resource;
+	MeshFileHeaderV1 header;
+	if (size >= sizeof(header) && memcmp(buffer, MESH_FILE_MAGIC, sizeof(header.magic)) == 0)
+	{
+		memcpy(&header, cursor, sizeof(header));
+		memcpy(ranges, header.ranges, sizeof(ranges));
+		res->vertexFormat = header.vertexFormat;
+		bytes = sizeof(header);
+	}
+	else
+	{
+		memcpy(ranges, cursor, bytes);
+		res->vertexFormat = VF_LEGACY;
+	}
 
-	char* buffer = nullptr;
-	uint size = app->fs->Load(res->GetExportedFileFullPath(), &buffer);
+	//The counts must fit the file before anything is allocated for them
+	uint64 needed = bytes + sizeof(uint) * (uint64)ranges[0] + sizeof(float) * (uint64)ranges[1] * 3;
+	for (uint i = 2; i < 5; ++i)
+		if (ranges[i] > 0) needed += sizeof(float) * (uint64)ranges[1] * (i == 4 ? 2 : 3);
+	needed += sizeof(AABB);
 
-	if (buffer && size > 0)
+	if (needed > size)
 	{
-		char* cursor = buffer;
+		_LOG(LOG_ERROR, "Mesh file [%s] is truncated or has a bad header.", res->GetExportedFile());
+		return false;
+	}
 
-		//Ranges
-		uint ranges[5];
-		uint bytes = sizeof(ranges);
-		memcpy(ranges, cursor, bytes);
+	res->numIndices = ranges[0];
+	res->numVertices = ranges[1];
 
-		res->numIndices = ranges[0];
-		res->numVertices = ranges[1];
+	//Indices
+	cursor += bytes;
+	bytes = sizeof(uint) * res->numIndices;
+	res->indices = new uint[res->numIndices];
+	memcpy(res->indices, cursor, bytes);
 
-		//Indices
+	//Vertices
+	cursor += bytes;
+	bytes = sizeof(float) * res->numVertices * 3;
+	res->vertices = new float[res->numVertices * 3];
+	memcpy(res->vertices, cursor, bytes);
+
+	//Normals
+	if (ranges[2] > 0)
+	{
 		cursor += bytes;
-		bytes = sizeof(uint) * res->numIndices;
-		res->indices = new uint[res->numIndices];
-		memcpy(res->indices, cursor, bytes);
+		bytes = sizeof(float) * res->numVertices * 3;
+		res->normals = new float[res->numVertices * 3];
+		memcpy(res->normals, cursor, bytes);
+	}
 
-		//Vertices
+	//Colors
+	if (ranges[3] > 0)
+	{
 		cursor += bytes;
 		bytes = sizeof(float) * res->numVertices * 3;
-		res->vertices = new float[res->numVertices * 3];
-		memcpy(res->vertices, cursor, bytes);
+		res->colors = new float[res->numVertices * 3];
+		memcpy(res->colors, cursor, bytes);
+	}
+
+	//UVs
+	if (ranges[4] > 0)
+	{
+		cursor += bytes;
+		bytes = sizeof(float) * res->numVertices * 2;
+		res->uvs = new float[res->numVertices * 2];
+		memcpy(res->uvs, cursor, bytes);
+	}
+
+	//AABB
+	cursor += bytes;
+	bytes = sizeof(AABB);
+	memcpy(&res->aabb, cursor, bytes);
+
+	return true;
+}
+
+/** Bytes of every section of a mesh. In 64 bits, the counts of a damaged header would wrap in 32. */
+static void GetSectionSizes(uint numIndices, uint numVertices, uint64* sizes)
+{
+	sizes[MESH_SECTION_INDICES] = sizeof(uint) * (uint64)numIndices;
+	sizes[MESH_SECTION_VERTICES] = sizeof(float) * (uint64)numVertices * 3;
+	sizes[MESH_SECTION_NORMALS] = sizeof(float) * (uint64)numVertices * 3;
+	sizes[MESH_SECTION_COLORS] = sizeof(float) * (uint64)numVertices * 3;
+	sizes[MESH_SECTION_UVS] = sizeof(float) * (uint64)numVertices * 2;
+	sizes[MESH_SECTION_AABB] = sizeof(AABB);
+}
+
+/** Validates a current version file and points the mesh arrays into it. The mesh keeps the file open while loaded. */
+static bool LoadInPlace(ResourceMesh* res, MappedFile* file)
+{
+	char* data = file->GetData();
+	uint size = file->GetSize();
+
+	MeshFileHeader header;
+	memcpy(&header, data, sizeof(header));
 
-		//Normals
-		if (ranges[2] > 0)
+	if (header.version != MESH_FILE_VERSION)
+	{
+		_LOG(LOG_ERROR, "Mesh file [%s] has the unknown version %u.", res->GetExportedFile(), header.version);
+		return false;
+	}
+
+	if ((uint64)sizeof(header) + header.dataSize > size)
+	{
+		_LOG(LOG_ERROR, "Mesh file [%s] is truncated.", res->GetExportedFile());
+		return false;
+	}
+
+	uint64 sizes[MESH_SECTION_COUNT];
+	GetSectionSizes(header.numIndices, header.numVertices, sizes);
+
+	if (sizes[MESH_SECTION_INDICES] + sizes[MESH_SECTION_VERTICES] > header.dataSize)
+	{
+		_LOG(LOG_ERROR, "Mesh file [%s] has more indices or vertices than data.", res->GetExportedFile());
+		return false;
+	}
+
+	for (uint i = 0; i < MESH_SECTION_COUNT; ++i)
+	{
+		uint offset = header.offsets[i];
+		bool required = (i == MESH_SECTION_INDICES || i == MESH_SECTION_VERTICES || i == MESH_SECTION_AABB);
+		if ((offset == 0 && required) || (offset != 0 && (offset % MESH_FILE_ALIGNMENT != 0 || offset < sizeof(header)
+			|| (uint64)offset + sizes[i] > sizeof(header) + (uint64)header.dataSize)))
 		{
-			cursor += bytes;
-			bytes = sizeof(float) * res->numVertices * 3;
-			res->normals = new float[res->numVertices * 3];
-			memcpy(res->normals, cursor, bytes);
+			_LOG(LOG_ERROR, "Mesh file [%s] has a bad section table.", res->GetExportedFile());
+			return false;
 		}
+	}
+
+	if (XXHash32(data + sizeof(header), header.dataSize) != header.checksum)
+	{
+		_LOG(LOG_ERROR, "Mesh file [%s] is corrupted, the checksum does not match.", res->GetExportedFile());
+		return false;
+	}
+
+	res->vertexFormat = header.vertexFormat;
+	res->numIndices = header.numIndices;
+	res->numVertices = header.numVertices;
+
+	res->indices = (uint*)(data + header.offsets[MESH_SECTION_INDICES]);
+	res->vertices = (float*)(data + header.offsets[MESH_SECTION_VERTICES]);
+	if (header.offsets[MESH_SECTION_NORMALS]) res->normals = (float*)(data + header.offsets[MESH_SECTION_NORMALS]);
+	if (header.offsets[MESH_SECTION_COLORS]) res->colors = (float*)(data + header.offsets[MESH_SECTION_COLORS]);
+	if (header.offsets[MESH_SECTION_UVS]) res->uvs = (float*)(data + header.offsets[MESH_SECTION_UVS]);
+	memcpy(&res->aabb, data + header.offsets[MESH_SECTION_AABB], sizeof(AABB));
+
+	res->mappedFile = file;
 
-		//Colors
-		if (ranges[3] > 0)
+	return true;
+}
+
+/** ImporterMesh - LoadResource: Reads and uploads the mesh right away. */
+bool ImporterMesh::LoadResource(Resource * resource)
+{
+	MEMORY_TAG(MEM_MESHES);
+	if(!resource || resource->GetType() != RES_MESH || resource->exportedFile.Empty())
+		return false;
+
+	ResourceMesh* res = (ResourceMesh*)resource;
+
+	MeshLoadData load;
+	bool ret = ReadResource(res->exportedFile, load);
+
+	return UploadResource(res, load, ret);
+}
+
+/** ImporterMesh - ReadResource: Maps the exported file and packs the vertex buffers into the load data. Current version files are used
+								 in place, older ones are copied. Touches no GL nor shared state, so it can run on a worker thread. */
+bool ImporterMesh::ReadResource(const Path & exportedFile, MeshLoadData & load)
+{
+	MEMORY_TAG(MEM_MESHES);
+	bool ret = false;
+
+	ResourceMesh* res = &load.mesh;
+	res->exportedFile = exportedFile;
+
+	MappedFile* file = new MappedFile();
+	if (file->Open(exportedFile.GetFullPath(), &load.stats))
+	{
+		const char* data = file->GetData();
+		MeshFileHeader header;
+
+		if (file->GetSize() >= sizeof(header) && memcmp(data, MESH_FILE_MAGIC, sizeof(header.magic)) == 0
+			&& ((const MeshFileHeaderV1*)data)->version >= MESH_FILE_VERSION)
 		{
-			cursor += bytes;
-			bytes = sizeof(float) * res->numVertices * 3;
-			res->colors = new float[res->numVertices * 3];
-			memcpy(res->colors, cursor, bytes);
+			ret = LoadInPlace(res, file);
+			if (ret)
+				file = nullptr; //Owned by the mesh now
 		}
-
-		//UVs
-		if (ranges[4] > 0)
+		else
 		{
-			cursor += bytes;
-			bytes = sizeof(float) * res->numVertices * 2;
-			res->uvs = new float[res->numVertices * 2];
-			memcpy(res->uvs, cursor, bytes);
+			ret = LoadCopy(res, data, file->GetSize());
 		}
 
-		//AABB
-		cursor += bytes;
-		bytes = sizeof(AABB);
-		memcpy(&res->aabb, cursor, bytes);
+		if (ret)
+			BuildBuffers(res, load.buffers);
+	}
+	else
+	{
+		_LOG(LOG_ERROR, "Could not open the mesh file [%s].", exportedFile.GetFile());
+	}
 
+	RELEASE(file);
 
-		ret = true;
+	return ret;
+}
 
-		GenBuffers(res);
+/** ImporterMesh - UploadResource: Moves the data read into the mesh and uploads it. If the read failed only frees the load data. Main thread only. */
+bool ImporterMesh::UploadResource(ResourceMesh * res, MeshLoadData & load, bool read)
+{
+	compressionStats.decodedBytes += load.stats.decodedBytes;
+	compressionStats.decodeMs += load.stats.decodeMs;
+
+	if (!read || !res)
+	{
+		load.buffers.Clear();
+		load.mesh.RemoveFromMemory();
+		return false;
 	}
 
-	RELEASE_ARRAY(buffer);
+	res->TakeData(load.mesh);
+	UploadBuffers(res, load.buffers);
 
-	return ret;
+	return true;
 }
 
-void ImporterMesh::GenBuffers(const ResourceMesh * res)
+/** Converts a float into a 16 bit float, rounding to the nearest. */
+static unsigned short FloatToHalf(float value)
 {
-	if (res)
+	uint32 bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	uint32 sign = (bits >> 16) & 0x8000;
+	int exponent = (int)((bits >> 23) & 0xFF) - 127 + 15;
+	uint32 mantissa = bits & 0x7FFFFF;
+
+	if (((bits >> 23) & 0xFF) == 0xFF) //Inf or NaN
+		return (unsigned short)(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+
+	if (exponent >= 31) //Overflow
+		return (unsigned short)(sign | 0x7C00);
+
+	if (exponent <= 0) //Denormal or zero
 	{
-		if (res->vertices && res->indices)
-		{
-			glGenVertexArrays(1, &(GLuint)res->idContainer);
+		if (exponent < -10)
+			return (unsigned short)sign;
+
+		mantissa |= 0x800000;
+		uint32 shift = 14 - exponent;
+		uint32 half = mantissa >> shift;
+		if ((mantissa >> (shift - 1)) & 1) ++half;
+		return (unsigned short)(sign | half);
+	}
 
-			glGenBuffers(1, &(GLuint)res->idVertices);
-			glGenBuffers(1, &(GLuint)res->idIndices);
-			if (res->normals) glGenBuffers(1, &(GLuint)res->idNormals);
-			if (res->colors) glGenBuffers(1, &(GLuint)res->idColors);
-			if (res->uvs) glGenBuffers(1, &(GLuint)res->idUvs);
+	uint32 half = sign | (exponent << 10) | (mantissa >> 13);
+	if (mantissa & 0x1000) ++half; //The carry moves into the exponent properly
+	return (unsigned short)half;
+}
 
-			glBindVertexArray(res->idContainer);
+/** Packs a normal into a signed normalized 10:10:10:2 value. */
+static uint32 PackNormal(const float* normal)
+{
+	uint32 ret = 0;
+	for (uint i = 0; i < 3; ++i)
+	{
+		float v = normal[i] < -1.0f ? -1.0f : (normal[i] > 1.0f ? 1.0f : normal[i]);
+		int q = (int)floorf(v * 511.0f + 0.5f);
+		ret |= ((uint32)q & 0x3FF) << (i * 10);
+	}
+	return ret;
+}
 
-			//Vertices
-			glBindBuffer(GL_ARRAY_BUFFER, res->idVertices);
-			glBufferData(GL_ARRAY_BUFFER, sizeof(float) * res->numVertices * 3, res->vertices, GL_STATIC_DRAW);
+struct VertexAttribute
+{
+	GLuint location = 0;
+	GLint components = 0;
+	GLenum type = GL_FLOAT;
+	GLboolean normalized = GL_FALSE;
+	uint size = 0;
+	uint offset = 0;
+};
+
+/** Fills the attributes a vertex format uses for the data present and returns how many there are.
+	For interleaved formats the offsets are filled and stride is the vertex size, otherwise it is 0. */
+static uint GetAttributes(uint format, bool normals, bool uvs, bool colors, VertexAttribute* attributes, uint& stride)
+{
+	uint numAttributes = 0;
 
-			//Indices
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, res->idIndices);
-			glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint) * res->numIndices, res->indices, GL_STATIC_DRAW);
+	VertexAttribute& pos = attributes[numAttributes++];
+	pos.location = 0; pos.components = 3; pos.size = sizeof(float) * 3;
 
-			//Vertices
-			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, (GLvoid*)0);
-			glEnableVertexAttribArray(0);
+	if (normals)
+	{
+		VertexAttribute& attr = attributes[numAttributes++];
+		attr.location = 1;
+		if (format & VF_SNORM_NORMALS) { attr.components = 4; attr.type = GL_INT_2_10_10_10_REV; attr.normalized = GL_TRUE; attr.size = sizeof(uint32); }
+		else { attr.components = 3; attr.size = sizeof(float) * 3; }
+	}
 
+	if (uvs)
+	{
+		VertexAttribute& attr = attributes[numAttributes++];
+		attr.location = 2; attr.components = 2;
+		if (format & VF_HALF_UVS) { attr.type = GL_HALF_FLOAT; attr.size = sizeof(unsigned short) * 2; }
+		else { attr.size = sizeof(float) * 2; }
+	}
 
-			//Normals
-			if (res->idNormals > 0)
-			{
-				glBindBuffer(GL_ARRAY_BUFFER, res->idNormals);
-				glBufferData(GL_ARRAY_BUFFER, sizeof(float) * res->numVertices * 3, res->normals, GL_STATIC_DRAW);
+	if (colors)
+	{
+		VertexAttribute& attr = attributes[numAttributes++];
+		attr.location = 3;
+		if (format & VF_UNORM8_COLORS) { attr.components = 4; attr.type = GL_UNSIGNED_BYTE; attr.normalized = GL_TRUE; attr.size = sizeof(uchar) * 4; }
+		else { attr.components = 3; attr.size = sizeof(float) * 3; }
+	}
 
-				glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, (GLvoid*)0);
-				glEnableVertexAttribArray(1);
-			}
+	stride = 0;
+	if (format & VF_INTERLEAVED)
+	{
+		for (uint i = 0; i < numAttributes; ++i)
+		{
+			attributes[i].offset = stride;
+			stride += attributes[i].size;
+		}
+	}
 
-			//UVs
-			if (res->idUvs > 0)
-			{
-				glBindBuffer(GL_ARRAY_BUFFER, res->idUvs);
-				glBufferData(GL_ARRAY_BUFFER, sizeof(float) * res->numVertices * 2, res->uvs, GL_STATIC_DRAW);
+	return numAttributes;
+}
 
-				glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2, (GLvoid*)0);
-				glEnableVertexAttribArray(2);
+/** Writes the attribute of a vertex into dst using the mesh vertex format. */
+static void WriteAttribute(const ResourceMesh* res, GLuint location, uint vertex, char* dst)
+{
+	switch (location)
+	{
+	case 0:
+		memcpy(dst, &res->vertices[vertex * 3], sizeof(float) * 3);
+		break;
+	case 1:
+		if (res->vertexFormat & VF_SNORM_NORMALS)
+		{
+			uint32 packed = PackNormal(&res->normals[vertex * 3]);
+			memcpy(dst, &packed, sizeof(packed));
+		}
+		else
+		{
+			memcpy(dst, &res->normals[vertex * 3], sizeof(float) * 3);
+		}
+		break;
+	case 2:
+		if (res->vertexFormat & VF_HALF_UVS)
+		{
+			unsigned short uv[2] = { FloatToHalf(res->uvs[vertex * 2]), FloatToHalf(res->uvs[vertex * 2 + 1]) };
+			memcpy(dst, uv, sizeof(uv));
+		}
+		else
+		{
+			memcpy(dst, &res->uvs[vertex * 2], sizeof(float) * 2);
+		}
+		break;
+	case 3:
+		if (res->vertexFormat & VF_UNORM8_COLORS)
+		{
+			uchar color[4] = { 0, 0, 0, 255 };
+			for (uint i = 0; i < 3; ++i)
+			{
+				float c = res->colors[vertex * 3 + i];
+				color[i] = (uchar)((c <= 0.0f) ? 0 : (c >= 1.0f) ? 255 : (uint)(c * 255.0f + 0.5f));
 			}
+			memcpy(dst, color, sizeof(color));
+		}
+		else
+		{
+			memcpy(dst, &res->colors[vertex * 3], sizeof(float) * 3);
+		}
+		break;
+	}
+}
 
+/** ImporterMesh - GenBuffers: Uploads the mesh into VRAM following the mesh vertex format. Only the buffers are created here,
+							  the vertex array is set up by the render side with SetupVertexArray, as VAOs can't be shared between contexts. */
+void ImporterMesh::GenBuffers(ResourceMesh * res)
+{
+	if (res)
+	{
+		MeshBufferData buffers;
+		BuildBuffers(res, buffers);
+		UploadBuffers(res, buffers);
+	}
+}
 
-			//Colors
-			if (res->idColors> 0)
-			{
-				glBindBuffer(GL_ARRAY_BUFFER, res->idColors);
-				glBufferData(GL_ARRAY_BUFFER, sizeof(float) * res->numVertices * 3, res->colors, GL_STATIC_DRAW);
+/** ImporterMesh - BuildBuffers: Packs the mesh data into the buffers GenBuffers uploads. No GL calls, safe on any thread. */
+void ImporterMesh::BuildBuffers(const ResourceMesh * res, MeshBufferData & buffers)
+{
+	buffers.Clear();
 
-				glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, (GLvoid*)0);
-				glEnableVertexAttribArray(3);
-			}
+	if (!res || !res->vertices || !res->indices)
+		return;
 
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-			glBindBuffer(GL_ARRAY_BUFFER, 0);
-			glBindVertexArray(0);
+	VertexAttribute attributes[4];
+	uint stride = 0;
+	uint numAttributes = GetAttributes(res->vertexFormat, res->normals != nullptr, res->uvs != nullptr, res->colors != nullptr, attributes, stride);
 
+	//Vertices
+	if (stride > 0)
+	{
+		char* data = new char[stride * res->numVertices];
+		for (uint v = 0; v < res->numVertices; ++v)
+		{
+			for (uint i = 0; i < numAttributes; ++i)
+				WriteAttribute(res, attributes[i].location, v, data + v * stride + attributes[i].offset);
 		}
+
+		buffers.vertexData[0] = data;
+		buffers.vertexSizes[0] = stride * res->numVertices;
+	}
+	else
+	{
+		for (uint i = 0; i < numAttributes; ++i)
+		{
+			const VertexAttribute& attr = attributes[i];
+
+			char* data = new char[attr.size * res->numVertices];
+			for (uint v = 0; v < res->numVertices; ++v)
+				WriteAttribute(res, attr.location, v, data + v * attr.size);
+
+			buffers.vertexData[attr.location] = data;
+			buffers.vertexSizes[attr.location] = attr.size * res->numVertices;
+		}
+	}
+
+	//Indices
+	buffers.shortIndices = (res->vertexFormat & VF_SHORT_INDICES) && res->numVertices < 65536;
+	if (buffers.shortIndices)
+	{
+		unsigned short* indices = new unsigned short[res->numIndices];
+		for (uint i = 0; i < res->numIndices; ++i)
+			indices[i] = (unsigned short)res->indices[i];
+
+		buffers.shortIndexData = indices;
+		buffers.indexSize = sizeof(unsigned short) * res->numIndices;
+	}
+	else
+	{
+		buffers.indexSize = sizeof(uint) * res->numIndices;
 	}
+
+	buffers.valid = true;
 }
 
-UID ImporterMesh::SaveResource(ResourceMesh * res, Path& outputPath)
+/** ImporterMesh - UploadBuffers: Creates the GL buffers of the mesh from the packed data and frees it. Main thread only. */
+void ImporterMesh::UploadBuffers(ResourceMesh * res, MeshBufferData & buffers)
 {
-	//TODO: Save name?? But name is already saved into the resources file..
+	if (res && buffers.valid)
+	{
+		uint* ids[4] = { &res->idVertices, &res->idNormals, &res->idUvs, &res->idColors };
 
-	uint ranges[5] = {
-		res->numIndices,
-		res->numVertices,
-		(res->normals) ? res->numVertices : 0,
-		(res->colors) ? res->numVertices : 0,
-		(res->uvs) ? res->numVertices : 0
-	};
+		RenderBackend* backend = RenderBackend::Get();
 
-	uint size = sizeof(ranges) + sizeof(uint) * res->numIndices + sizeof(float) * res->numVertices * 3;
-	if (res->normals) size += sizeof(float) * res->numVertices * 3;
-	if (res->colors) size += sizeof(float) * res->numVertices * 3;
-	if (res->uvs) size += sizeof(float) * res->numVertices * 2;
-	size += sizeof(AABB);
+		//Binding the element buffer would modify the bound VAO
+		GLState::BindVertexArray(0);
 
-	//Allocate mem
-	char* data = new char[size];
-	char* cursor = data;
+		res->vramBytes = 0;
 
-	//Ranges 
-	uint bytes = sizeof(ranges);
-	memcpy(cursor, ranges, bytes);
+		for (uint i = 0; i < 4; ++i)
+		{
+			if (buffers.vertexData[i])
+			{
+				*ids[i] = backend->GenBuffer();
+				GLState::BindBuffer(GL_ARRAY_BUFFER, *ids[i]);
+				backend->BufferData(GL_ARRAY_BUFFER, buffers.vertexSizes[i], buffers.vertexData[i], GL_STATIC_DRAW);
+				res->vramBytes += buffers.vertexSizes[i];
+			}
+		}
 
-	//Indices
-	cursor += bytes;
-	bytes = sizeof(uint) * res->numIndices;
-	memcpy(cursor, res->indices, bytes);
+		res->shortIndices = buffers.shortIndices;
 
-	//Vertices
-	cursor += bytes;
-	bytes = sizeof(float) * res->numVertices * 3;
-	memcpy(cursor, res->vertices, bytes);
+		res->idIndices = backend->GenBuffer();
+		GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, res->idIndices);
+		backend->BufferData(GL_ELEMENT_ARRAY_BUFFER, buffers.indexSize, buffers.shortIndices ? (const void*)buffers.shortIndexData : (const void*)res->indices, GL_STATIC_DRAW);
+		res->vramBytes += buffers.indexSize;
+	}
 
-	//Normals
-	if (res->normals)
+	buffers.Clear();
+}
+
+/** ImporterMesh - SetupVertexArray: Points the attributes of the bound VAO to the mesh buffers. Attribute locations are
+									 0 position, 1 normal, 2 uv and 3 color, either interleaved in one buffer or each in its own. */
+void ImporterMesh::SetupVertexArray(const MeshDrawInfo & info)
+{
+	VertexAttribute attributes[4];
+	uint stride = 0;
+	uint numAttributes = GetAttributes(info.vertexFormat, info.normals, info.uvs, info.colors, attributes, stride);
+
+	const uint buffers[4] = { info.idVertices, info.idNormals, info.idUvs, info.idColors };
+
+	for (uint i = 0; i < numAttributes; ++i)
 	{
-		cursor += bytes;
-		memcpy(cursor, res->normals, bytes);
+		const VertexAttribute& attr = attributes[i];
+
+		if (stride > 0)
+		{
+			GLState::BindBuffer(GL_ARRAY_BUFFER, info.idVertices);
+			RenderBackend::Get()->VertexAttribute(attr.location, attr.components, attr.type, attr.normalized != 0, stride, attr.offset);
+		}
+		else
+		{
+			GLState::BindBuffer(GL_ARRAY_BUFFER, buffers[attr.location]);
+			RenderBackend::Get()->VertexAttribute(attr.location, attr.components, attr.type, attr.normalized != 0, attr.size, 0);
+		}
 	}
 
-	//Colors
-	if (res->colors)
+	GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, info.idIndices);
+}
+
+UID ImporterMesh::SaveResource(ResourceMesh * res, Path& outputPath, UID forceUID)
+{
+	//TODO: Save name?? But name is already saved into the resources file..
+
+	MeshFileHeader header;
+	memcpy(header.magic, MESH_FILE_MAGIC, sizeof(header.magic));
+	header.vertexFormat = res->vertexFormat;
+	header.numIndices = res->numIndices;
+	header.numVertices = res->numVertices;
+	memset(header.reserved, 0, sizeof(header.reserved));
+
+	const void* sections[MESH_SECTION_COUNT] = { res->indices, res->vertices, res->normals, res->colors, res->uvs, &res->aabb };
+	uint64 sizes[MESH_SECTION_COUNT];
+	GetSectionSizes(res->numIndices, res->numVertices, sizes);
+
+	//Every section starts aligned
+	uint size = sizeof(header);
+	for (uint i = 0; i < MESH_SECTION_COUNT; ++i)
 	{
-		cursor += bytes;
-		memcpy(cursor, res->colors, bytes);
+		header.offsets[i] = 0;
+		if (sections[i])
+		{
+			size = (size + MESH_FILE_ALIGNMENT - 1) & ~(MESH_FILE_ALIGNMENT - 1);
+			header.offsets[i] = size;
+			size += (uint)sizes[i];
+		}
 	}
+	header.dataSize = size - sizeof(header);
 
-	//UVs
-	if (res->uvs)
+	//Allocate mem, zeroed so the padding is too
+	char* data = new char[size];
+	memset(data, 0, size);
+
+	for (uint i = 0; i < MESH_SECTION_COUNT; ++i)
 	{
-		cursor += bytes;
-		bytes = sizeof(float) * res->numVertices * 2;
-		memcpy(cursor, res->uvs, bytes);
+		if (sections[i])
+			memcpy(data + header.offsets[i], sections[i], (size_t)sizes[i]);
 	}
 
-	//AABB
-	cursor += bytes;
-	bytes = sizeof(AABB);
-	memcpy(cursor, &res->aabb, bytes);
+	header.checksum = XXHash32(data + sizeof(header), header.dataSize);
+	memcpy(data, &header, sizeof(header));
+
+	//The arrays go through the shuffle filter, each up to the next section so the padding is not left alone
+	CompressionSection compressionSections[MESH_SECTION_COUNT];
+	uint numCompressionSections = 0;
+	for (uint i = 0; i < MESH_SECTION_COUNT; ++i)
+	{
+		if (sections[i] == nullptr)
+			continue;
+
+		uint end = size;
+		for (uint j = i + 1; j < MESH_SECTION_COUNT; ++j)
+		{
+			if (sections[j])
+			{
+				end = header.offsets[j];
+				break;
+			}
+		}
 
-	UID ret = app->resources->GetNewUID();
+		CompressionSection& section = compressionSections[numCompressionSections++];
+		section.offset = header.offsets[i];
+		section.size = end - header.offsets[i];
+		section.filter = i == MESH_SECTION_AABB ? FILTER_NONE : FILTER_SHUFFLE_DELTA;
+	}
+
+	UID ret = forceUID != 0 ? forceUID : app->resources->GetNewUID();
 	outputPath.Set(MESH_SAVE_PATH, std::to_string(ret).c_str(), MESH_EXTENSION);
 
-	if (app->fs->Save(outputPath.GetFullPath(), data, size) != size)
+	CompressionStats stats;
+	if (Compression::SaveFile(outputPath.GetFullPath(), data, size, compressionLevel, compressionSections, numCompressionSections, &stats))
+	{
+		AddSaveStats(outputPath.GetFullPath(), stats);
+	}
+	else
 	{
 		_LOG(LOG_ERROR, "ERRRO: Saving mesh!!");
 		ret = 0;
@@ -310,6 +711,7 @@ UID ImporterMesh::SaveResource(ResourceMesh * res, Path& outputPath)
 
 bool ImporterMesh::LoadCube(ResourceMesh * res)
 {
+	MEMORY_TAG(MEM_MESHES);
 	if (!res)return false;
 
 	res->originalFile.SetFileName("*Cube*");
@@ -420,6 +822,7 @@ bool ImporterMesh::LoadCube(ResourceMesh * res)
 
 	//-----------------------
 
+	res->vertexFormat = vertexFormat;
 	GenBuffers(res);
 
 	return true;
@@ -427,6 +830,7 @@ bool ImporterMesh::LoadCube(ResourceMesh * res)
 
 bool ImporterMesh::LoadQuad(ResourceMesh * res)
 {
+	MEMORY_TAG(MEM_MESHES);
 	if (!res) return false;
 
 	res->originalFile.SetFileName("*Quad*");
@@ -488,6 +892,7 @@ bool ImporterMesh::LoadQuad(ResourceMesh * res)
 
 	//-----------------------
 
+	res->vertexFormat = vertexFormat;
 	GenBuffers(res);
 
 	return true;
@@ -496,6 +901,7 @@ bool ImporterMesh::LoadQuad(ResourceMesh * res)
 //TODO: Fix
 bool ImporterMesh::LoadPlane(ResourceMesh * res)
 {
+	MEMORY_TAG(MEM_MESHES);
 	if (!res) return false;
 
 	res->originalFile.SetFileName("*Plane*");
@@ -583,6 +989,7 @@ bool ImporterMesh::LoadPlane(ResourceMesh * res)
 
 	//-----------------------
 
+	res->vertexFormat = vertexFormat;
 	GenBuffers(res);
 
 	return true;
@@ -591,6 +998,7 @@ bool ImporterMesh::LoadPlane(ResourceMesh * res)
 //TODO: Actually do it
 bool ImporterMesh::LoadCone(ResourceMesh * res)
 {
+	MEMORY_TAG(MEM_MESHES);
 	if (!res) return false;
 
 	res->originalFile.SetFileName("*Cone*");
@@ -603,6 +1011,7 @@ bool ImporterMesh::LoadCone(ResourceMesh * res)
 //TODO: Actually do it
 bool ImporterMesh::LoadCylinder(ResourceMesh * res)
 {
+	MEMORY_TAG(MEM_MESHES);
 	if (!res) return false;
 
 	res->originalFile.SetFileName("*Cylinder*");
@@ -615,6 +1024,7 @@ bool ImporterMesh::LoadCylinder(ResourceMesh * res)
 //TODO: Actually do it
 bool ImporterMesh::LoadTorus(ResourceMesh * res)
 {
+	MEMORY_TAG(MEM_MESHES);
 	if (!res) return false;
 
 	res->originalFile.SetFileName("*Torus*");
@@ -627,6 +1037,7 @@ bool ImporterMesh::LoadTorus(ResourceMesh * res)
 //TODO: Actually do it
 bool ImporterMesh::LoadSphere(ResourceMesh * res)
 {
+	MEMORY_TAG(MEM_MESHES);
 	if (!res) return false;
 
 	res->originalFile.SetFileName("*Sphere*");
@@ -3,11 +3,101 @@
 
 #include "Importer.h"
 #include "Globals.h"
+#include "ResourceMesh.h"
 #include <string>
 
 struct aiMesh;
+struct MeshDrawInfo;
 
-class ResourceMesh;
+#define MESH_FILE_MAGIC "GGME"
+#define MESH_FILE_VERSION 2
+#define MESH_FILE_ALIGNMENT 16
+
+/** Header of the version 1 files, the sections follow it packed. Files without any header are the old format and load
+	with the legacy vertex layout. Both are copied into the mesh arrays when loaded. */
+struct MeshFileHeaderV1
+{
+	char magic[4];
+	uint version = 1;
+	uint vertexFormat = 0;
+	uint ranges[5]; //Indices, vertices, normals, colors, uvs
+};
+
+enum MeshFileSection
+{
+	MESH_SECTION_INDICES,
+	MESH_SECTION_VERTICES,
+	MESH_SECTION_NORMALS,
+	MESH_SECTION_COLORS,
+	MESH_SECTION_UVS,
+	MESH_SECTION_AABB,
+	MESH_SECTION_COUNT
+};
+
+/** Header at the start of the mesh files. Every section starts at an offset multiple of MESH_FILE_ALIGNMENT, so the mesh
+	arrays point straight into the mapped file. The checksum is the xxHash32 of everything after the header. */
+struct MeshFileHeader
+{
+	char magic[4];
+	uint version = MESH_FILE_VERSION;
+	uint vertexFormat = 0;
+	uint numIndices = 0;
+	uint numVertices = 0;
+	uint offsets[MESH_SECTION_COUNT]; //From the start of the file, 0 for the missing sections.
+	uint dataSize = 0;				  //Bytes after the header.
+	uint checksum = 0;
+	uint reserved[3];
+};
+
+/** Vertex and index data of a mesh packed with its vertex format, ready for the GL buffers. Separate attributes are
+	indexed by their location, interleaved formats only use the first. */
+struct MeshBufferData
+{
+	char* vertexData[4] = { nullptr, nullptr, nullptr, nullptr };
+	uint vertexSizes[4] = { 0, 0, 0, 0 };
+
+	unsigned short* shortIndexData = nullptr; //Converted indices, the 32 bit ones are uploaded from the mesh.
+	uint indexSize = 0;
+	bool shortIndices = false;
+
+	bool valid = false;
+
+	MeshBufferData()
+	{}
+
+	~MeshBufferData()
+	{
+		Clear();
+	}
+
+	void Clear()
+	{
+		for (uint i = 0; i < 4; ++i)
+		{
+			RELEASE_ARRAY(vertexData[i]);
+			vertexSizes[i] = 0;
+		}
+		RELEASE_ARRAY(shortIndexData);
+		indexSize = 0;
+		shortIndices = false;
+		valid = false;
+	}
+
+private:
+	MeshBufferData(const MeshBufferData&);
+	MeshBufferData& operator=(const MeshBufferData&);
+};
+
+/** Mesh read on a worker thread, waiting to be moved into its resource and uploaded on the main thread. */
+struct MeshLoadData
+{
+	ResourceMesh mesh;
+	MeshBufferData buffers;
+	CompressionStats stats;
+
+	MeshLoadData() : mesh(0)
+	{}
+};
 
 class ImporterMesh : public Importer
 {
@@ -15,12 +105,18 @@ public:
 	ImporterMesh();
 	virtual ~ImporterMesh();
 
-	bool ImportMesh(const aiMesh* mesh, Path& output, UID& id);
+	bool ImportMesh(const aiMesh* mesh, Path& output, UID& id, UID forceUID = 0);
 
 	bool LoadResource(Resource* resource)override;
-	void GenBuffers(const ResourceMesh* res);
+	bool ReadResource(const Path& exportedFile, MeshLoadData& load);
+	bool UploadResource(ResourceMesh* res, MeshLoadData& load, bool read);
 
-	UID SaveResource(ResourceMesh* res, Path& outputPath);
+	void GenBuffers(ResourceMesh* res);
+	void BuildBuffers(const ResourceMesh* res, MeshBufferData& buffers);
+	void UploadBuffers(ResourceMesh* res, MeshBufferData& buffers);
+	static void SetupVertexArray(const MeshDrawInfo& info);
+
+	UID SaveResource(ResourceMesh* res, Path& outputPath, UID forceUID = 0);
 
 
 	bool LoadCube(ResourceMesh* res);
@@ -30,6 +126,9 @@ public:
 	bool LoadCylinder(ResourceMesh* res);
 	bool LoadTorus(ResourceMesh* res);
 	bool LoadSphere(ResourceMesh* res);
+
+public:
+	uint vertexFormat; //VertexFormatFlags used for the new imported meshes.
 };
 
 #endif // !__IMPORTER_MESH_H__
\ No newline at end of file
@@ -17,6 +17,9 @@
 #include "ResourceTexture.h"
 #include "ResourceScene.h"
 
+#include "ImporterMesh.h"
+#include "JobSystem.h"
+
 #include <cimport.h>
 #include <scene.h>
 #include <postprocess.h>
@@ -219,11 +222,36 @@ void ImporterScene::RecImport(const aiScene * scene, const aiNode * node, GameOb
 void ImporterScene::ImportMeshes(const aiScene* scene, Path& file, JsonFile& metaFile)
 {
 	meshesImported.clear();
-	
-	for(int i = 0; i < scene->mNumMeshes; ++i)
+
+	uint numMeshes = scene->mNumMeshes;
+
+	//UIDs taken first and in order, the import gives the same ids no matter how the workers run
+	std::vector<UID> uids;
+	app->resources->ReserveUIDs(numMeshes, uids);
+
+	std::vector<Path> outputs(numMeshes);
+	std::vector<UID> ids(numMeshes, 0);
+	std::vector<char> succeeded(numMeshes, 0);
+
+	ImporterMesh* importer = app->resources->meshImporter;
+	JobSystem::ParallelFor(numMeshes, [&](uint i)
 	{
-		aiMesh* mesh = scene->mMeshes[i];
-		if(mesh) meshesImported.push_back(app->resources->ImportBuf(mesh, RES_MESH, 0, &file));
+		succeeded[i] = importer->ImportMesh(scene->mMeshes[i], outputs[i], ids[i], uids[i]) ? 1 : 0;
+	});
+
+	//Resources added on this thread and in mesh order. Failed meshes keep their slot with 0 so the nodes index them right
+	for (uint i = 0; i < numMeshes; ++i)
+	{
+		if (succeeded[i] && ids[i] != 0)
+		{
+			app->resources->AddImportedResource(RES_MESH, ids[i], outputs[i], &file);
+			meshesImported.push_back(ids[i]);
+		}
+		else
+		{
+			_LOG(LOG_WARN, "Could not import the mesh %u of %s.", i, file.GetFullPath());
+			meshesImported.push_back(0);
+		}
 	}
 
 	metaFile.AddUIntArray("meshes_ids", meshesImported.data(), meshesImported.size());
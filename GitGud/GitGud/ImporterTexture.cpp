@@ -4,11 +4,22 @@
 #include "M_FileSystem.h"
 #include "M_ResourceManager.h"
 #include "ResourceTexture.h"
+#include "GLState.h"
+#include "RenderBackend.h"
+#include "MemoryTracker.h"
+#include "MappedFile.h"
 
 #include <il.h>
 #include <ilu.h>
 #include <ilut.h>
 
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include <string.h>
+
+static std::mutex devilMutex; //DevIL keeps the bound image as global state.
+
 
 ImporterTexture::ImporterTexture()
 {
@@ -31,8 +42,10 @@ ImporterTexture::~ImporterTexture()
 	ilShutDown();
 }
 
+/** ImporterTexture - Import: Imports the image file. Files named as normal maps (_n, _nm, _nrm, _normal) are imported as such. */
 bool ImporterTexture::Import(Path originalFile, Path & exportedFile, UID & resUID)
 {
+	MEMORY_TAG(MEM_TEXTURES);
 	bool ret = false;
 
 	if (originalFile.Empty()) return ret;
@@ -41,7 +54,7 @@ bool ImporterTexture::Import(Path originalFile, Path & exportedFile, UID & resUI
 	uint size = app->fs->Load(originalFile.GetFullPath(), &buffer);
 
 	if (buffer && size > 0)
-		ret = ImportBuff(buffer, size, exportedFile, resUID);
+		ret = ImportBuff(buffer, size, exportedFile, resUID, GetUsageFromName(originalFile.GetFileName()));
 
 	RELEASE_ARRAY(buffer);
 
@@ -51,132 +64,336 @@ bool ImporterTexture::Import(Path originalFile, Path & exportedFile, UID & resUI
 	return ret;
 }
 
-bool ImporterTexture::ImportBuff(const void* buffer, uint size, Path& exportedFile, UID& resUID)
+/** ImporterTexture - ImportBuff: Decodes the image and saves it as a DDS file with the full mip chain. */
+bool ImporterTexture::ImportBuff(const void* buffer, uint size, Path& exportedFile, UID& resUID, TextureUsage usage)
 {
-	bool ret = false;
+	MEMORY_TAG(MEM_TEXTURES);
+
+	uint width = 0;
+	uint height = 0;
+	std::vector<uchar> pixels;
+
+	if (!DecodeImage(buffer, size, width, height, pixels))
+	{
+		_LOG(LOG_WARN, "Devil could not decode the texture.");
+		return false;
+	}
+
+	return SaveCompressed(pixels, width, height, usage, DDS_MAX_LEVELS, exportedFile, resUID);
+}
+
+/** ImporterTexture - DecodeImage: Decodes any image DevIL reads into RGBA8 pixels, rows from the bottom like GL takes them and the
+								  mesh UVs expect. Only holds DevIL for the decode. */
+bool ImporterTexture::DecodeImage(const void * buffer, uint size, uint & width, uint & height, std::vector<uchar>& pixels)
+{
+	width = 0;
+	height = 0;
+
+	std::lock_guard<std::mutex> lock(devilMutex);
 
-	/**First load the image */
-	//1-Gen the image and bind it
 	ILuint image;
 	ilGenImages(1, &image);
 	ilBindImage(image);
 
-	//2-Load the image from buffer
 	if (ilLoadL(IL_TYPE_UNKNOWN, buffer, size))
 	{
-		ilEnable(IL_FILE_OVERWRITE);
+		//Rows are stored bottom to top
+		if (ilGetInteger(IL_IMAGE_ORIGIN) == IL_ORIGIN_UPPER_LEFT)
+			iluFlipImage();
 
-		ILuint _size;
-		ILubyte* data = nullptr;
-
-		//3-Set format (DDS, DDS compression)
-		ilSetInteger(IL_DXTC_FORMAT, IL_DXT5);
-		//4-Get size
-		_size = ilSaveL(IL_DDS, nullptr, 0);
-		if (_size > 0)
+		if (ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE))
 		{
-			//5-If size is more than 0 create the image buffer
-			data = new ILubyte[_size];
+			width = ilGetInteger(IL_IMAGE_WIDTH);
+			height = ilGetInteger(IL_IMAGE_HEIGHT);
+			pixels.resize(width * height * 4);
+			if (width > 0 && height > 0)
+				ilCopyPixels(0, 0, 0, width, height, 1, IL_RGBA, IL_UNSIGNED_BYTE, pixels.data());
+		}
+	}
 
-			//6-Save the image with the correct format and save it with file system
-			if (ilSaveL(IL_DDS, data, _size) > 0)
+	ilDeleteImages(1, &image);
+
+	return width > 0 && height > 0;
+}
+
+/** ImporterTexture - SaveCompressed: Saves the RGBA8 pixels as a DDS file with up to maxLevels mips. The mips and the block
+									  compression run on the job system. The format comes from the usage: BC5 for normal maps,
+									  BC3 for color with alpha and BC1 for the rest. The pixels are used as scratch memory. */
+bool ImporterTexture::SaveCompressed(std::vector<uchar>& pixels, uint width, uint height, TextureUsage usage, uint maxLevels, Path & exportedFile, UID & resUID)
+{
+	MEMORY_TAG(MEM_TEXTURES);
+
+	PerfTimer timer;
+
+	DDSFormat format = DDS_BC1;
+	if (usage == TEX_USAGE_NORMAL)
+	{
+		format = DDS_BC5;
+	}
+	else
+	{
+		for (uint i = 3; i < pixels.size(); i += 4)
+		{
+			if (pixels[i] != 255)
 			{
-				//Save it FS
-				resUID = app->resources->GetNewUID();
-				exportedFile.Set(TEXTURE_SAVE_PATH, std::to_string(resUID).c_str(), TEXTURE_EXTENSION);
-
-				if (app->fs->Save(exportedFile.GetFullPath(), (const char*)data, _size) == _size)
-					ret = true;
-				else
-					_LOG(LOG_WARN, "Error importing texture.");
+				format = DDS_BC3;
+				break;
 			}
+		}
+	}
 
-			//7-Release the image buffer to avoid memory leaks
-			RELEASE_ARRAY(data);
+	uint numLevels = std::min(TextureCompression::GetNumLevels(width, height), std::min(maxLevels, (uint)DDS_MAX_LEVELS));
+	numLevels = std::max(numLevels, 1u);
+
+	uint fileSize = DDS_FILE_HEADER_SIZE;
+	for (uint i = 0, w = width, h = height; i < numLevels; ++i, w = std::max(1u, w / 2), h = std::max(1u, h / 2))
+		fileSize += TextureCompression::GetLevelSize(w, h, format);
+
+	std::vector<char> file(fileSize);
+	WriteDDSHeader(file.data(), format, width, height, numLevels);
+
+	//Each level is compressed and then halved into the next
+	std::vector<uchar> next;
+	uint offset = DDS_FILE_HEADER_SIZE;
+	for (uint i = 0, w = width, h = height; i < numLevels; ++i)
+	{
+		TextureCompression::CompressLevel(pixels.data(), w, h, format, quality, (uchar*)file.data() + offset);
+		offset += TextureCompression::GetLevelSize(w, h, format);
+
+		if (i + 1 < numLevels)
+		{
+			uint nextWidth = std::max(1u, w / 2);
+			uint nextHeight = std::max(1u, h / 2);
+			next.resize(nextWidth * nextHeight * 4);
+			TextureCompression::Downsample(pixels.data(), w, h, next.data(), quality, usage == TEX_USAGE_NORMAL);
+			pixels.swap(next);
+			w = nextWidth;
+			h = nextHeight;
 		}
+	}
 
-		//8-Finally if the image was loaded destroy the image to avoid more memory leaks
-		ilDeleteImages(1, &image);
+	bool ret = false;
+
+	resUID = app->resources->GetNewUID();
+	exportedFile.Set(TEXTURE_SAVE_PATH, std::to_string(resUID).c_str(), TEXTURE_EXTENSION);
+
+	CompressionStats stats;
+	if (Compression::SaveFile(exportedFile.GetFullPath(), file.data(), fileSize, compressionLevel, nullptr, 0, &stats))
+	{
+		AddSaveStats(exportedFile.GetFullPath(), stats);
+		ret = true;
+
+		static const char* formatNames[] = { "-", "BC1", "BC2", "BC3", "BC4", "BC5", "BC7" };
+		_LOG(LOG_INFO, "Texture %ux%u imported as %s with %u levels in %.2f ms.", width, height, formatNames[format], numLevels, timer.ReadMs());
+	}
+	else
+	{
+		_LOG(LOG_WARN, "Error importing texture.");
 	}
 
 	return ret;
 }
 
+/** ImporterTexture - GetUsageFromName: Normal map if the file name ends in _n, _nm, _nrm, _normal or _normals. */
+TextureUsage ImporterTexture::GetUsageFromName(const char * fileName)
+{
+	if (!fileName)
+		return TEX_USAGE_COLOR;
+
+	std::string name(fileName);
+	std::transform(name.begin(), name.end(), name.begin(), ::tolower);
 
+	static const char* suffixes[] = { "_n", "_nm", "_nrm", "_normal", "_normals" };
+	for (uint i = 0; i < sizeof(suffixes) / sizeof(suffixes[0]); ++i)
+	{
+		size_t length = strlen(suffixes[i]);
+		if (name.size() > length && name.compare(name.size() - length, length, suffixes[i]) == 0)
+			return TEX_USAGE_NORMAL;
+	}
+
+	return TEX_USAGE_COLOR;
+}
 
+/** ImporterTexture - LoadResource: Reads and uploads the texture right away. */
 bool ImporterTexture::LoadResource(Resource * resource)
 {
-	bool ret = false;
+	MEMORY_TAG(MEM_TEXTURES);
 
 	if (!resource || resource->GetType() != RES_TEXTURE || resource->exportedFile.Empty())
-		return ret;
+		return false;
 
 	ResourceTexture* res = (ResourceTexture*)resource;
 
-	char* data = nullptr;
-	uint size = app->fs->Load(res->GetExportedFileFullPath(), &data);
+	TextureLoadData load;
+	bool ret = ReadResource(res->exportedFile, load);
+
+	return UploadResource(res, load, ret);
+}
+
+/** ImporterTexture - ReadResource: Reads the exported file. Block compressed DDS files are only parsed and kept open for the upload,
+									the rest are decoded into a DevIL image. Can run on a worker thread, DevIL is only used under
+									its lock so the decodes are one at a time. */
+bool ImporterTexture::ReadResource(const Path & exportedFile, TextureLoadData & load)
+{
+	MEMORY_TAG(MEM_TEXTURES);
+
+	//Decompresses the compressed library files
+	MappedFile& file = load.file;
+	if (!file.Open(exportedFile.GetFullPath(), &load.stats) || file.GetSize() == 0)
+	{
+		_LOG(LOG_ERROR, "Could not load texture file [%s].", exportedFile.GetFile());
+		return false;
+	}
 
-	if (data && size > 0)
+	if (ParseDDS(file.GetData(), file.GetSize(), load.dds))
 	{
-		ILuint image = 0;
-		ilGenImages(1, &image);
-		ilBindImage(image);
+		if (load.dds.bottomUp)
+			return true;
 
-		if (ilLoadL(IL_DDS, (const void*)data, size))
+		//Top down files, written by other tools or before the engine stored the rows from the bottom
+		load.flipped.assign(file.GetData(), file.GetData() + file.GetSize());
+		if (FlipDDSRows(load.flipped.data(), load.dds))
 		{
-			ILinfo info;
-			iluGetImageInfo(&info);
+			file.Close();
+			return true;
+		}
 
-			res->width = info.Width;
-			res->height = info.Height;
-			res->bpp = info.Bpp;
-			res->depth = info.Depth;
-			res->mips = info.NumMips;
-			res->bytes = info.SizeOfData;
+		//Blocks that can't be flipped as they are, DevIL decodes them
+		load.flipped.clear();
+		load.dds = DDSImage();
+	}
 
-			switch (info.Format)
-			{
-			case IL_COLOUR_INDEX:
-				res->format = ResourceTexture::COLOR_INDEX;
-				break;
-			case IL_RGB:
-				res->format = ResourceTexture::RGB;
-				break;
-			case IL_RGBA:
-				res->format = ResourceTexture::RGBA;
-				break;
-			case IL_BGR:
-				res->format = ResourceTexture::BGR;
-				break;
-			case IL_BGRA:
-				res->format = ResourceTexture::BGRA;
-				break;
-			case IL_LUMINANCE:
-				res->format = ResourceTexture::LUMINANCE;
-				break;
-			default:
-				res->format = ResourceTexture::UNKNOWN;
-				break;
-			}
+	std::lock_guard<std::mutex> lock(devilMutex);
 
-			res->texID = ilutGLBindTexImage();
-			ilDeleteImages(1, &image);
+	ilGenImages(1, &load.image);
+	ilBindImage(load.image);
+
+	bool loaded = ilLoadL(IL_DDS, (const void*)file.GetData(), file.GetSize()) != IL_FALSE;
+	file.Close();
+
+	if (!loaded)
+	{
+		_LOG(LOG_ERROR, "Devil could not load the texture file [%s].", exportedFile.GetFile());
+		ilDeleteImages(1, &load.image);
+		load.image = 0;
+		return false;
+	}
+
+	return true;
+}
+
+/** ImporterTexture - UploadResource: Fills the texture from the compressed levels or the decoded image and uploads it. If the read
+									  failed only frees the load data. Main thread only. */
+bool ImporterTexture::UploadResource(ResourceTexture * res, TextureLoadData & load, bool read)
+{
+	MEMORY_TAG(MEM_TEXTURES);
+
+	compressionStats.decodedBytes += load.stats.decodedBytes;
+	compressionStats.decodeMs += load.stats.decodeMs;
+
+	if (load.dds.numLevels > 0)
+	{
+		const char* data = load.flipped.empty() ? load.file.GetData() : load.flipped.data();
+		bool ret = read && res && UploadCompressed(res, data, load.dds);
+		load.file.Close();
+		load.flipped.clear();
+		return ret;
+	}
+
+	if (load.image == 0)
+		return false;
 
-			ret = true;
+	bool ret = false;
+
+	std::lock_guard<std::mutex> lock(devilMutex);
+	ilBindImage(load.image);
+
+	if (read && res)
+	{
+		ILinfo info;
+		iluGetImageInfo(&info);
+
+		res->width = info.Width;
+		res->height = info.Height;
+		res->bpp = info.Bpp;
+		res->depth = info.Depth;
+		res->mips = info.NumMips;
+		res->bytes = info.SizeOfData; //Only the first level is uploaded
+
+		switch (info.Format)
+		{
+		case IL_COLOUR_INDEX:
+			res->format = ResourceTexture::COLOR_INDEX;
+			break;
+		case IL_RGB:
+			res->format = ResourceTexture::RGB;
+			break;
+		case IL_RGBA:
+			res->format = ResourceTexture::RGBA;
+			break;
+		case IL_BGR:
+			res->format = ResourceTexture::BGR;
+			break;
+		case IL_BGRA:
+			res->format = ResourceTexture::BGRA;
+			break;
+		case IL_LUMINANCE:
+			res->format = ResourceTexture::LUMINANCE;
+			break;
+		default:
+			res->format = ResourceTexture::UNKNOWN;
+			break;
 		}
-		else
+
+		if (!app->IsHeadless())
 		{
-			_LOG(LOG_ERROR, "Devil could not load the texture resource [%s] from file [%s].", res->GetResourceName(), res->GetExportedFile());
+			res->texID = ilutGLBindTexImage();
+			GLState::InvalidateTextures(); //DevIL binds the texture on its own
 		}
+
+		ret = true;
 	}
-	else
+
+	ilDeleteImages(1, &load.image);
+	load.image = 0;
+
+	return ret;
+}
+
+/** ImporterTexture - UploadCompressed: Uploads every level of a block compressed DDS file without decoding it. Main thread only. */
+bool ImporterTexture::UploadCompressed(ResourceTexture * res, const char * data, const DDSImage & dds)
+{
+	res->width = dds.width;
+	res->height = dds.height;
+	res->depth = 1;
+	res->bpp = 0; //Block compressed, less than a byte per pixel on BC1 and BC4
+	res->mips = dds.numLevels;
+	res->bytes = dds.dataSize;
+	res->format = (ResourceTexture::Format)(ResourceTexture::BC1 + (dds.format - DDS_BC1));
+
+	RenderBackend* backend = RenderBackend::Get();
+
+	uint texture = backend->GenTexture();
+	GLState::BindTexture(GL_TEXTURE_2D, texture);
+
+	backend->TexParameter(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	backend->TexParameter(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	backend->TexParameter(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	backend->TexParameter(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, dds.numLevels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+	backend->TexParameter(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, dds.numLevels - 1); //Chains that stop before 1x1 stay complete
+
+	uint glFormat = GetDDSFormatGL(dds.format);
+	for (uint i = 0; i < dds.numLevels; ++i)
 	{
-		_LOG(LOG_ERROR, "Could not load texture resource [%s] from file [%s].", res->GetResourceName(), res->GetExportedFile());
+		const DDSLevel& level = dds.levels[i];
+		backend->CompressedTexImage2D(GL_TEXTURE_2D, i, glFormat, level.width, level.height, level.size, data + level.offset);
 	}
 
-	RELEASE_ARRAY(data);
+	GLState::BindTexture(GL_TEXTURE_2D, 0);
 
-	return ret;
+	res->texID = texture;
+
+	return true;
 }
 
 #define CHECKERS_WIDHT 64
@@ -184,6 +401,7 @@ bool ImporterTexture::LoadResource(Resource * resource)
 
 bool ImporterTexture::LoadChequers(ResourceTexture * res)
 {
+	MEMORY_TAG(MEM_TEXTURES);
 	if (!res)return false;
 
 	res->originalFile.SetFileName("*checkers*");
@@ -205,18 +423,6 @@ bool ImporterTexture::LoadChequers(ResourceTexture * res)
 
 	uint imageName = 0;
 
-	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-
-	glGenTextures(1, &imageName);
-	glBindTexture(GL_TEXTURE_2D, imageName);
-
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, CHECKERS_WIDHT, CHECKERS_HEIGHT,
-		0, GL_RGBA, GL_UNSIGNED_BYTE, checkImage);
-
 	res->width = CHECKERS_WIDHT;
 	res->height = CHECKERS_HEIGHT;
 	res->bpp = 1;
@@ -224,9 +430,23 @@ bool ImporterTexture::LoadChequers(ResourceTexture * res)
 	res->mips = 0;
 	res->bytes = sizeof(GLubyte) * CHECKERS_WIDHT * CHECKERS_HEIGHT * 4;
 	res->format = ResourceTexture::RGBA;
+
+	RenderBackend* backend = RenderBackend::Get();
+
+	backend->PixelStore(GL_UNPACK_ALIGNMENT, 1);
+
+	imageName = backend->GenTexture();
+	GLState::BindTexture(GL_TEXTURE_2D, imageName);
+
+	backend->TexParameter(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	backend->TexParameter(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	backend->TexParameter(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	backend->TexParameter(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	backend->TexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, CHECKERS_WIDHT, CHECKERS_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, checkImage);
+
 	res->texID = imageName;
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLState::BindTexture(GL_TEXTURE_2D, 0);
 
 	return true;
 }
@@ -2,10 +2,32 @@
 #define __IMPORTER_TEXTURE_H__
 
 #include "Importer.h"
+#include "MappedFile.h"
+#include "DDS.h"
+#include "TextureCompression.h"
 #include <string>
+#include <vector>
 
 class ResourceTexture;
 
+/** What the texture is used for, picks the compressed format on import. */
+enum TextureUsage
+{
+	TEX_USAGE_COLOR = 0,	//BC1, BC3 if it has alpha.
+	TEX_USAGE_NORMAL		//BC5, two channels.
+};
+
+/** Texture read on a worker thread, waiting for its upload on the main thread. Block compressed DDS files are uploaded
+	straight from the file, any other goes through a DevIL image. */
+struct TextureLoadData
+{
+	MappedFile file;
+	DDSImage dds;				//With levels if the file is uploaded without decoding.
+	std::vector<char> flipped;	//Copy of a top down DDS file with its rows flipped, uploaded instead of the file.
+	uint image = 0; //DevIL image, 0 if not used or the read failed.
+	CompressionStats stats;
+};
+
 class ImporterTexture : public Importer
 {
 public:
@@ -13,11 +35,23 @@ public:
 	virtual ~ImporterTexture();
 
 	bool Import(Path originalFile, Path& exportedFile, UID& resUID);
-	bool ImportBuff(const void* buffer, uint size, Path& exportedFile, UID& resUID);
+	bool ImportBuff(const void* buffer, uint size, Path& exportedFile, UID& resUID, TextureUsage usage = TEX_USAGE_COLOR);
+	bool DecodeImage(const void* buffer, uint size, uint& width, uint& height, std::vector<uchar>& pixels);
+	bool SaveCompressed(std::vector<uchar>& pixels, uint width, uint height, TextureUsage usage, uint maxLevels, Path& exportedFile, UID& resUID);
 	
 	bool LoadResource(Resource* resource)override;
+	bool ReadResource(const Path& exportedFile, TextureLoadData& load);
+	bool UploadResource(ResourceTexture* res, TextureLoadData& load, bool read);
 
 	bool LoadChequers(ResourceTexture* res);
+
+	static TextureUsage GetUsageFromName(const char* fileName);
+
+public:
+	TextureQuality quality = TEX_QUALITY_NORMAL; //Of the mips and block compression on import.
+
+private:
+	bool UploadCompressed(ResourceTexture* res, const char* data, const DDSImage& dds);
 };
 
 #endif // !__IMPORTER_TEXTURE_H__
\ No newline at end of file
@@ -0,0 +1,177 @@
+#include "JobSystem.h"
+
+#include "Profiler.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <string>
+
+struct Job
+{
+	std::function<void()> function;
+	JobCounter* counter = nullptr;
+};
+
+struct JobQueue
+{
+	std::deque<Job> jobs;
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable condition;	//Jobs scheduled or quitting.
+	std::condition_variable finished;	//A job finished, for the waits with nothing to run.
+	bool quit = false;
+};
+
+static JobQueue queue;
+
+static void RunJob(Job& job)
+{
+	job.function();
+
+	if (job.counter && job.counter->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		//Taking the lock so a wait can't miss the notification between its check and its sleep
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.finished.notify_all();
+	}
+}
+
+static void WorkerLoop(uint index)
+{
+	PROFILE_THREAD(("Job worker " + std::to_string(index)).c_str());
+
+	while (true)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(queue.mutex);
+			queue.condition.wait(lock, []() { return queue.quit || !queue.jobs.empty(); });
+
+			if (queue.jobs.empty())
+				break; //Quitting with nothing left
+
+			job = std::move(queue.jobs.front());
+			queue.jobs.pop_front();
+		}
+
+		RunJob(job);
+	}
+}
+
+/** JobSystem - Start: Launches the workers. With 0 uses one per hardware thread but the main one. */
+void JobSystem::Start(uint workers)
+{
+	if (!queue.workers.empty())
+		return;
+
+	if (workers == 0)
+	{
+		uint hardware = std::thread::hardware_concurrency();
+		workers = hardware > 1 ? hardware - 1 : 0;
+	}
+
+	queue.quit = false;
+	for (uint i = 0; i < workers; ++i)
+		queue.workers.push_back(std::thread(WorkerLoop, i));
+
+	_LOG(LOG_INFO, "Job system: Started %u workers.", workers);
+}
+
+/** JobSystem - Stop: Runs the jobs left and joins the workers. */
+void JobSystem::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.quit = true;
+	}
+	queue.condition.notify_all();
+
+	for (std::vector<std::thread>::iterator it = queue.workers.begin(); it != queue.workers.end(); ++it)
+		if (it->joinable())
+			it->join();
+
+	queue.workers.clear();
+}
+
+uint JobSystem::GetWorkerCount()
+{
+	return queue.workers.size();
+}
+
+/** JobSystem - Schedule: Queues the job, the counter is increased now and decreased when it finishes. */
+void JobSystem::Schedule(const std::function<void()>& function, JobCounter * counter)
+{
+	Job job;
+	job.function = function;
+	job.counter = counter;
+
+	if (counter)
+		counter->pending.fetch_add(1, std::memory_order_relaxed);
+
+	if (queue.workers.empty())
+	{
+		RunJob(job);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back(std::move(job));
+	}
+	queue.condition.notify_one();
+}
+
+/** JobSystem - Wait: Blocks until the jobs of the counter have finished, running the queued ones meanwhile. Jobs of other counters are
+					  left to the workers, a wait on the main thread would stall the frame on them. */
+void JobSystem::Wait(JobCounter * counter)
+{
+	if (counter == nullptr)
+		return;
+
+	while (counter->pending.load(std::memory_order_acquire) > 0)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(queue.mutex);
+
+			std::deque<Job>::iterator it = queue.jobs.begin();
+			while (it != queue.jobs.end() && it->counter != counter)
+				++it;
+
+			if (it == queue.jobs.end())
+			{
+				//Every job left is running, woken when the last one finishes
+				queue.finished.wait(lock, [counter]() { return counter->pending.load(std::memory_order_acquire) == 0; });
+				continue;
+			}
+
+			job = std::move(*it);
+			queue.jobs.erase(it);
+		}
+
+		RunJob(job);
+	}
+}
+
+/** JobSystem - ParallelFor: Runs job(i) for every i below count across the workers and the calling thread, and waits. */
+void JobSystem::ParallelFor(uint count, const std::function<void(uint)>& job)
+{
+	if (count == 0)
+		return;
+
+	if (count == 1 || queue.workers.empty())
+	{
+		for (uint i = 0; i < count; ++i)
+			job(i);
+		return;
+	}
+
+	JobCounter counter;
+	for (uint i = 0; i < count; ++i)
+		Schedule([&job, i]() { job(i); }, &counter);
+
+	Wait(&counter);
+}
@@ -0,0 +1,37 @@
+#ifndef __JOB_SYSTEM_H__
+#define __JOB_SYSTEM_H__
+
+#include "Globals.h"
+#include <atomic>
+#include <functional>
+
+/** Jobs of a group still pending. Wait on it to know when all of them have finished. */
+struct JobCounter
+{
+	std::atomic<uint> pending;
+
+	JobCounter()
+	{
+		pending.store(0);
+	}
+};
+
+/**
+*	- Pool of worker threads running short jobs from a shared queue. Started by the app before the modules init.
+*	- Waiting threads run the queued jobs of the counter they wait on instead of sleeping, so waiting from a job or with few
+*	  workers can't deadlock. The jobs of other counters are left to the workers.
+*	- Without workers (not started, or a single core) jobs run right away on the thread scheduling them.
+*/
+class JobSystem
+{
+public:
+	static void Start(uint workers = 0);
+	static void Stop();
+	static uint GetWorkerCount();
+
+	static void Schedule(const std::function<void()>& job, JobCounter* counter = nullptr);
+	static void Wait(JobCounter* counter);
+	static void ParallelFor(uint count, const std::function<void(uint)>& job);
+};
+
+#endif // !__JOB_SYSTEM_H__
@@ -1,5 +1,7 @@
 #include "JsonFile.h"
 
+#include "MemoryTracker.h"
+
 
 
 JsonFile::JsonFile()
@@ -7,6 +9,7 @@ JsonFile::JsonFile()
 
 JsonFile::JsonFile(const char * buffer)
 {
+	MEMORY_TAG(MEM_JSON);
 	Json::Reader r;
 	r.parse(buffer, objRoot);
 }
@@ -275,7 +278,7 @@ void JsonFile::AddColor(const char* name, Color value)
 
 std::string JsonFile::Write(bool styled)
 {
-	
+	MEMORY_TAG(MEM_JSON);
 	std::string ret;
 	styled ? WriteStyled(ret) : WriteFast(ret);
 	return ret;
@@ -0,0 +1,319 @@
+#include "Logger.h"
+
+#include <SDL.h>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <string.h>
+
+#define LOG_WAIT_MS 10 //The log thread wakes up on its own after this, in case a notify was missed.
+
+/** Bounded lock-free queue (Vyukov): every cell keeps a sequence number telling if it is free or written for the current
+	lap, so producers and consumers only contend on their own position counter. Push and Pop work in place: Begin
+	reserves the cell and End publishes it. */
+template<typename T, uint SIZE>
+class LogRing
+{
+public:
+	LogRing()
+	{
+		for (uint i = 0; i < SIZE; ++i)
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+		enqueuePos.store(0, std::memory_order_relaxed);
+		dequeuePos.store(0, std::memory_order_relaxed);
+	}
+
+	T* BeginPush(size_t& ticket)
+	{
+		size_t pos = enqueuePos.load(std::memory_order_relaxed);
+		while (true)
+		{
+			Cell& cell = cells[pos & (SIZE - 1)];
+			size_t sequence = cell.sequence.load(std::memory_order_acquire);
+			intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+
+			if (diff == 0)
+			{
+				if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					ticket = pos;
+					return &cell.data;
+				}
+			}
+			else if (diff < 0)
+				return nullptr; //Full
+			else
+				pos = enqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+
+	void EndPush(size_t ticket)
+	{
+		cells[ticket & (SIZE - 1)].sequence.store(ticket + 1, std::memory_order_release);
+	}
+
+	T* BeginPop(size_t& ticket)
+	{
+		size_t pos = dequeuePos.load(std::memory_order_relaxed);
+		while (true)
+		{
+			Cell& cell = cells[pos & (SIZE - 1)];
+			size_t sequence = cell.sequence.load(std::memory_order_acquire);
+			intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+
+			if (diff == 0)
+			{
+				if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					ticket = pos;
+					return &cell.data;
+				}
+			}
+			else if (diff < 0)
+				return nullptr; //Empty
+			else
+				pos = dequeuePos.load(std::memory_order_relaxed);
+		}
+	}
+
+	void EndPop(size_t ticket)
+	{
+		cells[ticket & (SIZE - 1)].sequence.store(ticket + SIZE, std::memory_order_release);
+	}
+
+private:
+	struct Cell
+	{
+		std::atomic<size_t> sequence;
+		T data;
+	};
+
+	Cell cells[SIZE];
+	alignas(64) std::atomic<size_t> enqueuePos;
+	alignas(64) std::atomic<size_t> dequeuePos;
+};
+
+struct LogState
+{
+	LogRing<LogMessage, LOG_QUEUE_SIZE> messages;
+	LogRing<LogLine, LOG_CONSOLE_SIZE> lines;
+
+	std::atomic<uint> droppedMessages;
+	std::atomic<uint> droppedLines;
+	uint reportedMessages = 0;	//Only touched under the mutex.
+	uint reportedLines = 0;
+
+	std::atomic<bool> running;
+	bool quit = false;
+	std::thread thread;
+	std::mutex mutex;				//Guards quit and keeps the log thread and the synchronous writes apart.
+	std::condition_variable condition;
+
+	time_t lastTime = -1;
+	char timeStr[64];
+
+	LogState()
+	{
+		droppedMessages.store(0);
+		droppedLines.store(0);
+		running.store(false);
+		timeStr[0] = '\0';
+	}
+};
+
+//Function static so it is ready for the logs of other static constructors
+static LogState& GetState()
+{
+	static LogState state;
+	return state;
+}
+
+/** Formats the message into its final lines: stdout through SDL_Log and the console ring. */
+static void Write(LogState& s, const LogMessage& msg)
+{
+	//The calendar only changes once per second
+	if (msg.time != s.lastTime)
+	{
+		tm date;
+		localtime_s(&date, &msg.time);
+		snprintf(s.timeStr, sizeof(s.timeStr), "(%d-%d-%d %d:%d:%d)", date.tm_mday, date.tm_mon + 1, date.tm_year + 1900,
+			date.tm_hour, date.tm_min, date.tm_sec);
+		s.lastTime = msg.time;
+	}
+
+	SDL_Log("\n%s %s::%s(%d): %s", s.timeStr, GetLogTypeStr(msg.type), msg.file, msg.line, msg.text);
+
+	size_t ticket;
+	LogLine* line = s.lines.BeginPush(ticket);
+	if (line)
+	{
+		line->type = msg.type;
+		snprintf(line->text, LOG_LINE_SIZE, "%s %s::%s", s.timeStr, GetLogTypeStr(msg.type), msg.text);
+		s.lines.EndPush(ticket);
+	}
+	else
+	{
+		s.droppedLines.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+/** Writes everything queued and reports the drops once there is room for them. */
+static void Flush(LogState& s)
+{
+	size_t ticket;
+	while (LogMessage* msg = s.messages.BeginPop(ticket))
+	{
+		Write(s, *msg);
+		s.messages.EndPop(ticket);
+	}
+
+	uint dropped = s.droppedMessages.load(std::memory_order_relaxed);
+	if (dropped != s.reportedMessages)
+	{
+		LogMessage msg;
+		msg.type = LOG_WARN;
+		msg.file = __FILE__;
+		msg.line = __LINE__;
+		msg.time = time(nullptr);
+		snprintf(msg.text, LOG_MESSAGE_SIZE, "Log: %u messages dropped, the log queue was full.", dropped - s.reportedMessages);
+		Write(s, msg);
+		s.reportedMessages = dropped;
+	}
+
+	dropped = s.droppedLines.load(std::memory_order_relaxed);
+	if (dropped != s.reportedLines)
+	{
+		LogLine* line = s.lines.BeginPush(ticket);
+		if (line)
+		{
+			line->type = LOG_WARN;
+			snprintf(line->text, LOG_LINE_SIZE, "%s %s::Log: %u console lines dropped, see the output for them.", s.timeStr,
+				GetLogTypeStr(LOG_WARN), dropped - s.reportedLines);
+			s.lines.EndPush(ticket);
+			s.reportedLines = dropped;
+		}
+	}
+}
+
+static void Loop()
+{
+	LogState& s = GetState();
+
+	//Producers never take the lock while the thread runs, it only keeps the synchronous writes of Stop apart
+	std::unique_lock<std::mutex> lock(s.mutex);
+	while (!s.quit)
+	{
+		Flush(s);
+		s.condition.wait_for(lock, std::chrono::milliseconds(LOG_WAIT_MS));
+	}
+
+	Flush(s);
+}
+
+/** Logger - Start: Launches the log thread. Everything logged before is already written. */
+void Logger::Start()
+{
+	LogState& s = GetState();
+	if (s.running.load())
+		return;
+
+	s.quit = false;
+	s.running.store(true);
+	s.thread = std::thread(Loop);
+}
+
+/** Logger - Stop: Writes what is left in the queue and joins the log thread. */
+void Logger::Stop()
+{
+	LogState& s = GetState();
+	if (!s.running.load())
+		return;
+
+	s.running.store(false);
+	{
+		std::lock_guard<std::mutex> lock(s.mutex);
+		s.quit = true;
+	}
+	s.condition.notify_one();
+
+	if (s.thread.joinable())
+		s.thread.join();
+
+	//Messages pushed by threads that saw the logger running while it stopped
+	std::lock_guard<std::mutex> lock(s.mutex);
+	Flush(s);
+}
+
+/** Logger - Push: Formats the message text on the calling thread and leaves the rest to the log thread. */
+void Logger::Push(LogType type, const char * file, int line, const char * format, va_list args)
+{
+	LogState& s = GetState();
+
+	if (!s.running.load(std::memory_order_acquire))
+	{
+		LogMessage msg;
+		msg.type = type;
+		msg.file = file;
+		msg.line = line;
+		msg.time = time(nullptr);
+		vsnprintf(msg.text, LOG_MESSAGE_SIZE, format, args);
+
+		std::lock_guard<std::mutex> lock(s.mutex);
+		Write(s, msg);
+		return;
+	}
+
+	//Errors and commands wait for room, the rest is dropped when the queue is full
+	size_t ticket;
+	LogMessage* msg = s.messages.BeginPush(ticket);
+	while (msg == nullptr)
+	{
+		if (type < LOG_ERROR)
+		{
+			s.droppedMessages.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		s.condition.notify_one();
+		std::this_thread::yield();
+		msg = s.messages.BeginPush(ticket);
+	}
+
+	msg->type = type;
+	msg->file = file;
+	msg->line = line;
+	msg->time = time(nullptr);
+	vsnprintf(msg->text, LOG_MESSAGE_SIZE, format, args);
+	s.messages.EndPush(ticket);
+
+	s.condition.notify_one();
+}
+
+/** Logger - PopConsoleLine: Takes the oldest line for the console. Only the main thread pops them. */
+bool Logger::PopConsoleLine(LogLine & line)
+{
+	LogState& s = GetState();
+
+	size_t ticket;
+	LogLine* ret = s.lines.BeginPop(ticket);
+	if (ret == nullptr)
+		return false;
+
+	line.type = ret->type;
+	strcpy_s(line.text, LOG_LINE_SIZE, ret->text);
+	s.lines.EndPop(ticket);
+
+	return true;
+}
+
+uint Logger::GetDroppedMessages()
+{
+	return GetState().droppedMessages.load(std::memory_order_relaxed);
+}
+
+uint Logger::GetDroppedLines()
+{
+	return GetState().droppedLines.load(std::memory_order_relaxed);
+}
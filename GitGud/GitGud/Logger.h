@@ -0,0 +1,51 @@
+#ifndef __LOGGER_H__
+#define __LOGGER_H__
+
+#include "Globals.h"
+#include <stdarg.h>
+#include <time.h>
+
+#define LOG_QUEUE_SIZE 1024		//Messages waiting for the log thread, must be a power of two.
+#define LOG_CONSOLE_SIZE 1024	//Formatted lines waiting for the main thread, must be a power of two.
+#define LOG_MESSAGE_SIZE 4096	//As the old _log buffers, shader compile logs must fit.
+#define LOG_LINE_SIZE 4224		//The message and its timestamp and type.
+
+/** A message as the caller logged it. The text is formatted by the caller, the rest is left to the log thread. */
+struct LogMessage
+{
+	LogType type = LOG_INFO;
+	const char* file = nullptr;	//__FILE__, it outlives the queue.
+	int line = 0;
+	time_t time = 0;
+	char text[LOG_MESSAGE_SIZE];
+};
+
+/** A line ready for the editor console. */
+struct LogLine
+{
+	LogType type = LOG_INFO;
+	char text[LOG_LINE_SIZE];
+};
+
+/**
+*	- Asynchronous log pipeline. _LOG only formats its arguments into a slot of a lock-free bounded queue and returns,
+*	  any thread can log. The log thread builds the timestamp and the final lines, calls SDL_Log and pushes the console
+*	  line into a second bounded queue the main thread drains into the editor once per frame.
+*	- Both queues have a fixed size and never allocate: when a burst fills them the new messages are dropped and counted,
+*	  and the count is logged once there is room again. Errors and commands are never dropped, they wait for room.
+*	- Before Start and after Stop messages are written synchronously on the calling thread.
+*/
+class Logger
+{
+public:
+	static void Start();
+	static void Stop();
+
+	static void Push(LogType type, const char* file, int line, const char* format, va_list args);
+	static bool PopConsoleLine(LogLine& line);
+
+	static uint GetDroppedMessages();
+	static uint GetDroppedLines();
+};
+
+#endif // !__LOGGER_H__
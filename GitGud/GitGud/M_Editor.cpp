@@ -16,10 +16,12 @@
 #include "EdShaderEditor.h"
 #include "EdPlayMenu.h"
 #include "EdTimeDisplay.h"
+#include "EdProfiler.h"
 
 #include "GameObject.h"
 #include "Light.h"
 #include "M_GoManager.h"
+#include "MemoryTracker.h"
 
 #include <SDL.h>
 #include "imGui/imgui.h"
@@ -27,6 +29,17 @@
 
 #include <algorithm>
 
+//ImGui allocates with malloc, routed through the tracker so its memory shows under the editor tag
+static void* ImGuiAlloc(size_t size)
+{
+	return MemoryTracker::Alloc(size, MEM_EDITOR);
+}
+
+static void ImGuiFree(void* ptr)
+{
+	MemoryTracker::Free(ptr);
+}
+
 
 M_Editor::M_Editor(const char* name, bool startEnabled) : Module(name, startEnabled)
 {
@@ -45,6 +58,7 @@ M_Editor::M_Editor(const char* name, bool startEnabled) : Module(name, startEnab
 	timeDisplay = new EdTimeDisplay(false);
 	materialCreator = new EdMaterialCreator(false);
 	shaderEditor = new EdShaderEditor(false);
+	profiler = new EdProfiler(false);
 
 
 	editorWins.push_back(config); 
@@ -56,6 +70,7 @@ M_Editor::M_Editor(const char* name, bool startEnabled) : Module(name, startEnab
 	editorWins.push_back(timeDisplay);
 	editorWins.push_back(materialCreator);
 	editorWins.push_back(shaderEditor);
+	editorWins.push_back(profiler);
 
 	configuration = M_INIT | M_PRE_UPDATE | M_UPDATE | M_CLEAN_UP;
 }
@@ -76,7 +91,12 @@ bool M_Editor::Init(JsonFile* file)
 {
 	_LOG(LOG_INFO, "Editor: Init.");
 
+	//Must be set before ImGui allocates anything
+	ImGui::GetIO().MemAllocFn = ImGuiAlloc;
+	ImGui::GetIO().MemFreeFn = ImGuiFree;
+
 	ImGui_ImplSdlGL3_Init(app->win->GetWindow());
+	ImGui::GetIO().RenderDrawListsFn = NULL; //The renderer copies the draw data into its render packet and draws it from there
 
 	SetStyle((CONFIG_PATH + std::string("style.json")).c_str());
 
@@ -92,6 +112,7 @@ bool M_Editor::Start()
 
 UpdateReturn M_Editor::PreUpdate(float dt)
 {
+	MEMORY_TAG(MEM_EDITOR);
 	ImGui_ImplSdlGL3_NewFrame(app->win->GetWindow());
 
 	ImGuiIO& io = ImGui::GetIO();
@@ -103,6 +124,7 @@ UpdateReturn M_Editor::PreUpdate(float dt)
 
 UpdateReturn M_Editor::Update(float dt)
 {
+	MEMORY_TAG(MEM_EDITOR);
 
 	ImGui::BeginMainMenuBar();
 	{
@@ -125,6 +147,7 @@ UpdateReturn M_Editor::Update(float dt)
 			ImGui::MenuItem("Inspector", nullptr, &inspector->active);
 			ImGui::MenuItem("Resource", nullptr, &resources->active);
 			ImGui::MenuItem("Time", nullptr, &timeDisplay->active);
+			ImGui::MenuItem("Profiler", nullptr, &profiler->active);
 			ImGui::MenuItem("SetStyle", nullptr, &styleEditor);
 
 			ImGui::EndMenu();
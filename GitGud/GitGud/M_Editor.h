@@ -22,6 +22,7 @@ class EdResources;
 class EdShaderEditor;
 class EdPlayMenu;
 class EdTimeDisplay;
+class EdProfiler;
 
 enum FILE_DIALGUE_CBK
 {
@@ -74,6 +75,7 @@ public:
 	EdShaderEditor* shaderEditor = nullptr;
 	EdPlayMenu* playMenu = nullptr;
 	EdTimeDisplay* timeDisplay = nullptr;
+	EdProfiler* profiler = nullptr;
 
 
 private:
@@ -3,6 +3,7 @@
 #include "App.h"
 
 #include "Path.h"
+#include "MemoryTracker.h"
 
 #include "PhysFS\include\physfs.h"
 #include <SDL.h>
@@ -106,6 +107,32 @@ const char * M_FileSystem::GetBaseDir() const
 	return PHYSFS_getBaseDir();
 }
 
+/** M_FileSystem - GetRealPath: Path of the file on the OS, from the search path it is found on. For files inside an archive
+								 it will point into the archive, so opening it fails. */
+bool M_FileSystem::GetRealPath(const char * file, std::string & realPath) const
+{
+	const char* realDir = PHYSFS_getRealDir(file);
+	if (realDir == nullptr)
+		return false;
+
+	//Files under a mount point are relative to it on the real dir
+	const char* mountPoint = PHYSFS_getMountPoint(realDir);
+	if (mountPoint)
+	{
+		while (*mountPoint == '/') ++mountPoint;
+		size_t length = strlen(mountPoint);
+		if (length > 0 && strncmp(file, mountPoint, length) == 0)
+			file += length;
+	}
+
+	realPath.assign(realDir);
+	if (!realPath.empty() && realPath.back() != '/' && realPath.back() != '\\')
+		realPath.push_back('/');
+	realPath.append(file);
+
+	return true;
+}
+
 void M_FileSystem::DisplaySearchPaths() const
 {
 	for (char** i = PHYSFS_getSearchPath(); *i != NULL; ++i)
@@ -132,6 +159,7 @@ uint M_FileSystem::Load(const char * file, char ** buffer) const
 
 		if (size > 0)
 		{
+			MEMORY_TAG(MEM_FS_BUFFERS);
 			*buffer = new char[(uint)size];
 			PHYSFS_sint64 readed = PHYSFS_read(fsFile, *buffer, 1, (PHYSFS_sint32)size);
 			if (readed != size)
@@ -204,6 +232,35 @@ uint M_FileSystem::Save(const char * file, const void * buffer, uint size) const
 	return ret;
 }
 
+uint M_FileSystem::Append(const char * file, const void * buffer, uint size) const
+{
+	uint ret = 0;
+
+	PHYSFS_file* fsFile = PHYSFS_openAppend(file);
+
+	if (fsFile)
+	{
+		PHYSFS_sint64 written = PHYSFS_write(fsFile, (const void*)buffer, 1, size);
+		if (written != size)
+		{
+			_LOG(LOG_ERROR, "Error while appending to file %s: %s\n", file, PHYSFS_getLastError());
+		}
+		else
+		{
+			ret = (uint)written;
+		}
+
+		if (PHYSFS_close(fsFile) == 0)
+			_LOG(LOG_ERROR, "Error while closing file %s: %s\n", file, PHYSFS_getLastError());
+	}
+	else
+	{
+		_LOG(LOG_ERROR, "Error while opening file %s: %s\n", file, PHYSFS_getLastError());
+	}
+
+	return ret;
+}
+
 uint M_FileSystem::GetFilesOnDir(const char * dir, std::vector<std::string>& files)const
 {
 	uint ret = 0;
@@ -25,6 +25,7 @@ public:
 	const char* GetSaveDir()const { return "save/"; }
 
 	const char* GetBaseDir()const;
+	bool GetRealPath(const char* file, std::string& realPath)const;
 
 	void DisplaySearchPaths()const;
 	int GetSearchPaths(std::vector<std::string>& paths);
@@ -33,6 +34,7 @@ public:
 	SDL_RWops* Load(const char* file)const;
 
 	uint Save(const char* file, const void* buffer, uint size)const;
+	uint Append(const char* file, const void* buffer, uint size)const;
 
 	uint GetFilesOnDir(const char* dir, std::vector<std::string>& files)const;
 	uint GetFilesAndDirs(const char* dir, std::vector<std::string>& files, std::vector<std::string>& dirs)const;
@@ -5,8 +5,13 @@
 #include "JsonFile.h"
 
 #include "M_FileSystem.h"
+#include "M_Renderer.h"
 
 #include "GGOctree.h"
+#include "Profiler.h"
+#include "PerfTimer.h"
+#include "Replay.h"
+#include "MemoryTracker.h"
 
 #include "GameObject.h"
 #include "Component.h"
@@ -77,10 +82,23 @@ UpdateReturn M_GoManager::PreUpdate(float dt)
 
 	if (root)
 	{
+		transformMs = boxesMs = 0.f;
 		if (anyGOTransHasChanged)
 		{
-			root->RecCalcTransform(root->transform->GetLocalTransform());
-			root->RecCalcBoxes();
+			PerfTimer timer;
+			{
+				PROFILE_SCOPE("Transforms");
+				root->RecCalcTransform(root->transform->GetLocalTransform());
+			}
+			transformMs = (float)timer.ReadMs();
+
+			timer.Start();
+			{
+				PROFILE_SCOPE("Boxes");
+				root->RecCalcBoxes();
+			}
+			boxesMs = (float)timer.ReadMs();
+
 			anyGOTransHasChanged = false;
 		}
 
@@ -173,11 +191,13 @@ GameObject * M_GoManager::CreateGameObject(GameObject * parent)
 void M_GoManager::InsertToTree(GameObject * object)
 {
 	octree->Insert(object);
+	app->renderer->AddStaticObject(object);
 }
 
 void M_GoManager::EraseFromTree(GameObject * object)
 {
 	octree->Erase(object);
+	app->renderer->RemoveStaticObject(object);
 }
 
 void M_GoManager::AddDynObject(GameObject * obj)
@@ -212,12 +232,31 @@ void M_GoManager::FastRemoveGameObject(GameObject * obj)
 	}
 }
 
-void M_GoManager::GetToDrawStaticObjects(std::vector<GameObject*>& objects, Camera * cam)
+void M_GoManager::GetToDrawStaticObjects(FrameVector<GameObject*>& objects, Camera * cam)
 {
+	PROFILE_SCOPE("Octree culling");
+
 	if(cam)
 		octree->CollectCandidates(objects, cam->frustum);
 }
 
+float M_GoManager::GetOctreeSize() const
+{
+	return octreeSize;
+}
+
+/** M_GoManager - GetTransformMs: Time spent this frame recalculating the transforms, 0 if none changed. */
+float M_GoManager::GetTransformMs() const
+{
+	return transformMs;
+}
+
+/** M_GoManager - GetBoxesMs: Time spent this frame recalculating the bounding boxes, 0 if no transform changed. */
+float M_GoManager::GetBoxesMs() const
+{
+	return boxesMs;
+}
+
 std::list<GameObject*>* M_GoManager::GetDynamicObjects()
 {
 	return &dynamicGameObjects;
@@ -248,11 +287,13 @@ std::list<Light*>* M_GoManager::GetLightsList()
 void M_GoManager::SaveScene()
 {
 	mustSave = true;
+	app->replay->RecordEvent(REPLAY_EVENT_SAVE_SCENE);
 }
 
 void M_GoManager::LoadScene()
 {
 	mustLoad = true;
+	app->replay->RecordEvent(REPLAY_EVENT_LOAD_SCENE);
 }
 
 GameObject * M_GoManager::CastRay(const LineSegment & segment, float & distance) const
@@ -394,7 +435,9 @@ void M_GoManager::DoOnDrawDebug(GameObject* obj)
 
 void M_GoManager::RecursiveTestRay(const LineSegment & segment, float & distance, GameObject ** best)const
 {
-	std::map<float, GameObject*> objects;
+	FRAME_HEAP_CHECK();
+
+	FrameMap<float, GameObject*> objects;
 	octree->CollectIntersections(objects, segment);
 
 	for (const auto& it : dynamicGameObjects)
@@ -404,15 +447,13 @@ void M_GoManager::RecursiveTestRay(const LineSegment & segment, float & distance
 			objects[nearHit] = it;
 	}
 
-	for (std::map<float, GameObject*>::const_iterator it = objects.begin(); it != objects.end(); ++it)
+	for (FrameMap<float, GameObject*>::const_iterator it = objects.begin(); it != objects.end(); ++it)
 	{
 		GameObject* go = it->second;
-		std::vector<Component*> meshes;
-		go->GetComponents(CMP_MESH, meshes);
+		const Mesh* m = (const Mesh*)go->GetComponent(CMP_MESH);
 
-		if (meshes.size() > 0)
+		if (m)
 		{
-			const Mesh* m = (const Mesh*)meshes[0];
 			const ResourceMesh* r = (const ResourceMesh*)m->GetResource();
 
 			if (r)
@@ -445,7 +486,9 @@ void M_GoManager::RecursiveTestRay(const LineSegment & segment, float & distance
 
 void M_GoManager::RecursiveTestRay(const Ray & ray, float & distance, GameObject ** best) const
 {
-	std::map<float, GameObject*> objects;
+	FRAME_HEAP_CHECK();
+
+	FrameMap<float, GameObject*> objects;
 	octree->CollectIntersections(objects, ray);
 
 	for (const auto& it : dynamicGameObjects)
@@ -455,15 +498,13 @@ void M_GoManager::RecursiveTestRay(const Ray & ray, float & distance, GameObject
 			objects[nearHit] = it;
 	}
 
-	for (std::map<float, GameObject*>::const_iterator it = objects.begin(); it != objects.end(); ++it)
+	for (FrameMap<float, GameObject*>::const_iterator it = objects.begin(); it != objects.end(); ++it)
 	{
 		GameObject* go = it->second;
-		std::vector<Component*> meshes;
-		go->GetComponents(CMP_MESH, meshes);
+		const Mesh* m = (const Mesh*)go->GetComponent(CMP_MESH);
 
-		if (meshes.size() > 0)
+		if (m)
 		{
-			const Mesh* m = (const Mesh*)meshes[0];
 			const ResourceMesh* r = (const ResourceMesh*)m->GetResource();
 
 			if (r)
@@ -551,6 +592,7 @@ void M_GoManager::SaveSceneNow()
 
 void M_GoManager::LoadSceneNow()
 {
+	MEMORY_TAG(MEM_SCENE);
 	bool ret = false;
 
 	//TODO: Resource scene organitzation!!
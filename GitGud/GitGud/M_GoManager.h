@@ -3,6 +3,7 @@
 
 #include "Module.h"
 #include "Math.h"
+#include "FrameAllocator.h"
 #include <vector>
 #include <string>
 #include <map>
@@ -44,9 +45,13 @@ public:
 	void RemoveGameObject(GameObject* obj);
 	void FastRemoveGameObject(GameObject* obj);
 
-	void GetToDrawStaticObjects(std::vector<GameObject*>& objects, Camera* cam);
+	void GetToDrawStaticObjects(FrameVector<GameObject*>& objects, Camera* cam);
 	std::list<GameObject*>* GetDynamicObjects();
 
+	float GetOctreeSize()const;
+	float GetTransformMs()const;
+	float GetBoxesMs()const;
+
 	void AddLight(Light* l);
 	void RemoveLight(Light* l);
 	std::list<Light*>* GetLightsList();
@@ -90,6 +95,8 @@ public:
 
 private:
 	float octreeSize = 0.0f;
+	float transformMs = 0.f;
+	float boxesMs = 0.f;
 
 	bool mustSave = false, mustLoad = false;
 
@@ -4,11 +4,10 @@
 #include "M_Window.h"
 #include "M_Editor.h"
 #include "M_ResourceManager.h"
+#include "Replay.h"
 
 #include <SDL.h>
 
-#define MAX_KEYS 300
-
 M_Input::M_Input(const char* name, bool startEnabled) : Module(name, startEnabled)
 {
 	_LOG(LOG_INFO, "Input: Creation.");
@@ -44,17 +43,38 @@ bool M_Input::Init(JsonFile* file)
 	return ret;
 }
 
+/** M_Input - PreUpdate: Updates the key and button states from SDL, or from the replayed frame while replaying. Live events
+						 are still polled for the window, but only passed to the editor when not replaying. */
 UpdateReturn M_Input::PreUpdate(float dt)
 {
 	UpdateReturn ret = UPDT_CONTINUE;
 
 	SDL_PumpEvents();
 
-	const Uint8* keys = SDL_GetKeyboardState(nullptr);
+	const FrameInput* replayed = app->replay->GetReplayedInput();
+	FrameInput input;
+
+	if (replayed)
+	{
+		input = *replayed;
+	}
+	else
+	{
+		const Uint8* keys = SDL_GetKeyboardState(nullptr);
+		for (int i = 0; i < MAX_KEYS; ++i)
+		{
+			if (keys[i] == 1)
+				input.SetKeyPressed(i);
+		}
+
+		input.buttons = SDL_GetMouseState(&input.mouseX, &input.mouseY);
+		input.mouseX /= app->win->GetWinScale();
+		input.mouseY /= app->win->GetWinScale();
+	}
 
 	for (int i = 0; i < MAX_KEYS; ++i)
 	{
-		if (keys[i] == 1)
+		if (input.IsKeyPressed(i))
 		{
 			if (keyboard[i] == KEY_IDLE)
 				keyboard[i] = KEY_DOWN;
@@ -70,16 +90,9 @@ UpdateReturn M_Input::PreUpdate(float dt)
 		}
 	}
 
-	Uint32 buttons = SDL_GetMouseState(&mouseX, &mouseY);
-
-	mouseX /= app->win->GetWinScale();
-	mouseY /= app->win->GetWinScale();
-	wheelY = 0;
-	mouseMotionX = mouseMotionY = 0;
-
 	for (int i = 0; i < MAX_MOUSE_BUTTONS; ++i)
 	{
-		if (buttons & SDL_BUTTON(i))
+		if (input.buttons & SDL_BUTTON(i))
 		{
 			if (mouse[i] == KEY_IDLE)
 				mouse[i] = KEY_DOWN;
@@ -98,19 +111,24 @@ UpdateReturn M_Input::PreUpdate(float dt)
 	SDL_Event e;
 	while (SDL_PollEvent(&e))
 	{
-		app->editor->PassInput(&e);
+		if (!replayed)
+			app->editor->PassInput(&e);
 
 		switch (e.type)
 		{
 		case SDL_MOUSEWHEEL:
-			wheelY = e.wheel.y;
+			if (!replayed)
+				input.wheelY = e.wheel.y;
 			break;
 
 		case SDL_MOUSEMOTION:
-			mouseX = e.motion.x / app->win->GetWinScale();
-			mouseY = e.motion.y / app->win->GetWinScale();
-			mouseMotionX = e.motion.xrel / app->win->GetWinScale();
-			mouseMotionY = e.motion.yrel / app->win->GetWinScale();
+			if (!replayed)
+			{
+				input.mouseX = e.motion.x / app->win->GetWinScale();
+				input.mouseY = e.motion.y / app->win->GetWinScale();
+				input.mouseMotionX = e.motion.xrel / app->win->GetWinScale();
+				input.mouseMotionY = e.motion.yrel / app->win->GetWinScale();
+			}
 			break;
 
 		case SDL_QUIT:
@@ -147,6 +165,14 @@ UpdateReturn M_Input::PreUpdate(float dt)
 
 	SDL_PollEvent(&e);
 
+	mouseX = input.mouseX;
+	mouseY = input.mouseY;
+	mouseMotionX = input.mouseMotionX;
+	mouseMotionY = input.mouseMotionY;
+	wheelY = input.wheelY;
+
+	app->replay->RecordInput(input);
+
 	return ret;
 }
 
@@ -5,6 +5,8 @@
 #include "Module.h"
 
 #define MAX_MOUSE_BUTTONS 5
+#define MAX_KEYS 300
+#define INPUT_KEY_BYTES ((MAX_KEYS + 7) / 8)
 
 enum KEY_STATE
 {
@@ -14,6 +16,23 @@ enum KEY_STATE
 	KEY_UP
 };
 
+/** Raw input of a frame, before the key states are derived from it. Recorded and replayed by Replay. */
+struct FrameInput
+{
+	FrameInput() { memset(keys, 0, sizeof(keys)); }
+
+	bool IsKeyPressed(int id)const { return (keys[id >> 3] & (1 << (id & 7))) != 0; }
+	void SetKeyPressed(int id) { keys[id >> 3] |= (uchar)(1 << (id & 7)); }
+
+	uchar keys[INPUT_KEY_BYTES];
+	uint buttons = 0;
+	int mouseX = 0;
+	int mouseY = 0;
+	int mouseMotionX = 0;
+	int mouseMotionY = 0;
+	int wheelY = 0;
+};
+
 class M_Input : public Module
 {
 public:
@@ -16,23 +16,37 @@
 #include "ResourceShader.h"
 
 #include "DrawDebugTools.h"
+#include "StaticBatcher.h"
+#include "GLState.h"
+#include "RenderThread.h"
+#include "RenderPacket.h"
+#include "Profiler.h"
+#include "RecordingBackend.h"
+#include "PerfTimer.h"
+
+#include "imGui/imgui.h"
 
 //TMP
 #include "Math.h"
 
 #include "OpenGL.h"
 
+#include <algorithm>
+
 /*
  -opengl32.lib
  -glu32.lib
  -glew32.lib
 */
 
+//Static as the resources freed after the renderer cleanup still release their handles through it
+static RecordingBackend headlessBackend;
+
 M_Renderer::M_Renderer(const char* name, bool startEnabled) : Module(name, startEnabled)
 {
 	_LOG(LOG_INFO, "Renderer: Creation.");
 
-	configuration = M_INIT | M_START | M_PRE_UPDATE | M_POST_UPDATE | M_CLEAN_UP | M_SAVE_CONFIG | M_RESIZE_EVENT | M_DRAW_DEBUG;
+	configuration = M_INIT | M_START | M_POST_UPDATE | M_CLEAN_UP | M_SAVE_CONFIG | M_RESIZE_EVENT | M_DRAW_DEBUG;
 }
 
 
@@ -47,6 +61,27 @@ bool M_Renderer::Init(JsonFile* file)
 	bool ret = true;
 
 	vsync = file->GetBool("vsync", true);
+	staticBatching = file->GetBool("static_batching", true);
+	renderThreaded = file->GetBool("render_thread", false);
+
+	staticBatcher = new StaticBatcher();
+	renderThread = new RenderThread();
+
+	app->console->AddCommand(&cRenderStats);
+
+	//Null renderer: no context, GL goes to the recording backend. Packets are built and dropped, or executed against it with -record_gl.
+	if (app->IsHeadless())
+	{
+		recorder = &headlessBackend;
+		recorder->SetLogging(app->IsRecordingGL());
+		RenderBackend::Set(recorder);
+
+		_LOG(LOG_INFO, "Renderer: Headless, draw packets are %s.", app->IsRecordingGL() ? "recorded" : "built but not submitted");
+		context = nullptr;
+		renderThread->Start(nullptr, nullptr, false);
+		renderThread->SetHeadlessExecution(app->IsRecordingGL());
+		return true;
+	}
 
 	context = SDL_GL_CreateContext(app->win->GetWindow());
 	if (context == nullptr)
@@ -84,7 +119,7 @@ bool M_Renderer::Init(JsonFile* file)
 
 		glClearDepth(1.0f);
 
-		glClearColor(0.f, 0.f, 0.f, 1.f);
+		GLState::ClearColor(0.f, 0.f, 0.f, 1.f);
 
 		error = glGetError();
 		if (error != GL_NO_ERROR)
@@ -93,13 +128,28 @@ bool M_Renderer::Init(JsonFile* file)
 			ret = false;
 		}
 
-		glEnable(GL_DEPTH_TEST); // | GL_CULL_FACE);
+		GLState::SetCapability(GL_DEPTH_TEST, true); // | GL_CULL_FACE);
 		//glDepthFunc(GL_LESS);
 
-		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL); //GL_FILL | GL_LINE
+		GLState::PolygonMode(GL_FILL); //GL_FILL | GL_LINE
 
 		//TODO: Send event instead of direct resize
 		OnResize(app->win->GetWidth(), app->win->GetHeight());
+
+		if (renderThreaded && !CreateUploadContext())
+			renderThreaded = false;
+
+		if (!renderThread->Start(app->win->GetWindow(), context, renderThreaded))
+		{
+			_LOG(LOG_WARN, "Renderer: Render thread could not start, rendering from the main thread.");
+			SDL_GL_MakeCurrent(app->win->GetWindow(), context);
+			GLState::Invalidate();
+			SDL_GL_DeleteContext(uploadContext);
+			uploadContext = nullptr;
+
+			renderThreaded = false;
+			renderThread->Start(app->win->GetWindow(), context, false);
+		}
 	}
 
 	return ret;
@@ -117,38 +167,21 @@ bool M_Renderer::Start()
 	return true;
 }
 
-UpdateReturn M_Renderer::PreUpdate(float dt)
-{
-	Camera* cam = currentCamera ? currentCamera : app->camera->GetEditorCamera();
-	if (cam)
-	{
-		Color col = cam->GetBackground();
-		glClearColor(col.r, col.g, col.b, col.a);
-	}
-	else
-	{
-		glClearColor(0.f, 0.f, 0.f, 1.f);
-	}
-
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-	return UPDT_CONTINUE;
-}
-
+/** M_Renderer - PostUpdate: Builds the render packet of the frame (visible objects, static batches, debug lines and editor)
+							and hands it to the render thread, or draws it right away if rendering is not threaded. */
 UpdateReturn M_Renderer::PostUpdate(float dt)
 {
 	UpdateReturn ret = UPDT_CONTINUE;
 
-	//TMP: Testing compatibility mode vs core
+	PerfTimer frameTimer;
+	float editorMs = 0.f;
 
-	//glLineWidth(2.0f);
-	//glBegin(GL_LINES);
-	//glVertex3f(0.0f, 0.0f, 0.0f);
-	//glVertex3f(10.0f, 0.0f, 0.0f);
-	//glEnd();
-	//glLineWidth(1.0f);
+	Camera* cam = currentCamera ? currentCamera : app->camera->GetEditorCamera(); //TODO: AppState, editor/game?
+
+	RenderPacket* packet = renderThread->GetPacket();
+	FillPacket(packet, cam);
 
-	//-------------------------
+	DrawDebug::SetTarget(&packet->debug);
 
 	if (showGrid)
 	{
@@ -156,29 +189,50 @@ UpdateReturn M_Renderer::PostUpdate(float dt)
 		DrawDebug::DrawGrid();
 	}
 
-	Camera* cam = currentCamera ? currentCamera : app->camera->GetEditorCamera(); //TODO: AppState, editor/game?
+	PerfTimer cullTimer;
 
-	std::vector<GameObject*> objects;
-	app->goManager->GetToDrawStaticObjects(objects, cam);
-	std::list<GameObject*>* dyn = app->goManager->GetDynamicObjects();
-
-	//Static objects
-	for (std::vector<GameObject*>::iterator it = objects.begin(); it != objects.end(); ++it)
+	//Culling results live in the frame allocator, they should never touch the general heap
+	FrameVector<GameObject*> objects;
+	FrameVector<GameObject*> dynObjects;
 	{
-		if(*it && (*it)->IsActive())
-			DrawObject(*it, cam);
+		FRAME_HEAP_CHECK();
+
+		app->goManager->GetToDrawStaticObjects(objects, cam);
+
+		std::list<GameObject*>* dyn = app->goManager->GetDynamicObjects();
+		if (dyn)
+		{
+			PROFILE_SCOPE("Dynamic culling");
+			for (std::list<GameObject*>::iterator it = dyn->begin(); it != dyn->end(); ++it)
+			{
+				if (*it && (*it)->IsActive())
+					if ((*it)->enclosingBox.IsFinite() && cam->frustum.Intersects((*it)->enclosingBox))
+						dynObjects.push_back(*it);
+			}
+		}
 	}
 
-	//Dynamic bjects
-	if (dyn)
+	cullingMs = (float)cullTimer.ReadMs();
+
+	//Static objects
+	if (staticBatching)
+		staticBatcher->Prepare(app->resources->defaultShader->GetShaderID());
+
+	for (FrameVector<GameObject*>::iterator it = objects.begin(); it != objects.end(); ++it)
 	{
-		for (std::list<GameObject*>::iterator it = dyn->begin(); it != dyn->end(); ++it)
+		if (*it && (*it)->IsActive())
 		{
-			if(*it && (*it)->IsActive())
-				if((*it)->enclosingBox.IsFinite() && cam->frustum.Intersects((*it)->enclosingBox))
-					DrawObject(*it, cam);
+			if (!staticBatching || !staticBatcher->MarkVisible(*it, cam))
+				DrawObject(*it, packet);
 		}
 	}
+
+	if (staticBatching)
+		staticBatcher->CollectDraws(*packet);
+
+	//Dynamic bjects
+	for (FrameVector<GameObject*>::iterator it = dynObjects.begin(); it != dynObjects.end(); ++it)
+		DrawObject(*it, packet);
 	
 	//------------
 
@@ -188,10 +242,25 @@ UpdateReturn M_Renderer::PostUpdate(float dt)
 		app->DrawDebug();
 	}
 
-	//TODO: Editor state
-	app->editor->DrawEditor();
+	DrawDebug::SetTarget(nullptr);
 
-	SDL_GL_SwapWindow(app->win->GetWindow());
+	if (app->editor)
+	{
+		PROFILE_SCOPE("Editor draw");
+		PerfTimer editorTimer;
+
+		//TODO: Editor state
+		app->editor->DrawEditor();
+
+		ImGuiIO& io = ImGui::GetIO();
+		packet->ui.CopyFrom(ImGui::GetDrawData(), io.DisplaySize.x, io.DisplaySize.y, io.DisplayFramebufferScale.x, io.DisplayFramebufferScale.y);
+
+		editorMs = (float)editorTimer.ReadMs();
+	}
+
+	renderThread->Submit();
+
+	submissionMs = MAX(0.f, (float)frameTimer.ReadMs() - cullingMs - editorMs);
 
 	return ret;
 }
@@ -200,7 +269,20 @@ bool M_Renderer::CleanUp()
 {
 	_LOG(LOG_INFO, "Renderer: CleanUp.");
 
-	SDL_GL_DeleteContext(context);
+	//From here on the GL work runs on the main thread with the main context
+	renderThread->Stop();
+	if (uploadContext)
+	{
+		SDL_GL_DeleteContext(uploadContext);
+		uploadContext = nullptr;
+	}
+
+	RELEASE(staticBatcher);
+	renderThread->ReleaseGLObjects();
+	RELEASE(renderThread);
+
+	if (context)
+		SDL_GL_DeleteContext(context);
 
 	return true;
 }
@@ -210,13 +292,18 @@ bool M_Renderer::GetVSync() const
 	return vsync;
 }
 
+/** M_Renderer - SetVSync: The swap interval belongs to the context that swaps, so it is set on the render side. */
 void M_Renderer::SetVSync(bool set)
 {
 	if (vsync != set)
 	{
 		vsync = set;
-		if (SDL_GL_SetSwapInterval(vsync ? 1 : 0) < 0)
-			_LOG(LOG_WARN, "Unable to set VSync! SDL_Error: %s\n", SDL_GetError());
+		int interval = vsync ? 1 : 0;
+		RenderThread::Enqueue([interval]()
+		{
+			if (SDL_GL_SetSwapInterval(interval) < 0)
+				_LOG(LOG_WARN, "Unable to set VSync! SDL_Error: %s\n", SDL_GetError());
+		});
 	}
 }
 
@@ -230,54 +317,162 @@ void M_Renderer::SetCamera(Camera * cam)
 	currentCamera = cam;
 }
 
+/** M_Renderer - AddStaticObject: Queues a static object into the static batches, or refreshes it if already batched. */
+void M_Renderer::AddStaticObject(GameObject * object)
+{
+	if (staticBatcher)
+		staticBatcher->AddObject(object);
+}
+
+/** M_Renderer - RemoveStaticObject: Removes an object from the static batches. */
+void M_Renderer::RemoveStaticObject(GameObject * object)
+{
+	if (staticBatcher)
+		staticBatcher->RemoveObject(object);
+}
+
+const StaticBatcher * M_Renderer::GetStaticBatcher() const
+{
+	return staticBatcher;
+}
+
+const RenderThread * M_Renderer::GetRenderThread() const
+{
+	return renderThread;
+}
+
+/** M_Renderer - GetRecorder: Returns the recording backend when running headless, null when rendering with GL. */
+const RecordingBackend * M_Renderer::GetRecorder() const
+{
+	return recorder;
+}
+
+/** M_Renderer - GetCullingMs: Time spent last frame collecting the visible static and dynamic objects. */
+float M_Renderer::GetCullingMs() const
+{
+	return cullingMs;
+}
+
+/** M_Renderer - GetSubmissionMs: Time spent last frame building and submitting the packet, without culling and editor. */
+float M_Renderer::GetSubmissionMs() const
+{
+	return submissionMs;
+}
+
+/** M_Renderer - CRenderStats: Logs the calls of the last frame. Per call kind when recording, issued and skipped by GLState otherwise. */
+void M_Renderer::CRenderStats::Function(std::vector<std::string>& args)
+{
+	const RecordingBackend* recorder = app->renderer->GetRecorder();
+	if (recorder == nullptr)
+	{
+		_LOG(LOG_INFO, "Render stats: %u GL calls issued, %u skipped by the state cache.", GLState::GetIssuedCalls(), GLState::GetSkippedCalls());
+		return;
+	}
+
+	const RecordingStats& stats = (std::find(args.begin(), args.end(), "-t") != args.end()) ? recorder->GetTotalStats() : recorder->GetLastFrameStats();
+
+	_LOG(LOG_INFO, "Render stats: %u calls, %u state changes, %u draws, %llu elements, %llu bytes uploaded.",
+		stats.calls, stats.stateChanges, stats.drawCalls, stats.elements, stats.uploadedBytes);
+
+	for (uint i = 0; i < ROP_COUNT; ++i)
+	{
+		if (stats.counts[i] > 0)
+			_LOG(LOG_INFO, "	%s: %u", RecordingBackend::GetOpName((RecordedOp)i), stats.counts[i]);
+	}
+
+	if (recorder->IsLogging())
+		_LOG(LOG_INFO, "Render stats: %u calls logged, %u dropped.", recorder->GetLog().size(), recorder->GetDroppedCalls());
+}
+
+/** M_Renderer - OnResize: The viewport is set by the render side from the packet. */
 void M_Renderer::OnResize(uint w, uint h)
 {
-	glViewport(0, 0, w, h);
+	viewportWidth = w;
+	viewportHeight = h;
 }
 
-void M_Renderer::DrawObject(GameObject * object, Camera * cam)
+/** M_Renderer - DrawObject: Adds the object mesh to the packet draws. */
+void M_Renderer::DrawObject(GameObject * object, RenderPacket* packet)
 {
 	Mesh* meshCmp = (Mesh*)object->GetComponent(CMP_MESH);
 	if (meshCmp)
 	{
 		ResourceMesh* mesh = (ResourceMesh*)meshCmp->GetResource();
-		if (mesh)
+		if (mesh && mesh->GetLoadState() == RES_LOADING)
+			mesh = app->resources->cube; //Placeholder until the mesh is loaded
+
+		if (mesh && mesh->idVertices && mesh->idIndices)
 		{
-			glUseProgram(app->resources->defaultShader->GetShaderID());
+			packet->draws.push_back(MeshDraw());
+			MeshDraw& draw = packet->draws.back();
 
-			glBindVertexArray(mesh->idContainer);
+			mesh->GetDrawInfo(draw.mesh);
 
-			glUniformMatrix4fv(modelLoc, 1, GL_FALSE, object->transform->GetGlobalTransformGL());
-			glUniformMatrix4fv(viewLoc, 1, GL_FALSE, cam->GetGLViewMatrix());
-			glUniformMatrix4fv(projLoc, 1, GL_FALSE, cam->GetGLProjectionMatrix());
+			float4x4 model = object->transform->GetGlobalTransform().Transposed();
+			memcpy(draw.model, model.ptr(), sizeof(draw.model));
+		}
+	}
+}
 
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->idIndices);
+/** M_Renderer - FillPacket: Sets the frame data of the packet: clear color, viewport, camera matrices and default shader. */
+void M_Renderer::FillPacket(RenderPacket * packet, Camera * cam)
+{
+	packet->clearColor = cam ? cam->GetBackground() : Color(0.f, 0.f, 0.f, 1.f);
+	packet->viewportWidth = viewportWidth;
+	packet->viewportHeight = viewportHeight;
 
-			glDrawElements(GL_TRIANGLES, mesh->numIndices, GL_UNSIGNED_INT, NULL);
+	if (cam)
+	{
+		memcpy(packet->view, cam->GetGLViewMatrix(), sizeof(packet->view));
+		memcpy(packet->projection, cam->GetGLProjectionMatrix(), sizeof(packet->projection));
+	}
+	else
+	{
+		memcpy(packet->view, float4x4::identity.ptr(), sizeof(packet->view));
+		memcpy(packet->projection, float4x4::identity.ptr(), sizeof(packet->projection));
+	}
+
+	packet->program = app->resources->defaultShader->GetShaderID();
+	packet->modelLoc = modelLoc;
+	packet->viewLoc = viewLoc;
+	packet->projLoc = projLoc;
+}
 
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-			glBindVertexArray(0);
+/** M_Renderer - CreateUploadContext: Creates a context shared with the main one and makes it current, so the main thread can
+									  keep creating GL resources while the render thread owns the main context. */
+bool M_Renderer::CreateUploadContext()
+{
+	SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 1);
+	uploadContext = SDL_GL_CreateContext(app->win->GetWindow());
+	SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 0);
 
-			glUseProgram(0);
-		}
+	if (uploadContext == nullptr)
+	{
+		_LOG(LOG_WARN, "Renderer: Could not create the upload context, rendering from the main thread. SDL_Error: %s\n", SDL_GetError());
+		SDL_GL_MakeCurrent(app->win->GetWindow(), context);
+		return false;
 	}
+
+	GLState::Invalidate(); //The cached state belonged to the main context
+	return true;
 }
 
 void M_Renderer::PrepareShaderLocs()
 {
 	uint shader = app->resources->defaultShader->GetShaderID();
+	RenderBackend* backend = RenderBackend::Get();
 
-	viewLoc = glGetUniformLocation(shader, "view");
-	modelLoc = glGetUniformLocation(shader, "model");
-	projLoc = glGetUniformLocation(shader, "projection");
+	viewLoc = backend->GetUniformLocation(shader, "view");
+	modelLoc = backend->GetUniformLocation(shader, "model");
+	projLoc = backend->GetUniformLocation(shader, "projection");
 }
 
-void M_Renderer::DrawChilds(GameObject * object, Camera* cam)
+void M_Renderer::DrawChilds(GameObject * object, Camera* cam, RenderPacket* packet)
 {
 	for (auto it : object->childs)
 	{
 		if (it && cam->frustum.Intersects(it->enclosingBox))
-			DrawObject(it, cam);
-		DrawChilds(it, cam);
+			DrawObject(it, packet);
+		DrawChilds(it, cam, packet);
 	}
 }
@@ -2,10 +2,15 @@
 #define __M_RENDERER_H__
 
 #include "Module.h"
+#include "Console.h"
 #include <SDL.h>
 
 class GameObject;
 class Camera;
+class StaticBatcher;
+class RenderThread;
+class RecordingBackend;
+struct RenderPacket;
 
 class M_Renderer : public Module
 {
@@ -15,7 +20,6 @@ public:
 
 	bool Init(JsonFile* file)override;
 	bool Start()override;
-	UpdateReturn PreUpdate(float dt)override;
 	UpdateReturn PostUpdate(float dt)override;
 	bool CleanUp()override;
 
@@ -25,11 +29,22 @@ public:
 	Camera* GetCurrentCamera()const;
 	void SetCamera(Camera* cam);
 
+	void AddStaticObject(GameObject* object);
+	void RemoveStaticObject(GameObject* object);
+	const StaticBatcher* GetStaticBatcher()const;
+	const RenderThread* GetRenderThread()const;
+	const RecordingBackend* GetRecorder()const;
+
+	float GetCullingMs()const;
+	float GetSubmissionMs()const;
+
 
 private:
 	void OnResize(uint w, uint h) override;
 
-	void DrawObject(GameObject* object, Camera* cam);
+	void DrawObject(GameObject* object, RenderPacket* packet);
+	void FillPacket(RenderPacket* packet, Camera* cam);
+	bool CreateUploadContext();
 
 
 	//****
@@ -38,18 +53,38 @@ private:
 
 	void PrepareShaderLocs();
 
-	void DrawChilds(GameObject* object, Camera* cam);
+	void DrawChilds(GameObject* object, Camera* cam, RenderPacket* packet);
 
 	//-------------------
 
 public:
 	bool showGrid = true;
+	bool staticBatching = true;
 
 private:
 	SDL_GLContext context;
+	SDL_GLContext uploadContext = nullptr; //Current on the main thread while the render thread owns the main context.
 	bool vsync;
+	bool renderThreaded = false;
+
+	uint viewportWidth = 0;
+	uint viewportHeight = 0;
+
+	float cullingMs = 0.f;
+	float submissionMs = 0.f;
 
 	Camera* currentCamera = nullptr; //TODO: Only one camera?? Viewport??
+
+	StaticBatcher* staticBatcher = nullptr;
+	RenderThread* renderThread = nullptr;
+	RecordingBackend* recorder = nullptr;
+
+	struct CRenderStats : public Command
+	{
+		CRenderStats() : Command("Render stats", "render_stats", "Log the render calls of the last frame. -t since start (recording only)")
+		{}
+		void Function(std::vector<std::string>& args)override;
+	}cRenderStats;
 };
 
 
@@ -20,8 +20,34 @@
 #include "ImporterShader.h"
 
 #include "JsonFile.h"
+#include "Hash.h"
+#include "MemoryTracker.h"
+#include "Profiler.h"
+#include "PerfTimer.h"
+#include "MappedFile.h"
+#include "DDS.h"
+
+#include <algorithm>
 
 #define RESERVED_RESOURCES 20
+#define IMPORT_CACHE_VERSION 2
+#define ATLAS_FILE_VERSION 2 //2: pages stored from the bottom row, the regions of older ones are upside down.
+#define REGISTRY_MIN_JOURNAL 256 //Journal entries allowed before rewriting the registry, or a quarter of its records if more.
+
+/** Texture atlases rebuilt by a job: the textures to pack, taken on the main thread, and the pages the job saved. */
+struct AtlasBuild
+{
+	std::vector<UID> textures;
+	std::vector<std::string> files;	//Source file of every texture.
+	std::vector<uint> usages;
+	uint size = 0;
+	uint padding = 0;
+	uint64 hash = 0;
+
+	std::vector<AtlasPage> pages;	//Saved, without their pixels.
+	std::vector<UID> pageUIDs;
+	std::vector<std::string> pageFiles;
+};
 
 /** M_ResourceManager: Creates all importers. */
 M_ResourceManager::M_ResourceManager(const char* name, bool startEnabled) : Module(name, startEnabled)
@@ -34,7 +60,7 @@ M_ResourceManager::M_ResourceManager(const char* name, bool startEnabled) : Modu
 	sceneImporter = new ImporterScene();
 	shaderImporter = new ImporterShader();
 
-	configuration = M_INIT | M_START | M_CLEAN_UP | M_SAVE_CONFIG;
+	configuration = M_INIT | M_START | M_PRE_UPDATE | M_CLEAN_UP | M_SAVE_CONFIG;
 }
 
 /** ~M_ResourceManager: Destroy all importers. */
@@ -55,6 +81,21 @@ bool M_ResourceManager::Init(JsonFile * conf)
 	_LOG(LOG_INFO, "Resource manager: Init.");
 
 	resourceFile = conf->GetString("resource_file", "resources.json");
+	registryFile = conf->GetString("registry_file", "resources.bin");
+	exportJson = conf->GetBool("resources_json_export", false);
+	importCacheFile = conf->GetString("import_cache_file", "import_cache.json");
+	meshImporter->vertexFormat = conf->GetInt("mesh_vertex_format", VF_COMPACT);
+	meshImporter->compressionLevel = conf->GetInt("mesh_compression", 1);
+	textureImporter->compressionLevel = conf->GetInt("texture_compression", 1);
+	textureImporter->quality = (TextureQuality)conf->GetInt("texture_quality", TEX_QUALITY_NORMAL);
+	uploadBudgetMs = conf->GetFloat("upload_budget_ms", 2.f);
+	cpuBudget = (uint64)conf->GetInt("cpu_budget_mb", 512) * 1024 * 1024;
+	gpuBudget = (uint64)conf->GetInt("gpu_budget_mb", 1024) * 1024 * 1024;
+	textureAtlases = conf->GetBool("texture_atlases", false);
+	atlasThreshold = conf->GetInt("atlas_threshold", 128);
+	atlasSize = conf->GetInt("atlas_size", 2048);
+	atlasPadding = conf->GetInt("atlas_padding", 8);
+	atlasFile = conf->GetString("atlas_file", "atlases.json");
 
 	return true;
 }
@@ -70,14 +111,30 @@ bool M_ResourceManager::Start()
 		return false;
 	}
 
+	LoadAtlases(); //Before the textures are created
 	LoadResources();
+	LoadImportCache();
+	atlasesDirty = textureAtlases;
 
 	return true;
 }
 
-/** M_ResourceManager - PreUpdate: Nothing for now. */
+/** M_ResourceManager - PreUpdate: Uploads the resources loaded asynchronously and evicts the cached ones over the budgets.
+									 Starts an atlas rebuild after textures were imported and adds its atlases once it finishes. */
 UpdateReturn M_ResourceManager::PreUpdate(float dt)
 {
+	if (atlasBuild && atlasJobs.pending.load() == 0)
+		FinishTextureAtlases();
+
+	if (atlasesDirty && !atlasBuild)
+		BuildTextureAtlases();
+
+	if (!retiredAtlases.empty())
+		DeleteRetiredAtlases();
+
+	UploadLoadedResources();
+	EnforceBudgets();
+
 	return UPDT_CONTINUE;
 }
 
@@ -86,14 +143,32 @@ bool M_ResourceManager::CleanUp()
 {
 	_LOG(LOG_INFO, "Resource manager: CleanUp.");
 
+	//Its pages are saved already, they are kept
+	JobSystem::Wait(&atlasJobs);
+	if (atlasBuild)
+		FinishTextureAtlases();
+
 	SaveResources();
+	SaveImportCache();
+	SaveAtlases();
 	//TODO: Once all resources are saved, should cleanup all the resources.
 
+	//The loads in flight only free their data
+	JobSystem::Wait(&loadJobs);
+	for (std::deque<AsyncLoad>::iterator it = uploads.begin(); it != uploads.end(); ++it)
+		it->resource->UploadAsync(false);
+	uploads.clear();
+	pendingLoads = 0;
+
+	unreferenced.clear();
+	unreferencedPos.clear();
+
 	for (auto it : resources)
 	{
 		RELEASE(it.second);
 	}
 	resources.erase(resources.begin(), resources.end());
+	registry.Close();
 
 	return true;
 }
@@ -104,7 +179,7 @@ bool M_ResourceManager::CleanUp()
 *		if the file is already in Assets, no matter if is in a directory, will import it.
 *
 *	- const char* fileNam: Path of the file to import with its relative path to it.
-*	- bool checkFirst: Flag to search for already imported files. False by default.
+*	- bool checkFirst: Flag to search the import cache first. An unchanged file returns the resource already imported. False by default.
 *
 *	- Return UID: The id resulting resource, 0 if any error.
 *
@@ -123,15 +198,16 @@ UID M_ResourceManager::ImportFile(const char * fileName, bool checkFirst)
 		app->fs->DuplicateFile(fileName, source.GetFullPath());
 	}
 
+	ResourceType type = GetTypeFromExtension(source.GetExtension());
+	uint64 hash = 0;
+
 	if (checkFirst)
 	{
-		Resource* tmp = FindResourceFromOriginalFullPath(source.GetFullPath());
-		if (tmp)
-			return tmp->GetUID();
+		UID cached = FindInImportCache(source, type, hash);
+		if (cached != 0)
+			return cached;
 	}
 
-	ResourceType type = GetTypeFromExtension(source.GetExtension());
-
 	bool success = false;
 	Path exportedPath;
 	UID resid = 0;
@@ -159,6 +235,11 @@ UID M_ResourceManager::ImportFile(const char * fileName, bool checkFirst)
 		r->name = source.GetFileName();
 		ret = r->GetUID();
 
+		AddToImportCache(source, type, ret, hash);
+
+		if (type == RES_TEXTURE)
+			atlasesDirty = textureAtlases;
+
 		_LOG(LOG_INFO, "Imported file [%s] to [%s].", r->GetOriginalFile(), r->GetExportedFile());
 	}
 	else
@@ -203,11 +284,7 @@ UID M_ResourceManager::ImportBuf(const void * buffer, ResourceType type, uint si
 
 	if (succes && ret != 0)
 	{
-		Resource* res = CreateResource(type, ret);
-		res->originalFile.SetFullPath((sourceFile) ? sourceFile->GetFullPath() : "unknown");
-		res->exportedFile.SetFullPath(output.GetFullPath());
-		res->name = sourceFile ? sourceFile->GetFileName() : "unamed";
-		_LOG(LOG_INFO, "Imported a buffer succesfully [%s].", output.GetFullPath());
+		AddImportedResource(type, ret, output, sourceFile);
 	}
 	else
 	{
@@ -217,11 +294,242 @@ UID M_ResourceManager::ImportBuf(const void * buffer, ResourceType type, uint si
 	return ret;
 }
 
-/** M_ResourceManager - GetResourceFromUID: Return a resource from its UID, nullptr if not founf. */
+/** M_ResourceManager - AddImportedResource: Creates the resource of a buffer imported into the exported file with the UID. Main thread only,
+											 parallel imports save their files on the workers and add the resources once they finish. */
+Resource * M_ResourceManager::AddImportedResource(ResourceType type, UID uid, const Path & exportedFile, const Path * sourceFile)
+{
+	Resource* res = CreateResource(type, uid);
+	if (res)
+	{
+		res->originalFile.SetFullPath((sourceFile) ? sourceFile->GetFullPath() : "unknown");
+		res->exportedFile.SetFullPath(exportedFile.GetFullPath());
+		res->name = sourceFile ? sourceFile->GetFileName() : "unamed";
+		_LOG(LOG_INFO, "Imported a buffer succesfully [%s].", exportedFile.GetFullPath());
+	}
+
+	return res;
+}
+
+/** M_ResourceManager - LoadToMemoryAsync: Adds an instance of the resource like Resource::LoadToMemory, but the file is read and decoded
+											on a worker thread and uploaded later on the main thread. The resource is loading until then,
+											check IsReady before using its data. Resources without async load are loaded right away. */
+bool M_ResourceManager::LoadToMemoryAsync(Resource * resource)
+{
+	if (!resource)
+		return false;
+
+	//Back from the cache of released resources
+	RemoveUnreferenced(resource);
+
+	if (resource->loadState == RES_LOADED || resource->loadState == RES_LOADING)
+		++residency.hits;
+	else
+		++residency.misses;
+
+	if (!resource->CanLoadAsync() || resource->loadState == RES_LOADED || resource->loadState == RES_LOADING || resource->instancesLoaded > 0)
+	{
+		bool ret = resource->LoadToMemory();
+		UpdateResidency(resource);
+		return ret;
+	}
+
+	resource->instancesLoaded = 1;
+	resource->loadState = RES_LOADING;
+	++pendingLoads;
+
+	JobSystem::Schedule([this, resource]()
+	{
+		PROFILE_SCOPE("Resource read");
+		bool read = resource->ReadAsync();
+
+		std::lock_guard<std::mutex> lock(uploadsMutex);
+		AsyncLoad load;
+		load.resource = resource;
+		load.read = read;
+		uploads.push_back(load);
+	}, &loadJobs);
+
+	return true;
+}
+
+/** M_ResourceManager - ReleaseResource: Removes an instance of the resource. The data of the last one is not freed, the resource goes to
+											the cache of released resources and is only evicted when the memory budgets are exceeded. */
+void M_ResourceManager::ReleaseResource(Resource * resource)
+{
+	if (!resource || resource->instancesLoaded == 0)
+		return;
+
+	if (resource->instancesLoaded > 1 || resource->loadState != RES_LOADED || resource->GetUID() <= RESERVED_RESOURCES)
+	{
+		resource->RemoveInstance(); //Loading ones are cached when their upload finds no instances
+		UpdateResidency(resource);
+		return;
+	}
+
+	resource->instancesLoaded = 0;
+	AddUnreferenced(resource);
+}
+
+/** M_ResourceManager - GetPendingLoads: Async loads started and not uploaded yet. */
+uint M_ResourceManager::GetPendingLoads() const
+{
+	return pendingLoads;
+}
+
+/** M_ResourceManager - GetLastUploadMs: Time spent on the uploads on the last frame. */
+float M_ResourceManager::GetLastUploadMs() const
+{
+	return lastUploadMs;
+}
+
+/** M_ResourceManager - UploadLoadedResources: Uploads the resources read by the workers until the frame budget is spent. */
+void M_ResourceManager::UploadLoadedResources()
+{
+	PROFILE_SCOPE("Resource uploads");
+
+	PerfTimer timer;
+	timer.Start();
+
+	while (true)
+	{
+		AsyncLoad load;
+		{
+			std::lock_guard<std::mutex> lock(uploadsMutex);
+			if (uploads.empty())
+				break;
+
+			load = uploads.front();
+			uploads.pop_front();
+		}
+
+		Resource* res = load.resource;
+		if (res->UploadAsync(load.read))
+		{
+			res->loadState = RES_LOADED;
+		}
+		else
+		{
+			res->loadState = RES_LOAD_FAILED;
+			_LOG(LOG_ERROR, "Could not load the resource [%s] from file [%s].", res->GetResourceName(), res->GetExportedFile());
+		}
+		--pendingLoads;
+
+		//Every instance was released while loading, cached like the released ones
+		if (res->instancesLoaded == 0)
+		{
+			if (res->loadState == RES_LOADED)
+			{
+				AddUnreferenced(res);
+			}
+			else
+			{
+				res->RemoveFromMemory();
+				res->loadState = RES_UNLOADED;
+			}
+		}
+		UpdateResidency(res);
+
+		if (timer.ReadMs() >= uploadBudgetMs)
+			break;
+	}
+
+	lastUploadMs = (float)timer.ReadMs();
+}
+
+/** M_ResourceManager - EnforceBudgets: Evicts the least recently released resources while the loaded ones exceed the CPU or the GPU
+										   budget. The resources with instances are never evicted. Only the cache is walked, the totals are kept
+										   by UpdateResidency. */
+void M_ResourceManager::EnforceBudgets()
+{
+	PROFILE_SCOPE("Resource budgets");
+
+	while ((residency.cpuBytes > cpuBudget || residency.gpuBytes > gpuBudget) && !unreferenced.empty())
+	{
+		Resource* res = unreferenced.back();
+		RemoveUnreferenced(res);
+
+		res->RemoveFromMemory();
+		res->loadState = RES_UNLOADED;
+		UpdateResidency(res);
+		++residency.evictions;
+	}
+}
+
+/** M_ResourceManager - UpdateResidency: Moves the bytes the resource has in the residency totals to the ones it uses now, none if it is
+											not loaded. Called after every change of its load state. */
+void M_ResourceManager::UpdateResidency(Resource * resource)
+{
+	uint64 cpu = 0, gpu = 0;
+	if (resource->IsReady())
+		GetResidentBytes(resource, cpu, gpu);
+
+	residency.cpuBytes = residency.cpuBytes - resource->residentCpu + cpu;
+	residency.gpuBytes = residency.gpuBytes - resource->residentGpu + gpu;
+	resource->residentCpu = cpu;
+	resource->residentGpu = gpu;
+}
+
+/** M_ResourceManager - AddUnreferenced: Puts a loaded resource without instances at the front of the cache of released resources. */
+void M_ResourceManager::AddUnreferenced(Resource * resource)
+{
+	UpdateResidency(resource);
+
+	unreferenced.push_front(resource);
+	unreferencedPos[resource] = unreferenced.begin();
+
+	residency.cached = unreferenced.size();
+	residency.cachedCpuBytes += resource->residentCpu;
+	residency.cachedGpuBytes += resource->residentGpu;
+}
+
+/** M_ResourceManager - RemoveUnreferenced: Takes the resource out of the cache of released resources. False if it was not there. */
+bool M_ResourceManager::RemoveUnreferenced(Resource * resource)
+{
+	std::map<Resource*, std::list<Resource*>::iterator>::iterator cached = unreferencedPos.find(resource);
+	if (cached == unreferencedPos.end())
+		return false;
+
+	unreferenced.erase(cached->second);
+	unreferencedPos.erase(cached);
+
+	residency.cached = unreferenced.size();
+	residency.cachedCpuBytes -= resource->residentCpu;
+	residency.cachedGpuBytes -= resource->residentGpu;
+	return true;
+}
+
+/** M_ResourceManager - GetResidentBytes: CPU and VRAM used by the data of a loaded resource. */
+void M_ResourceManager::GetResidentBytes(const Resource * resource, uint64 & cpu, uint64 & gpu)
+{
+	cpu = 0;
+	gpu = 0;
+
+	if (resource->GetType() == RES_MESH)
+	{
+		const ResourceMesh* mesh = (const ResourceMesh*)resource;
+		cpu = mesh->GetFloatLayoutBytes();
+		gpu = mesh->vramBytes;
+	}
+	else if (resource->GetType() == RES_TEXTURE)
+	{
+		const ResourceTexture* texture = (const ResourceTexture*)resource;
+		if (texture->texID != 0)
+			gpu = texture->bytes;
+	}
+}
+
+/** M_ResourceManager - GetResourceFromUID: Return a resource from its UID, nullptr if not founf. Resources of the registry not used yet are created now. */
 Resource * M_ResourceManager::GetResourceFromUID(UID uuid)
 {
 	std::map<UID, Resource*>::iterator it = resources.find(uuid);
-	return it != resources.end() ? it->second : nullptr;
+	if (it != resources.end())
+		return it->second;
+
+	RegistryEntry entry;
+	if (!allMaterialized && registry.Find(uuid, entry) && std::find(deletedResources.begin(), deletedResources.end(), uuid) == deletedResources.end())
+		return Materialize(entry);
+
+	return nullptr;
 }
 
 /** M_ResourceManager - CreateResource: Create a desired type resource. If no passed UID, 0 UID or 
@@ -235,27 +543,44 @@ Resource * M_ResourceManager::CreateResource(ResourceType type, UID forceUID)
 	if (forceUID == 0 || GetResourceFromUID(forceUID))
 		forceUID = GetNewUID();
 
+	ret = NewResource(type, forceUID);
+	if (ret && forceUID > RESERVED_RESOURCES)
+		unsavedResources.push_back(forceUID);
+
+	return ret;
+}
+
+/** M_ResourceManager - NewResource: Creates the resource object of the type and adds it to the map. */
+Resource * M_ResourceManager::NewResource(ResourceType type, UID uid)
+{
+	Resource* ret = nullptr;
+
 	switch (type)
 	{
 	case RES_MESH:
-		ret = (Resource*)new ResourceMesh(forceUID);
+		ret = (Resource*)new ResourceMesh(uid);
 		break;
 	case RES_TEXTURE:
-		ret = (Resource*)new ResourceTexture(forceUID);
+		ret = (Resource*)new ResourceTexture(uid);
+		{
+			std::map<UID, AtlasRegion>::const_iterator region = atlasRegions.find(uid);
+			if (region != atlasRegions.end())
+				((ResourceTexture*)ret)->atlasRegion = region->second;
+		}
 		break;
 	case RES_MATERIAL:
-		ret = (Resource*)new ResourceMaterial(forceUID);
+		ret = (Resource*)new ResourceMaterial(uid);
 		break;
 	case RES_SCENE:
-		ret = (Resource*)new ResourceScene(forceUID);
+		ret = (Resource*)new ResourceScene(uid);
 		break;
 	case RES_SHADER:
-		ret = (Resource*)new ResourceShader(forceUID);
+		ret = (Resource*)new ResourceShader(uid);
 		break;
 	}
 
 	if (ret)
-		resources[forceUID] = ret;
+		resources[uid] = ret;
 
 	return ret;
 }
@@ -263,6 +588,8 @@ Resource * M_ResourceManager::CreateResource(ResourceType type, UID forceUID)
 /** M_ResourceManager - FindResourceFromOriginalFullPath: Get a resource from its original full path. Return nullptr if not found. */
 Resource * M_ResourceManager::FindResourceFromOriginalFullPath(const char * fullpath)
 {
+	MaterializeAll();
+
 	for (auto it : resources)
 	{
 		if (strcmp(it.second->originalFile.GetFullPath(), fullpath) == 0)
@@ -303,15 +630,41 @@ ResourceType M_ResourceManager::GetTypeFromExtension(const char * ext) const
 	return ret;
 }
 
-/** M_ResourceManager - GetNewUID: Return a new rnadom UID. */
+/** M_ResourceManager - GetNewUID: Return a new rnadom UID, never 0. Safe against the other calls from any thread. */
 UID M_ResourceManager::GetNewUID() const
 {
-	return app->random->GetRandInt();
+	std::lock_guard<std::mutex> lock(uidMutex);
+
+	UID ret = 0;
+	while (ret == 0)
+		ret = app->random->GetRandInt();
+
+	return ret;
+}
+
+/** M_ResourceManager - ReserveUIDs: Fills uids with count new UIDs, different between them and from the current resources. They are drawn in
+									 order on the calling thread, so a parallel import that takes them first gets the same UIDs every run. */
+void M_ResourceManager::ReserveUIDs(uint count, std::vector<UID>& uids) const
+{
+	uids.clear();
+	uids.reserve(count);
+
+	std::lock_guard<std::mutex> lock(uidMutex);
+
+	while (uids.size() < count)
+	{
+		UID uid = app->random->GetRandInt();
+		RegistryEntry entry;
+		if (uid != 0 && resources.find(uid) == resources.end() && !registry.Find(uid, entry) && std::find(uids.begin(), uids.end(), uid) == uids.end())
+			uids.push_back(uid);
+	}
 }
 
 /** M_ResourceManager - GetResourcesOfType: Fill a passed vector with all resources of type. Sveral types can be passed at once. */
-void M_ResourceManager::GetResourcesOfType(std::vector<Resource*>& res, ResourceType type) const
+void M_ResourceManager::GetResourcesOfType(std::vector<Resource*>& res, ResourceType type)
 {
+	MaterializeAll();
+
 	for (auto it : resources)
 	{
 		if (type & it.second->GetType())
@@ -319,8 +672,183 @@ void M_ResourceManager::GetResourcesOfType(std::vector<Resource*>& res, Resource
 	}
 }
 
-/** M_ResourceManager - LoadResources: Loads all resources from the resource file. */
+/** M_ResourceManager - GetUIDsOfType: Fills a frame allocated vector with the UIDs of all resources of type, sorted. The registry records not
+										used yet are listed without creating their resources, for the per frame queries that only use a few. */
+void M_ResourceManager::GetUIDsOfType(FrameVector<UID>& uids, ResourceType type) const
+{
+	std::map<UID, Resource*>::const_iterator it = resources.begin();
+	uint record = 0;
+	uint numRecords = allMaterialized ? 0 : registry.GetNumRecords();
+	RegistryEntry entry;
+
+	//Both are sorted by UID, merge them skipping the records already created.
+	while (it != resources.end() || record < numRecords)
+	{
+		if (record < numRecords && registry.GetRecord(record, entry) && (it == resources.end() || entry.uid <= it->first))
+		{
+			++record;
+			if ((it != resources.end() && entry.uid == it->first) || std::find(deletedResources.begin(), deletedResources.end(), entry.uid) != deletedResources.end())
+				continue;
+			if (type & entry.type)
+				uids.push_back(entry.uid);
+		}
+		else if (it != resources.end())
+		{
+			if (type & it->second->GetType())
+				uids.push_back(it->first);
+			++it;
+		}
+		else
+		{
+			++record; //Corrupted record.
+		}
+	}
+}
+
+/** M_ResourceManager - GetMemoryUsage: Adds up the CPU and VRAM used by the meshes and textures currently in memory, the cached ones included. */
+void M_ResourceManager::GetMemoryUsage(ResourceMemory & memory) const
+{
+	memory = ResourceMemory();
+
+	for (auto it : resources)
+	{
+		if (!it.second->IsReady())
+			continue;
+
+		uint64 cpu, gpu;
+		GetResidentBytes(it.second, cpu, gpu);
+
+		if (it.second->GetType() == RES_MESH)
+		{
+			++memory.meshes;
+			memory.meshCpuBytes += cpu;
+			memory.meshVramBytes += gpu;
+		}
+		else if (it.second->GetType() == RES_TEXTURE)
+		{
+			++memory.textures;
+			memory.textureVramBytes += gpu;
+		}
+	}
+}
+
+/** M_ResourceManager - GetResidencyStats: Hits, misses and evictions since the start, and the memory of the last budgets check. */
+const ResidencyStats & M_ResourceManager::GetResidencyStats() const
+{
+	return residency;
+}
+
+uint64 M_ResourceManager::GetCpuBudget() const
+{
+	return cpuBudget;
+}
+
+uint64 M_ResourceManager::GetGpuBudget() const
+{
+	return gpuBudget;
+}
+
+/** M_ResourceManager - LoadResources: Opens the resource registry. Only the resources of its journal are created now, the rest when first used.
+										Without a registry they are loaded from the json file, and the registry is written on the next save. */
 void M_ResourceManager::LoadResources()
+{
+	PerfTimer timer;
+	timer.Start();
+
+	allMaterialized = false;
+
+	if (registry.Open((RESOURCES_PATH + registryFile).c_str()))
+	{
+		const std::vector<RegistryEntry>& journal = registry.GetJournal();
+		for (std::vector<RegistryEntry>::const_iterator it = journal.begin(); it != journal.end(); ++it)
+			Materialize(*it);
+
+		_LOG(LOG_INFO, "Resource registry: %u records and %u journal entries opened in %.2f ms.", registry.GetNumRecords(), journal.size(), timer.ReadMs());
+	}
+	else
+	{
+		LoadResourcesJson();
+		allMaterialized = true;
+	}
+}
+
+/** M_ResourceManager - SaveResources: Appends the resources created since the last save to the registry journal. The whole registry
+										is rewritten instead when there is none yet, the journal grows past a quarter of it, it ends
+										in an append that did not finish or resources were deleted. */
+void M_ResourceManager::SaveResources()
+{
+	if (exportJson)
+		ExportResourcesJson();
+
+	uint journalSize = registry.GetJournal().size() + unsavedResources.size();
+	bool rewrite = !registry.IsOpen() || registry.IsJournalTorn() || registry.IsOutdated() || !deletedResources.empty() ||
+		journalSize > std::max<uint>(REGISTRY_MIN_JOURNAL, registry.GetNumRecords() / 4);
+
+	if (!rewrite && unsavedResources.empty())
+		return;
+
+	std::vector<Resource*> saved;
+
+	if (rewrite)
+	{
+		MaterializeAll();
+		for (std::map<UID, Resource*>::iterator it = resources.begin(); it != resources.end(); ++it)
+		{
+			if (it->first > RESERVED_RESOURCES)
+				saved.push_back(it->second);
+		}
+	}
+	else
+	{
+		for (std::vector<UID>::iterator it = unsavedResources.begin(); it != unsavedResources.end(); ++it)
+		{
+			std::map<UID, Resource*>::iterator res = resources.find(*it);
+			if (res != resources.end())
+				saved.push_back(res->second);
+		}
+	}
+
+	std::vector<RegistryEntry> entries(saved.size());
+	std::vector<std::string> data(saved.size()); //Owns the data strings of the entries
+	for (uint i = 0; i < saved.size(); ++i)
+	{
+		RegistryEntry& entry = entries[i];
+		entry.uid = saved[i]->GetUID();
+		entry.type = saved[i]->GetType();
+		entry.originalFile = saved[i]->GetOriginalFileFullPath();
+		entry.exportedFile = saved[i]->GetExportedFileFullPath();
+		entry.name = saved[i]->GetResourceName();
+
+		//What the json export keeps of each type, the shader file of the shaders
+		JsonFile file;
+		saved[i]->OnSave(file);
+		if (!file.Value().isNull())
+			data[i] = file.Write();
+		entry.data = data[i].c_str();
+	}
+
+	//The mapping does not share writes
+	std::string file = RESOURCES_PATH + registryFile;
+	registry.Close();
+
+	bool written = rewrite ? ResourceRegistry::Write(file.c_str(), entries) : ResourceRegistry::Append(file.c_str(), entries);
+	if (written)
+	{
+		unsavedResources.clear();
+		if (rewrite)
+			deletedResources.clear();
+		_LOG(LOG_INFO, "Resource registry: %s %u resources.", rewrite ? "Rewritten with" : "Appended", entries.size());
+	}
+	else
+	{
+		_LOG(LOG_ERROR, "Could not save resources!");
+	}
+
+	registry.Open(file.c_str());
+}
+
+/** M_ResourceManager - LoadResourcesJson: Loads all resources from the json resource file. */
+void M_ResourceManager::LoadResourcesJson()
 {
 	char* buffer = nullptr;
 	uint size = app->fs->Load((RESOURCES_PATH + resourceFile).c_str(), &buffer);
@@ -347,9 +875,11 @@ void M_ResourceManager::LoadResources()
 	RELEASE_ARRAY(buffer);
 }
 
-/** M_ResourceManager - SaveResources: Saves all resources into the resource file. */
-void M_ResourceManager::SaveResources()
+/** M_ResourceManager - ExportResourcesJson: Saves all resources into the json resource file, readable for debugging. */
+void M_ResourceManager::ExportResourcesJson()
 {
+	MaterializeAll();
+
 	JsonFile save;
 
 	std::map<UID, Resource*>::iterator it = resources.begin();
@@ -367,8 +897,545 @@ void M_ResourceManager::SaveResources()
 
 	if (app->fs->Save((RESOURCES_PATH + resourceFile).c_str(), buffer.c_str(), buffer.size()) != buffer.size())
 	{
-		_LOG(LOG_ERROR, "Could not save resources!");
+		_LOG(LOG_ERROR, "Could not export the resources!");
+	}
+}
+
+/** M_ResourceManager - DeleteResource: Frees the resource, deletes its exported file and drops it from the registry on the next save.
+										  False if it still has instances or is loading, it is kept then. */
+bool M_ResourceManager::DeleteResource(UID uid)
+{
+	Resource* res = GetResourceFromUID(uid);
+	if (res)
+	{
+		if (res->instancesLoaded > 0 || res->loadState == RES_LOADING)
+			return false;
+
+		RemoveUnreferenced(res);
+		if (res->loadState == RES_LOADED)
+			res->RemoveFromMemory();
+		res->loadState = RES_UNLOADED;
+		UpdateResidency(res);
+
+		if (app->fs->Exist(res->GetExportedFileFullPath()) && !app->fs->Destroy(res->GetExportedFileFullPath()))
+			_LOG(LOG_WARN, "Could not delete the file [%s] of the resource %u.", res->GetExportedFileFullPath(), uid);
+
+		resources.erase(uid);
+		RELEASE(res);
+	}
+
+	unsavedResources.erase(std::remove(unsavedResources.begin(), unsavedResources.end(), uid), unsavedResources.end());
+	if (std::find(deletedResources.begin(), deletedResources.end(), uid) == deletedResources.end())
+		deletedResources.push_back(uid);
+
+	return true;
+}
+
+/** M_ResourceManager - Materialize: Creates the resource of a registry entry, or updates it if it was already created. The data of its
+										type is only loaded when it is created, like the json load did. */
+Resource * M_ResourceManager::Materialize(const RegistryEntry & entry)
+{
+	Resource* res = nullptr;
+	bool created = false;
+
+	std::map<UID, Resource*>::iterator it = resources.find(entry.uid);
+	if (it != resources.end())
+	{
+		if (it->second->GetType() != entry.type)
+			return it->second;
+		res = it->second;
+	}
+	else
+	{
+		res = NewResource((ResourceType)entry.type, entry.uid);
+		created = res != nullptr;
+	}
+
+	if (res)
+	{
+		res->originalFile.SetFullPath(entry.originalFile);
+		res->exportedFile.SetFullPath(entry.exportedFile);
+		res->name = entry.name;
+
+		if (created)
+		{
+			JsonFile data(entry.data);
+			res->OnLoad(data);
+		}
+	}
+
+	return res;
+}
+
+/** M_ResourceManager - MaterializeAll: Creates all the registry resources not used yet. Needed before going through all resources. */
+void M_ResourceManager::MaterializeAll()
+{
+	if (allMaterialized)
+		return;
+
+	RegistryEntry entry;
+	for (uint i = 0; i < registry.GetNumRecords(); ++i)
+	{
+		if (registry.GetRecord(i, entry) && resources.find(entry.uid) == resources.end() &&
+			std::find(deletedResources.begin(), deletedResources.end(), entry.uid) == deletedResources.end())
+			Materialize(entry);
+	}
+
+	allMaterialized = true;
+}
+
+/** M_ResourceManager - LoadImportCache: Loads the import cache file. The entries of other cache versions are dropped. */
+void M_ResourceManager::LoadImportCache()
+{
+	importCache.clear();
+
+	char* buffer = nullptr;
+	uint size = app->fs->Load((RESOURCES_PATH + importCacheFile).c_str(), &buffer);
+
+	if (buffer && size > 0)
+	{
+		JsonFile file(buffer);
+
+		if (file.GetInt("version", 0) == IMPORT_CACHE_VERSION)
+		{
+			uint count = file.GetArraySize("imports");
+			for (uint i = 0; i < count; ++i)
+			{
+				JsonFile e = file.GetObjectFromArray("imports", i);
+
+				ImportCacheEntry entry;
+				entry.modification = e.GetDouble("modification", 0.0);
+				entry.hash = e.GetUInt64("hash", 0);
+				entry.settings = e.GetUInt64("settings", 0);
+				entry.uid = e.GetUInt("UID", 0);
+
+				if (entry.uid != 0)
+					importCache[e.GetString("source", "")] = entry;
+			}
+		}
+	}
+
+	RELEASE_ARRAY(buffer);
+}
+
+/** M_ResourceManager - SaveImportCache: Saves the import cache file. */
+void M_ResourceManager::SaveImportCache()
+{
+	JsonFile save;
+	save.AddInt("version", IMPORT_CACHE_VERSION);
+
+	for (std::map<std::string, ImportCacheEntry>::const_iterator it = importCache.begin(); it != importCache.end(); ++it)
+	{
+		JsonFile e;
+		e.AddString("source", it->first);
+		e.AddDouble("modification", it->second.modification);
+		e.AddUInt64("hash", it->second.hash);
+		e.AddUInt64("settings", it->second.settings);
+		e.AddUInt("UID", it->second.uid);
+		save.AppendArrayValue("imports", e.Value());
+	}
+
+	auto buffer = save.Write(true);
+
+	if (app->fs->Save((RESOURCES_PATH + importCacheFile).c_str(), buffer.c_str(), buffer.size()) != buffer.size())
+	{
+		_LOG(LOG_ERROR, "Could not save the import cache!");
+	}
+}
+
+/**
+*	M_ResourceManager - FindInImportCache: Returns the resource of a previous import of the source, 0 if it must be imported.
+*		If the modification time did not change the entry is used without reading the file. Otherwise the contents are hashed
+*		and any import with the same hash and settings is used, so touched or copied files are not imported again.
+*
+*	- uint64& hash: The hash of the source if it was computed, 0 if not.
+*/
+UID M_ResourceManager::FindInImportCache(const Path & source, ResourceType type, uint64 & hash)
+{
+	hash = 0;
+
+	uint64 settings = GetImportSettingsHash(type);
+	double modification = app->fs->GetLastModification(source.GetFullPath());
+
+	std::map<std::string, ImportCacheEntry>::iterator entry = importCache.find(source.GetFullPath());
+	if (entry != importCache.end() && entry->second.settings == settings && modification >= 0.0 && entry->second.modification == modification)
+	{
+		Resource* res = GetResourceFromUID(entry->second.uid);
+		if (res && app->fs->Exist(res->GetExportedFileFullPath()))
+		{
+			_LOG(LOG_INFO, "Import cache: [%s] is unchanged, using resource %u.", source.GetFullPath(), entry->second.uid);
+			return entry->second.uid;
+		}
+	}
+
+	hash = HashImportSource(source.GetFullPath());
+	if (hash == 0)
+		return 0;
+
+	for (std::map<std::string, ImportCacheEntry>::iterator it = importCache.begin(); it != importCache.end(); ++it)
+	{
+		if (it->second.hash != hash || it->second.settings != settings)
+			continue;
+
+		Resource* res = GetResourceFromUID(it->second.uid);
+		if (res && app->fs->Exist(res->GetExportedFileFullPath()))
+		{
+			UID uid = it->second.uid;
+			_LOG(LOG_INFO, "Import cache: [%s] has the same contents as [%s], using resource %u.", source.GetFullPath(), it->first.c_str(), uid);
+			AddToImportCache(source, type, uid, hash);
+			return uid;
+		}
 	}
+
+	return 0;
+}
+
+/** M_ResourceManager - AddToImportCache: Records the import of the source. Hashes it if the hash was not computed yet. */
+void M_ResourceManager::AddToImportCache(const Path & source, ResourceType type, UID uid, uint64 hash)
+{
+	if (hash == 0)
+		hash = HashImportSource(source.GetFullPath());
+
+	ImportCacheEntry& entry = importCache[source.GetFullPath()];
+	entry.modification = app->fs->GetLastModification(source.GetFullPath());
+	entry.hash = hash;
+	entry.settings = GetImportSettingsHash(type);
+	entry.uid = uid;
+}
+
+/** M_ResourceManager - HashImportSource: xxHash64 of the contents of the file, 0 if it could not be read. */
+uint64 M_ResourceManager::HashImportSource(const char * file) const
+{
+	char* buffer = nullptr;
+	uint size = app->fs->Load(file, &buffer);
+
+	uint64 ret = 0;
+	if (buffer && size > 0)
+		ret = XXHash64(buffer, size);
+
+	RELEASE_ARRAY(buffer);
+	return ret;
+}
+
+/** M_ResourceManager - GetImportSettingsHash: Hash of everything that changes the result of importing a file of the type. */
+uint64 M_ResourceManager::GetImportSettingsHash(ResourceType type) const
+{
+	int settings[7] = { IMPORT_CACHE_VERSION, type, 0, 0, 0, 0, 0 };
+
+	switch (type)
+	{
+	case RES_TEXTURE:
+		settings[2] = textureImporter->compressionLevel;
+		settings[3] = textureImporter->quality;
+		break;
+	case RES_SCENE:
+		settings[2] = meshImporter->vertexFormat;
+		settings[3] = meshImporter->compressionLevel;
+		settings[4] = MESH_FILE_VERSION;
+		settings[5] = textureImporter->compressionLevel;
+		settings[6] = textureImporter->quality;
+		break;
+	}
+
+	return XXHash64(settings, sizeof(settings));
+}
+
+/** M_ResourceManager - LoadAtlases: Loads the atlas file: the atlases built, where every packed texture lies and the known texture sizes. */
+void M_ResourceManager::LoadAtlases()
+{
+	atlases.clear();
+	retiredAtlases.clear();
+	atlasRegions.clear();
+	textureSizes.clear();
+	atlasHash = 0;
+
+	char* buffer = nullptr;
+	uint size = app->fs->Load((RESOURCES_PATH + atlasFile).c_str(), &buffer);
+
+	if (buffer && size > 0)
+	{
+		JsonFile file(buffer);
+
+		if (file.GetInt("version", 0) == ATLAS_FILE_VERSION)
+		{
+			atlasHash = file.GetUInt64("hash", 0);
+
+			uint count = file.GetArraySize("atlases");
+			for (uint i = 0; i < count; ++i)
+				atlases.push_back(file.GetUInt("atlases", 0, i));
+
+			count = file.GetArraySize("retired");
+			for (uint i = 0; i < count; ++i)
+				retiredAtlases.push_back(file.GetUInt("retired", 0, i));
+
+			count = file.GetArraySize("regions");
+			for (uint i = 0; i < count; ++i)
+			{
+				JsonFile r = file.GetObjectFromArray("regions", i);
+
+				AtlasRegion region;
+				region.atlas = r.GetUInt("atlas", 0);
+				region.offset[0] = r.GetFloat("offset", 0.f, 0);
+				region.offset[1] = r.GetFloat("offset", 0.f, 1);
+				region.scale[0] = r.GetFloat("scale", 1.f, 0);
+				region.scale[1] = r.GetFloat("scale", 1.f, 1);
+
+				if (region.atlas != 0)
+					atlasRegions[r.GetUInt("UID", 0)] = region;
+			}
+
+			count = file.GetArraySize("sizes");
+			for (uint i = 0; i < count; ++i)
+			{
+				JsonFile t = file.GetObjectFromArray("sizes", i);
+				textureSizes[t.GetUInt("UID", 0)] = std::make_pair(t.GetUInt("width", 0), t.GetUInt("height", 0));
+			}
+		}
+	}
+
+	RELEASE_ARRAY(buffer);
+}
+
+/** M_ResourceManager - SaveAtlases: Saves the atlas file. */
+void M_ResourceManager::SaveAtlases()
+{
+	JsonFile save;
+	save.AddInt("version", ATLAS_FILE_VERSION);
+	save.AddUInt64("hash", atlasHash);
+
+	if (!atlases.empty())
+		save.AddUIntArray("atlases", atlases.data(), atlases.size());
+	if (!retiredAtlases.empty())
+		save.AddUIntArray("retired", retiredAtlases.data(), retiredAtlases.size());
+
+	for (std::map<UID, AtlasRegion>::const_iterator it = atlasRegions.begin(); it != atlasRegions.end(); ++it)
+	{
+		JsonFile r;
+		r.AddUInt("UID", it->first);
+		r.AddUInt("atlas", it->second.atlas);
+		r.AddFloatArray("offset", (float*)it->second.offset, 2);
+		r.AddFloatArray("scale", (float*)it->second.scale, 2);
+		save.AppendArrayValue("regions", r.Value());
+	}
+
+	for (std::map<UID, std::pair<uint, uint>>::const_iterator it = textureSizes.begin(); it != textureSizes.end(); ++it)
+	{
+		JsonFile t;
+		t.AddUInt("UID", it->first);
+		t.AddUInt("width", it->second.first);
+		t.AddUInt("height", it->second.second);
+		save.AppendArrayValue("sizes", t.Value());
+	}
+
+	auto buffer = save.Write(true);
+
+	if (app->fs->Save((RESOURCES_PATH + atlasFile).c_str(), buffer.c_str(), buffer.size()) != buffer.size())
+	{
+		_LOG(LOG_ERROR, "Could not save the atlas file!");
+	}
+}
+
+/**
+*	M_ResourceManager - BuildTextureAtlases: Starts a rebuild of the atlases when the textures with both sides up to the threshold or the
+*		settings changed. The textures keep their own files too, for the objects that can not use the atlas (UVs out of 0-1, several
+*		textures). A job decodes the images again from their source files so the atlases are not compressed twice, packs and saves
+*		them. The current atlases are used until FinishTextureAtlases swaps them.
+*/
+void M_ResourceManager::BuildTextureAtlases()
+{
+	atlasesDirty = false;
+
+	if (!textureAtlases)
+		return;
+
+	//Only the textures are created, their sizes come from the file headers
+	FrameVector<UID> textures;
+	GetUIDsOfType(textures, RES_TEXTURE);
+
+	AtlasBuild* build = new AtlasBuild();
+	for (FrameVector<UID>::iterator it = textures.begin(); it != textures.end(); ++it)
+	{
+		ResourceTexture* texture = (ResourceTexture*)GetResourceFromUID(*it);
+		if (!texture || texture == checkers || texture == lenna || !app->fs->Exist(texture->GetOriginalFileFullPath()))
+			continue;
+		if (std::find(atlases.begin(), atlases.end(), *it) != atlases.end())
+			continue;
+
+		uint width, height;
+		if (GetTextureSize(texture, width, height) && width <= atlasThreshold && height <= atlasThreshold)
+		{
+			build->textures.push_back(*it);
+			build->files.push_back(texture->GetOriginalFileFullPath());
+			build->usages.push_back(ImporterTexture::GetUsageFromName(texture->originalFile.GetFileName()));
+		}
+	}
+
+	build->size = atlasSize;
+	build->padding = atlasPadding;
+	build->hash = GetAtlasSettingsHash(build->textures);
+
+	bool upToDate = build->hash == atlasHash;
+	for (std::vector<UID>::iterator it = atlases.begin(); it != atlases.end() && upToDate; ++it)
+	{
+		Resource* atlas = GetResourceFromUID(*it);
+		upToDate = atlas && app->fs->Exist(atlas->GetExportedFileFullPath());
+	}
+
+	if (upToDate)
+	{
+		RELEASE(build);
+		return;
+	}
+
+	atlasBuild = build;
+
+	ImporterTexture* importer = textureImporter;
+	JobSystem::Schedule([build, importer]()
+	{
+		PROFILE_SCOPE("Texture atlases");
+
+		std::vector<AtlasImage> images[2]; //By usage, normal maps go to their own atlases
+		for (uint i = 0; i < build->textures.size(); ++i)
+		{
+			char* buffer = nullptr;
+			uint size = app->fs->Load(build->files[i].c_str(), &buffer);
+
+			AtlasImage image;
+			image.texture = build->textures[i];
+			if (buffer && size > 0 && importer->DecodeImage(buffer, size, image.width, image.height, image.pixels))
+				images[build->usages[i]].push_back(std::move(image));
+
+			RELEASE_ARRAY(buffer);
+		}
+
+		for (uint usage = 0; usage < 2; ++usage)
+		{
+			std::vector<AtlasPage> pages;
+			TextureAtlas::Pack(images[usage], build->size, build->padding, pages);
+			images[usage].clear();
+
+			for (std::vector<AtlasPage>::iterator page = pages.begin(); page != pages.end(); ++page)
+			{
+				Path exported;
+				UID uid = 0;
+				bool saved = importer->SaveCompressed(page->pixels, page->width, page->height, (TextureUsage)usage, TextureAtlas::GetMaxLevels(build->padding), exported, uid);
+
+				page->pixels.clear();
+				page->pixels.shrink_to_fit();
+
+				if (saved)
+				{
+					build->pages.push_back(std::move(*page));
+					build->pageUIDs.push_back(uid);
+					build->pageFiles.push_back(exported.GetFullPath());
+				}
+			}
+		}
+	}, &atlasJobs);
+}
+
+/** M_ResourceManager - FinishTextureAtlases: Adds the atlases saved by the finished rebuild and moves the textures to their regions. The
+												replaced atlases are retired, deleted once no batch uses them. Main thread only. */
+void M_ResourceManager::FinishTextureAtlases()
+{
+	AtlasBuild* build = atlasBuild;
+	atlasBuild = nullptr;
+
+	retiredAtlases.insert(retiredAtlases.end(), atlases.begin(), atlases.end());
+	atlases.clear();
+	atlasRegions.clear();
+
+	for (uint p = 0; p < build->pages.size(); ++p)
+	{
+		const AtlasPage& page = build->pages[p];
+		UID uid = build->pageUIDs[p];
+
+		Path exported;
+		exported.SetFullPath(build->pageFiles[p].c_str());
+
+		Resource* atlas = AddImportedResource(RES_TEXTURE, uid, exported, nullptr);
+		if (atlas)
+			atlas->name = "Atlas " + std::to_string(atlases.size());
+		atlases.push_back(uid);
+
+		for (uint i = 0; i < page.textures.size(); ++i)
+		{
+			AtlasRegion region = page.regions[i];
+			region.atlas = uid;
+			atlasRegions[page.textures[i]] = region;
+		}
+	}
+
+	//The textures not created yet take their region when they are
+	for (std::map<UID, Resource*>::iterator it = resources.begin(); it != resources.end(); ++it)
+	{
+		if (it->second->GetType() == RES_TEXTURE)
+		{
+			std::map<UID, AtlasRegion>::const_iterator region = atlasRegions.find(it->first);
+			((ResourceTexture*)it->second)->atlasRegion = region != atlasRegions.end() ? region->second : AtlasRegion();
+		}
+	}
+
+	atlasHash = build->hash;
+	SaveAtlases();
+
+	_LOG(LOG_INFO, "Texture atlases: Packed %u textures into %u atlases.", atlasRegions.size(), atlases.size());
+
+	RELEASE(build);
+}
+
+/** M_ResourceManager - DeleteRetiredAtlases: Deletes the replaced atlases that no batch uses anymore, with their files. */
+void M_ResourceManager::DeleteRetiredAtlases()
+{
+	uint count = retiredAtlases.size();
+
+	for (std::vector<UID>::iterator it = retiredAtlases.begin(); it != retiredAtlases.end();)
+	{
+		if (DeleteResource(*it))
+			it = retiredAtlases.erase(it);
+		else
+			++it;
+	}
+
+	if (retiredAtlases.size() != count)
+		SaveAtlases();
+}
+
+/** M_ResourceManager - GetTextureSize: Size of the texture from the header of its exported file. False if it could not be read. */
+bool M_ResourceManager::GetTextureSize(const ResourceTexture * texture, uint & width, uint & height)
+{
+	std::map<UID, std::pair<uint, uint>>::const_iterator known = textureSizes.find(texture->GetUID());
+	if (known != textureSizes.end())
+	{
+		width = known->second.first;
+		height = known->second.second;
+		return true;
+	}
+
+	MappedFile file;
+	DDSImage dds;
+	if (!file.Open(texture->GetExportedFileFullPath()) || !ParseDDS(file.GetData(), file.GetSize(), dds))
+		return false;
+
+	width = dds.width;
+	height = dds.height;
+	textureSizes[texture->GetUID()] = std::make_pair(width, height);
+
+	return true;
+}
+
+/** M_ResourceManager - GetAtlasSettingsHash: Hash of the textures to pack and everything that changes the atlases. */
+uint64 M_ResourceManager::GetAtlasSettingsHash(const std::vector<UID>& textures) const
+{
+	std::vector<uint> data(textures.begin(), textures.end());
+	data.push_back(ATLAS_FILE_VERSION);
+	data.push_back(atlasThreshold);
+	data.push_back(atlasSize);
+	data.push_back(atlasPadding);
+	data.push_back(textureImporter->quality);
+	data.push_back(textureImporter->compressionLevel);
+
+	return XXHash64(data.data(), data.size() * sizeof(uint));
 }
 
 /** M_ResourceManager - LoadBasicResources: Create all basic resources such as primitives, checker texture, default shader, etc. */
@@ -377,18 +1444,22 @@ bool M_ResourceManager::LoadBasicResources()
 	checkers = (ResourceTexture*)CreateResource(RES_TEXTURE, 1);
 	if (!textureImporter->LoadChequers(checkers)) return false;
 	checkers->AddInstance();
+	UpdateResidency(checkers);
 
 	cube = (ResourceMesh*)CreateResource(RES_MESH, 2);
 	if (!meshImporter->LoadCube(cube)) return false;
 	cube->AddInstance();
+	UpdateResidency(cube);
 
 	quad = (ResourceMesh*)CreateResource(RES_MESH, 3);
 	if(!meshImporter->LoadQuad(quad)) return false;
 	quad->AddInstance();
+	UpdateResidency(quad);
 
 	plane = (ResourceMesh*)CreateResource(RES_MESH, 4);
 	if (!meshImporter->LoadPlane(plane)) return false;
 	plane->AddInstance();
+	UpdateResidency(plane);
 
 	//sphere = (ResourceMesh*)CreateResource(RES_MESH, 5);
 	//if (!meshImporter->LoadSphere(sphere)) return false;
@@ -397,6 +1468,7 @@ bool M_ResourceManager::LoadBasicResources()
 	defaultShader = (ResourceShader*)CreateResource(RES_SHADER, 6);
 	if (!shaderImporter->PrepareDefaultShader(defaultShader)) return false;
 	defaultShader->AddInstance();
+	UpdateResidency(defaultShader);
 
 	return true;
 }
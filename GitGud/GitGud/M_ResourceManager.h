@@ -2,10 +2,17 @@
 #define __M_RESOURCEMANAGER_H__
 
 #include "Module.h"
+#include "FrameAllocator.h"
+#include "JobSystem.h"
+#include "ResourceRegistry.h"
+#include "TextureAtlas.h"
 
 #include <map>
+#include <list>
 #include <vector>
+#include <deque>
 #include <string>
+#include <mutex>
 
 enum ResourceType;
 
@@ -16,12 +23,29 @@ class ResourceMaterial;
 class ResourceScene;
 class ResourceShader;
 
+struct ResourceMemory;
+struct AtlasBuild;
+
 class ImporterMesh;
 class ImporterTexture;
 class ImporterMaterial;
 class ImporterScene;
 class ImporterShader;
 
+/** Residency of the resources data. Hits are loads of resources already in memory, cached ones included. */
+struct ResidencyStats
+{
+	uint64 hits = 0;
+	uint64 misses = 0;
+	uint64 evictions = 0;
+
+	uint cached = 0;			//Loaded resources without instances.
+	uint64 cpuBytes = 0;		//All the loaded resources, cached ones included.
+	uint64 gpuBytes = 0;
+	uint64 cachedCpuBytes = 0;
+	uint64 cachedGpuBytes = 0;
+};
+
 class M_ResourceManager : public Module
 {
 public:
@@ -35,23 +59,63 @@ public:
 
 	UID ImportFile(const char* fileName, bool checkFirst = false);
 	UID ImportBuf(const void* buffer, ResourceType type, uint size = 0, Path* sourceFile = nullptr);
+	Resource* AddImportedResource(ResourceType type, UID uid, const Path& exportedFile, const Path* sourceFile);
 
 	Resource* GetResourceFromUID(UID uuid);
 	Resource* CreateResource(ResourceType type, UID forceUID = 0);
 
 	Resource* FindResourceFromOriginalFullPath(const char* fullpath);
 
+	bool LoadToMemoryAsync(Resource* resource);
+	void ReleaseResource(Resource* resource);
+	uint GetPendingLoads()const;
+	float GetLastUploadMs()const;
+
 	ResourceType GetTypeFromExtension(const char* ext)const;
 
 	UID GetNewUID()const;
+	void ReserveUIDs(uint count, std::vector<UID>& uids)const;
 
-	void GetResourcesOfType(std::vector<Resource*>& res, ResourceType type)const;
+	void GetResourcesOfType(std::vector<Resource*>& res, ResourceType type);
+	void GetUIDsOfType(FrameVector<UID>& uids, ResourceType type)const;
+	void GetMemoryUsage(ResourceMemory& memory)const;
+	const ResidencyStats& GetResidencyStats()const;
+	uint64 GetCpuBudget()const;
+	uint64 GetGpuBudget()const;
 
 private:
 	void LoadResources();
 	void SaveResources();
+	void LoadResourcesJson();
+	void ExportResourcesJson();
+	Resource* NewResource(ResourceType type, UID uid);
+	bool DeleteResource(UID uid);
+	Resource* Materialize(const RegistryEntry& entry);
+	void MaterializeAll();
 	bool LoadBasicResources();
 
+	void UploadLoadedResources();
+	void EnforceBudgets();
+	void UpdateResidency(Resource* resource);
+	void AddUnreferenced(Resource* resource);
+	bool RemoveUnreferenced(Resource* resource);
+	static void GetResidentBytes(const Resource* resource, uint64& cpu, uint64& gpu);
+
+	void LoadImportCache();
+	void SaveImportCache();
+	UID FindInImportCache(const Path& source, ResourceType type, uint64& hash);
+	void AddToImportCache(const Path& source, ResourceType type, UID uid, uint64 hash);
+	uint64 HashImportSource(const char* file)const;
+	uint64 GetImportSettingsHash(ResourceType type)const;
+
+	void LoadAtlases();
+	void SaveAtlases();
+	void BuildTextureAtlases();
+	void FinishTextureAtlases();
+	void DeleteRetiredAtlases();
+	bool GetTextureSize(const ResourceTexture* texture, uint& width, uint& height);
+	uint64 GetAtlasSettingsHash(const std::vector<UID>& textures)const;
+
 public:
 	ImporterMesh*		meshImporter = nullptr;
 	ImporterTexture*	textureImporter = nullptr;
@@ -77,9 +141,63 @@ public:
 	ResourceShader* normalsDebugShader = nullptr;
 
 private:
-	std::string resourceFile;
-	std::map<UID, Resource*> resources;
-
+	std::string resourceFile;			//Json export of the resources, also loaded when there is no registry yet.
+	std::string registryFile;
+	std::map<UID, Resource*> resources;	//Created resources, the registry ones are only created when first used.
+
+	ResourceRegistry registry;
+	std::vector<UID> unsavedResources;	//Created since the last save, appended to the registry journal.
+	std::vector<UID> deletedResources;	//Since the last save, never created again. The registry is rewritten without them.
+	bool allMaterialized = false;
+	bool exportJson = false;
+
+	mutable std::mutex uidMutex; //The random generator is not thread safe.
+
+	/** Source file of an import as it was when imported. */
+	struct ImportCacheEntry
+	{
+		double modification = 0.0;
+		uint64 hash = 0;		//Of the contents.
+		uint64 settings = 0;	//Hash of the importer settings used.
+		UID uid = 0;
+	};
+
+	std::string importCacheFile;
+	std::map<std::string, ImportCacheEntry> importCache;	//By source path.
+
+	bool textureAtlases = false;	//Packs the small textures into atlases after they are imported.
+	uint atlasThreshold = 128;		//Textures with both sides up to it are packed.
+	uint atlasSize = 2048;
+	uint atlasPadding = 8;
+	bool atlasesDirty = false;		//Textures were imported since the atlases were built.
+	uint64 atlasHash = 0;			//Of the packed textures and the settings used.
+	std::string atlasFile;
+	std::vector<UID> atlases;
+	std::vector<UID> retiredAtlases;	//Replaced by a rebuild, deleted once no batch uses them.
+	AtlasBuild* atlasBuild = nullptr;	//Rebuild in flight, owned by its job until atlasJobs is done.
+	JobCounter atlasJobs;
+	std::map<UID, AtlasRegion> atlasRegions;				//By texture.
+	std::map<UID, std::pair<uint, uint>> textureSizes;	//Read from the exported files, so each is only read once.
+
+	/** Resource read by a worker, waiting for its upload. */
+	struct AsyncLoad
+	{
+		Resource* resource = nullptr;
+		bool read = false;
+	};
+
+	JobCounter loadJobs;
+	std::mutex uploadsMutex;
+	std::deque<AsyncLoad> uploads;	//Guarded by the mutex, filled by the workers.
+	uint pendingLoads = 0;			//Loads started and not uploaded yet.
+	float uploadBudgetMs = 2.f;		//Time per frame for the uploads, at least one is done every frame.
+	float lastUploadMs = 0.f;
+
+	std::list<Resource*> unreferenced;	//Loaded resources without instances, the most recently released first. Evicted from the back.
+	std::map<Resource*, std::list<Resource*>::iterator> unreferencedPos;
+	uint64 cpuBudget = 0;
+	uint64 gpuBudget = 0;
+	ResidencyStats residency;			//The byte totals are kept up to date on every load state change.
 
 };
 
@@ -1,6 +1,7 @@
 #include <stdlib.h>
 #include "Globals.h"
 #include "App.h"
+#include "Logger.h"
 
 
 #ifdef _DEBUG
@@ -22,6 +23,8 @@ App* app = nullptr;
 
 int main(int argc, char** argv)
 {
+	Logger::Start();
+
 	_LOG(LOG_INFO, "Starting engine %s from 'Josef21296'.", APP_TITLE);
 
 	int mainRet = EXIT_FAILURE;
@@ -98,6 +101,7 @@ int main(int argc, char** argv)
 	_LOG(LOG_INFO, "Exiting game engine! GITGUD :)");
 #endif // _DEBUG
 
+	Logger::Stop();
 
 	return mainRet;
 }
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include "MappedFile.h"
+
+#include "App.h"
+#include "M_FileSystem.h"
+#include "Compression.h"
+
+#include <string>
+
+MappedFile::MappedFile()
+{}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+/** MappedFile - Open: Maps the file, a path of the file system. Compressed library files are decompressed into memory,
+	adding the decoding to the stats if any. */
+bool MappedFile::Open(const char * fileName, CompressionStats* stats)
+{
+	if (!OpenRaw(fileName))
+		return false;
+
+	if (!Compression::IsCompressed(data, size))
+		return true;
+
+	uint rawSize = Compression::GetRawSize(data, size);
+	char* decoded = new char[rawSize + 15];
+	char* decodedData = (char*)(((size_t)decoded + 15) & ~(size_t)15);
+
+	bool ret = Compression::Decompress(data, size, decodedData, rawSize, stats);
+	Close();
+
+	if (!ret)
+	{
+		_LOG(LOG_ERROR, "Error decompressing '%s'. The file is corrupted.", fileName);
+		RELEASE_ARRAY(decoded);
+		return false;
+	}
+
+	buffer = decoded;
+	data = decodedData;
+	size = rawSize;
+	compressed = true;
+
+	return true;
+}
+
+/** MappedFile - OpenRaw: Maps the file. Falls back to reading it if it is not on a real directory. */
+bool MappedFile::OpenRaw(const char * fileName)
+{
+	Close();
+
+	std::string realPath;
+	if (app->fs->GetRealPath(fileName, realPath))
+	{
+		file = CreateFileA(realPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file != INVALID_HANDLE_VALUE)
+		{
+			LARGE_INTEGER fileSize;
+			if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0 && fileSize.QuadPart <= 0xFFFFFFFF)
+			{
+				mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+				if (mapping)
+					view = (char*)MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+			}
+
+			if (view)
+			{
+				data = view;
+				size = (uint)fileSize.QuadPart;
+				return true;
+			}
+
+			Close();
+		}
+	}
+
+	//Archives or mapping errors
+	char* loaded = nullptr;
+	uint loadedSize = app->fs->Load(fileName, &loaded);
+	if (loaded == nullptr || loadedSize == 0)
+	{
+		RELEASE_ARRAY(loaded);
+		return false;
+	}
+
+	if (((size_t)loaded & 15) == 0)
+	{
+		buffer = loaded;
+		data = buffer;
+	}
+	else
+	{
+		//32 bit heaps only align to 8 bytes
+		buffer = new char[loadedSize + 15];
+		data = (char*)(((size_t)buffer + 15) & ~(size_t)15);
+		memcpy(data, loaded, loadedSize);
+		RELEASE_ARRAY(loaded);
+	}
+	size = loadedSize;
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (view)
+		UnmapViewOfFile(view);
+	if (mapping)
+		CloseHandle(mapping);
+	if (file != INVALID_HANDLE_VALUE)
+		CloseHandle(file);
+
+	view = nullptr;
+	mapping = nullptr;
+	file = INVALID_HANDLE_VALUE;
+
+	RELEASE_ARRAY(buffer);
+
+	data = nullptr;
+	size = 0;
+	compressed = false;
+}
+
+char * MappedFile::GetData() const
+{
+	return data;
+}
+
+uint MappedFile::GetSize() const
+{
+	return size;
+}
+
+/** MappedFile - IsMapped: False if the file had to be read into memory. */
+bool MappedFile::IsMapped() const
+{
+	return view != nullptr;
+}
+
+/** MappedFile - IsCompressed: True if the file was compressed, the data is the decompressed copy. */
+bool MappedFile::IsCompressed() const
+{
+	return compressed;
+}
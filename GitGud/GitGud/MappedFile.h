@@ -0,0 +1,43 @@
+#ifndef __MAPPED_FILE_H__
+#define __MAPPED_FILE_H__
+
+#include "Globals.h"
+
+struct CompressionStats;
+
+/**
+*	- Read only view of a whole file. Files on a real directory are memory mapped (copy on write, so writing the data never
+*	  reaches the file); files inside an archive are read into a 16 byte aligned buffer through the file system.
+*	- The data is aligned to 16 bytes in both cases, so aligned sections of the file can be used in place.
+*	- Compressed library files are decompressed on open into an aligned buffer, the same for the users of the data.
+*/
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	bool Open(const char* file, CompressionStats* stats = nullptr);
+	void Close();
+
+	char* GetData()const;
+	uint GetSize()const;
+	bool IsMapped()const;
+	bool IsCompressed()const;
+
+private:
+	bool OpenRaw(const char* file);
+
+private:
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = nullptr;
+	char* view = nullptr;
+
+	char* buffer = nullptr; //Only if the file could not be mapped or was compressed.
+
+	char* data = nullptr;
+	uint size = 0;
+	bool compressed = false;
+};
+
+#endif // !__MAPPED_FILE_H__
@@ -2,6 +2,7 @@
 
 #include "App.h"
 #include "M_ResourceManager.h"
+#include "M_Renderer.h"
 #include "Resource.h"
 #include "GameObject.h"
 
@@ -23,3 +24,10 @@ void Material::OnSaveCmp(JsonFile & sect) const
 void Material::OnLoadCmp(JsonFile * sect)
 {
 }
+
+/** Material - OnResourceChanged: Static objects are batched by material, so they must be batched again. */
+void Material::OnResourceChanged()
+{
+	if (object->IsStatic())
+		app->renderer->AddStaticObject(object);
+}
@@ -13,6 +13,8 @@ public:
 	void OnSaveCmp(JsonFile& sect)const override;
 	void OnLoadCmp(JsonFile* sect)override;
 
+	void OnResourceChanged()override;
+
 	ComponentType GetComponentType()override { return type; }
 };
 
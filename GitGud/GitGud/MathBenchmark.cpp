@@ -0,0 +1,289 @@
+#include "MathBenchmark.h"
+
+#include "App.h"
+#include "JsonFile.h"
+#include "M_FileSystem.h"
+#include "PerfTimer.h"
+#include "Math.h"
+
+#include <algorithm>
+
+//Aligned as the SIMD builds need 16 byte aligned math types
+template<typename T>
+using MathBenchVector = std::vector<T, AlignedAllocator<T, 16>>;
+
+/** Random input shared by all the benchmarks. Results go to their own arrays so the work can't be optimized away. */
+struct MathBenchData
+{
+	MathBenchVector<float3> positions;
+	MathBenchVector<Quat> rotations;
+	MathBenchVector<float3> scales;
+	MathBenchVector<float4x4> matrices;
+	MathBenchVector<float4x4> results;
+	MathBenchVector<OBB> obbs;
+	MathBenchVector<AABB> aabbs;
+	MathBenchVector<LineSegment> segments;
+	MathBenchVector<Triangle> triangles;
+	Frustum frustum;
+
+	void Generate(uint count, uint seed)
+	{
+		LCG lcg(seed);
+
+		positions.resize(count);
+		rotations.resize(count);
+		scales.resize(count);
+		matrices.resize(count);
+		results.resize(count);
+		obbs.resize(count);
+		aabbs.resize(count);
+		segments.resize(count);
+		triangles.resize(count);
+
+		for (uint i = 0; i < count; ++i)
+		{
+			positions[i] = float3(lcg.Float(-50.f, 50.f), lcg.Float(-10.f, 10.f), lcg.Float(-50.f, 50.f));
+			rotations[i] = Quat::FromEulerXYZ(lcg.Float(0.f, 2.f * pi), lcg.Float(0.f, 2.f * pi), lcg.Float(0.f, 2.f * pi));
+			scales[i] = float3::one * lcg.Float(0.5f, 2.f);
+			matrices[i] = float4x4::FromTRS(positions[i], rotations[i], scales[i]);
+
+			aabbs[i] = AABB::FromCenterAndSize(positions[i], scales[i]);
+			obbs[i] = aabbs[i];
+
+			segments[i] = LineSegment(float3(lcg.Float(-1.f, 1.f), 10.f, lcg.Float(-1.f, 1.f)), float3(lcg.Float(-1.f, 1.f), -10.f, lcg.Float(-1.f, 1.f)));
+			triangles[i] = Triangle(float3(lcg.Float(-2.f, 0.f), 0.f, lcg.Float(-2.f, 0.f)), float3(lcg.Float(0.f, 2.f), 0.f, lcg.Float(-2.f, 0.f)),
+				float3(lcg.Float(-1.f, 1.f), 0.f, lcg.Float(0.f, 2.f)));
+		}
+
+		//Same setup as the editor camera
+		frustum.SetKind(FrustumSpaceGL, FrustumRightHanded);
+		frustum.SetFrame(float3(0.f, 5.f, -40.f), float3::unitZ, float3::unitY);
+		frustum.SetViewPlaneDistances(1.f, 100.f);
+		frustum.SetVerticalFovAndAspectRatio(45.f * DEGTORAD, 16.f / 9.f);
+	}
+};
+
+typedef float(*MathBenchFunction)(MathBenchData& data, uint count);
+
+static float BenchFromTRS(MathBenchData& data, uint count)
+{
+	for (uint i = 0; i < count; ++i)
+		data.results[i] = float4x4::FromTRS(data.positions[i], data.rotations[i], data.scales[i]);
+	return data.results[count - 1][0][3];
+}
+
+static float BenchMatrixMul(MathBenchData& data, uint count)
+{
+	for (uint i = 1; i < count; ++i)
+		data.results[i] = data.matrices[i - 1] * data.matrices[i];
+	return data.results[count - 1][0][3];
+}
+
+static float BenchTransposed(MathBenchData& data, uint count)
+{
+	for (uint i = 0; i < count; ++i)
+		data.results[i] = data.matrices[i].Transposed();
+	return data.results[count - 1][0][3];
+}
+
+static float BenchInverted(MathBenchData& data, uint count)
+{
+	for (uint i = 0; i < count; ++i)
+		data.results[i] = data.matrices[i].Inverted();
+	return data.results[count - 1][0][3];
+}
+
+static float BenchOBBTransform(MathBenchData& data, uint count)
+{
+	float ret = 0.f;
+	for (uint i = 0; i < count; ++i)
+	{
+		OBB obb = data.obbs[i];
+		obb.Transform(data.matrices[i]);
+		ret += obb.pos.x;
+	}
+	return ret;
+}
+
+static float BenchAABBFromOBB(MathBenchData& data, uint count)
+{
+	float ret = 0.f;
+	AABB aabb;
+	for (uint i = 0; i < count; ++i)
+	{
+		aabb.SetFrom(data.obbs[i]);
+		ret += aabb.minPoint.x;
+	}
+	return ret;
+}
+
+static float BenchFrustumAABB(MathBenchData& data, uint count)
+{
+	uint visible = 0;
+	for (uint i = 0; i < count; ++i)
+		visible += data.frustum.Intersects(data.aabbs[i]) ? 1 : 0;
+	return (float)visible;
+}
+
+static float BenchSegmentTriangle(MathBenchData& data, uint count)
+{
+	float ret = 0.f;
+	float distance;
+	float3 hit;
+	for (uint i = 0; i < count; ++i)
+	{
+		if (data.segments[i].Intersects(data.triangles[i], &distance, &hit))
+			ret += distance;
+	}
+	return ret;
+}
+
+static float BenchQuatMul(MathBenchData& data, uint count)
+{
+	Quat q = Quat::identity;
+	for (uint i = 0; i < count; ++i)
+		q = q * data.rotations[i];
+	return q.w;
+}
+
+static float BenchQuatTransform(MathBenchData& data, uint count)
+{
+	float ret = 0.f;
+	for (uint i = 0; i < count; ++i)
+		ret += data.rotations[i].Transform(data.positions[i]).x;
+	return ret;
+}
+
+static float BenchQuatSlerp(MathBenchData& data, uint count)
+{
+	float ret = 0.f;
+	for (uint i = 1; i < count; ++i)
+		ret += data.rotations[i - 1].Slerp(data.rotations[i], 0.5f).w;
+	return ret;
+}
+
+struct MathBench
+{
+	const char* name;
+	MathBenchFunction function;
+};
+
+static const MathBench benchmarks[] =
+{
+	{ "float4x4::FromTRS", BenchFromTRS },
+	{ "float4x4 * float4x4", BenchMatrixMul },
+	{ "float4x4::Transposed", BenchTransposed },
+	{ "float4x4::Inverted", BenchInverted },
+	{ "OBB::Transform", BenchOBBTransform },
+	{ "AABB::SetFrom(OBB)", BenchAABBFromOBB },
+	{ "Frustum::Intersects(AABB)", BenchFrustumAABB },
+	{ "LineSegment::Intersects(Triangle)", BenchSegmentTriangle },
+	{ "Quat * Quat", BenchQuatMul },
+	{ "Quat::Transform(float3)", BenchQuatTransform },
+	{ "Quat::Slerp", BenchQuatSlerp }
+};
+
+//=============================================================================
+
+/** MathBenchmark - Run: Runs every benchmark on the calling thread, it blocks for a while with big batches. */
+void MathBenchmark::Run(const MathBenchSettings & settings, std::vector<MathBenchResult>& results)
+{
+	results.clear();
+
+	uint count = MAX(2u, settings.batch);
+	uint repetitions = MAX(1u, settings.repetitions);
+
+	MathBenchData data;
+	data.Generate(count, settings.seed);
+
+	const double ticksToNs = 1000000000.0 / (double)PerfTimer::GetFrequency() / (double)count;
+	std::vector<double> times(repetitions);
+	volatile float sink = 0.f;
+
+	for (uint b = 0; b < sizeof(benchmarks) / sizeof(benchmarks[0]); ++b)
+	{
+		for (uint i = 0; i < settings.warmup; ++i)
+			sink = sink + benchmarks[b].function(data, count);
+
+		for (uint i = 0; i < repetitions; ++i)
+		{
+			PerfTimer timer;
+			sink = sink + benchmarks[b].function(data, count);
+			times[i] = timer.ReadTicks() * ticksToNs;
+		}
+
+		std::sort(times.begin(), times.end());
+
+		MathBenchResult result;
+		result.name = benchmarks[b].name;
+		result.minNs = times.front();
+		result.maxNs = times.back();
+		result.medianNs = (repetitions % 2) ? times[repetitions / 2] : (times[repetitions / 2 - 1] + times[repetitions / 2]) * 0.5;
+		for (uint i = 0; i < repetitions; ++i)
+			result.meanNs += times[i];
+		result.meanNs /= repetitions;
+
+		results.push_back(result);
+	}
+}
+
+/** MathBenchmark - Save: Saves the build config, the settings and the results as json. */
+bool MathBenchmark::Save(const char * file, const MathBenchSettings & settings, const std::vector<MathBenchResult>& results)
+{
+	JsonFile json;
+	json.AddString("simd", GetSimdLevel());
+	json.AddBool("automatic_simd", IsAutomaticSimd());
+	json.AddUInt("batch", settings.batch);
+	json.AddUInt("warmup", settings.warmup);
+	json.AddUInt("repetitions", settings.repetitions);
+	json.AddUInt("seed", settings.seed);
+
+	JsonFile benchs;
+	for (std::vector<MathBenchResult>::const_iterator it = results.begin(); it != results.end(); ++it)
+	{
+		JsonFile bench;
+		bench.AddDouble("median_ns", it->medianNs);
+		bench.AddDouble("min_ns", it->minNs);
+		bench.AddDouble("max_ns", it->maxNs);
+		bench.AddDouble("mean_ns", it->meanNs);
+		benchs.AddSection(it->name.c_str(), bench);
+	}
+	json.AddSection("results", benchs);
+
+	std::string buffer = json.Write(true);
+	bool ret = app->fs->Save(file, buffer.c_str(), buffer.size()) == buffer.size();
+	if (ret)
+		_LOG(LOG_INFO, "Math benchmark: Results saved to [%s].", file);
+
+	return ret;
+}
+
+/** MathBenchmark - GetSimdLevel: Instruction set MathGeoLib was compiled with. */
+const char * MathBenchmark::GetSimdLevel()
+{
+#if defined(MATH_AVX)
+	return "AVX";
+#elif defined(MATH_SSE41)
+	return "SSE4.1";
+#elif defined(MATH_SSE3)
+	return "SSE3";
+#elif defined(MATH_SSE2)
+	return "SSE2";
+#elif defined(MATH_SSE)
+	return "SSE";
+#elif defined(MATH_NEON)
+	return "NEON";
+#else
+	return "Scalar";
+#endif
+}
+
+/** MathBenchmark - IsAutomaticSimd: True if the math classes take their SIMD paths (float4x4_sse.h...) by default. */
+bool MathBenchmark::IsAutomaticSimd()
+{
+#if defined(MATH_AUTOMATIC_SSE) && defined(MATH_SIMD)
+	return true;
+#else
+	return false;
+#endif
+}
@@ -0,0 +1,42 @@
+#ifndef __MATH_BENCHMARK_H__
+#define __MATH_BENCHMARK_H__
+
+#include "Globals.h"
+#include <vector>
+#include <string>
+
+struct MathBenchSettings
+{
+	uint batch = 4096;		//Operations per repetition, about the objects of a big scene.
+	uint warmup = 3;		//Repetitions run before measuring.
+	uint repetitions = 15;
+	uint seed = 1;
+};
+
+/** Time per operation of a benchmark, over its measured repetitions. */
+struct MathBenchResult
+{
+	std::string name;
+	double medianNs = 0.0;
+	double minNs = 0.0;
+	double maxNs = 0.0;
+	double meanNs = 0.0;
+};
+
+/**
+*	- Microbenchmarks of the MathGeoLib operations the engine runs every frame: transforms, boxes, culling, picking and rotations.
+*	- Each benchmark runs over a batch of seeded random data, warmed up first and then repeated, the median per operation
+*	  is the stable figure to compare.
+*	- The SIMD level MathGeoLib was built with comes from MathBuildConfig.h (GG_MATH_SIMD), run it in both builds to compare.
+*/
+class MathBenchmark
+{
+public:
+	static void Run(const MathBenchSettings& settings, std::vector<MathBenchResult>& results);
+	static bool Save(const char* file, const MathBenchSettings& settings, const std::vector<MathBenchResult>& results);
+
+	static const char* GetSimdLevel();
+	static bool IsAutomaticSimd();
+};
+
+#endif // !__MATH_BENCHMARK_H__
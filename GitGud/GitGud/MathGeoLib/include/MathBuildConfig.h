@@ -140,6 +140,12 @@
 //#define MATH_SSE2
 //#define MATH_SSE // SSE1.
 
+// GitGud: Define GG_MATH_SIMD in the project to build with SSE2 and compare with bench_math against the scalar build.
+// The SIMD types need 16 byte alignment, so objects holding them must be allocated aligned.
+#ifdef GG_MATH_SIMD
+#define MATH_SSE2
+#endif
+
 ///\todo Test iOS support.
 ///\todo Enable NEON only on ARMv7, not older.
 //#if (defined(ANDROID) && defined(__ARM_ARCH_7A__)) || (defined(WIN8RT) && defined(_M_ARM))
@@ -0,0 +1,196 @@
+#include "MemoryTracker.h"
+
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+#define MEMORY_HEADER_SIZE 16 //Keeps the alignment malloc gives.
+
+struct MemoryTagCounters
+{
+	std::atomic<uint64> bytes;
+	std::atomic<uint64> peakBytes;
+	std::atomic<uint64> allocations;
+	std::atomic<uint64> totalAllocations;
+};
+
+//Zero initialized before any allocation can happen, as they are constant initialized statics
+static MemoryTagCounters counters[MEM_TAG_COUNT];
+static thread_local MemoryTag currentTag = MEM_OTHER;
+static thread_local uint64 threadAllocations = 0;
+
+/** MemoryTracker - Alloc: Allocates the memory with a header holding its size and tag, so Free can count it back. */
+void * MemoryTracker::Alloc(size_t size, MemoryTag tag)
+{
+	char* block = (char*)malloc(size + MEMORY_HEADER_SIZE);
+	if (block == nullptr)
+		return nullptr;
+
+	*(size_t*)block = size;
+	*(MemoryTag*)(block + sizeof(size_t)) = tag;
+
+	OnAlloc(tag, size);
+	return block + MEMORY_HEADER_SIZE;
+}
+
+/** MemoryTracker - Free: Frees memory allocated with Alloc, counting it against the tag it was allocated with. */
+void MemoryTracker::Free(void * ptr)
+{
+	if (ptr == nullptr)
+		return;
+
+	char* block = (char*)ptr - MEMORY_HEADER_SIZE;
+	OnFree(*(MemoryTag*)(block + sizeof(size_t)), *(size_t*)block);
+	free(block);
+}
+
+void MemoryTracker::OnAlloc(MemoryTag tag, size_t size)
+{
+	MemoryTagCounters& c = counters[tag];
+
+	uint64 bytes = c.bytes.fetch_add(size, std::memory_order_relaxed) + size;
+	c.allocations.fetch_add(1, std::memory_order_relaxed);
+	c.totalAllocations.fetch_add(1, std::memory_order_relaxed);
+	++threadAllocations;
+
+	uint64 peak = c.peakBytes.load(std::memory_order_relaxed);
+	while (bytes > peak && !c.peakBytes.compare_exchange_weak(peak, bytes, std::memory_order_relaxed))
+	{}
+}
+
+void MemoryTracker::OnFree(MemoryTag tag, size_t size)
+{
+	MemoryTagCounters& c = counters[tag];
+
+	c.bytes.fetch_sub(size, std::memory_order_relaxed);
+	c.allocations.fetch_sub(1, std::memory_order_relaxed);
+}
+
+MemoryTag MemoryTracker::GetCurrentTag()
+{
+	return currentTag;
+}
+
+/** MemoryTracker - SetCurrentTag: Sets the tag of the next allocations of the calling thread and returns the previous one. */
+MemoryTag MemoryTracker::SetCurrentTag(MemoryTag tag)
+{
+	MemoryTag previous = currentTag;
+	currentTag = tag;
+	return previous;
+}
+
+/** MemoryTracker - GetThreadAllocations: Allocations the calling thread has made since it started. */
+uint64 MemoryTracker::GetThreadAllocations()
+{
+	return threadAllocations;
+}
+
+void MemoryTracker::GetStats(MemoryTag tag, MemoryTagStats & stats)
+{
+	const MemoryTagCounters& c = counters[tag];
+
+	stats.bytes = c.bytes.load(std::memory_order_relaxed);
+	stats.peakBytes = c.peakBytes.load(std::memory_order_relaxed);
+	stats.allocations = c.allocations.load(std::memory_order_relaxed);
+	stats.totalAllocations = c.totalAllocations.load(std::memory_order_relaxed);
+}
+
+/** MemoryTracker - GetTotal: Sum of all the tags. The peak is the sum of the tag peaks, an upper bound of the real one. */
+void MemoryTracker::GetTotal(MemoryTagStats & stats)
+{
+	stats = MemoryTagStats();
+
+	for (uint i = 0; i < MEM_TAG_COUNT; ++i)
+	{
+		MemoryTagStats tag;
+		GetStats((MemoryTag)i, tag);
+
+		stats.bytes += tag.bytes;
+		stats.peakBytes += tag.peakBytes;
+		stats.allocations += tag.allocations;
+		stats.totalAllocations += tag.totalAllocations;
+	}
+}
+
+const char * MemoryTracker::GetTagName(MemoryTag tag)
+{
+	switch (tag)
+	{
+	case MEM_OTHER: return "Other";
+	case MEM_SCENE: return "Scene";
+	case MEM_MESHES: return "Resources/Meshes";
+	case MEM_TEXTURES: return "Resources/Textures";
+	case MEM_EDITOR: return "Editor";
+	case MEM_JSON: return "Json";
+	case MEM_FS_BUFFERS: return "FS buffers";
+	}
+	return "Unknown";
+}
+
+/** MemoryTracker - IsTrackingNew: True if every new and delete is counted, false if only the explicit allocations are. */
+bool MemoryTracker::IsTrackingNew()
+{
+	return GG_MEMORY_TRACK_NEW != 0;
+}
+
+//=============================================================================
+
+#if GG_MEMORY_TRACK_NEW
+
+void* operator new(size_t size)
+{
+	void* ret = MemoryTracker::Alloc(size, currentTag);
+	if (ret == nullptr)
+		throw std::bad_alloc();
+	return ret;
+}
+
+void* operator new[](size_t size)
+{
+	void* ret = MemoryTracker::Alloc(size, currentTag);
+	if (ret == nullptr)
+		throw std::bad_alloc();
+	return ret;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return MemoryTracker::Alloc(size, currentTag);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return MemoryTracker::Alloc(size, currentTag);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	MemoryTracker::Free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	MemoryTracker::Free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+	MemoryTracker::Free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+	MemoryTracker::Free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+	MemoryTracker::Free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+	MemoryTracker::Free(ptr);
+}
+
+#endif // GG_MEMORY_TRACK_NEW
@@ -0,0 +1,98 @@
+#ifndef __MEMORY_TRACKER_H__
+#define __MEMORY_TRACKER_H__
+
+#include "Globals.h"
+
+//Define GG_MEMORY_TRACKING as 0 to compile the tracker out. Debug builds count only the explicit allocations, as mmgr owns
+//the global new and delete there.
+#ifndef GG_MEMORY_TRACKING
+#define GG_MEMORY_TRACKING 1
+#endif
+
+#if GG_MEMORY_TRACKING && !defined(_DEBUG)
+#define GG_MEMORY_TRACK_NEW 1
+#else
+#define GG_MEMORY_TRACK_NEW 0
+#endif
+
+#if GG_MEMORY_TRACKING
+#define MEMORY_TAG_CONCAT_IMPL(a, b) a##b
+#define MEMORY_TAG_CONCAT(a, b) MEMORY_TAG_CONCAT_IMPL(a, b)
+#define MEMORY_TAG(tag) MemoryTagScope MEMORY_TAG_CONCAT(memoryTag, __LINE__)(tag)
+#else
+#define MEMORY_TAG(tag)
+#endif
+
+enum MemoryTag
+{
+	MEM_OTHER,
+	MEM_SCENE,
+	MEM_MESHES,
+	MEM_TEXTURES,
+	MEM_EDITOR,
+	MEM_JSON,
+	MEM_FS_BUFFERS,
+	MEM_TAG_COUNT
+};
+
+struct MemoryTagStats
+{
+	uint64 bytes = 0;			//Live bytes.
+	uint64 peakBytes = 0;
+	uint64 allocations = 0;		//Live allocations.
+	uint64 totalAllocations = 0;
+};
+
+/** Memory held by the loaded resources, counted from their data instead of their allocations. */
+struct ResourceMemory
+{
+	uint meshes = 0;
+	uint64 meshCpuBytes = 0;
+	uint64 meshVramBytes = 0;
+
+	uint textures = 0;
+	uint64 textureVramBytes = 0; //Every uploaded level at its GPU size, the pixels are not kept on the CPU once uploaded.
+};
+
+/**
+*	- Counts the live bytes and allocations per tag with atomic counters, cheap enough for release builds.
+*	- Release builds replace the global new and delete: every allocation carries a small header with its size and the tag of
+*	  the scope it was made in (MEMORY_TAG), untagged ones go to MEM_OTHER. Frees are counted against the allocation tag.
+*	- Allocations not made through new (ImGui...) can go through Alloc and Free with an explicit tag, in any build.
+*/
+class MemoryTracker
+{
+public:
+	static void* Alloc(size_t size, MemoryTag tag);
+	static void Free(void* ptr);
+
+	static void OnAlloc(MemoryTag tag, size_t size);
+	static void OnFree(MemoryTag tag, size_t size);
+
+	static MemoryTag GetCurrentTag();
+	static MemoryTag SetCurrentTag(MemoryTag tag);
+
+	static uint64 GetThreadAllocations();
+
+	static void GetStats(MemoryTag tag, MemoryTagStats& stats);
+	static void GetTotal(MemoryTagStats& stats);
+	static const char* GetTagName(MemoryTag tag);
+	static bool IsTrackingNew();
+};
+
+/** Tags the allocations made on the calling thread while alive. Use it through MEMORY_TAG. */
+class MemoryTagScope
+{
+public:
+	MemoryTagScope(MemoryTag tag) : previous(MemoryTracker::SetCurrentTag(tag))
+	{}
+	~MemoryTagScope()
+	{
+		MemoryTracker::SetCurrentTag(previous);
+	}
+
+private:
+	MemoryTag previous;
+};
+
+#endif // !__MEMORY_TRACKER_H__
@@ -4,6 +4,7 @@
 #include "GameObject.h"
 #include "ResourceMesh.h"
 #include "M_ResourceManager.h"
+#include "M_Renderer.h"
 
 #include "DrawDebugTools.h"
 
@@ -18,19 +19,21 @@ Mesh::~Mesh()
 	ClearMesh();
 }
 
-/** Mesh - GetBox: Recalculate the AABB passed according to the mesh AABB. */
+/** Mesh - GetBox: Recalculate the AABB passed according to the mesh AABB. While the mesh is loading uses the placeholder cube one. */
 void Mesh::GetBox(AABB & box) const
 {
 	ResourceMesh* r = (ResourceMesh*)app->resources->GetResourceFromUID(resource);
-	if (r && r->vertices)
+	if (r && r->IsReady())
 		box.Enclose(r->aabb);
+	else if (r && r->GetLoadState() == RES_LOADING && app->resources->cube)
+		box.Enclose(app->resources->cube->aabb);
 }
 
-/** Mesh - ClearMesh: Remove an instance of the resource. */
+/** Mesh - ClearMesh: Release an instance of the resource. The last one keeps the data cached until the resource budgets need it. */
 void Mesh::ClearMesh()
 {
 	Resource* m = GetResource();
-	if (m) { m->RemoveInstance(); resource = 0; }
+	if (m) { app->resources->ReleaseResource(m); resource = 0; }
 }
 
 /** Mesh - OnSaveCmp: Saves the mesh resource info into the GO save file. */
@@ -68,6 +71,25 @@ void Mesh::OnLoadCmp(JsonFile * sect)
 void Mesh::OnResourceChanged()
 {
 	ClearMesh(); //Before changing the mesh resource, clear the current one.
+
+	if (object->IsStatic())
+		app->renderer->AddStaticObject(object); //Batches pick the new mesh before the next draw.
+
+	waitingLoad = true;
+}
+
+/** Mesh - OnPreUpdate: Refreshes the object box once the mesh resource finishes loading, the placeholder one was used until then. */
+void Mesh::OnPreUpdate(float dt)
+{
+	if (waitingLoad)
+	{
+		Resource* r = GetResource();
+		if (r == nullptr || r->GetLoadState() != RES_LOADING)
+		{
+			waitingLoad = false;
+			object->RefreshBox(); //Static objects are batched again with the loaded mesh
+		}
+	}
 }
 
 //-------------------------------------
@@ -24,6 +24,8 @@ public:
 
 	void OnResourceChanged()override;
 
+	void OnPreUpdate(float dt)override;
+
 	void OnDebugDraw() override;
 
 	ComponentType GetComponentType()override { return type; }
@@ -36,6 +38,7 @@ public:
 
 private:
 	bool onVRAM = false;
+	bool waitingLoad = false; //The box must be refreshed once the resource finishes loading.
 
 };
 
@@ -43,3 +43,11 @@ uint64 PerfTimer::ReadTicks() const
 	else
 		return stopedAt - startedAt;
 }
+
+uint64 PerfTimer::GetFrequency()
+{
+	if (frequency == 0)
+		frequency = SDL_GetPerformanceFrequency();
+
+	return frequency;
+}
@@ -15,6 +15,8 @@ public:
 	double ReadMs()const;
 	uint64 ReadTicks()const;
 
+	static uint64 GetFrequency();
+
 private:
 	bool running;
 	uint64 startedAt;
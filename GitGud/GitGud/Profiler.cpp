@@ -0,0 +1,296 @@
+#include "Profiler.h"
+
+#include "App.h"
+#include "M_FileSystem.h"
+#include "PerfTimer.h"
+
+#include <atomic>
+#include <mutex>
+
+struct ProfilerThread
+{
+	std::string name;
+	uint id = 0;
+	uint depth = 0;
+
+	std::atomic<uint64> head; //Total events written, the ring position is head % PROFILER_EVENTS_PER_THREAD.
+	ProfilerEvent events[PROFILER_EVENTS_PER_THREAD];
+
+	ProfilerThread() : head(0)
+	{}
+};
+
+/** Owns the thread rings so they are freed at exit. */
+struct ProfilerRegistry
+{
+	~ProfilerRegistry()
+	{
+		for (std::vector<ProfilerThread*>::iterator it = threads.begin(); it != threads.end(); ++it)
+			RELEASE(*it);
+	}
+
+	std::mutex mutex;
+	std::vector<ProfilerThread*> threads;
+};
+
+static ProfilerRegistry& Registry()
+{
+	static ProfilerRegistry registry;
+	return registry;
+}
+
+static PerfTimer& Clock()
+{
+	static PerfTimer timer;
+	return timer;
+}
+
+static thread_local ProfilerThread* currentThread = nullptr;
+
+static std::atomic<bool> paused(false);
+
+//Only touched by the main thread
+static ProfilerFrame frames[PROFILER_FRAMES];
+static uint frameCount = 0;
+static uint64 frameStart = 0;
+static bool frameOpen = false;
+
+static ProfilerThread* GetThread()
+{
+	if (currentThread == nullptr)
+	{
+		ProfilerRegistry& registry = Registry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+
+		currentThread = new ProfilerThread();
+		currentThread->id = registry.threads.size();
+		currentThread->name = "Thread " + std::to_string(currentThread->id);
+		registry.threads.push_back(currentThread);
+	}
+
+	return currentThread;
+}
+
+/** Appends the string to the json escaping the characters that need it. */
+static void AppendEscaped(std::string& json, const char* str)
+{
+	for (const char* c = str; c && *c != '\0'; ++c)
+	{
+		if (*c == '"' || *c == '\\') json += '\\';
+		if ((uchar)*c >= 0x20) json += *c;
+	}
+}
+
+//=============================================================================
+
+/** Profiler - SetThreadName: Names the calling thread in the profiler views and trace. */
+void Profiler::SetThreadName(const char * name)
+{
+	ProfilerThread* thread = GetThread();
+
+	std::lock_guard<std::mutex> lock(Registry().mutex);
+	thread->name = name ? name : "";
+}
+
+/** Profiler - BeginFrame: Marks the start of a frame. Must be called from the main thread. */
+void Profiler::BeginFrame()
+{
+	frameOpen = !paused;
+	if (frameOpen)
+		frameStart = Now();
+}
+
+/** Profiler - EndFrame: Marks the end of the frame begun with BeginFrame. */
+void Profiler::EndFrame()
+{
+	if (frameOpen)
+	{
+		ProfilerFrame& frame = frames[frameCount % PROFILER_FRAMES];
+		frame.index = frameCount++;
+		frame.start = frameStart;
+		frame.end = Now();
+		frameOpen = false;
+	}
+}
+
+bool Profiler::IsCapturing()
+{
+	return !paused;
+}
+
+/** Profiler - SetPaused: While paused nothing is recorded, so the captured frames can be inspected. */
+void Profiler::SetPaused(bool pause)
+{
+	paused = pause;
+}
+
+bool Profiler::IsPaused()
+{
+	return paused;
+}
+
+uint64 Profiler::Now()
+{
+	return Clock().ReadTicks();
+}
+
+/** Profiler - Push: Opens a scope on the calling thread and returns its depth. */
+uint Profiler::Push()
+{
+	return GetThread()->depth++;
+}
+
+/** Profiler - Record: Closes the scope opened with Push, storing it into the thread ring. */
+void Profiler::Record(const char * name, uint64 start, uint64 end, uint depth)
+{
+	ProfilerThread* thread = GetThread();
+	if (thread->depth > 0)
+		--thread->depth;
+
+	uint64 head = thread->head.load(std::memory_order_relaxed);
+	ProfilerEvent& e = thread->events[head % PROFILER_EVENTS_PER_THREAD];
+	e.name = name;
+	e.start = start;
+	e.end = end;
+	e.depth = depth;
+
+	thread->head.store(head + 1, std::memory_order_release);
+}
+
+/** Profiler - GetFrames: Fills the recorded frames from the oldest to the newest and returns how many there are. */
+uint Profiler::GetFrames(std::vector<ProfilerFrame>& ret)
+{
+	ret.clear();
+
+	uint count = MIN(frameCount, (uint)PROFILER_FRAMES);
+	for (uint i = frameCount - count; i < frameCount; ++i)
+		ret.push_back(frames[i % PROFILER_FRAMES]);
+
+	return count;
+}
+
+/** Profiler - GetEvents: Copies the events of every thread that overlap the range of ticks passed. The oldest events of a ring
+						  may be overwritten while copying if its thread is recording fast, it is fine for a profiler view. */
+void Profiler::GetEvents(uint64 from, uint64 to, std::vector<ProfilerThreadEvents>& ret)
+{
+	ret.clear();
+
+	ProfilerRegistry& registry = Registry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	for (std::vector<ProfilerThread*>::const_iterator it = registry.threads.begin(); it != registry.threads.end(); ++it)
+	{
+		const ProfilerThread* thread = *it;
+
+		ret.push_back(ProfilerThreadEvents());
+		ProfilerThreadEvents& dst = ret.back();
+		dst.name = thread->name;
+		dst.id = thread->id;
+
+		uint64 head = thread->head.load(std::memory_order_acquire);
+		uint64 count = MIN(head, (uint64)PROFILER_EVENTS_PER_THREAD);
+
+		for (uint64 i = head - count; i < head; ++i)
+		{
+			const ProfilerEvent& e = thread->events[i % PROFILER_EVENTS_PER_THREAD];
+			if (e.end >= from && e.start <= to)
+				dst.events.push_back(e);
+		}
+	}
+}
+
+double Profiler::TicksToMs(uint64 ticks)
+{
+	return 1000.0 * (double)ticks / (double)PerfTimer::GetFrequency();
+}
+
+/** Profiler - SaveChromeTrace: Saves the recorded frames as a Chrome trace-event JSON (chrome://tracing, Perfetto...). */
+bool Profiler::SaveChromeTrace(const char * file)
+{
+	if (file == nullptr)
+		return false;
+
+	std::string json;
+	WriteChromeTrace(json);
+
+	if (!app->fs->Exist(PROFILER_PATH))
+		app->fs->MakeDir(PROFILER_PATH);
+
+	bool ret = app->fs->Save(file, json.data(), json.size()) == json.size();
+	if (ret)
+		_LOG(LOG_INFO, "Profiler: Trace saved to [%s].", file);
+
+	return ret;
+}
+
+/** Profiler - WriteChromeTrace: Writes the events of the recorded frames, of all the threads, in trace-event JSON format. */
+void Profiler::WriteChromeTrace(std::string & json)
+{
+	std::vector<ProfilerFrame> recorded;
+	uint64 from = 0, to = (uint64)-1;
+	if (GetFrames(recorded) > 0)
+	{
+		from = recorded.front().start;
+		to = recorded.back().end;
+	}
+
+	std::vector<ProfilerThreadEvents> threads;
+	GetEvents(from, to, threads);
+
+	const double ticksToUs = 1000000.0 / (double)PerfTimer::GetFrequency();
+	char buffer[128];
+	bool first = true;
+
+	json = "{\"traceEvents\":[\n";
+
+	for (std::vector<ProfilerThreadEvents>::const_iterator t = threads.begin(); t != threads.end(); ++t)
+	{
+		if (!first) json += ",\n";
+		first = false;
+
+		json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":";
+		json += std::to_string(t->id);
+		json += ",\"args\":{\"name\":\"";
+		AppendEscaped(json, t->name.c_str());
+		json += "\"}}";
+
+		for (std::vector<ProfilerEvent>::const_iterator e = t->events.begin(); e != t->events.end(); ++e)
+		{
+			json += ",\n{\"name\":\"";
+			AppendEscaped(json, e->name);
+			snprintf(buffer, sizeof(buffer), "\",\"cat\":\"GitGud\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%u}",
+				e->start * ticksToUs, (e->end - e->start) * ticksToUs, t->id);
+			json += buffer;
+		}
+	}
+
+	for (std::vector<ProfilerFrame>::const_iterator f = recorded.begin(); f != recorded.end(); ++f)
+	{
+		if (!first) json += ",\n";
+		first = false;
+
+		snprintf(buffer, sizeof(buffer), "{\"name\":\"Frame %u\",\"cat\":\"Frame\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%.3f,\"pid\":0,\"tid\":0}",
+			f->index, f->start * ticksToUs);
+		json += buffer;
+	}
+
+	json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+//=============================================================================
+
+ProfilerScope::ProfilerScope(const char * name) : name(name)
+{
+	if (Profiler::IsCapturing())
+	{
+		depth = Profiler::Push();
+		start = Profiler::Now();
+		active = true;
+	}
+}
+
+ProfilerScope::~ProfilerScope()
+{
+	if (active)
+		Profiler::Record(name, start, Profiler::Now(), depth);
+}
@@ -0,0 +1,101 @@
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+#include "Globals.h"
+#include <vector>
+#include <string>
+
+//Define GG_PROFILER as 0 to compile all the profiling markers out.
+#ifndef GG_PROFILER
+#define GG_PROFILER 1
+#endif
+
+#define PROFILER_EVENTS_PER_THREAD 32768
+#define PROFILER_FRAMES 300
+
+#if GG_PROFILER
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+#define PROFILE_SCOPE(name) ProfilerScope PROFILE_CONCAT(profilerScope, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
+#define PROFILE_THREAD(name) Profiler::SetThreadName(name)
+#define PROFILE_FRAME_BEGIN() Profiler::BeginFrame()
+#define PROFILE_FRAME_END() Profiler::EndFrame()
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_FUNCTION()
+#define PROFILE_THREAD(name)
+#define PROFILE_FRAME_BEGIN()
+#define PROFILE_FRAME_END()
+#endif
+
+/** A closed scope. The name must outlive the profiler (literals or long lived strings). */
+struct ProfilerEvent
+{
+	const char* name = nullptr;
+	uint64 start = 0;
+	uint64 end = 0;
+	uint depth = 0;
+};
+
+struct ProfilerFrame
+{
+	uint index = 0;
+	uint64 start = 0;
+	uint64 end = 0;
+};
+
+/** Events of a thread copied out of its ring buffer. */
+struct ProfilerThreadEvents
+{
+	std::string name;
+	uint id = 0;
+	std::vector<ProfilerEvent> events;
+};
+
+/**
+*	- Hierarchical CPU profiler. Scopes are recorded into a ring buffer per thread, only written by its owner thread,
+*	  so recording never locks. The rings are read from the main thread for the editor and the trace export.
+*	- Timestamps are PerfTimer ticks since the profiler started.
+*	- Frames are marked by the main thread and used to slice the events of all the threads.
+*/
+class Profiler
+{
+public:
+	static void SetThreadName(const char* name);
+
+	static void BeginFrame();
+	static void EndFrame();
+
+	static bool IsCapturing();
+	static void SetPaused(bool paused);
+	static bool IsPaused();
+
+	static uint64 Now();
+	static uint Push();
+	static void Record(const char* name, uint64 start, uint64 end, uint depth);
+
+	static uint GetFrames(std::vector<ProfilerFrame>& frames);
+	static void GetEvents(uint64 from, uint64 to, std::vector<ProfilerThreadEvents>& threads);
+
+	static double TicksToMs(uint64 ticks);
+
+	static bool SaveChromeTrace(const char* file);
+	static void WriteChromeTrace(std::string& json);
+};
+
+/** Records the time between its construction and destruction. Use it through PROFILE_SCOPE. */
+class ProfilerScope
+{
+public:
+	ProfilerScope(const char* name);
+	~ProfilerScope();
+
+private:
+	const char* name;
+	uint64 start = 0;
+	uint depth = 0;
+	bool active = false;
+};
+
+#endif // !__PROFILER_H__
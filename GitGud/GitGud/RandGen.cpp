@@ -36,3 +36,8 @@ float RandGen::GetRandFloat(float min, float max)
 {
 	return lcg->Float(min, max);
 }
+
+void RandGen::SetSeed(uint32 seed)
+{
+	lcg->Seed(seed);
+}
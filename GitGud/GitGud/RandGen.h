@@ -16,6 +16,8 @@ public:
 	float GetRandFloat();
 	float GetRandFloat(float min, float max);
 
+	void SetSeed(uint32 seed);
+
 private:
 	LCG* lcg = nullptr;
 };
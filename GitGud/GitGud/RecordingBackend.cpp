@@ -0,0 +1,361 @@
+#include "RecordingBackend.h"
+
+#include "OpenGL.h"
+
+static const char* opNames[ROP_COUNT] =
+{
+	"UseProgram", "BindVertexArray", "BindBuffer", "ActiveTexture", "BindTexture", "SetCapability", "BlendFunc", "CullFace",
+	"DepthFunc", "DepthMask", "Viewport", "LineWidth", "PolygonMode", "ClearColor", "Clear",
+	"GenBuffer", "DeleteBuffer", "BufferData", "BufferSubData", "MapBufferRange", "UnmapBuffer", "GenVertexArray", "DeleteVertexArray", "VertexAttribute",
+	"GenTexture", "DeleteTexture", "PixelStore", "TexParameter", "TexImage2D", "CompressedTexImage2D",
+	"CompileShader", "LinkProgram", "DeleteShader", "DeleteProgram", "GetUniformLocation", "UniformMatrix4",
+	"DrawElements", "MultiDrawElements", "DrawArrays"
+};
+
+static uint FloatBits(float value)
+{
+	uint bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+RecordingBackend::RecordingBackend(bool logCalls) : logging(logCalls)
+{
+}
+
+const char * RecordingBackend::GetName() const
+{
+	return "Recording";
+}
+
+void RecordingBackend::UseProgram(uint program)
+{
+	Record(ROP_USE_PROGRAM, program);
+}
+
+void RecordingBackend::BindVertexArray(uint vao)
+{
+	Record(ROP_BIND_VAO, vao);
+}
+
+void RecordingBackend::BindBuffer(uint target, uint buffer)
+{
+	Record(ROP_BIND_BUFFER, target, buffer);
+}
+
+void RecordingBackend::ActiveTexture(uint unit)
+{
+	Record(ROP_ACTIVE_TEXTURE, unit);
+}
+
+void RecordingBackend::BindTexture(uint target, uint texture)
+{
+	Record(ROP_BIND_TEXTURE, target, texture);
+}
+
+void RecordingBackend::SetCapability(uint cap, bool enable)
+{
+	Record(ROP_CAPABILITY, cap, enable ? 1 : 0);
+}
+
+void RecordingBackend::BlendFunc(uint src, uint dst)
+{
+	Record(ROP_BLEND_FUNC, src, dst);
+}
+
+void RecordingBackend::CullFace(uint mode)
+{
+	Record(ROP_CULL_FACE, mode);
+}
+
+void RecordingBackend::DepthFunc(uint func)
+{
+	Record(ROP_DEPTH_FUNC, func);
+}
+
+void RecordingBackend::DepthMask(bool write)
+{
+	Record(ROP_DEPTH_MASK, write ? 1 : 0);
+}
+
+void RecordingBackend::Viewport(int x, int y, int w, int h)
+{
+	Record(ROP_VIEWPORT, x, y, w, h);
+}
+
+void RecordingBackend::LineWidth(float width)
+{
+	Record(ROP_LINE_WIDTH, FloatBits(width));
+}
+
+void RecordingBackend::PolygonMode(uint mode)
+{
+	Record(ROP_POLYGON_MODE, mode);
+}
+
+void RecordingBackend::ClearColor(float r, float g, float b, float a)
+{
+	Record(ROP_CLEAR_COLOR, FloatBits(r), FloatBits(g), FloatBits(b), FloatBits(a));
+}
+
+void RecordingBackend::Clear(uint mask)
+{
+	Record(ROP_CLEAR, mask);
+}
+
+uint RecordingBackend::GenBuffer()
+{
+	uint buffer = NextHandle();
+	Record(ROP_GEN_BUFFER, buffer);
+	return buffer;
+}
+
+void RecordingBackend::DeleteBuffer(uint buffer)
+{
+	Record(ROP_DELETE_BUFFER, buffer);
+}
+
+void RecordingBackend::BufferData(uint target, uint size, const void * data, uint usage)
+{
+	Record(ROP_BUFFER_DATA, target, size, usage);
+	if (data)
+	{
+		frame.uploadedBytes += size;
+		total.uploadedBytes += size;
+	}
+}
+
+void RecordingBackend::BufferSubData(uint target, uint offset, uint size, const void * data)
+{
+	Record(ROP_BUFFER_SUB_DATA, target, offset, size);
+	frame.uploadedBytes += size;
+	total.uploadedBytes += size;
+}
+
+/** RecordingBackend - MapBufferRange: Returns scratch memory, what is written there is counted as uploaded. */
+void * RecordingBackend::MapBufferRange(uint target, uint offset, uint size, uint access)
+{
+	Record(ROP_MAP_BUFFER, target, offset, size, access);
+	if (mapped.size() < size)
+		mapped.resize(size);
+
+	frame.uploadedBytes += size;
+	total.uploadedBytes += size;
+	return mapped.data();
+}
+
+void RecordingBackend::UnmapBuffer(uint target)
+{
+	Record(ROP_UNMAP_BUFFER, target);
+}
+
+uint RecordingBackend::GenVertexArray()
+{
+	uint vao = NextHandle();
+	Record(ROP_GEN_VAO, vao);
+	return vao;
+}
+
+void RecordingBackend::DeleteVertexArray(uint vao)
+{
+	Record(ROP_DELETE_VAO, vao);
+}
+
+void RecordingBackend::VertexAttribute(uint location, int components, uint type, bool normalized, int stride, uint offset)
+{
+	Record(ROP_VERTEX_ATTRIBUTE, location, (components << 1) | (normalized ? 1 : 0), type, (stride << 16) | (offset & 0xFFFF));
+}
+
+uint RecordingBackend::GenTexture()
+{
+	uint texture = NextHandle();
+	Record(ROP_GEN_TEXTURE, texture);
+	return texture;
+}
+
+void RecordingBackend::DeleteTexture(uint texture)
+{
+	Record(ROP_DELETE_TEXTURE, texture);
+}
+
+void RecordingBackend::PixelStore(uint name, int value)
+{
+	Record(ROP_PIXEL_STORE, name, value);
+}
+
+void RecordingBackend::TexParameter(uint target, uint name, int value)
+{
+	Record(ROP_TEX_PARAMETER, target, name, value);
+}
+
+void RecordingBackend::TexImage2D(uint target, int level, int internalFormat, int width, int height, uint format, uint type, const void * data)
+{
+	Record(ROP_TEX_IMAGE_2D, target, level, width, height);
+	if (data)
+	{
+		//Only the formats the engine uploads, 4 bytes per pixel
+		frame.uploadedBytes += (uint64)width * height * 4;
+		total.uploadedBytes += (uint64)width * height * 4;
+	}
+}
+
+void RecordingBackend::CompressedTexImage2D(uint target, int level, uint internalFormat, int width, int height, uint size, const void * data)
+{
+	Record(ROP_COMPRESSED_TEX_IMAGE_2D, target, level, width, height);
+	frame.uploadedBytes += size;
+	total.uploadedBytes += size;
+}
+
+/** RecordingBackend - CompileShader: Always succeeds, the code is not validated. */
+uint RecordingBackend::CompileShader(uint type, const char * code, std::string & log)
+{
+	uint shader = NextHandle();
+	Record(ROP_COMPILE_SHADER, type, shader);
+	return shader;
+}
+
+uint RecordingBackend::LinkProgram(const uint * shaders, uint count, std::string & log)
+{
+	uint program = NextHandle();
+	Record(ROP_LINK_PROGRAM, program, count);
+	return program;
+}
+
+void RecordingBackend::DeleteShader(uint shader)
+{
+	Record(ROP_DELETE_SHADER, shader);
+}
+
+void RecordingBackend::DeleteProgram(uint program)
+{
+	Record(ROP_DELETE_PROGRAM, program);
+}
+
+/** RecordingBackend - GetUniformLocation: Hands out a stable location per name, as GL does for a given program. */
+int RecordingBackend::GetUniformLocation(uint program, const char * name)
+{
+	int location = 0;
+	for (const char* c = name; c && *c != '\0'; ++c)
+		location = (location * 31 + *c) & 0xFFFF;
+
+	Record(ROP_UNIFORM_LOCATION, program, location);
+	return location;
+}
+
+void RecordingBackend::UniformMatrix4(int location, const float * matrix)
+{
+	Record(ROP_UNIFORM_MATRIX, location);
+}
+
+void RecordingBackend::DrawElements(uint mode, int count, uint type, uint offset)
+{
+	Record(ROP_DRAW_ELEMENTS, mode, count, type, offset);
+	++frame.drawCalls;
+	++total.drawCalls;
+	frame.elements += count;
+	total.elements += count;
+}
+
+void RecordingBackend::MultiDrawElements(uint mode, const int * counts, uint type, const void * const * offsets, int drawCount)
+{
+	Record(ROP_MULTI_DRAW_ELEMENTS, mode, drawCount, type);
+	frame.drawCalls += drawCount;
+	total.drawCalls += drawCount;
+	for (int i = 0; i < drawCount; ++i)
+	{
+		frame.elements += counts[i];
+		total.elements += counts[i];
+	}
+}
+
+void RecordingBackend::DrawArrays(uint mode, int first, int count)
+{
+	Record(ROP_DRAW_ARRAYS, mode, first, count);
+	++frame.drawCalls;
+	++total.drawCalls;
+	frame.elements += count;
+	total.elements += count;
+}
+
+/** RecordingBackend - EndFrame: Publishes the counters of the frame and starts a new one. The log is kept. */
+void RecordingBackend::EndFrame()
+{
+	lastFrame = frame;
+	frame = RecordingStats();
+}
+
+void RecordingBackend::SetLogging(bool logCalls)
+{
+	logging = logCalls;
+}
+
+bool RecordingBackend::IsLogging() const
+{
+	return logging;
+}
+
+const std::vector<RecordedCall>& RecordingBackend::GetLog() const
+{
+	return calls;
+}
+
+/** RecordingBackend - GetDroppedCalls: Calls not logged because the log was full. */
+uint RecordingBackend::GetDroppedCalls() const
+{
+	return dropped;
+}
+
+void RecordingBackend::ClearLog()
+{
+	calls.clear();
+	dropped = 0;
+}
+
+const RecordingStats & RecordingBackend::GetLastFrameStats() const
+{
+	return lastFrame;
+}
+
+const RecordingStats & RecordingBackend::GetTotalStats() const
+{
+	return total;
+}
+
+const char * RecordingBackend::GetOpName(RecordedOp op)
+{
+	return (op >= 0 && op < ROP_COUNT) ? opNames[op] : "Unknown";
+}
+
+void RecordingBackend::Record(RecordedOp op, uint a, uint b, uint c, uint d)
+{
+	++frame.calls;
+	++frame.counts[op];
+	++total.calls;
+	++total.counts[op];
+
+	if (op <= ROP_CLEAR_COLOR)
+	{
+		++frame.stateChanges;
+		++total.stateChanges;
+	}
+
+	if (logging)
+	{
+		if (calls.size() < RECORDING_MAX_CALLS)
+		{
+			RecordedCall call;
+			call.op = (uchar)op;
+			call.args[0] = a; call.args[1] = b; call.args[2] = c; call.args[3] = d;
+			calls.push_back(call);
+		}
+		else
+		{
+			++dropped;
+		}
+	}
+}
+
+uint RecordingBackend::NextHandle()
+{
+	return ++lastHandle;
+}
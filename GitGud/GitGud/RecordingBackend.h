@@ -0,0 +1,168 @@
+#ifndef __RECORDING_BACKEND_H__
+#define __RECORDING_BACKEND_H__
+
+#include "RenderBackend.h"
+#include <vector>
+#include <string.h>
+
+#define RECORDING_MAX_CALLS 1048576 //Calls over this are counted but not logged.
+
+enum RecordedOp
+{
+	ROP_USE_PROGRAM = 0,
+	ROP_BIND_VAO,
+	ROP_BIND_BUFFER,
+	ROP_ACTIVE_TEXTURE,
+	ROP_BIND_TEXTURE,
+	ROP_CAPABILITY,
+	ROP_BLEND_FUNC,
+	ROP_CULL_FACE,
+	ROP_DEPTH_FUNC,
+	ROP_DEPTH_MASK,
+	ROP_VIEWPORT,
+	ROP_LINE_WIDTH,
+	ROP_POLYGON_MODE,
+	ROP_CLEAR_COLOR,
+	ROP_CLEAR,
+
+	ROP_GEN_BUFFER,
+	ROP_DELETE_BUFFER,
+	ROP_BUFFER_DATA,
+	ROP_BUFFER_SUB_DATA,
+	ROP_MAP_BUFFER,
+	ROP_UNMAP_BUFFER,
+	ROP_GEN_VAO,
+	ROP_DELETE_VAO,
+	ROP_VERTEX_ATTRIBUTE,
+
+	ROP_GEN_TEXTURE,
+	ROP_DELETE_TEXTURE,
+	ROP_PIXEL_STORE,
+	ROP_TEX_PARAMETER,
+	ROP_TEX_IMAGE_2D,
+	ROP_COMPRESSED_TEX_IMAGE_2D,
+
+	ROP_COMPILE_SHADER,
+	ROP_LINK_PROGRAM,
+	ROP_DELETE_SHADER,
+	ROP_DELETE_PROGRAM,
+	ROP_UNIFORM_LOCATION,
+	ROP_UNIFORM_MATRIX,
+
+	ROP_DRAW_ELEMENTS,
+	ROP_MULTI_DRAW_ELEMENTS,
+	ROP_DRAW_ARRAYS,
+
+	ROP_COUNT
+};
+
+/** A logged call. Args are the call handles, enums and sizes, floats stored by bits. Pointed data is not kept. */
+struct RecordedCall
+{
+	uchar op;
+	uint args[4];
+};
+
+struct RecordingStats
+{
+	uint calls = 0;
+	uint stateChanges = 0;	//Calls from ROP_USE_PROGRAM to ROP_CLEAR_COLOR.
+	uint drawCalls = 0;		//Multi draws count each of their draws.
+	uint64 elements = 0;	//Indices or vertices drawn.
+	uint64 uploadedBytes = 0;
+	uint counts[ROP_COUNT];
+
+	RecordingStats()
+	{
+		memset(counts, 0, sizeof(counts));
+	}
+};
+
+/**
+*	- Backend without GPU: hands out fake handles and counts every call, optionally logging them into a compact command log.
+*	- Meant for headless runs, where everything happens on the main thread. It is not thread safe.
+*	- Counters are per frame (EndFrame publishes them) and since the start.
+*/
+class RecordingBackend : public RenderBackend
+{
+public:
+	RecordingBackend(bool logCalls = false);
+
+	const char* GetName()const override;
+
+	void UseProgram(uint program)override;
+	void BindVertexArray(uint vao)override;
+	void BindBuffer(uint target, uint buffer)override;
+	void ActiveTexture(uint unit)override;
+	void BindTexture(uint target, uint texture)override;
+	void SetCapability(uint cap, bool enable)override;
+	void BlendFunc(uint src, uint dst)override;
+	void CullFace(uint mode)override;
+	void DepthFunc(uint func)override;
+	void DepthMask(bool write)override;
+	void Viewport(int x, int y, int w, int h)override;
+	void LineWidth(float width)override;
+	void PolygonMode(uint mode)override;
+	void ClearColor(float r, float g, float b, float a)override;
+	void Clear(uint mask)override;
+
+	uint GenBuffer()override;
+	void DeleteBuffer(uint buffer)override;
+	void BufferData(uint target, uint size, const void* data, uint usage)override;
+	void BufferSubData(uint target, uint offset, uint size, const void* data)override;
+	void* MapBufferRange(uint target, uint offset, uint size, uint access)override;
+	void UnmapBuffer(uint target)override;
+
+	uint GenVertexArray()override;
+	void DeleteVertexArray(uint vao)override;
+	void VertexAttribute(uint location, int components, uint type, bool normalized, int stride, uint offset)override;
+
+	uint GenTexture()override;
+	void DeleteTexture(uint texture)override;
+	void PixelStore(uint name, int value)override;
+	void TexParameter(uint target, uint name, int value)override;
+	void TexImage2D(uint target, int level, int internalFormat, int width, int height, uint format, uint type, const void* data)override;
+	void CompressedTexImage2D(uint target, int level, uint internalFormat, int width, int height, uint size, const void* data)override;
+
+	uint CompileShader(uint type, const char* code, std::string& log)override;
+	uint LinkProgram(const uint* shaders, uint count, std::string& log)override;
+	void DeleteShader(uint shader)override;
+	void DeleteProgram(uint program)override;
+	int GetUniformLocation(uint program, const char* name)override;
+	void UniformMatrix4(int location, const float* matrix)override;
+
+	void DrawElements(uint mode, int count, uint type, uint offset)override;
+	void MultiDrawElements(uint mode, const int* counts, uint type, const void* const* offsets, int drawCount)override;
+	void DrawArrays(uint mode, int first, int count)override;
+
+	void EndFrame()override;
+
+	void SetLogging(bool logCalls);
+	bool IsLogging()const;
+	const std::vector<RecordedCall>& GetLog()const;
+	uint GetDroppedCalls()const;
+	void ClearLog();
+
+	const RecordingStats& GetLastFrameStats()const;
+	const RecordingStats& GetTotalStats()const;
+
+	static const char* GetOpName(RecordedOp op);
+
+private:
+	void Record(RecordedOp op, uint a = 0, uint b = 0, uint c = 0, uint d = 0);
+	uint NextHandle();
+
+private:
+	bool logging = false;
+	std::vector<RecordedCall> calls;
+	uint dropped = 0;
+
+	RecordingStats frame;
+	RecordingStats lastFrame;
+	RecordingStats total;
+
+	uint lastHandle = 0;
+	std::vector<char> mapped; //Scratch memory returned by MapBufferRange.
+};
+
+#endif // !__RECORDING_BACKEND_H__
@@ -0,0 +1,17 @@
+#include "RenderBackend.h"
+#include "GLBackend.h"
+
+static GLBackend glBackend;
+static RenderBackend* current = &glBackend;
+
+/** RenderBackend - Get: Returns the backend in use, OpenGL unless another one was set. */
+RenderBackend * RenderBackend::Get()
+{
+	return current;
+}
+
+/** RenderBackend - Set: Sets the backend for every GL call. Must be done before any GL object is created. Null restores OpenGL. */
+void RenderBackend::Set(RenderBackend * backend)
+{
+	current = backend ? backend : &glBackend;
+}
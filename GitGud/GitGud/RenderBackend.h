@@ -0,0 +1,77 @@
+#ifndef __RENDER_BACKEND_H__
+#define __RENDER_BACKEND_H__
+
+#include "Globals.h"
+#include <string>
+
+/**
+*	- Every GL call of the engine goes through the current backend: GLState forwards the state changes it doesn't skip,
+*	  and mesh uploads, shaders, batches, debug lines and packet draws call it directly.
+*	- Enums and handles are the GL ones, so callers keep using GL_ARRAY_BUFFER, GL_TRIANGLES...
+*	- GLBackend is the real one and the default. RecordingBackend needs no GPU and logs the calls, for headless
+*	  benchmarks and checks of call counts and state changes.
+*/
+class RenderBackend
+{
+public:
+	virtual ~RenderBackend() {}
+
+	virtual const char* GetName()const = 0;
+
+	//State
+	virtual void UseProgram(uint program) = 0;
+	virtual void BindVertexArray(uint vao) = 0;
+	virtual void BindBuffer(uint target, uint buffer) = 0;
+	virtual void ActiveTexture(uint unit) = 0;
+	virtual void BindTexture(uint target, uint texture) = 0;
+	virtual void SetCapability(uint cap, bool enable) = 0;
+	virtual void BlendFunc(uint src, uint dst) = 0;
+	virtual void CullFace(uint mode) = 0;
+	virtual void DepthFunc(uint func) = 0;
+	virtual void DepthMask(bool write) = 0;
+	virtual void Viewport(int x, int y, int w, int h) = 0;
+	virtual void LineWidth(float width) = 0;
+	virtual void PolygonMode(uint mode) = 0;
+	virtual void ClearColor(float r, float g, float b, float a) = 0;
+	virtual void Clear(uint mask) = 0;
+
+	//Buffers and vertex arrays
+	virtual uint GenBuffer() = 0;
+	virtual void DeleteBuffer(uint buffer) = 0;
+	virtual void BufferData(uint target, uint size, const void* data, uint usage) = 0;
+	virtual void BufferSubData(uint target, uint offset, uint size, const void* data) = 0;
+	virtual void* MapBufferRange(uint target, uint offset, uint size, uint access) = 0;
+	virtual void UnmapBuffer(uint target) = 0;
+
+	virtual uint GenVertexArray() = 0;
+	virtual void DeleteVertexArray(uint vao) = 0;
+	virtual void VertexAttribute(uint location, int components, uint type, bool normalized, int stride, uint offset) = 0;
+
+	//Textures
+	virtual uint GenTexture() = 0;
+	virtual void DeleteTexture(uint texture) = 0;
+	virtual void PixelStore(uint name, int value) = 0;
+	virtual void TexParameter(uint target, uint name, int value) = 0;
+	virtual void TexImage2D(uint target, int level, int internalFormat, int width, int height, uint format, uint type, const void* data) = 0;
+	virtual void CompressedTexImage2D(uint target, int level, uint internalFormat, int width, int height, uint size, const void* data) = 0;
+
+	//Shaders
+	virtual uint CompileShader(uint type, const char* code, std::string& log) = 0;
+	virtual uint LinkProgram(const uint* shaders, uint count, std::string& log) = 0;
+	virtual void DeleteShader(uint shader) = 0;
+	virtual void DeleteProgram(uint program) = 0;
+	virtual int GetUniformLocation(uint program, const char* name) = 0;
+	virtual void UniformMatrix4(int location, const float* matrix) = 0;
+
+	//Draws
+	virtual void DrawElements(uint mode, int count, uint type, uint offset) = 0;
+	virtual void MultiDrawElements(uint mode, const int* counts, uint type, const void* const* offsets, int drawCount) = 0;
+	virtual void DrawArrays(uint mode, int first, int count) = 0;
+
+	virtual void EndFrame() {}
+
+	static RenderBackend* Get();
+	static void Set(RenderBackend* backend);
+};
+
+#endif // !__RENDER_BACKEND_H__
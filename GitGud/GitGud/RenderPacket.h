@@ -0,0 +1,134 @@
+#ifndef __RENDER_PACKET_H__
+#define __RENDER_PACKET_H__
+
+#include "Globals.h"
+#include "Math.h"
+#include "Color.h"
+#include <vector>
+#include <functional>
+
+struct ImDrawData;
+struct ImDrawList;
+
+/** GL handles and layout of a mesh, copied from the resource so the render side never touches resources. */
+struct MeshDrawInfo
+{
+	uint idVertices = 0;
+	uint idNormals = 0;
+	uint idUvs = 0;
+	uint idColors = 0;
+	uint idIndices = 0;
+
+	uint vertexFormat = 0;
+	bool normals = false;
+	bool uvs = false;
+	bool colors = false;
+
+	uint numIndices = 0;
+	bool shortIndices = false;
+};
+
+struct MeshDraw
+{
+	MeshDrawInfo mesh;
+	float model[16]; //Already in OpenGL layout.
+};
+
+/** GL objects of a static batch. Only the render side touches them, through packet commands. */
+struct StaticBatchGPU
+{
+	uint idContainer = 0;
+	uint idVertices = 0;
+	uint idIndices = 0;
+};
+
+struct BatchDraw
+{
+	StaticBatchGPU* gpu = nullptr;
+	uint texture = 0; //Atlas of the batch, 0 if it has none.
+	std::vector<int> counts;
+	std::vector<const void*> offsets;
+};
+
+struct DebugVertex
+{
+	float position[3];
+	uchar color[4];
+};
+
+struct DebugLineBatch
+{
+	float width = 1.f;
+	std::vector<DebugVertex> vertices;
+};
+
+/** Debug geometry of a frame. Lines are grouped by width so each group is a single draw, the grid is only flagged
+	as the render side keeps it in its own buffer. */
+struct DebugDrawData
+{
+	void AddLine(const float3& origin, const float3& destination, const Color& color, float width);
+	void Clear();
+	uint GetVertexCount()const;
+
+	std::vector<DebugLineBatch> batches; //Only the first numBatches are valid, the rest keep their memory for next frames.
+	uint numBatches = 0;
+
+	bool grid = false;
+	Color gridColor;
+};
+
+/** Copy of the ImGui draw lists of a frame, as ImGui reuses its own ones as soon as the next frame starts. */
+struct UIDrawData
+{
+	UIDrawData();
+	~UIDrawData();
+
+	void CopyFrom(ImDrawData* data, float displayWidth, float displayHeight, float scaleX, float scaleY);
+	void Clear();
+
+	std::vector<ImDrawList*> lists;
+	uint numLists = 0;
+
+	float displayWidth = 0.f;
+	float displayHeight = 0.f;
+	float scaleX = 1.f;
+	float scaleY = 1.f;
+};
+
+/**
+*	- Everything the render side needs to draw a frame. Built by the main thread and read-only once submitted.
+*	- Commands run before any draw, in the order they were enqueued (uploads, deletions, context settings...).
+*	- Vectors are cleared but not freed between frames to keep the allocations stable.
+*/
+struct RenderPacket
+{
+	void Clear();
+
+	uint frame = 0;
+	void* uploadFence = nullptr; //GLsync of the uploads done from the main thread context for this frame.
+
+	std::vector<std::function<void()>> commands;
+
+	Color clearColor;
+	uint viewportWidth = 0;
+	uint viewportHeight = 0;
+
+	float view[16];
+	float projection[16];
+
+	uint program = 0;
+	int modelLoc = -1;
+	int viewLoc = -1;
+	int projLoc = -1;
+
+	std::vector<MeshDraw> draws;
+
+	std::vector<BatchDraw> batches; //Only the first numBatches are valid, the rest keep their memory for next frames.
+	uint numBatches = 0;
+
+	DebugDrawData debug;
+
+	UIDrawData ui;
+};
+
+#endif // !__RENDER_PACKET_H__
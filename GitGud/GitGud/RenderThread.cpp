@@ -0,0 +1,448 @@
+#include "RenderThread.h"
+
+#include "ImporterMesh.h"
+#include "GLState.h"
+#include "RenderBackend.h"
+#include "PerfTimer.h"
+#include "Profiler.h"
+
+#include "imGui/imgui.h"
+#include "imGui/imgui_impl_sdl_gl3.h"
+
+#include "OpenGL.h"
+
+std::vector<std::function<void()>>* RenderThread::commandTarget = nullptr;
+std::map<uint, uint> RenderThread::meshVAOs;
+
+/** Copies an ImGui vector reusing the destination memory. */
+template<class T>
+static void CopyImVector(ImVector<T>& dst, const ImVector<T>& src)
+{
+	dst.resize(src.Size);
+	if (src.Size > 0)
+		memcpy(dst.Data, src.Data, sizeof(T) * src.Size);
+}
+
+//=============================================================================
+
+UIDrawData::UIDrawData()
+{
+}
+
+UIDrawData::~UIDrawData()
+{
+	for (std::vector<ImDrawList*>::iterator it = lists.begin(); it != lists.end(); ++it)
+		RELEASE(*it);
+}
+
+/** UIDrawData - CopyFrom: Copies the draw lists of the ImGui draw data. Must be called between ImGui::Render and the next frame. */
+void UIDrawData::CopyFrom(ImDrawData* data, float displayWidth, float displayHeight, float scaleX, float scaleY)
+{
+	Clear();
+
+	this->displayWidth = displayWidth;
+	this->displayHeight = displayHeight;
+	this->scaleX = scaleX;
+	this->scaleY = scaleY;
+
+	if (data == nullptr || !data->Valid)
+		return;
+
+	for (int i = 0; i < data->CmdListsCount; ++i)
+	{
+		const ImDrawList* src = data->CmdLists[i];
+		if (src->VtxBuffer.empty() || src->IdxBuffer.empty())
+			continue;
+
+		if (lists.size() <= numLists)
+			lists.push_back(new ImDrawList());
+
+		ImDrawList* dst = lists[numLists++];
+		CopyImVector(dst->CmdBuffer, src->CmdBuffer);
+		CopyImVector(dst->IdxBuffer, src->IdxBuffer);
+		CopyImVector(dst->VtxBuffer, src->VtxBuffer);
+	}
+}
+
+void UIDrawData::Clear()
+{
+	numLists = 0;
+}
+
+void RenderPacket::Clear()
+{
+	uploadFence = nullptr;
+	commands.clear();
+	draws.clear();
+	numBatches = 0;
+	debug.Clear();
+	ui.Clear();
+}
+
+//=============================================================================
+
+RenderThread::RenderThread()
+{
+}
+
+RenderThread::~RenderThread()
+{
+	Stop();
+}
+
+/** RenderThread - Start: With threaded, launches the render thread making the context passed current on it.
+						  The calling thread must already have another context current, shared with the passed one.
+						  Without window the packets are dropped on submit, or executed with SetHeadlessExecution. */
+bool RenderThread::Start(SDL_Window * window, SDL_GLContext context, bool threaded)
+{
+	this->window = window;
+	this->context = context;
+
+	if (!threaded)
+		return true;
+
+	quit = false;
+	ready = false;
+	failed = false;
+
+	thread = std::thread(&RenderThread::Loop, this);
+
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		condition.wait(lock, [this] { return ready; });
+	}
+
+	if (failed)
+	{
+		thread.join();
+		_LOG(LOG_ERROR, "Render thread: Could not make the context current! SDL_Error: %s\n", SDL_GetError());
+		return false;
+	}
+
+	this->threaded = true;
+	commandTarget = &packets[building].commands;
+
+	_LOG(LOG_INFO, "Render thread: Started.");
+
+	return true;
+}
+
+/** RenderThread - Stop: Lets the render thread finish the submitted packets and joins it. The context is made current
+						 on the calling thread again and the commands already enqueued for the next packet are run there. */
+void RenderThread::Stop()
+{
+	if (threaded)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			quit = true;
+		}
+		condition.notify_all();
+
+		if (thread.joinable())
+			thread.join();
+
+		threaded = false;
+		commandTarget = nullptr;
+
+		SDL_GL_MakeCurrent(window, context);
+		GLState::Invalidate();
+
+		RenderPacket& packet = packets[building];
+		for (std::vector<std::function<void()>>::iterator it = packet.commands.begin(); it != packet.commands.end(); ++it)
+			(*it)();
+		packet.Clear();
+
+		_LOG(LOG_INFO, "Render thread: Stopped.");
+	}
+}
+
+bool RenderThread::IsThreaded() const
+{
+	return threaded;
+}
+
+/** RenderThread - SetHeadlessExecution: Without window, executes the submitted packets instead of dropping them. */
+void RenderThread::SetHeadlessExecution(bool execute)
+{
+	headlessExecution = execute;
+}
+
+/** RenderThread - GetPacket: Returns the packet to fill for the current frame. */
+RenderPacket * RenderThread::GetPacket()
+{
+	return &packets[building];
+}
+
+/** RenderThread - Submit: Hands the current packet to the render side. Not threaded it is drawn and swapped right away,
+						   threaded it waits for the render thread to finish the previous packet, so it is at most one frame ahead. */
+void RenderThread::Submit()
+{
+	PROFILE_SCOPE("Submit");
+
+	RenderPacket* packet = &packets[building];
+	packet->frame = ++frame;
+
+	if (window == nullptr)
+	{
+		PerfTimer timer;
+		if (headlessExecution)
+			Execute(packet);
+		GLState::EndFrame();
+
+		renderBusyMs = (float)timer.ReadMs();
+		packet->Clear();
+		return;
+	}
+
+	if (!threaded)
+	{
+		PerfTimer timer;
+		{
+			PROFILE_SCOPE("Execute");
+			Execute(packet);
+		}
+		{
+			PROFILE_SCOPE("Swap");
+			SDL_GL_SwapWindow(window);
+		}
+		GLState::EndFrame();
+
+		renderBusyMs = (float)timer.ReadMs();
+		packet->Clear();
+		return;
+	}
+
+	//The render context must wait for this frame uploads before using them
+	packet->uploadFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	glFlush();
+
+	PerfTimer timer;
+	{
+		PROFILE_SCOPE("Wait render thread");
+
+		std::unique_lock<std::mutex> lock(mutex);
+		framesInFlight = (rendering ? 1 : 0) + (toRender ? 1 : 0);
+
+		condition.wait(lock, [this] { return !rendering && toRender == nullptr; });
+
+		toRender = packet;
+		building = 1 - building;
+
+		renderBusyMs = lastBusyMs;
+		renderIdleMs = lastIdleMs;
+	}
+	condition.notify_all();
+
+	mainWaitMs = (float)timer.ReadMs();
+
+	packets[building].Clear();
+	commandTarget = &packets[building].commands;
+}
+
+/** RenderThread - Enqueue: Runs the command on the render side before the next packet draws. Not threaded, or while
+							there is no render thread (init, shutdown), it is run right away. Must be called from the main thread. */
+void RenderThread::Enqueue(const std::function<void()>& command)
+{
+	if (commandTarget)
+		commandTarget->push_back(command);
+	else
+		command();
+}
+
+/** RenderThread - ReleaseMeshVAO: Deletes the VAO created for a mesh vertex buffer. Must run on the render side (inside a command). */
+void RenderThread::ReleaseMeshVAO(uint idVertices)
+{
+	std::map<uint, uint>::iterator it = meshVAOs.find(idVertices);
+	if (it != meshVAOs.end())
+	{
+		GLState::DeleteVertexArray(it->second);
+		meshVAOs.erase(it);
+	}
+}
+
+/** RenderThread - ReleaseGLObjects: Deletes the GL objects owned by the render side. Must run with the render context current. */
+void RenderThread::ReleaseGLObjects()
+{
+	debugRenderer.CleanUp();
+
+	for (std::map<uint, uint>::iterator it = meshVAOs.begin(); it != meshVAOs.end(); ++it)
+		GLState::DeleteVertexArray(it->second);
+	meshVAOs.clear();
+}
+
+/** RenderThread - GetMainWaitMs: Time the main thread was blocked on the last submit waiting for the render thread. */
+float RenderThread::GetMainWaitMs() const
+{
+	return mainWaitMs;
+}
+
+/** RenderThread - GetRenderBusyMs: Time spent executing and swapping the last packet. */
+float RenderThread::GetRenderBusyMs() const
+{
+	return renderBusyMs;
+}
+
+/** RenderThread - GetRenderIdleMs: Time the render thread waited for the last packet. */
+float RenderThread::GetRenderIdleMs() const
+{
+	return renderIdleMs;
+}
+
+/** RenderThread - GetFramesInFlight: Packets the render side still had when the last one was submitted. */
+uint RenderThread::GetFramesInFlight() const
+{
+	return framesInFlight;
+}
+
+void RenderThread::Loop()
+{
+	PROFILE_THREAD("Render");
+
+	bool current = SDL_GL_MakeCurrent(window, context) == 0;
+
+	if (current)
+	{
+		GLState::Invalidate();
+		//ImGui VAO can't be shared, its device objects are created with the context that will draw them
+		ImGui_ImplSdlGL3_CreateDeviceObjects();
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		ready = true;
+		failed = !current;
+	}
+	condition.notify_all();
+
+	if (!current)
+		return;
+
+	PerfTimer timer;
+	while (true)
+	{
+		RenderPacket* packet = nullptr;
+
+		timer.Start();
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			condition.wait(lock, [this] { return toRender != nullptr || quit; });
+
+			if (toRender == nullptr)
+				break;
+
+			packet = toRender;
+			toRender = nullptr;
+			rendering = true;
+		}
+		float idle = (float)timer.ReadMs();
+
+		timer.Start();
+		{
+			PROFILE_SCOPE("Execute");
+			Execute(packet);
+		}
+		{
+			PROFILE_SCOPE("Swap");
+			SDL_GL_SwapWindow(window);
+		}
+		GLState::EndFrame();
+		float busy = (float)timer.ReadMs();
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			rendering = false;
+			lastIdleMs = idle;
+			lastBusyMs = busy;
+		}
+		condition.notify_all();
+	}
+
+	SDL_GL_MakeCurrent(window, nullptr);
+}
+
+/** RenderThread - Execute: Runs the packet commands and draws it: meshes, static batches, debug lines and the editor. */
+void RenderThread::Execute(RenderPacket * packet)
+{
+	if (packet->uploadFence)
+	{
+		glWaitSync((GLsync)packet->uploadFence, 0, GL_TIMEOUT_IGNORED);
+		glDeleteSync((GLsync)packet->uploadFence);
+		packet->uploadFence = nullptr;
+	}
+
+	for (std::vector<std::function<void()>>::iterator it = packet->commands.begin(); it != packet->commands.end(); ++it)
+		(*it)();
+	packet->commands.clear();
+
+	GLState::Viewport(0, 0, packet->viewportWidth, packet->viewportHeight);
+	GLState::ClearColor(packet->clearColor.r, packet->clearColor.g, packet->clearColor.b, packet->clearColor.a);
+	GLState::DepthMask(true);
+	RenderBackend* backend = RenderBackend::Get();
+	backend->Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	GLState::SetCapability(GL_DEPTH_TEST, true);
+	GLState::PolygonMode(GL_FILL);
+
+	if (packet->program != 0 && (!packet->draws.empty() || packet->numBatches > 0))
+	{
+		GLState::UseProgram(packet->program);
+		backend->UniformMatrix4(packet->viewLoc, packet->view);
+		backend->UniformMatrix4(packet->projLoc, packet->projection);
+
+		for (std::vector<MeshDraw>::const_iterator it = packet->draws.begin(); it != packet->draws.end(); ++it)
+		{
+			GLState::BindVertexArray(GetMeshVAO(it->mesh));
+			backend->UniformMatrix4(packet->modelLoc, it->model);
+			backend->DrawElements(GL_TRIANGLES, it->mesh.numIndices, it->mesh.shortIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, 0);
+		}
+
+		if (packet->numBatches > 0)
+		{
+			//Batched geometry is already in world space
+			backend->UniformMatrix4(packet->modelLoc, float4x4::identity.ptr());
+
+			for (uint i = 0; i < packet->numBatches; ++i)
+			{
+				const BatchDraw& batch = packet->batches[i];
+				GLState::BindTexture(GL_TEXTURE_2D, batch.texture); //Batches sharing an atlas keep it bound
+				GLState::BindVertexArray(batch.gpu->idContainer);
+				backend->MultiDrawElements(GL_TRIANGLES, &batch.counts[0], GL_UNSIGNED_INT, &batch.offsets[0], batch.counts.size());
+			}
+			GLState::BindTexture(GL_TEXTURE_2D, 0);
+		}
+	}
+
+	debugRenderer.Draw(packet->debug, packet->view, packet->projection);
+
+	if (packet->ui.numLists > 0)
+	{
+		ImDrawData data;
+		data.Valid = true;
+		data.CmdLists = &packet->ui.lists[0];
+		data.CmdListsCount = packet->ui.numLists;
+		data.TotalVtxCount = data.TotalIdxCount = 0;
+		for (uint i = 0; i < packet->ui.numLists; ++i)
+		{
+			data.TotalVtxCount += packet->ui.lists[i]->VtxBuffer.Size;
+			data.TotalIdxCount += packet->ui.lists[i]->IdxBuffer.Size;
+		}
+
+		ImGui_ImplSdlGL3_RenderDrawData(&data, ImVec2(packet->ui.displayWidth, packet->ui.displayHeight), ImVec2(packet->ui.scaleX, packet->ui.scaleY));
+	}
+}
+
+/** RenderThread - GetMeshVAO: Returns the VAO of a mesh, creating it the first time the mesh is drawn. */
+uint RenderThread::GetMeshVAO(const MeshDrawInfo & info)
+{
+	std::map<uint, uint>::iterator it = meshVAOs.find(info.idVertices);
+	if (it != meshVAOs.end())
+		return it->second;
+
+	uint vao = RenderBackend::Get()->GenVertexArray();
+	GLState::BindVertexArray(vao);
+	ImporterMesh::SetupVertexArray(info);
+
+	meshVAOs[info.idVertices] = vao;
+	return vao;
+}
@@ -0,0 +1,85 @@
+#ifndef __RENDER_THREAD_H__
+#define __RENDER_THREAD_H__
+
+#include "Globals.h"
+#include "RenderPacket.h"
+#include "DebugRenderer.h"
+#include <SDL.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <map>
+
+/**
+*	- Consumes the render packets built by the main thread and submits them to GL.
+*	- Threaded: a render thread owns the window context and draws packet N while the main thread builds packet N+1.
+*	  The main thread keeps a shared context for uploads and can't get more than one packet ahead.
+*	- Not threaded: packets are executed right away on the main thread when submitted.
+*	- Without window (headless): packets are dropped when submitted, or executed without swap if headless execution is set,
+*	  which only makes sense with a backend that needs no context.
+*	- GL work outside the packet draws (deletions, batch uploads...) goes through Enqueue so it runs on the render side.
+*/
+class RenderThread
+{
+public:
+	RenderThread();
+	~RenderThread();
+
+	bool Start(SDL_Window* window, SDL_GLContext context, bool threaded);
+	void Stop();
+	bool IsThreaded()const;
+	void SetHeadlessExecution(bool execute);
+
+	RenderPacket* GetPacket();
+	void Submit();
+
+	static void Enqueue(const std::function<void()>& command);
+	static void ReleaseMeshVAO(uint idVertices);
+	void ReleaseGLObjects();
+
+	float GetMainWaitMs()const;
+	float GetRenderBusyMs()const;
+	float GetRenderIdleMs()const;
+	uint GetFramesInFlight()const;
+
+private:
+	void Loop();
+	void Execute(RenderPacket* packet);
+
+	static uint GetMeshVAO(const MeshDrawInfo& info);
+
+private:
+	SDL_Window* window = nullptr;
+	SDL_GLContext context = nullptr;
+
+	bool threaded = false;
+	bool headlessExecution = false;
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable condition;
+
+	RenderPacket packets[2];
+	uint building = 0;					//Packet the main thread is filling.
+	RenderPacket* toRender = nullptr;	//Packet submitted and not yet taken by the render thread.
+	bool rendering = false;
+	bool ready = false;
+	bool failed = false;
+	bool quit = false;
+
+	uint frame = 0;
+
+	DebugRenderer debugRenderer;
+
+	float lastBusyMs = 0.f; //Written by the render thread, guarded by the mutex.
+	float lastIdleMs = 0.f;
+
+	float mainWaitMs = 0.f;
+	float renderBusyMs = 0.f;
+	float renderIdleMs = 0.f;
+	uint framesInFlight = 0;
+
+	static std::vector<std::function<void()>>* commandTarget;
+	static std::map<uint, uint> meshVAOs; //Vertex buffer -> VAO. VAOs are not shared between contexts so they live on the render side.
+};
+
+#endif // !__RENDER_THREAD_H__
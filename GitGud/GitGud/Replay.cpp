@@ -0,0 +1,447 @@
+#include "Replay.h"
+
+#include "App.h"
+#include "Console.h"
+#include "RandGen.h"
+#include "JsonFile.h"
+#include "M_FileSystem.h"
+#include "M_GoManager.h"
+
+#include <algorithm>
+
+enum ReplayFrameFlags
+{
+	REPLAY_KEYS = 1 << 0,
+	REPLAY_BUTTONS = 1 << 1,
+	REPLAY_MOUSE = 1 << 2,
+	REPLAY_COMMANDS = 1 << 3,
+	REPLAY_EVENTS = 1 << 4
+};
+
+struct ReplayHeader
+{
+	uint magic = REPLAY_MAGIC;
+	uint version = REPLAY_VERSION;
+	uint seed = 0;
+	uint frames = 0;
+};
+
+template<typename T>
+static void Write(std::vector<char>& buffer, const T& value)
+{
+	buffer.insert(buffer.end(), (const char*)&value, (const char*)&value + sizeof(T));
+}
+
+static void WriteString(std::vector<char>& buffer, const std::string& str)
+{
+	Write(buffer, (uint16)str.size());
+	buffer.insert(buffer.end(), str.begin(), str.end());
+}
+
+/** Reads the recording buffer failing, instead of overrunning it, on truncated files. */
+struct ReplayReader
+{
+	ReplayReader(const char* data, uint size) : cursor(data), end(data + size)
+	{}
+
+	template<typename T>
+	bool Read(T& value)
+	{
+		return ReadBytes(&value, sizeof(T));
+	}
+
+	bool ReadBytes(void* dst, uint size)
+	{
+		if (cursor + size > end)
+			return false;
+
+		memcpy(dst, cursor, size);
+		cursor += size;
+		return true;
+	}
+
+	bool ReadString(std::string& str)
+	{
+		uint16 size = 0;
+		if (!Read(size) || cursor + size > end)
+			return false;
+
+		str.assign(cursor, size);
+		cursor += size;
+		return true;
+	}
+
+	const char* cursor;
+	const char* end;
+};
+
+static bool SameMouse(const FrameInput& a, const FrameInput& b)
+{
+	return a.mouseX == b.mouseX && a.mouseY == b.mouseY && a.mouseMotionX == b.mouseMotionX && a.mouseMotionY == b.mouseMotionY && a.wheelY == b.wheelY;
+}
+
+//=============================================================================
+
+Replay::Replay()
+{}
+
+Replay::~Replay()
+{}
+
+/** Replay - StartRecording: Reseeds the random generator and records from the next frame on. Saved to the file on Stop. */
+bool Replay::StartRecording(const char * file)
+{
+	if (file == nullptr || *file == '\0')
+		return false;
+
+	Stop();
+
+	this->file = file;
+	frames.clear();
+	frames.push_back(ReplayFrame()); //Collects what happens before the first recorded frame starts.
+	frame = 0;
+	finished = false;
+
+	seed = app->random->GetRandInt();
+	app->random->SetSeed(seed);
+
+	mode = REPLAY_RECORDING;
+	_LOG(LOG_INFO, "Replay: Recording into [%s].", file);
+	return true;
+}
+
+/** Replay - StartPlaying: Loads the recording and plays it from the next frame on. The frame times are saved to the trace file,
+						   if any, when it ends. A fixed dt replaces the recorded ones. */
+bool Replay::StartPlaying(const char * file, const char* traceFile, float fixedDt)
+{
+	if (file == nullptr)
+		return false;
+
+	Stop();
+
+	if (!LoadRecording(file))
+	{
+		_LOG(LOG_ERROR, "Replay: Could not load the recording [%s].", file);
+		return false;
+	}
+
+	this->file = file;
+	this->traceFile = traceFile ? traceFile : "";
+	this->fixedDt = fixedDt;
+	frame = 0;
+	finished = false;
+	frameMs.clear();
+	frameMs.reserve(frames.size());
+
+	app->random->SetSeed(seed);
+
+	mode = REPLAY_PLAYING;
+	_LOG(LOG_INFO, "Replay: Playing [%s], %u frames.", file, (uint)frames.size());
+	return true;
+}
+
+/** Replay - Stop: Saves the recording, or the trace of the frames played so far, and goes idle. */
+void Replay::Stop()
+{
+	if (mode == REPLAY_RECORDING)
+	{
+		//The frame in progress never ran, keep it only for what it already collected
+		if (!frames.empty() && frames.back().commands.empty() && frames.back().events.empty())
+			frames.pop_back();
+
+		if (SaveRecording())
+		{
+			_LOG(LOG_INFO, "Replay: Recorded %u frames into [%s].", (uint)frames.size(), file.c_str());
+		}
+		else
+		{
+			_LOG(LOG_ERROR, "Replay: Could not save the recording [%s].", file.c_str());
+		}
+	}
+	else if (mode == REPLAY_PLAYING)
+	{
+		app->clock->SetForcedDT(0.f);
+
+		float total = 0.f;
+		for (std::vector<float>::const_iterator it = frameMs.begin(); it != frameMs.end(); ++it)
+			total += *it;
+
+		_LOG(LOG_INFO, "Replay: Played %u of %u frames, %.2f ms per frame.", (uint)frameMs.size(), (uint)frames.size(), frameMs.empty() ? 0.f : total / frameMs.size());
+
+		if (!traceFile.empty() && !SaveTrace())
+			_LOG(LOG_ERROR, "Replay: Could not save the frame trace [%s].", traceFile.c_str());
+
+		finished = true;
+	}
+
+	mode = REPLAY_IDLE;
+	frames.clear();
+	frameMs.clear();
+}
+
+ReplayMode Replay::GetMode() const
+{
+	return mode;
+}
+
+/** Replay - HasFinished: True once a replay has played all its frames. */
+bool Replay::HasFinished() const
+{
+	return finished;
+}
+
+uint Replay::GetFrame() const
+{
+	return frame;
+}
+
+uint Replay::GetFrameCount() const
+{
+	return frames.size();
+}
+
+/** Replay - OnFrameBegin: When playing, forces the frame dt and runs the frame events and commands. Must be called before
+						   the clock prepares the frame. */
+void Replay::OnFrameBegin()
+{
+	if (mode != REPLAY_PLAYING)
+		return;
+
+	if (frame >= frames.size())
+	{
+		Stop();
+		return;
+	}
+
+	const ReplayFrame& current = frames[frame];
+
+	app->clock->SetForcedDT(fixedDt > 0.f ? fixedDt : current.dt);
+
+	for (std::vector<uchar>::const_iterator it = current.events.begin(); it != current.events.end(); ++it)
+	{
+		switch (*it)
+		{
+		case REPLAY_EVENT_LOAD_SCENE: app->goManager->LoadScene(); break;
+		case REPLAY_EVENT_SAVE_SCENE: app->goManager->SaveScene(); break;
+		}
+	}
+
+	for (std::vector<std::string>::const_iterator it = current.commands.begin(); it != current.commands.end(); ++it)
+		app->console->OnCmdSubmision(it->c_str());
+
+	frameTimer.Start();
+}
+
+/** Replay - OnFrameEnd: Closes the frame: stores its dt when recording, its time when playing. */
+void Replay::OnFrameEnd()
+{
+	if (mode == REPLAY_RECORDING)
+	{
+		frames.back().dt = app->clock->DT();
+		frames.push_back(ReplayFrame());
+		++frame;
+	}
+	else if (mode == REPLAY_PLAYING)
+	{
+		frameMs.push_back((float)frameTimer.ReadMs());
+		if (++frame >= frames.size())
+			Stop();
+	}
+}
+
+void Replay::RecordInput(const FrameInput & input)
+{
+	if (mode == REPLAY_RECORDING)
+		frames.back().input = input;
+}
+
+/** Replay - RecordCommand: Records a submitted console command, but the replay ones. */
+void Replay::RecordCommand(const char * command)
+{
+	if (mode == REPLAY_RECORDING && command && strncmp(command, "replay", 6) != 0)
+		frames.back().commands.push_back(command);
+}
+
+void Replay::RecordEvent(ReplayEvent event)
+{
+	if (mode == REPLAY_RECORDING)
+		frames.back().events.push_back((uchar)event);
+}
+
+/** Replay - GetReplayedInput: Input of the frame being played, nullptr when not playing. */
+const FrameInput * Replay::GetReplayedInput() const
+{
+	return (mode == REPLAY_PLAYING && frame < frames.size()) ? &frames[frame].input : nullptr;
+}
+
+bool Replay::SaveRecording() const
+{
+	std::vector<char> buffer;
+	buffer.reserve(sizeof(ReplayHeader) + frames.size() * 8);
+
+	ReplayHeader header;
+	header.seed = seed;
+	header.frames = (uint)frames.size();
+	Write(buffer, header);
+
+	FrameInput previous;
+	for (std::vector<ReplayFrame>::const_iterator it = frames.begin(); it != frames.end(); ++it)
+	{
+		const FrameInput& input = it->input;
+
+		uchar flags = 0;
+		if (memcmp(input.keys, previous.keys, sizeof(input.keys)) != 0) flags |= REPLAY_KEYS;
+		if (input.buttons != previous.buttons) flags |= REPLAY_BUTTONS;
+		if (!SameMouse(input, previous)) flags |= REPLAY_MOUSE;
+		if (!it->commands.empty()) flags |= REPLAY_COMMANDS;
+		if (!it->events.empty()) flags |= REPLAY_EVENTS;
+
+		Write(buffer, it->dt);
+		Write(buffer, flags);
+
+		if (flags & REPLAY_KEYS)
+			buffer.insert(buffer.end(), (const char*)input.keys, (const char*)input.keys + sizeof(input.keys));
+
+		if (flags & REPLAY_BUTTONS)
+			Write(buffer, (uchar)input.buttons);
+
+		if (flags & REPLAY_MOUSE)
+		{
+			Write(buffer, (int16)input.mouseX);
+			Write(buffer, (int16)input.mouseY);
+			Write(buffer, (int16)input.mouseMotionX);
+			Write(buffer, (int16)input.mouseMotionY);
+			Write(buffer, (int16)input.wheelY);
+		}
+
+		if (flags & REPLAY_COMMANDS)
+		{
+			Write(buffer, (uint16)it->commands.size());
+			for (std::vector<std::string>::const_iterator cmd = it->commands.begin(); cmd != it->commands.end(); ++cmd)
+				WriteString(buffer, *cmd);
+		}
+
+		if (flags & REPLAY_EVENTS)
+		{
+			Write(buffer, (uchar)it->events.size());
+			buffer.insert(buffer.end(), it->events.begin(), it->events.end());
+		}
+
+		previous = input;
+	}
+
+	return app->fs->Save(file.c_str(), buffer.data(), buffer.size()) == buffer.size();
+}
+
+bool Replay::LoadRecording(const char * file)
+{
+	frames.clear();
+
+	char* data = nullptr;
+	uint size = app->fs->Load(file, &data);
+	if (data == nullptr || size == 0)
+	{
+		RELEASE_ARRAY(data);
+		return false;
+	}
+
+	ReplayReader reader(data, size);
+	ReplayHeader header;
+	bool ret = reader.Read(header) && header.magic == REPLAY_MAGIC && header.version == REPLAY_VERSION;
+
+	if (ret)
+	{
+		seed = header.seed;
+		frames.resize(header.frames);
+
+		FrameInput previous;
+		for (uint i = 0; i < header.frames && ret; ++i)
+		{
+			ReplayFrame& current = frames[i];
+			current.input = previous;
+
+			uchar flags = 0;
+			ret = reader.Read(current.dt) && reader.Read(flags);
+
+			if (ret && (flags & REPLAY_KEYS))
+				ret = reader.ReadBytes(current.input.keys, sizeof(current.input.keys));
+
+			if (ret && (flags & REPLAY_BUTTONS))
+			{
+				uchar buttons = 0;
+				ret = reader.Read(buttons);
+				current.input.buttons = buttons;
+			}
+
+			if (ret && (flags & REPLAY_MOUSE))
+			{
+				int16 mouse[5];
+				ret = reader.ReadBytes(mouse, sizeof(mouse));
+				current.input.mouseX = mouse[0];
+				current.input.mouseY = mouse[1];
+				current.input.mouseMotionX = mouse[2];
+				current.input.mouseMotionY = mouse[3];
+				current.input.wheelY = mouse[4];
+			}
+
+			if (ret && (flags & REPLAY_COMMANDS))
+			{
+				uint16 count = 0;
+				ret = reader.Read(count);
+				current.commands.resize(count);
+				for (uint c = 0; c < count && ret; ++c)
+					ret = reader.ReadString(current.commands[c]);
+			}
+
+			if (ret && (flags & REPLAY_EVENTS))
+			{
+				uchar count = 0;
+				ret = reader.Read(count);
+				current.events.resize(count);
+				if (ret && count > 0)
+					ret = reader.ReadBytes(current.events.data(), count);
+			}
+
+			previous = current.input;
+		}
+	}
+
+	if (!ret)
+		frames.clear();
+
+	RELEASE_ARRAY(data);
+	return ret;
+}
+
+/** Replay - SaveTrace: Saves the wall time of every played frame and its percentiles as json. */
+bool Replay::SaveTrace() const
+{
+	JsonFile json;
+	json.AddString("replay", file.c_str());
+	json.AddUInt("frames", (uint)frameMs.size());
+	json.AddFloat("fixed_dt", fixedDt);
+
+	if (!frameMs.empty())
+	{
+		std::vector<float> sorted(frameMs);
+		std::sort(sorted.begin(), sorted.end());
+
+		float total = 0.f;
+		for (std::vector<float>::const_iterator it = sorted.begin(); it != sorted.end(); ++it)
+			total += *it;
+
+		json.AddFloat("avg_ms", total / sorted.size());
+		json.AddFloat("p50_ms", sorted[(sorted.size() - 1) / 2]);
+		json.AddFloat("p90_ms", sorted[(uint)((sorted.size() - 1) * 0.9f)]);
+		json.AddFloat("p99_ms", sorted[(uint)((sorted.size() - 1) * 0.99f)]);
+		json.AddFloat("max_ms", sorted.back());
+		json.AddFloatArray("frame_ms", (float*)frameMs.data(), frameMs.size());
+	}
+
+	std::string buffer = json.Write(true);
+	bool ret = app->fs->Save(traceFile.c_str(), buffer.c_str(), buffer.size()) == buffer.size();
+	if (ret)
+		_LOG(LOG_INFO, "Replay: Frame trace saved to [%s].", traceFile.c_str());
+
+	return ret;
+}
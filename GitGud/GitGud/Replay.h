@@ -0,0 +1,88 @@
+#ifndef __REPLAY_H__
+#define __REPLAY_H__
+
+#include "Globals.h"
+#include "M_Input.h"
+#include "PerfTimer.h"
+#include <vector>
+#include <string>
+
+#define REPLAY_MAGIC 0x50524747 //"GGRP"
+#define REPLAY_VERSION 1
+
+enum ReplayMode
+{
+	REPLAY_IDLE,
+	REPLAY_RECORDING,
+	REPLAY_PLAYING
+};
+
+enum ReplayEvent
+{
+	REPLAY_EVENT_LOAD_SCENE,
+	REPLAY_EVENT_SAVE_SCENE
+};
+
+/** Everything recorded in a frame. */
+struct ReplayFrame
+{
+	float dt = 0.f;
+	FrameInput input;
+	std::vector<std::string> commands;
+	std::vector<uchar> events;
+};
+
+/**
+*	- Records the per frame input, dt, console commands and scene events of a run into a compact binary file, and plays them
+*	  back: input is fed through M_Input, dt is forced into GG_Clock and commands and events run at the start of their frame.
+*	- The random generator is seeded from the file, so a replay is the same workload on any build. ImGui still reads the live
+*	  mouse, so editor interactions are replayed through the recorded commands and not through the UI.
+*	- While playing, the wall time of every frame is kept and saved as a frame time trace when the replay ends.
+*	- File: header (magic, version, seed, frame count) and then, per frame, the dt, a flags byte and only what changed from
+*	  the previous frame: key bitmask, mouse buttons, mouse state, commands and events.
+*/
+class Replay
+{
+public:
+	Replay();
+	~Replay();
+
+	bool StartRecording(const char* file);
+	bool StartPlaying(const char* file, const char* traceFile = nullptr, float fixedDt = 0.f);
+	void Stop();
+
+	ReplayMode GetMode()const;
+	bool HasFinished()const;
+	uint GetFrame()const;
+	uint GetFrameCount()const;
+
+	void OnFrameBegin();
+	void OnFrameEnd();
+
+	void RecordInput(const FrameInput& input);
+	void RecordCommand(const char* command);
+	void RecordEvent(ReplayEvent event);
+	const FrameInput* GetReplayedInput()const;
+
+private:
+	bool SaveRecording()const;
+	bool LoadRecording(const char* file);
+	bool SaveTrace()const;
+
+private:
+	ReplayMode mode = REPLAY_IDLE;
+	bool finished = false;
+
+	std::string file;
+	std::string traceFile;
+	uint seed = 0;
+	float fixedDt = 0.f;	//Replaces the recorded dt if set.
+
+	std::vector<ReplayFrame> frames;
+	uint frame = 0;
+
+	PerfTimer frameTimer;
+	std::vector<float> frameMs;
+};
+
+#endif // !__REPLAY_H__
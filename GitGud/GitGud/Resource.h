@@ -15,8 +15,18 @@ enum ResourceType
 	RES_SHADER = 16
 };
 
+enum ResourceLoadState
+{
+	RES_UNLOADED = 0,
+	RES_LOADING,		//Read on a worker thread or waiting for its upload, the data can't be used yet.
+	RES_LOADED,
+	RES_LOAD_FAILED
+};
+
 class Resource
 {
+	friend class M_ResourceManager;
+
 public:
 	Resource(UID uuid, ResourceType resType) : uuid(uuid), type(resType)
 	{}
@@ -43,10 +53,22 @@ public:
 		return instancesLoaded;
 	}
 
-	/** IsInMemory: Return true if is at least one instance in memory. */
+	/** IsInMemory: Return true if is at least one instance in memory and its data is ready to use. */
 	bool IsInMemory()const
 	{
-		return instancesLoaded > 0;
+		return instancesLoaded > 0 && loadState == RES_LOADED;
+	}
+
+	/** GetLoadState: Return the load state, loading while an async load has not finished. */
+	ResourceLoadState GetLoadState()const
+	{
+		return loadState;
+	}
+
+	/** IsReady: Return true if the resource data is loaded and can be used. */
+	bool IsReady()const
+	{
+		return loadState == RES_LOADED;
 	}
 
 	/** GetOriginalFile: Return the original file of the resource. */
@@ -80,13 +102,23 @@ public:
 	}
 
 	/** LoadToMemory: If the resource is already in memory just adds an instance to counter otherwise calls the overloaded LoadInMemory method to current load it for first time. 
+						If an async load is in flight the instance is added to it, the data is ready once IsReady returns true.
 						Return true if could load it properly, false if not. */
 	bool LoadToMemory()
 	{
-		if (instancesLoaded > 0)
+		if (loadState == RES_LOADED || loadState == RES_LOADING)
+		{
 			++instancesLoaded;
+		}
+		else if (instancesLoaded > 0)
+		{
+			return false; //An async load failed, until its instances are removed
+		}
 		else
+		{
 			instancesLoaded = LoadInMemory() ? 1 : 0;
+			loadState = instancesLoaded > 0 ? RES_LOADED : RES_LOAD_FAILED;
+		}
 
 		return instancesLoaded > 0;
 	}
@@ -96,28 +128,42 @@ public:
 	bool FreeResource()
 	{
 		bool ret = false;
+		if (loadState == RES_LOADING)
+		{
+			instancesLoaded = 0; //Freed when the load finishes
+			return true;
+		}
+
 		if (instancesLoaded > 0)
 			ret = RemoveFromMemory();
 
 		if (ret)
+		{
 			instancesLoaded = 0;
+			loadState = RES_UNLOADED;
+		}
 
 		return ret;
 	}
 
-	/** AddInstance: Just add one to the instance counter. */
+	/** AddInstance: Just add one to the instance counter. Used for the resources loaded by hand, so the first one marks it as loaded. */
 	void AddInstance()
 	{
-		++instancesLoaded;
+		if (instancesLoaded++ == 0)
+			loadState = RES_LOADED;
 	}
 
-	/** RemoveInstace: Just remove one instace from the instances counter if is higher than one. If there was only one left also free the resource from memory. */
+	/** RemoveInstace: Just remove one instace from the instances counter if is higher than one. If there was only one left also free the resource from memory.
+						While an async load is in flight the resource is freed when it finishes instead. */
 	void RemoveInstance()
 	{
 		if (instancesLoaded > 0)
 		{
-			if (instancesLoaded == 1)
+			if (instancesLoaded == 1 && loadState != RES_LOADING)
+			{
 				RemoveFromMemory();
+				loadState = RES_UNLOADED;
+			}
 			--instancesLoaded;
 		}
 	}
@@ -153,6 +199,13 @@ protected:
 	/** RemoveFromMemory: Pure virtual method called when want to actually free the resource from memory. For example a mesh or a texture. */
 	virtual bool RemoveFromMemory() = 0;
 
+	/** CanLoadAsync: Virtual method, true if the resource implements ReadAsync and UploadAsync. Otherwise async loads call LoadInMemory. */
+	virtual bool CanLoadAsync()const { return false; }
+	/** ReadAsync: Virtual method called on a worker thread. Reads and decodes the resource into load data of its own, without GL calls nor touching the data the main thread uses. */
+	virtual bool ReadAsync() { return false; }
+	/** UploadAsync: Virtual method called on the main thread after ReadAsync. Moves the load data into the resource and uploads it to VRAM. If the read failed it only frees the load data. */
+	virtual bool UploadAsync(bool read) { return false; }
+
 public:
 	Path originalFile;
 	Path exportedFile;
@@ -164,6 +217,10 @@ protected:
 	UID uuid;
 
 	uint instancesLoaded = 0;
+	ResourceLoadState loadState = RES_UNLOADED;
+
+	uint64 residentCpu = 0; //Bytes counted in the residency totals of the resource manager.
+	uint64 residentGpu = 0;
 };
 
 #endif // !__RESOURCE_H__
@@ -145,6 +145,24 @@ void ResourceMaterial::SendMaterialToShader(float* model, float* camView, float*
 	}
 }
 
+/** ResourceMaterial - GetMainTexture: Return the texture of the material if it only uses one, 0 if it uses none or several. */
+UID ResourceMaterial::GetMainTexture() const
+{
+	UID ret = 0;
+
+	for (std::map<std::string, MaterialProperty*>::const_iterator it = properties.begin(); it != properties.end(); ++it)
+	{
+		if (it->second->propertyType == MaterialProperty::MP_TEXTURE_RES)
+		{
+			if (ret != 0)
+				return 0;
+			ret = it->second->property.textureResId;
+		}
+	}
+
+	return ret;
+}
+
 bool ResourceMaterial::SaveMaterial()
 {
 	return app->resources->materialImporter->SaveResource(this);
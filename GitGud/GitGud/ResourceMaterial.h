@@ -97,6 +97,8 @@ public:
 	void SendMaterialToShader(float* model, float* camView, float* camProj);
 
 	bool SaveMaterial();
+
+	UID GetMainTexture()const;
 	
 private:
 
@@ -3,9 +3,11 @@
 #include "App.h"
 #include "M_FileSystem.h"
 #include "ImporterMesh.h"
+#include "MappedFile.h"
 #include "M_ResourceManager.h"
 
-#include "OpenGL.h"
+#include "GLState.h"
+#include "RenderThread.h"
 
 
 ResourceMesh::ResourceMesh(UID uuid) : Resource(uuid, RES_MESH)
@@ -15,6 +17,7 @@ ResourceMesh::ResourceMesh(UID uuid) : Resource(uuid, RES_MESH)
 
 ResourceMesh::~ResourceMesh()
 {
+	RELEASE(pendingLoad);
 	RemoveFromMemory();
 }
 
@@ -25,14 +28,43 @@ bool ResourceMesh::LoadInMemory()
 	return app->resources->meshImporter->LoadResource(this);
 }
 
+/** ReadAsync: Overloaded method. Reads the mesh file and packs its buffers on a worker thread. */
+bool ResourceMesh::ReadAsync()
+{
+	pendingLoad = new MeshLoadData();
+	return app->resources->meshImporter->ReadResource(exportedFile, *pendingLoad);
+}
+
+/** UploadAsync: Overloaded method. Moves the mesh read into this one and uploads it. */
+bool ResourceMesh::UploadAsync(bool read)
+{
+	bool ret = false;
+	if (pendingLoad)
+	{
+		ret = app->resources->meshImporter->UploadResource(this, *pendingLoad, read);
+		RELEASE(pendingLoad);
+	}
+
+	return ret;
+}
+
 /** RemoveFromMemory: Overloaded method. Actually frees the mesh resource from memory including VRAM. */
 bool ResourceMesh::RemoveFromMemory()
 {
-	RELEASE_ARRAY(indices);
-	RELEASE_ARRAY(vertices);
-	RELEASE_ARRAY(normals);
-	RELEASE_ARRAY(uvs);
-	RELEASE_ARRAY(colors);
+	if (mappedFile)
+	{
+		indices = nullptr;
+		vertices = normals = uvs = colors = nullptr;
+		RELEASE(mappedFile);
+	}
+	else
+	{
+		RELEASE_ARRAY(indices);
+		RELEASE_ARRAY(vertices);
+		RELEASE_ARRAY(normals);
+		RELEASE_ARRAY(uvs);
+		RELEASE_ARRAY(colors);
+	}
 
 	numIndices = 0;
 	numVertices = 0;
@@ -49,14 +81,74 @@ void ResourceMesh::LoadToVRAM()
 	app->resources->meshImporter->GenBuffers(this);
 }
 
-/** FreeFromVRAM: Frees the resource from VRAM but not the full resource data. */
+/** FreeFromVRAM: Frees the resource from VRAM but not the full resource data. The buffers may still be used by a packet in flight,
+				   so they are deleted on the render side, together with the VAO it created for them. */
 void ResourceMesh::FreeFromVRAM()
 {
-	if (idIndices > 0) { glDeleteBuffers(1, &idIndices); idIndices = 0; }
-	if (idVertices > 0) { glDeleteBuffers(1, &idVertices); idVertices = 0; }
-	if (idNormals > 0) { glDeleteBuffers(1, &idNormals); idNormals = 0; }
-	if (idUvs > 0) { glDeleteBuffers(1, &idUvs); idUvs = 0; }
-	if (idColors > 0) { glDeleteBuffers(1, &idColors); idColors = 0; }
+	uint buffers[5] = { idVertices, idNormals, idUvs, idColors, idIndices };
+	if (idVertices > 0 || idIndices > 0)
+	{
+		RenderThread::Enqueue([buffers]()
+		{
+			RenderThread::ReleaseMeshVAO(buffers[0]);
+			for (uint i = 0; i < 5; ++i)
+				GLState::DeleteBuffer(buffers[i]);
+		});
+	}
+
+	idIndices = idVertices = idNormals = idUvs = idColors = 0;
+
+	shortIndices = false;
+	vramBytes = 0;
+}
+
+/** TakeData: Moves the mesh data of other, that must have no VRAM buffers, into this mesh, freeing the current one. */
+void ResourceMesh::TakeData(ResourceMesh & other)
+{
+	RemoveFromMemory();
+
+	numIndices = other.numIndices;
+	indices = other.indices;
+	numVertices = other.numVertices;
+	vertices = other.vertices;
+	normals = other.normals;
+	uvs = other.uvs;
+	colors = other.colors;
+	vertexFormat = other.vertexFormat;
+	mappedFile = other.mappedFile;
+	aabb = other.aabb;
+
+	other.indices = nullptr;
+	other.vertices = other.normals = other.uvs = other.colors = nullptr;
+	other.mappedFile = nullptr;
+	other.numIndices = other.numVertices = 0;
+}
+
+/** GetFloatLayoutBytes: Returns the VRAM the mesh would use with the legacy layout (32 bit floats and indices). */
+uint ResourceMesh::GetFloatLayoutBytes() const
+{
+	uint vertexSize = sizeof(float) * 3;
+	if (normals) vertexSize += sizeof(float) * 3;
+	if (uvs) vertexSize += sizeof(float) * 2;
+	if (colors) vertexSize += sizeof(float) * 3;
+
+	return vertexSize * numVertices + sizeof(uint) * numIndices;
+}
+
+/** GetDrawInfo: Fills the GL handles and layout the render side needs to draw the mesh. */
+void ResourceMesh::GetDrawInfo(MeshDrawInfo & info) const
+{
+	info.idVertices = idVertices;
+	info.idNormals = idNormals;
+	info.idUvs = idUvs;
+	info.idColors = idColors;
+	info.idIndices = idIndices;
+
+	info.vertexFormat = vertexFormat;
+	info.normals = normals != nullptr;
+	info.uvs = uvs != nullptr;
+	info.colors = colors != nullptr;
 
-	if (idContainer > 0) { glDeleteVertexArrays(1, &idContainer); idContainer = 0; }
+	info.numIndices = numIndices;
+	info.shortIndices = shortIndices;
 }
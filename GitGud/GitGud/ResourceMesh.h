@@ -4,6 +4,23 @@
 #include "Resource.h"
 #include "Math.h"
 
+struct MeshDrawInfo;
+struct MeshLoadData;
+class MappedFile;
+
+/** Layout used for the mesh data on the GPU. Chosen at import time and stored in the mesh file. */
+enum VertexFormatFlags
+{
+	VF_INTERLEAVED = 1 << 0,	//All the attributes in a single vertex buffer.
+	VF_HALF_UVS = 1 << 1,		//UVs as 16 bit floats.
+	VF_SNORM_NORMALS = 1 << 2,	//Normals packed as signed normalized 10:10:10:2.
+	VF_UNORM8_COLORS = 1 << 3,	//Colors as unsigned normalized 8 bit.
+	VF_SHORT_INDICES = 1 << 4	//16 bit indices when the mesh has less than 65536 vertices.
+};
+
+#define VF_LEGACY 0
+#define VF_COMPACT (VF_INTERLEAVED | VF_HALF_UVS | VF_SNORM_NORMALS | VF_UNORM8_COLORS | VF_SHORT_INDICES)
+
 class ResourceMesh : public Resource
 {
 public:
@@ -16,6 +33,11 @@ public:
 	void LoadToVRAM();
 	void FreeFromVRAM();
 
+	void TakeData(ResourceMesh& other);
+
+	uint GetFloatLayoutBytes()const;
+	void GetDrawInfo(MeshDrawInfo& info)const;
+
 public:
 	uint numIndices = 0;
 	uint* indices = nullptr;
@@ -29,6 +51,10 @@ public:
 	float* uvs = nullptr;
 	float* colors = nullptr;
 
+	uint vertexFormat = VF_LEGACY;
+
+	MappedFile* mappedFile = nullptr; //If set the arrays point into the mesh file instead of owning their memory.
+
 	//----------------------
 
 	uint idIndices = 0;
@@ -37,12 +63,20 @@ public:
 	uint idUvs = 0;
 	uint idColors = 0;
 
-	uint idContainer = 0;
+	bool shortIndices = false;
+	uint vramBytes = 0;
 
 	//----------------------
 
 	AABB aabb;
 
+protected:
+	bool CanLoadAsync()const override { return true; }
+	bool ReadAsync()override;
+	bool UploadAsync(bool read)override;
+
+private:
+	MeshLoadData* pendingLoad = nullptr; //Only while an async load is in flight.
 };
 
 #endif // !__RESOURCE_MESH_H__
\ No newline at end of file
@@ -0,0 +1,294 @@
+#include "ResourceRegistry.h"
+
+#include "App.h"
+#include "M_FileSystem.h"
+#include "Hash.h"
+
+#include <map>
+#include <string>
+#include <algorithm>
+
+ResourceRegistry::ResourceRegistry()
+{}
+
+ResourceRegistry::~ResourceRegistry()
+{
+	Close();
+}
+
+/** ResourceRegistry - Open: Maps the registry file and reads its journal. The base records are only read on demand. */
+bool ResourceRegistry::Open(const char * file)
+{
+	Close();
+
+	if (!mapped.Open(file))
+		return false;
+
+	const char* data = mapped.GetData();
+	uint64 size = mapped.GetSize();
+
+	const RegistryHeader* h = (const RegistryHeader*)data;
+	if (size < sizeof(RegistryHeader) || memcmp(h->magic, REGISTRY_MAGIC, 4) != 0 || (h->version != REGISTRY_VERSION && h->version != 1))
+	{
+		_LOG(LOG_WARN, "Registry '%s' has an unknown format or version.", file);
+		Close();
+		return false;
+	}
+
+	recordSize = h->version == 1 ? REGISTRY_V1_RECORD_SIZE : sizeof(RegistryRecord);
+
+	bool valid = h->recordsOffset >= sizeof(RegistryHeader) && (h->recordsOffset & 3) == 0 &&
+		(uint64)h->recordsOffset + (uint64)h->numRecords * recordSize <= h->stringsOffset &&
+		h->stringsSize > 0 && (uint64)h->stringsOffset + h->stringsSize <= h->journalOffset &&
+		h->journalOffset <= size && data[h->stringsOffset + h->stringsSize - 1] == '\0';
+
+	if (!valid)
+	{
+		_LOG(LOG_ERROR, "Registry '%s' is corrupted.", file);
+		Close();
+		return false;
+	}
+
+	header = h;
+	records = data + h->recordsOffset;
+	strings = data + h->stringsOffset;
+
+	ReadJournal(h->journalOffset);
+
+	return true;
+}
+
+void ResourceRegistry::Close()
+{
+	mapped.Close();
+	header = nullptr;
+	records = nullptr;
+	recordSize = sizeof(RegistryRecord);
+	strings = nullptr;
+	journal.clear();
+	journalEnd = 0;
+	journalTorn = false;
+}
+
+bool ResourceRegistry::IsOpen() const
+{
+	return header != nullptr;
+}
+
+uint ResourceRegistry::GetNumRecords() const
+{
+	return header ? header->numRecords : 0;
+}
+
+/** ResourceRegistry - GetRecord: Fills the entry with the base record at the index, sorted by UID. False if it is out of range or corrupted. */
+bool ResourceRegistry::GetRecord(uint index, RegistryEntry & entry) const
+{
+	if (index >= GetNumRecords())
+		return false;
+
+	const RegistryRecord* r = GetRecordPtr(index);
+	entry.uid = r->uid;
+	entry.type = r->type;
+	entry.data = "";
+
+	return GetString(r->originalFile, entry.originalFile) && GetString(r->exportedFile, entry.exportedFile) && GetString(r->name, entry.name) &&
+		(header->version == 1 || GetString(r->data, entry.data));
+}
+
+/** ResourceRegistry - Find: Binary search of the UID in the base records. The journal is not searched. */
+bool ResourceRegistry::Find(UID uid, RegistryEntry & entry) const
+{
+	if (!header)
+		return false;
+
+	//The records of the previous version are smaller, searched by index
+	uint first = 0;
+	uint count = header->numRecords;
+	while (count > 0)
+	{
+		uint half = count / 2;
+		if (GetRecordPtr(first + half)->uid < uid)
+		{
+			first += half + 1;
+			count -= half + 1;
+		}
+		else
+		{
+			count = half;
+		}
+	}
+
+	if (first == header->numRecords || GetRecordPtr(first)->uid != uid)
+		return false;
+
+	return GetRecord(first, entry);
+}
+
+const std::vector<RegistryEntry>& ResourceRegistry::GetJournal() const
+{
+	return journal;
+}
+
+/** ResourceRegistry - IsJournalTorn: Return true if the file has bytes after the last valid journal entry. */
+bool ResourceRegistry::IsJournalTorn() const
+{
+	return journalTorn;
+}
+
+/** ResourceRegistry - IsOutdated: Return true if the file is of the previous version, without the data of the resources. */
+bool ResourceRegistry::IsOutdated() const
+{
+	return header && header->version != REGISTRY_VERSION;
+}
+
+/** ResourceRegistry - Write: Writes a new registry file with the entries as the base and an empty journal. */
+bool ResourceRegistry::Write(const char * file, const std::vector<RegistryEntry>& entries)
+{
+	std::vector<const RegistryEntry*> sorted;
+	sorted.reserve(entries.size());
+	for (std::vector<RegistryEntry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+		sorted.push_back(&(*it));
+	std::sort(sorted.begin(), sorted.end(), [](const RegistryEntry* a, const RegistryEntry* b) { return a->uid < b->uid; });
+
+	//Repeated strings (the same original file for all the meshes of a scene) are stored once
+	std::string table(1, '\0');
+	std::map<std::string, uint> offsets;
+	offsets[""] = 0;
+
+	std::vector<RegistryRecord> records(sorted.size());
+	for (uint i = 0; i < sorted.size(); ++i)
+	{
+		const char* fields[4] = { sorted[i]->originalFile, sorted[i]->exportedFile, sorted[i]->name, sorted[i]->data };
+		uint* dst[4] = { &records[i].originalFile, &records[i].exportedFile, &records[i].name, &records[i].data };
+
+		for (uint f = 0; f < 4; ++f)
+		{
+			std::map<std::string, uint>::iterator found = offsets.find(fields[f]);
+			if (found == offsets.end())
+			{
+				found = offsets.insert(std::make_pair(std::string(fields[f]), (uint)table.size())).first;
+				table.append(fields[f]);
+				table.push_back('\0');
+			}
+			*dst[f] = found->second;
+		}
+
+		records[i].uid = sorted[i]->uid;
+		records[i].type = sorted[i]->type;
+	}
+
+	while (table.size() & 3)
+		table.push_back('\0');
+
+	RegistryHeader h;
+	memcpy(h.magic, REGISTRY_MAGIC, 4);
+	h.numRecords = records.size();
+	h.recordsOffset = sizeof(RegistryHeader);
+	h.stringsOffset = h.recordsOffset + records.size() * sizeof(RegistryRecord);
+	h.stringsSize = table.size();
+	h.journalOffset = h.stringsOffset + h.stringsSize;
+
+	std::vector<char> buffer(h.journalOffset);
+	memcpy(buffer.data(), &h, sizeof(h));
+	if (!records.empty())
+		memcpy(buffer.data() + h.recordsOffset, records.data(), records.size() * sizeof(RegistryRecord));
+	memcpy(buffer.data() + h.stringsOffset, table.data(), table.size());
+
+	return app->fs->Save(file, buffer.data(), buffer.size()) == buffer.size();
+}
+
+/** ResourceRegistry - Append: Appends the entries to the journal of an existing registry file. */
+bool ResourceRegistry::Append(const char * file, const std::vector<RegistryEntry>& entries)
+{
+	std::vector<char> buffer;
+
+	for (std::vector<RegistryEntry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+	{
+		std::string str;
+		str.append(it->originalFile).push_back('\0');
+		str.append(it->exportedFile).push_back('\0');
+		str.append(it->name).push_back('\0');
+		str.append(it->data).push_back('\0');
+		while (str.size() & 3)
+			str.push_back('\0');
+
+		RegistryJournalEntry e;
+		e.uid = it->uid;
+		e.type = it->type;
+		e.stringsSize = str.size();
+		e.checksum = XXHash32(str.data(), str.size());
+
+		buffer.insert(buffer.end(), (const char*)&e, (const char*)&e + sizeof(e));
+		buffer.insert(buffer.end(), str.begin(), str.end());
+	}
+
+	if (buffer.empty())
+		return true;
+
+	return app->fs->Append(file, buffer.data(), buffer.size()) == buffer.size();
+}
+
+/** ResourceRegistry - ReadJournal: Reads the journal entries from the offset to the end of the file. Stops at the first
+									 invalid one, the end of an append that did not finish, and flags the journal as torn. */
+void ResourceRegistry::ReadJournal(uint offset)
+{
+	const char* data = mapped.GetData();
+	uint size = mapped.GetSize();
+
+	journalEnd = offset;
+
+	while ((uint64)offset + sizeof(RegistryJournalEntry) <= size)
+	{
+		RegistryJournalEntry e;
+		memcpy(&e, data + offset, sizeof(e));
+
+		const char* str = data + offset + sizeof(e);
+		if (e.magic != REGISTRY_JOURNAL_MAGIC || (e.stringsSize & 3) != 0 || (uint64)offset + sizeof(e) + e.stringsSize > size ||
+			XXHash32(str, e.stringsSize) != e.checksum)
+		{
+			_LOG(LOG_WARN, "Registry journal: Ignoring the entries after an invalid one at %u.", offset);
+			break;
+		}
+
+		RegistryEntry entry;
+		entry.uid = e.uid;
+		entry.type = e.type;
+
+		const char** fields[4] = { &entry.originalFile, &entry.exportedFile, &entry.name, &entry.data };
+		uint numFields = header->version == 1 ? 3 : 4;
+		const char* end = str + e.stringsSize;
+		bool valid = true;
+		for (uint f = 0; f < numFields && valid; ++f)
+		{
+			const char* zero = (const char*)memchr(str, '\0', end - str);
+			valid = zero != nullptr;
+			if (valid)
+			{
+				*fields[f] = str;
+				str = zero + 1;
+			}
+		}
+
+		if (valid)
+			journal.push_back(entry);
+
+		offset += sizeof(e) + e.stringsSize;
+		journalEnd = offset;
+	}
+
+	journalTorn = journalEnd != size;
+}
+
+const RegistryRecord* ResourceRegistry::GetRecordPtr(uint index) const
+{
+	return (const RegistryRecord*)(records + (uint64)index * recordSize);
+}
+
+bool ResourceRegistry::GetString(uint offset, const char *& str) const
+{
+	if (offset >= header->stringsSize)
+		return false;
+
+	str = strings + offset;
+	return true;
+}
@@ -0,0 +1,106 @@
+#ifndef __RESOURCE_REGISTRY_H__
+#define __RESOURCE_REGISTRY_H__
+
+#include "Globals.h"
+#include "MappedFile.h"
+
+#include <vector>
+
+#define REGISTRY_MAGIC "GGRG"
+#define REGISTRY_JOURNAL_MAGIC 0x4C4E524A //"JRNL"
+#define REGISTRY_VERSION 2 //2: the per type data of the resources.
+#define REGISTRY_V1_RECORD_SIZE 20
+
+/** Header of the registry file. The base is the record table sorted by UID and the string table, the journal entries follow it. */
+struct RegistryHeader
+{
+	char magic[4];
+	uint version = REGISTRY_VERSION;
+	uint numRecords = 0;
+	uint recordsOffset = 0;
+	uint stringsOffset = 0;
+	uint stringsSize = 0;
+	uint journalOffset = 0; //End of the base.
+	uint reserved = 0;
+};
+
+/** Fixed size record of the base. The strings are offsets in the string table. */
+struct RegistryRecord
+{
+	UID uid = 0;
+	uint type = 0;
+	uint originalFile = 0;
+	uint exportedFile = 0;
+	uint name = 0;
+	uint data = 0;
+};
+
+/** Record appended after the base, followed by its original file, exported file, name and data zero terminated and padded to 4 bytes. */
+struct RegistryJournalEntry
+{
+	uint magic = REGISTRY_JOURNAL_MAGIC;
+	UID uid = 0;
+	uint type = 0;
+	uint stringsSize = 0;
+	uint checksum = 0; //xxHash32 of the strings.
+};
+
+/** A resource of the registry. When read from the file the strings point into the mapping, valid until it is closed. */
+struct RegistryEntry
+{
+	UID uid = 0;
+	uint type = 0;
+	const char* originalFile = "";
+	const char* exportedFile = "";
+	const char* name = "";
+	const char* data = "";	//Json written by the resource OnSave, empty if it writes nothing.
+};
+
+/**
+*	- Binary registry of the resources. The file is mapped and the base records are found by binary search when needed,
+*	  instead of parsing and creating every resource on start.
+*	- Saving appends journal entries with the records created or changed since the last save. Write rewrites the whole
+*	  file with the journal merged into the base. A journal with an unfinished append at its end must be rewritten, the
+*	  entries appended after it would never be read.
+*	- The file is opened without write sharing, close it before writing into it.
+*	- Files of the previous version are read without the data of the resources, and must be rewritten before appending.
+*/
+class ResourceRegistry
+{
+public:
+	ResourceRegistry();
+	~ResourceRegistry();
+
+	bool Open(const char* file);
+	void Close();
+	bool IsOpen()const;
+
+	uint GetNumRecords()const;
+	bool GetRecord(uint index, RegistryEntry& entry)const;
+	bool Find(UID uid, RegistryEntry& entry)const;
+
+	const std::vector<RegistryEntry>& GetJournal()const;
+	bool IsJournalTorn()const;
+	bool IsOutdated()const;
+
+	static bool Write(const char* file, const std::vector<RegistryEntry>& entries);
+	static bool Append(const char* file, const std::vector<RegistryEntry>& entries);
+
+private:
+	void ReadJournal(uint offset);
+	const RegistryRecord* GetRecordPtr(uint index)const;
+	bool GetString(uint offset, const char*& str)const;
+
+private:
+	MappedFile mapped;
+	const RegistryHeader* header = nullptr;
+	const char* records = nullptr;
+	uint recordSize = sizeof(RegistryRecord);	//Smaller in the previous version, without the data.
+	const char* strings = nullptr;
+
+	std::vector<RegistryEntry> journal; //In file order, later entries of an UID replace the earlier ones.
+	uint journalEnd = 0;				//End of the last valid journal entry.
+	bool journalTorn = false;			//There are bytes after it, appending would leave them in between.
+};
+
+#endif // !__RESOURCE_REGISTRY_H__
@@ -4,6 +4,9 @@
 #include "M_FileSystem.h"
 #include "M_ResourceManager.h"
 #include "ImporterShader.h"
+#include "GLState.h"
+#include "RenderBackend.h"
+#include "RenderThread.h"
 
 #include "OpenGL.h"
 
@@ -26,7 +29,11 @@ bool ResourceShader::LoadInMemory()
 
 bool ResourceShader::RemoveFromMemory()
 {
-	if (shaderID != 0) glDeleteProgram(shaderID);
+	if (shaderID != 0)
+	{
+		uint program = shaderID;
+		RenderThread::Enqueue([program]() { GLState::DeleteProgram(program); }); //May still be in use by a packet in flight
+	}
 
 	if (!vertexCode.empty()) vertexCode.clear();
 	if (!fragmentCode.empty()) fragmentCode.clear();
@@ -69,30 +76,30 @@ uint ResourceShader::CompileCode(ShaderType type, const char * code)
 
 	if (code)
 	{
-		uint sh = 0;
+		uint glType = 0;
 
 		switch (type)
 		{
 		case ResourceShader::SH_VERTEX:
-			sh = glCreateShader(GL_VERTEX_SHADER);
+			glType = GL_VERTEX_SHADER;
 			break;
 		case ResourceShader::SH_FRAGMENT:
-			sh = glCreateShader(GL_FRAGMENT_SHADER);
+			glType = GL_FRAGMENT_SHADER;
 			break;
 		case ResourceShader::SH_GEOMETRY:
-			sh = glCreateShader(GL_GEOMETRY_SHADER);
+			glType = GL_GEOMETRY_SHADER;
 			break;
 		default:
 			_LOG(LOG_WARN, "Invalid shader type passed.");
 			break;
 		}
 
-		if (sh != 0)
+		if (glType != 0)
 		{
-			glShaderSource(sh, 1, &code, NULL);
-			glCompileShader(sh);
+			std::string log;
+			ret = RenderBackend::Get()->CompileShader(glType, code, log);
 
-			if (CheckCompileErrors(sh, type)) ret = sh;
+			if (ret == 0) LogCompileErrors(type, log.c_str());
 		}
 	}
 
@@ -101,33 +108,19 @@ uint ResourceShader::CompileCode(ShaderType type, const char * code)
 
 bool ResourceShader::LinkShader(uint vertex, uint fragment, uint geometry)
 {
-	int program = glCreateProgram();
-
-	glAttachShader(program, vertex);
-	glAttachShader(program, fragment);
-	if (geometry != 0) glAttachShader(program, geometry);
-
-	glLinkProgram(program);
-
-	GLint succes = 0;
-	GLchar infoLog[1024];
+	RenderBackend* backend = RenderBackend::Get();
 
-	glGetProgramiv(program, GL_LINK_STATUS, &succes);
-	if (!succes)
-	{
-		glGetProgramInfoLog(program, 1024, NULL, infoLog);
-		_LOG(LOG_ERROR, "Shader link error: %s.", infoLog);
-	}
+	const uint shaders[3] = { vertex, fragment, geometry };
+	std::string log;
+	uint program = backend->LinkProgram(shaders, 3, log);
 
-	glDetachShader(program, vertex);
-	glDetachShader(program, fragment);
-	if (geometry != 0) glDetachShader(program, geometry);
+	if (program == 0)
+		_LOG(LOG_ERROR, "Shader link error: %s.", log.c_str());
 
-	glDeleteShader(vertex);
-	glDeleteShader(fragment);
-	if (geometry != 0) glDeleteShader(geometry);
+	for (uint i = 0; i < 3; ++i)
+		if (shaders[i] != 0) backend->DeleteShader(shaders[i]);
 
-	if (succes != 0)
+	if (program != 0)
 	{
 		_LOG(LOG_INFO, "Just compiled and linked succesfully [%s] shader.", name.c_str());
 		shaderID = program;
@@ -208,7 +201,12 @@ void ResourceShader::OnSave(JsonFile & file)
 
 void ResourceShader::OnLoad(JsonFile & file)
 {
-	shaderFile.SetFullPath(file.GetString("shader_file_full_path", "???").c_str());
+	//Registries saved without the data of the shaders: the file is where OnCreation puts it
+	std::string path = file.GetString("shader_file_full_path", "");
+	if (path.empty())
+		shaderFile.Set(SHADER_SAVE_PATH, name.c_str(), SHADER_EXTENSION);
+	else
+		shaderFile.SetFullPath(path.c_str());
 
 	LoadInMemory();
 }
@@ -279,33 +277,23 @@ void ResourceShader::OnCreation()
 	}
 }
 
-bool ResourceShader::CheckCompileErrors(uint shader, ShaderType type)
+void ResourceShader::LogCompileErrors(ShaderType type, const char* log)
 {
-	GLint succes = 0;
-	GLchar infoLog[1024];
-
-	glGetShaderiv(shader, GL_COMPILE_STATUS, &succes);
-	if (!succes)
+	std::string typeStr = "Unknown";
+	switch (type)
 	{
-		glGetShaderInfoLog(shader, 1024, NULL, infoLog);
-		std::string typeStr = "Unknown";
-		switch (type)
-		{
-		case ResourceShader::SH_VERTEX:
-			typeStr = "Vertex";
-			break;
-		case ResourceShader::SH_FRAGMENT:
-			typeStr = "Fragment";
-			break;
-		case ResourceShader::SH_GEOMETRY:
-			typeStr = "Geometry";
-			break;
-		}
-
-		_LOG(LOG_ERROR, "%s shader compilation error: %s.", typeStr.c_str(), infoLog);
+	case ResourceShader::SH_VERTEX:
+		typeStr = "Vertex";
+		break;
+	case ResourceShader::SH_FRAGMENT:
+		typeStr = "Fragment";
+		break;
+	case ResourceShader::SH_GEOMETRY:
+		typeStr = "Geometry";
+		break;
 	}
 
-	return succes != 0;
+	_LOG(LOG_ERROR, "%s shader compilation error: %s.", typeStr.c_str(), log);
 }
 
 
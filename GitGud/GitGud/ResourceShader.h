@@ -46,7 +46,7 @@ public:
 	void OnCreation();
 
 private:
-	bool CheckCompileErrors(uint shader, ShaderType type);
+	void LogCompileErrors(ShaderType type, const char* log);
 
 public:
 	Path shaderFile;
@@ -4,7 +4,8 @@
 #include "M_ResourceManager.h"
 #include "ImporterTexture.h"
 
-#include "OpenGL.h"
+#include "GLState.h"
+#include "RenderThread.h"
 
 ResourceTexture::ResourceTexture(UID uuid) : Resource(uuid, RES_TEXTURE)
 {
@@ -13,6 +14,8 @@ ResourceTexture::ResourceTexture(UID uuid) : Resource(uuid, RES_TEXTURE)
 
 ResourceTexture::~ResourceTexture()
 {
+	if (pendingLoad)
+		UploadAsync(false); //Frees the DevIL image
 	RemoveFromMemory();
 }
 
@@ -23,6 +26,35 @@ bool ResourceTexture::LoadInMemory()
 	return app->resources->textureImporter->LoadResource(this);
 }
 
+/** ReadAsync: Overloaded method. Reads and decodes the texture file on a worker thread. */
+bool ResourceTexture::ReadAsync()
+{
+	pendingLoad = new TextureLoadData();
+	return app->resources->textureImporter->ReadResource(exportedFile, *pendingLoad);
+}
+
+/** UploadAsync: Overloaded method. Uploads the decoded texture. */
+bool ResourceTexture::UploadAsync(bool read)
+{
+	bool ret = false;
+	if (pendingLoad)
+	{
+		ret = app->resources->textureImporter->UploadResource(this, *pendingLoad, read);
+		RELEASE(pendingLoad);
+	}
+
+	return ret;
+}
+
+/** GetDrawTextureID: Return the GL texture to draw, the checkers texture until the texture is loaded. */
+uint ResourceTexture::GetDrawTextureID() const
+{
+	if (IsReady() && texID != 0)
+		return texID;
+
+	return app->resources->checkers ? app->resources->checkers->texID : 0;
+}
+
 /** RemoveFromMemory: Overloaded method. Actually frees the texture resource from memory including VRAM. */
 bool ResourceTexture::RemoveFromMemory()
 {
@@ -38,7 +70,8 @@ bool ResourceTexture::RemoveFromMemory()
 
 	if (texID > 0)
 	{
-		glDeleteBuffers(1, &texID);
+		uint texture = texID;
+		RenderThread::Enqueue([texture]() { GLState::DeleteTexture(texture); }); //May still be in use by a packet in flight
 		texID = 0;
 		return true;
 	}
@@ -59,11 +92,11 @@ const char * ResourceTexture::GetTextureTypeStr()const
 }
 
 /** GetTextureFormatStr: Return the texture format as string.
-						Formats: Color index, Rgb, Rgba, Bgr, Bgra, Luminance, Unknown. */
+						Formats: Color index, Rgb, Rgba, Bgr, Bgra, Luminance, BC1 to BC5, BC7, Unknown. */
 const char * ResourceTexture::GetTextureFormatStr() const
 {
 	static const char* formats[] = {
-		"color index", "rgb", "rgba", "bgr", "bgra", "luminance", "unknown" };
+		"color index", "rgb", "rgba", "bgr", "bgra", "luminance", "bc1", "bc2", "bc3", "bc4", "bc5", "bc7", "unknown" };
 
 	return formats[format];
 }
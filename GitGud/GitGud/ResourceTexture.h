@@ -2,6 +2,7 @@
 #define __RESOURCE_TEXTURE_H__
 
 #include "Resource.h"
+#include "TextureAtlas.h"
 
 enum TextureType
 {
@@ -34,6 +35,8 @@ enum TextureFlag
 	TEX_FLAG_IGNORE_ALPHA = 0x4
 };
 
+struct TextureLoadData;
+
 class ResourceTexture : public Resource
 {
 public:
@@ -45,6 +48,12 @@ public:
 		BGR,
 		BGRA,
 		LUMINANCE,
+		BC1,
+		BC2,
+		BC3,
+		BC4,
+		BC5,
+		BC7,
 		UNKNOWN
 	};
 
@@ -57,6 +66,13 @@ public:
 	const char* GetTextureTypeStr()const;
 	const char* GetTextureFormatStr()const;
 
+	uint GetDrawTextureID()const;
+
+protected:
+	bool CanLoadAsync()const override { return true; }
+	bool ReadAsync()override;
+	bool UploadAsync(bool read)override;
+
 public:
 	uint width = 0;
 	uint height = 0;
@@ -69,6 +85,11 @@ public:
 
 	Format format = UNKNOWN;
 	TextureType textureType = TEX_NONE;
+
+	AtlasRegion atlasRegion; //Set by the resource manager if the texture was also packed into an atlas.
+
+private:
+	TextureLoadData* pendingLoad = nullptr; //Only while an async load is in flight.
 };
 
 #endif // !__RESOURCE_TEXTURE_H__
\ No newline at end of file
@@ -0,0 +1,302 @@
+#include "SceneStressTest.h"
+
+#include "App.h"
+#include "RandGen.h"
+#include "JsonFile.h"
+#include "M_FileSystem.h"
+#include "M_GoManager.h"
+#include "M_ResourceManager.h"
+#include "M_Renderer.h"
+
+#include "GameObject.h"
+#include "Transform.h"
+#include "Mesh.h"
+#include "ResourceMesh.h"
+
+#include <algorithm>
+
+#define STRESS_MOVE_AMPLITUDE 2.f
+#define STRESS_MOVE_STEP (1.f / 60.f) //Fixed so the movement does not depend on the frame rate.
+
+SceneStressTest::SceneStressTest()
+{}
+
+SceneStressTest::~SceneStressTest()
+{}
+
+/** SceneStressTest - Start: Generates the scene and starts sampling from the next frame. A running test is stopped first. */
+bool SceneStressTest::Start(const StressTestSettings & settings)
+{
+	if (running)
+		Stop();
+
+	if (!app->goManager || !app->resources || !app->resources->cube || !app->resources->quad)
+	{
+		_LOG(LOG_ERROR, "Stress test: The scene or the built-in meshes are not ready.");
+		return false;
+	}
+
+	this->settings = settings;
+	this->settings.depth = MAX(1u, settings.depth);
+	this->settings.frames = MAX(1u, settings.frames);
+
+	frame = 0;
+	finished = false;
+	for (uint i = 0; i < STRESS_PHASE_COUNT; ++i)
+	{
+		samples[i].clear();
+		samples[i].reserve(this->settings.frames);
+	}
+
+	RandGen rand(this->settings.seed);
+
+	PerfTimer timer;
+	Generate(rand);
+	generationMs = (float)timer.ReadMs();
+
+	_LOG(LOG_INFO, "Stress test: Generated %u objects (%u static, %u moving, depth %u) in %.2f ms, running %u frames.",
+		this->settings.objects, numStatic, (uint)moving.size(), this->settings.depth, generationMs, this->settings.frames);
+
+	running = true;
+	return true;
+}
+
+/** SceneStressTest - Stop: Stops the test without results and removes the generated objects. */
+void SceneStressTest::Stop()
+{
+	if (!running)
+		return;
+
+	ReleaseObjects(true);
+	running = false;
+
+	_LOG(LOG_INFO, "Stress test: Stopped after %u frames.", frame);
+}
+
+bool SceneStressTest::IsRunning() const
+{
+	return running;
+}
+
+bool SceneStressTest::HasFinished() const
+{
+	return finished;
+}
+
+/** SceneStressTest - OnFrameBegin: Moves the objects for this frame. Must be called before the modules update. */
+void SceneStressTest::OnFrameBegin()
+{
+	if (!running)
+		return;
+
+	MoveObjects();
+	frameTimer.Start();
+}
+
+/** SceneStressTest - OnFrameEnd: Samples the phases of the frame. Must be called after the modules update. */
+void SceneStressTest::OnFrameEnd()
+{
+	if (!running)
+		return;
+
+	samples[STRESS_TRANSFORM].push_back(app->goManager->GetTransformMs());
+	samples[STRESS_BOXES].push_back(app->goManager->GetBoxesMs());
+	samples[STRESS_CULLING].push_back(app->renderer->GetCullingMs());
+	samples[STRESS_SUBMISSION].push_back(app->renderer->GetSubmissionMs());
+	samples[STRESS_FRAME].push_back((float)frameTimer.ReadMs());
+
+	if (++frame >= settings.frames)
+		Finish();
+}
+
+const char * SceneStressTest::GetPhaseName(StressPhase phase)
+{
+	switch (phase)
+	{
+	case STRESS_TRANSFORM: return "transform";
+	case STRESS_BOXES: return "boxes";
+	case STRESS_CULLING: return "culling";
+	case STRESS_SUBMISSION: return "submission";
+	case STRESS_FRAME: return "frame";
+	}
+	return "unknown";
+}
+
+/** SceneStressTest - Generate: Creates the objects in chains of settings.depth. Transforms and boxes are calculated before
+								making the static chains static, as the octree needs the boxes and a static object that
+								changes its transform turns dynamic. */
+void SceneStressTest::Generate(RandGen & rand)
+{
+	roots.clear();
+	moving.clear();
+	basePositions.clear();
+	numStatic = 0;
+
+	const float extent = app->goManager->GetOctreeSize() * 0.45f;
+	const UID cube = app->resources->cube->GetUID();
+	const UID quad = app->resources->quad->GetUID();
+
+	std::vector<GameObject*> staticRoots;
+	GameObject* parent = nullptr;
+	bool chainStatic = false;
+
+	for (uint i = 0; i < settings.objects; ++i)
+	{
+		bool newChain = (i % settings.depth) == 0;
+		if (newChain)
+		{
+			parent = nullptr;
+			chainStatic = rand.GetRandFloat() < settings.staticRatio;
+		}
+
+		GameObject* go = app->goManager->CreateGameObject(parent);
+		go->SetName("StressObject");
+
+		Mesh* mesh = (Mesh*)go->CreateComponent(CMP_MESH);
+		mesh->SetResource(rand.GetRandFloat() < settings.quadRatio ? quad : cube);
+
+		float3 position = newChain ? float3(rand.GetRandFloat(-extent, extent), rand.GetRandFloat(0.f, extent * 0.2f), rand.GetRandFloat(-extent, extent))
+			: float3(rand.GetRandFloat(-1.f, 1.f), 1.5f, rand.GetRandFloat(-1.f, 1.f));
+		go->transform->SetLocalPosition(position);
+		go->transform->SetLocalRotation(Quat::RotateY(rand.GetRandFloat(0.f, 2.f * pi)));
+		go->transform->SetLocalScale(float3::one * rand.GetRandFloat(0.5f, 1.f));
+
+		if (newChain)
+		{
+			roots.push_back(go);
+			if (chainStatic)
+				staticRoots.push_back(go);
+		}
+
+		if (chainStatic)
+			++numStatic;
+		else if (rand.GetRandFloat() < settings.movingRatio)
+		{
+			moving.push_back(go);
+			basePositions.push_back(position);
+		}
+
+		parent = go;
+	}
+
+	GameObject* root = app->goManager->GetRoot();
+	root->RecCalcTransform(root->transform->GetLocalTransform());
+	root->RecCalcBoxes();
+	app->goManager->anyGOTransHasChanged = false;
+
+	for (std::vector<GameObject*>::iterator it = staticRoots.begin(); it != staticRoots.end(); ++it)
+		(*it)->SetStatic(true); //Recursive, the whole chain goes to the octree.
+}
+
+/** SceneStressTest - MoveObjects: Moves the moving objects in circles around their generated position. */
+void SceneStressTest::MoveObjects()
+{
+	float time = frame * STRESS_MOVE_STEP;
+
+	for (uint i = 0; i < moving.size(); ++i)
+	{
+		float offset = time + i * 0.1f;
+		moving[i]->transform->SetLocalPosition(basePositions[i] + float3(Sin(offset), 0.f, Cos(offset)) * STRESS_MOVE_AMPLITUDE);
+	}
+}
+
+/** SceneStressTest - Finish: Logs and saves the results and removes the generated objects unless told to keep them. */
+void SceneStressTest::Finish()
+{
+	_LOG(LOG_INFO, "Stress test: %u objects, %u frames.", settings.objects, frame);
+
+	for (uint i = 0; i < STRESS_PHASE_COUNT; ++i)
+	{
+		StressPhaseStats stats;
+		GetPhaseStats((StressPhase)i, stats);
+		_LOG(LOG_INFO, "Stress test: %-10s avg %.3f ms, p50 %.3f ms, p99 %.3f ms, max %.3f ms.",
+			GetPhaseName((StressPhase)i), stats.avgMs, stats.p50Ms, stats.p99Ms, stats.maxMs);
+	}
+
+	if (!settings.output.empty() && !Save(settings.output.c_str()))
+		_LOG(LOG_ERROR, "Stress test: Could not save the results to [%s].", settings.output.c_str());
+
+	ReleaseObjects(!settings.keepObjects);
+	running = false;
+	finished = true;
+}
+
+/** SceneStressTest - ReleaseObjects: Forgets the generated objects, removing them from the scene if told to. */
+void SceneStressTest::ReleaseObjects(bool remove)
+{
+	if (remove)
+	{
+		for (std::vector<GameObject*>::iterator it = roots.begin(); it != roots.end(); ++it)
+			app->goManager->RemoveGameObject(*it);
+	}
+
+	roots.clear();
+	moving.clear();
+	basePositions.clear();
+}
+
+void SceneStressTest::GetPhaseStats(StressPhase phase, StressPhaseStats & stats) const
+{
+	stats = StressPhaseStats();
+
+	const std::vector<float>& phaseSamples = samples[phase];
+	if (phaseSamples.empty())
+		return;
+
+	std::vector<float> sorted(phaseSamples);
+	std::sort(sorted.begin(), sorted.end());
+
+	float total = 0.f;
+	for (std::vector<float>::const_iterator it = sorted.begin(); it != sorted.end(); ++it)
+		total += *it;
+
+	stats.avgMs = total / sorted.size();
+	stats.p50Ms = sorted[(sorted.size() - 1) / 2];
+	stats.p99Ms = sorted[(uint)((sorted.size() - 1) * 0.99f)];
+	stats.maxMs = sorted.back();
+}
+
+/** SceneStressTest - Save: Saves the settings, the stats of each phase and its samples per frame as json. */
+bool SceneStressTest::Save(const char * file) const
+{
+	JsonFile json;
+
+	JsonFile config;
+	config.AddUInt("objects", settings.objects);
+	config.AddUInt("depth", settings.depth);
+	config.AddFloat("static_ratio", settings.staticRatio);
+	config.AddFloat("quad_ratio", settings.quadRatio);
+	config.AddFloat("moving_ratio", settings.movingRatio);
+	config.AddUInt("frames", settings.frames);
+	config.AddUInt("seed", settings.seed);
+	json.AddSection("settings", config);
+
+	json.AddUInt("static_objects", numStatic);
+	json.AddUInt("moving_objects", (uint)moving.size());
+	json.AddFloat("generation_ms", generationMs);
+
+	JsonFile phases;
+	for (uint i = 0; i < STRESS_PHASE_COUNT; ++i)
+	{
+		StressPhaseStats stats;
+		GetPhaseStats((StressPhase)i, stats);
+
+		JsonFile phase;
+		phase.AddFloat("avg_ms", stats.avgMs);
+		phase.AddFloat("p50_ms", stats.p50Ms);
+		phase.AddFloat("p99_ms", stats.p99Ms);
+		phase.AddFloat("max_ms", stats.maxMs);
+		if (!samples[i].empty())
+			phase.AddFloatArray("frames_ms", (float*)samples[i].data(), samples[i].size());
+
+		phases.AddSection(GetPhaseName((StressPhase)i), phase);
+	}
+	json.AddSection("phases", phases);
+
+	std::string buffer = json.Write(true);
+	bool ret = app->fs->Save(file, buffer.c_str(), buffer.size()) == buffer.size();
+	if (ret)
+		_LOG(LOG_INFO, "Stress test: Results saved to [%s].", file);
+
+	return ret;
+}
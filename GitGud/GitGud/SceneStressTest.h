@@ -0,0 +1,93 @@
+#ifndef __SCENE_STRESS_TEST_H__
+#define __SCENE_STRESS_TEST_H__
+
+#include "Globals.h"
+#include "Math.h"
+#include "PerfTimer.h"
+#include <vector>
+#include <string>
+
+class GameObject;
+class RandGen;
+
+enum StressPhase
+{
+	STRESS_TRANSFORM,
+	STRESS_BOXES,
+	STRESS_CULLING,
+	STRESS_SUBMISSION,
+	STRESS_FRAME,
+	STRESS_PHASE_COUNT
+};
+
+struct StressTestSettings
+{
+	uint objects = 1000;
+	uint depth = 1;				//Length of the parent-child chains, 1 is a flat scene.
+	float staticRatio = 0.5f;	//Fraction of the chains made static.
+	float quadRatio = 0.f;		//Fraction of the objects using the quad mesh, the rest use the cube.
+	float movingRatio = 0.1f;	//Fraction of the dynamic objects moved every frame.
+	uint frames = 300;
+	uint seed = 1;
+	bool keepObjects = false;	//Keep the generated objects when the test finishes.
+	std::string output;			//Json file with the results, none if empty.
+};
+
+struct StressPhaseStats
+{
+	float avgMs = 0.f;
+	float p50Ms = 0.f;
+	float p99Ms = 0.f;
+	float maxMs = 0.f;
+};
+
+/**
+*	- Fills the scene with procedurally generated objects and measures how the frame phases scale with them.
+*	- Objects are scattered inside the octree, in chains of the given depth, sharing the built-in cube and quad meshes.
+*	- Every frame a fraction of the dynamic objects is moved and the transform, boxes, culling, submission and whole frame
+*	  times are sampled. After the given frames the results are logged and optionally saved as json.
+*	- The generation is seeded so two builds run the very same scene.
+*/
+class SceneStressTest
+{
+public:
+	SceneStressTest();
+	~SceneStressTest();
+
+	bool Start(const StressTestSettings& settings);
+	void Stop();
+	bool IsRunning()const;
+	bool HasFinished()const;
+
+	void OnFrameBegin();
+	void OnFrameEnd();
+
+	static const char* GetPhaseName(StressPhase phase);
+
+private:
+	void Generate(RandGen& rand);
+	void MoveObjects();
+	void Finish();
+	void ReleaseObjects(bool remove);
+
+	void GetPhaseStats(StressPhase phase, StressPhaseStats& stats)const;
+	bool Save(const char* file)const;
+
+private:
+	StressTestSettings settings;
+
+	bool running = false;
+	bool finished = false;
+	uint frame = 0;
+
+	std::vector<GameObject*> roots;		//First object of each chain, removing them removes the whole scene.
+	std::vector<GameObject*> moving;
+	std::vector<float3> basePositions;	//Of the moving objects.
+	uint numStatic = 0;
+	float generationMs = 0.f;
+
+	PerfTimer frameTimer;
+	std::vector<float> samples[STRESS_PHASE_COUNT];
+};
+
+#endif // !__SCENE_STRESS_TEST_H__
@@ -0,0 +1,556 @@
+#include "StaticBatcher.h"
+
+#include "GameObject.h"
+#include "Transform.h"
+#include "Mesh.h"
+#include "Material.h"
+#include "Camera.h"
+
+#include "ResourceMesh.h"
+#include "ResourceMaterial.h"
+#include "ResourceTexture.h"
+#include "App.h"
+#include "M_ResourceManager.h"
+
+#include "GLState.h"
+#include "RenderBackend.h"
+#include "RenderPacket.h"
+#include "RenderThread.h"
+#include "Profiler.h"
+
+#include <memory>
+
+#include "OpenGL.h"
+
+/** Returns the mesh resource of an object only if its data is in memory and can be batched. */
+static const ResourceMesh* GetBatchableMesh(GameObject* object)
+{
+	const ResourceMesh* ret = nullptr;
+
+	if (object)
+	{
+		Mesh* meshCmp = (Mesh*)object->GetComponent(CMP_MESH);
+		if (meshCmp)
+		{
+			const ResourceMesh* mesh = (const ResourceMesh*)meshCmp->GetResource();
+			if (mesh && mesh->vertices && mesh->indices && mesh->numVertices <= STATIC_BATCH_MAX_VERTICES)
+				ret = mesh;
+		}
+	}
+
+	return ret;
+}
+
+/** Return true if the mesh has UVs and all of them are inside 0-1, so they can be moved into an atlas region. */
+static bool UVsInUnitRange(const ResourceMesh* mesh)
+{
+	if (mesh->uvs == nullptr)
+		return false;
+
+	for (uint i = 0; i < mesh->numVertices * 2; ++i)
+	{
+		if (mesh->uvs[i] < 0.f || mesh->uvs[i] > 1.f)
+			return false;
+	}
+
+	return true;
+}
+
+//=============================================================================
+
+StaticBatch::StaticBatch(const StaticBatchKey& key) : key(key)
+{
+	gpu = new StaticBatchGPU();
+
+	if (key.atlas != 0)
+	{
+		atlasTexture = app->resources->GetResourceFromUID(key.atlas);
+		app->resources->LoadToMemoryAsync(atlasTexture);
+	}
+}
+
+/** StaticBatch - Destructor: The GL objects may still be used by a packet in flight, so they are deleted on the render side. */
+StaticBatch::~StaticBatch()
+{
+	StaticBatchGPU* objects = gpu;
+	RenderThread::Enqueue([objects]()
+	{
+		GLState::DeleteBuffer(objects->idVertices);
+		GLState::DeleteBuffer(objects->idIndices);
+		GLState::DeleteVertexArray(objects->idContainer);
+		delete objects;
+	});
+	gpu = nullptr;
+
+	if (atlasTexture)
+		app->resources->ReleaseResource(atlasTexture);
+}
+
+/** StaticBatch - Fits: Return true if the batch can still hold the amount of vertices passed. */
+bool StaticBatch::Fits(uint vertices) const
+{
+	return usedVertices + vertices <= STATIC_BATCH_MAX_VERTICES;
+}
+
+/** StaticBatch - Append: Adds the object geometry at the end of the batch. If the buffers have room
+						 the new range is uploaded alone, otherwise the batch is rebuilt with more capacity. */
+uint StaticBatch::Append(GameObject* object, const ResourceMesh* mesh, const float uvRemap[4])
+{
+	StaticBatchEntry entry;
+	entry.object = object;
+	memcpy(entry.uvRemap, uvRemap, sizeof(entry.uvRemap));
+	entry.firstVertex = usedVertices;
+	entry.numVertices = mesh->numVertices;
+	entry.firstIndex = usedIndices;
+	entry.numIndices = mesh->numIndices;
+
+	entries.push_back(entry);
+	usedVertices += entry.numVertices;
+	usedIndices += entry.numIndices;
+	++aliveEntries;
+
+	if (usedVertices > vertexCapacity || usedIndices > indexCapacity)
+		Rebuild();
+	else
+		Write(entry, mesh);
+
+	return entries.size() - 1;
+}
+
+/** StaticBatch - Remove: Marks an entry as removed. Its range is skipped until the batch is compacted. */
+void StaticBatch::Remove(uint entry)
+{
+	if (entry < entries.size() && entries[entry].object)
+	{
+		entries[entry].object = nullptr;
+		deadIndices += entries[entry].numIndices;
+		--aliveEntries;
+	}
+}
+
+/** StaticBatch - NeedsCompaction: Return true when at least half of the indices belong to removed entries. */
+bool StaticBatch::NeedsCompaction() const
+{
+	return deadIndices > 0 && deadIndices * 2 >= usedIndices;
+}
+
+/** StaticBatch - Rebuild: Drops the removed entries and uploads all the live geometry again. */
+void StaticBatch::Rebuild()
+{
+	std::vector<StaticBatchEntry> alive;
+	alive.reserve(aliveEntries);
+
+	usedVertices = 0;
+	usedIndices = 0;
+	deadIndices = 0;
+
+	for (std::vector<StaticBatchEntry>::iterator it = entries.begin(); it != entries.end(); ++it)
+	{
+		if (it->object)
+		{
+			const ResourceMesh* mesh = GetBatchableMesh(it->object);
+
+			StaticBatchEntry entry = *it;
+			entry.firstVertex = usedVertices;
+			entry.numVertices = mesh ? mesh->numVertices : 0;
+			entry.firstIndex = usedIndices;
+			entry.numIndices = mesh ? mesh->numIndices : 0;
+
+			usedVertices += entry.numVertices;
+			usedIndices += entry.numIndices;
+			alive.push_back(entry);
+		}
+	}
+
+	entries.swap(alive);
+
+	Reserve(MAX(usedVertices + usedVertices / 2, STATIC_BATCH_MIN_CAPACITY), MAX(usedIndices + usedIndices / 2, STATIC_BATCH_MIN_CAPACITY));
+
+	for (std::vector<StaticBatchEntry>::iterator it = entries.begin(); it != entries.end(); ++it)
+	{
+		const ResourceMesh* mesh = GetBatchableMesh(it->object);
+		if (mesh && it->numIndices > 0)
+			Write(*it, mesh);
+	}
+}
+
+/** StaticBatch - Collect: Fills the draw with the entries marked as visible this frame. Contiguous ranges are merged
+						   so everything is submited with a single glMultiDrawElements. Return false if there is nothing to draw. */
+bool StaticBatch::Collect(uint frame, BatchDraw& draw) const
+{
+	draw.gpu = gpu;
+	draw.texture = atlasTexture ? ((const ResourceTexture*)atlasTexture)->GetDrawTextureID() : 0;
+	draw.counts.clear();
+	draw.offsets.clear();
+
+	uint rangeStart = 0, rangeCount = 0;
+	for (std::vector<StaticBatchEntry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+	{
+		if (it->object == nullptr || it->visibleFrame != frame || it->numIndices == 0)
+			continue;
+
+		if (rangeCount > 0 && rangeStart + rangeCount == it->firstIndex)
+		{
+			rangeCount += it->numIndices;
+		}
+		else
+		{
+			if (rangeCount > 0)
+			{
+				draw.counts.push_back(rangeCount);
+				draw.offsets.push_back((const void*)(sizeof(uint) * rangeStart));
+			}
+			rangeStart = it->firstIndex;
+			rangeCount = it->numIndices;
+		}
+	}
+
+	if (rangeCount > 0)
+	{
+		draw.counts.push_back(rangeCount);
+		draw.offsets.push_back((const void*)(sizeof(uint) * rangeStart));
+	}
+
+	return !draw.counts.empty();
+}
+
+bool StaticBatch::Empty() const
+{
+	return aliveEntries == 0;
+}
+
+/** StaticBatch - Reserve: (Re)allocates the batch buffers with the capacity passed. The content is lost. */
+void StaticBatch::Reserve(uint vertices, uint indices)
+{
+	vertexCapacity = vertices;
+	indexCapacity = indices;
+
+	const GLsizei stride = sizeof(float) * STATIC_BATCH_VERTEX_FLOATS;
+	const GLsizeiptr vertexBytes = stride * vertexCapacity;
+	const GLsizeiptr indexBytes = sizeof(uint) * indexCapacity;
+	StaticBatchGPU* objects = gpu;
+
+	RenderThread::Enqueue([objects, stride, vertexBytes, indexBytes]()
+	{
+		RenderBackend* backend = RenderBackend::Get();
+
+		if (objects->idContainer == 0)
+		{
+			objects->idContainer = backend->GenVertexArray();
+			objects->idVertices = backend->GenBuffer();
+			objects->idIndices = backend->GenBuffer();
+		}
+
+		GLState::BindVertexArray(objects->idContainer);
+
+		GLState::BindBuffer(GL_ARRAY_BUFFER, objects->idVertices);
+		backend->BufferData(GL_ARRAY_BUFFER, vertexBytes, nullptr, GL_STATIC_DRAW);
+
+		GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, objects->idIndices);
+		backend->BufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, nullptr, GL_STATIC_DRAW);
+
+		//Same attribute locations than the non batched meshes
+		backend->VertexAttribute(0, 3, GL_FLOAT, false, stride, 0);
+		backend->VertexAttribute(1, 3, GL_FLOAT, false, stride, sizeof(float) * 3);
+		backend->VertexAttribute(2, 2, GL_FLOAT, false, stride, sizeof(float) * 6);
+		backend->VertexAttribute(3, 3, GL_FLOAT, false, stride, sizeof(float) * 8);
+
+		GLState::BindVertexArray(0);
+	});
+}
+
+/** StaticBatch - Write: Pre-transforms the mesh into world space and queues its upload into the entry range.
+						Normals are kept untouched as the default shader consumes them as they come, UVs are moved into the atlas. */
+void StaticBatch::Write(const StaticBatchEntry& entry, const ResourceMesh* mesh)
+{
+	const float4x4 world = entry.object->transform->GetGlobalTransform();
+
+	std::shared_ptr<std::vector<float>> vertices = std::make_shared<std::vector<float>>(entry.numVertices * STATIC_BATCH_VERTEX_FLOATS, 0.0f);
+	float* cursor = vertices->data();
+
+	for (uint i = 0; i < entry.numVertices; ++i, cursor += STATIC_BATCH_VERTEX_FLOATS)
+	{
+		float3 pos = world.TransformPos(float3(&mesh->vertices[i * 3]));
+		memcpy(cursor, pos.ptr(), sizeof(float) * 3);
+
+		if (mesh->normals) memcpy(cursor + 3, &mesh->normals[i * 3], sizeof(float) * 3);
+		if (mesh->uvs)
+		{
+			cursor[6] = mesh->uvs[i * 2] * entry.uvRemap[2] + entry.uvRemap[0];
+			cursor[7] = mesh->uvs[i * 2 + 1] * entry.uvRemap[3] + entry.uvRemap[1];
+		}
+		if (mesh->colors) memcpy(cursor + 8, &mesh->colors[i * 3], sizeof(float) * 3);
+	}
+
+	std::shared_ptr<std::vector<uint>> indices = std::make_shared<std::vector<uint>>(mesh->indices, mesh->indices + entry.numIndices);
+	for (std::vector<uint>::iterator it = indices->begin(); it != indices->end(); ++it)
+		*it += entry.firstVertex;
+
+	const GLsizei stride = sizeof(float) * STATIC_BATCH_VERTEX_FLOATS;
+	const GLintptr vertexOffset = stride * entry.firstVertex;
+	const GLintptr indexOffset = sizeof(uint) * entry.firstIndex;
+	StaticBatchGPU* objects = gpu;
+
+	RenderThread::Enqueue([objects, vertices, indices, vertexOffset, indexOffset]()
+	{
+		GLState::BindVertexArray(objects->idContainer);
+
+		GLState::BindBuffer(GL_ARRAY_BUFFER, objects->idVertices);
+		RenderBackend::Get()->BufferSubData(GL_ARRAY_BUFFER, vertexOffset, sizeof(float) * vertices->size(), vertices->data());
+
+		GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, objects->idIndices);
+		RenderBackend::Get()->BufferSubData(GL_ELEMENT_ARRAY_BUFFER, indexOffset, sizeof(uint) * indices->size(), indices->data());
+
+		GLState::BindVertexArray(0);
+	});
+}
+
+//=============================================================================
+
+StaticBatcher::StaticBatcher()
+{
+}
+
+StaticBatcher::~StaticBatcher()
+{
+	Clear();
+}
+
+/** StaticBatcher - AddObject: Queues a static object to be batched. Adding an already batched object refreshes it. */
+void StaticBatcher::AddObject(GameObject* object)
+{
+	if (object)
+	{
+		pendingRemove.erase(object);
+		pendingAdd.insert(object);
+	}
+}
+
+/** StaticBatcher - RemoveObject: Queues a static object to be removed from its batch. The object is never accessed again. */
+void StaticBatcher::RemoveObject(GameObject* object)
+{
+	if (object)
+	{
+		pendingAdd.erase(object);
+		pendingRemove.insert(object);
+	}
+}
+
+/** StaticBatcher - Prepare: Applies the queued changes to the batches. Only the touched batches are updated. */
+void StaticBatcher::Prepare(uint shader)
+{
+	++frame;
+
+	for (std::set<GameObject*>::iterator it = pendingRemove.begin(); it != pendingRemove.end(); ++it)
+		Erase(*it);
+	pendingRemove.clear();
+
+	for (std::set<GameObject*>::iterator it = pendingAdd.begin(); it != pendingAdd.end(); ++it)
+	{
+		Erase(*it);
+		Insert(*it, shader);
+	}
+	pendingAdd.clear();
+
+	for (std::map<StaticBatchKey, std::vector<StaticBatch*>>::iterator it = batches.begin(); it != batches.end();)
+	{
+		std::vector<StaticBatch*>& list = it->second;
+		for (std::vector<StaticBatch*>::iterator b = list.begin(); b != list.end();)
+		{
+			StaticBatch* batch = *b;
+			if (batch->Empty())
+			{
+				RELEASE(batch);
+				b = list.erase(b);
+				continue;
+			}
+
+			if (batch->NeedsCompaction())
+			{
+				batch->Rebuild();
+				for (uint i = 0; i < batch->entries.size(); ++i)
+					locations[batch->entries[i].object].entry = i;
+			}
+			++b;
+		}
+
+		if (list.empty())
+			it = batches.erase(it);
+		else
+			++it;
+	}
+}
+
+/** StaticBatcher - MarkVisible: Return true if the object is drawn by a batch. It is only drawn if it is inside the camera frustum,
+								 an object collected several times is still drawn once. */
+bool StaticBatcher::MarkVisible(GameObject* object, Camera* cam)
+{
+	std::map<GameObject*, Location>::iterator it = locations.find(object);
+	if (it == locations.end())
+		return false;
+
+	if (cam && object->enclosingBox.IsFinite() && cam->frustum.Intersects(object->enclosingBox))
+		it->second.batch->entries[it->second.entry].visibleFrame = frame;
+
+	return true;
+}
+
+/** StaticBatcher - CollectDraws: Adds the visible ranges of all the batches to the packet. They are drawn with an identity model matrix. */
+void StaticBatcher::CollectDraws(RenderPacket& packet)
+{
+	PROFILE_SCOPE("Static batches");
+
+	lastDrawCalls = 0;
+
+	for (std::map<StaticBatchKey, std::vector<StaticBatch*>>::iterator it = batches.begin(); it != batches.end(); ++it)
+	{
+		for (std::vector<StaticBatch*>::iterator b = it->second.begin(); b != it->second.end(); ++b)
+		{
+			if (packet.batches.size() <= packet.numBatches)
+				packet.batches.push_back(BatchDraw());
+
+			if ((*b)->Collect(frame, packet.batches[packet.numBatches]))
+			{
+				++packet.numBatches;
+				++lastDrawCalls;
+			}
+		}
+	}
+}
+
+/** StaticBatcher - Clear: Frees all the batches and forgets all the objects. */
+void StaticBatcher::Clear()
+{
+	for (std::map<StaticBatchKey, std::vector<StaticBatch*>>::iterator it = batches.begin(); it != batches.end(); ++it)
+	{
+		for (std::vector<StaticBatch*>::iterator b = it->second.begin(); b != it->second.end(); ++b)
+			RELEASE(*b);
+	}
+
+	batches.clear();
+	locations.clear();
+	pendingAdd.clear();
+	pendingRemove.clear();
+}
+
+uint StaticBatcher::GetBatchCount() const
+{
+	uint ret = 0;
+	for (std::map<StaticBatchKey, std::vector<StaticBatch*>>::const_iterator it = batches.begin(); it != batches.end(); ++it)
+		ret += it->second.size();
+	return ret;
+}
+
+uint StaticBatcher::GetBatchedObjects() const
+{
+	return locations.size();
+}
+
+uint StaticBatcher::GetBatchedTriangles() const
+{
+	uint ret = 0;
+	for (std::map<StaticBatchKey, std::vector<StaticBatch*>>::const_iterator it = batches.begin(); it != batches.end(); ++it)
+	{
+		for (std::vector<StaticBatch*>::const_iterator b = it->second.begin(); b != it->second.end(); ++b)
+			ret += ((*b)->usedIndices - (*b)->deadIndices) / 3;
+	}
+	return ret;
+}
+
+uint StaticBatcher::GetLastDrawCalls() const
+{
+	return lastDrawCalls;
+}
+
+/** StaticBatcher - Insert: Adds the object to the first batch of its material/shader with enough room, creating one if needed. */
+void StaticBatcher::Insert(GameObject* object, uint shader)
+{
+	ResourceMesh* mesh = nullptr;
+	StaticBatchKey key;
+	key.shader = shader;
+	float uvRemap[4];
+
+	if (!GetMesh(object, &mesh, key, uvRemap))
+		return;
+
+	std::vector<StaticBatch*>& list = batches[key];
+
+	StaticBatch* batch = nullptr;
+	for (std::vector<StaticBatch*>::iterator it = list.begin(); it != list.end() && batch == nullptr; ++it)
+	{
+		if ((*it)->Fits(mesh->numVertices))
+			batch = *it;
+	}
+
+	if (batch == nullptr)
+	{
+		batch = new StaticBatch(key);
+		list.push_back(batch);
+	}
+
+	uint prevSize = batch->entries.size();
+	Location loc;
+	loc.batch = batch;
+	loc.entry = batch->Append(object, mesh, uvRemap);
+	locations[object] = loc;
+
+	//Appending may have compacted the batch
+	if (batch->entries.size() != prevSize + 1)
+	{
+		for (uint i = 0; i < batch->entries.size(); ++i)
+			locations[batch->entries[i].object].entry = i;
+	}
+}
+
+/** StaticBatcher - Erase: Removes the object from its batch if it was batched. */
+void StaticBatcher::Erase(GameObject* object)
+{
+	std::map<GameObject*, Location>::iterator it = locations.find(object);
+	if (it != locations.end())
+	{
+		it->second.batch->Remove(it->second.entry);
+		locations.erase(it);
+	}
+}
+
+/** StaticBatcher - GetMesh: Return true if the object has a mesh that can be batched, filling the key with its material. If the
+							  only texture of the material is in an atlas and the UVs do not wrap, the key gets the atlas instead
+							  and the UV remap is its region. */
+bool StaticBatcher::GetMesh(GameObject* object, ResourceMesh** mesh, StaticBatchKey& key, float uvRemap[4]) const
+{
+	const ResourceMesh* res = GetBatchableMesh(object);
+	if (res == nullptr)
+		return false;
+
+	*mesh = (ResourceMesh*)res;
+
+	Material* mat = (Material*)object->GetComponent(CMP_MATERIAL);
+	key.material = mat ? mat->GetResourceUID() : 0;
+	key.atlas = 0;
+
+	uvRemap[0] = uvRemap[1] = 0.f;
+	uvRemap[2] = uvRemap[3] = 1.f;
+
+	if (key.material != 0 && UVsInUnitRange(res))
+	{
+		const Resource* material = app->resources->GetResourceFromUID(key.material);
+		UID textureUID = (material && material->GetType() == RES_MATERIAL) ? ((const ResourceMaterial*)material)->GetMainTexture() : 0;
+		const Resource* texture = textureUID ? app->resources->GetResourceFromUID(textureUID) : nullptr;
+
+		if (texture && texture->GetType() == RES_TEXTURE)
+		{
+			const AtlasRegion& region = ((const ResourceTexture*)texture)->atlasRegion;
+			if (region.atlas != 0)
+			{
+				key.material = 0;
+				key.atlas = region.atlas;
+				uvRemap[0] = region.offset[0];
+				uvRemap[1] = region.offset[1];
+				uvRemap[2] = region.scale[0];
+				uvRemap[3] = region.scale[1];
+			}
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,124 @@
+#ifndef __STATIC_BATCHER_H__
+#define __STATIC_BATCHER_H__
+
+#include "Globals.h"
+#include <vector>
+#include <map>
+#include <set>
+
+class GameObject;
+class Resource;
+class ResourceMesh;
+class Camera;
+struct StaticBatchGPU;
+struct BatchDraw;
+struct RenderPacket;
+
+#define STATIC_BATCH_VERTEX_FLOATS 11 //Position(3), normal(3), uv(2), color(3)
+#define STATIC_BATCH_MAX_VERTICES 1048576
+#define STATIC_BATCH_MIN_CAPACITY 4096
+
+struct StaticBatchKey
+{
+	UID material = 0;
+	UID atlas = 0; //Texture atlas of the objects, their materials are not told apart then.
+	uint shader = 0;
+
+	bool operator<(const StaticBatchKey& other)const
+	{
+		if (material != other.material)
+			return material < other.material;
+		return (atlas != other.atlas) ? atlas < other.atlas : shader < other.shader;
+	}
+};
+
+struct StaticBatchEntry
+{
+	GameObject* object = nullptr; //nullptr marks a removed entry waiting for compaction.
+	uint firstVertex = 0;
+	uint numVertices = 0;
+	uint firstIndex = 0;
+	uint numIndices = 0;
+	uint visibleFrame = 0;
+	float uvRemap[4] = { 0.f, 0.f, 1.f, 1.f }; //UV offset and scale into the atlas.
+};
+
+class StaticBatch
+{
+public:
+	StaticBatch(const StaticBatchKey& key);
+	~StaticBatch();
+
+	bool Fits(uint vertices)const;
+	uint Append(GameObject* object, const ResourceMesh* mesh, const float uvRemap[4]);
+	void Remove(uint entry);
+	bool NeedsCompaction()const;
+	void Rebuild();
+	bool Collect(uint frame, BatchDraw& draw)const;
+
+	bool Empty()const;
+
+private:
+	void Reserve(uint vertices, uint indices);
+	void Write(const StaticBatchEntry& entry, const ResourceMesh* mesh);
+
+public:
+	StaticBatchKey key;
+	std::vector<StaticBatchEntry> entries;
+
+	uint usedVertices = 0;
+	uint usedIndices = 0;
+	uint deadIndices = 0;
+	uint aliveEntries = 0;
+
+private:
+	uint vertexCapacity = 0;
+	uint indexCapacity = 0;
+
+	StaticBatchGPU* gpu = nullptr; //Owned by the render side once the batch is destroyed.
+	Resource* atlasTexture = nullptr; //Kept loaded while the batch exists.
+};
+
+class StaticBatcher
+{
+public:
+	StaticBatcher();
+	~StaticBatcher();
+
+	void AddObject(GameObject* object);
+	void RemoveObject(GameObject* object);
+
+	void Prepare(uint shader);
+	bool MarkVisible(GameObject* object, Camera* cam);
+	void CollectDraws(RenderPacket& packet);
+
+	void Clear();
+
+	uint GetBatchCount()const;
+	uint GetBatchedObjects()const;
+	uint GetBatchedTriangles()const;
+	uint GetLastDrawCalls()const;
+
+private:
+	void Insert(GameObject* object, uint shader);
+	void Erase(GameObject* object);
+	bool GetMesh(GameObject* object, ResourceMesh** mesh, StaticBatchKey& key, float uvRemap[4])const;
+
+private:
+	struct Location
+	{
+		StaticBatch* batch = nullptr;
+		uint entry = 0;
+	};
+
+	std::map<StaticBatchKey, std::vector<StaticBatch*>> batches;
+	std::map<GameObject*, Location> locations;
+
+	std::set<GameObject*> pendingAdd;
+	std::set<GameObject*> pendingRemove;
+
+	uint frame = 0;
+	uint lastDrawCalls = 0;
+};
+
+#endif // !__STATIC_BATCHER_H__
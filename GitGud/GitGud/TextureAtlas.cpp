@@ -0,0 +1,112 @@
+#include "TextureAtlas.h"
+
+#include <string.h>
+#include <algorithm>
+
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "imGUI\stb_rect_pack.h"
+
+/** TextureAtlas - Pack: Packs the images into as many atlases of size x size as needed, trimmed to what they use. Images that
+						 do not fit in an empty atlas are left out. */
+void TextureAtlas::Pack(const std::vector<AtlasImage>& images, uint size, uint padding, std::vector<AtlasPage>& pages)
+{
+	const uint blocks = size / 4;
+	const uint pad = (padding + 3) & ~3u; //Keeps the images block aligned
+
+	std::vector<stbrp_rect> pending;
+	for (uint i = 0; i < images.size(); ++i)
+	{
+		const AtlasImage& image = images[i];
+		if (image.width == 0 || image.height == 0 || image.pixels.size() != image.width * image.height * 4)
+			continue;
+
+		stbrp_rect rect;
+		memset(&rect, 0, sizeof(rect));
+		rect.id = i;
+		rect.w = (stbrp_coord)((image.width + pad * 2 + 3) / 4);
+		rect.h = (stbrp_coord)((image.height + pad * 2 + 3) / 4);
+
+		if (rect.w <= blocks && rect.h <= blocks)
+			pending.push_back(rect);
+	}
+
+	std::vector<stbrp_node> nodes(blocks);
+	std::vector<stbrp_rect> left;
+
+	while (!pending.empty())
+	{
+		stbrp_context context;
+		stbrp_init_target(&context, blocks, blocks, nodes.data(), nodes.size());
+		stbrp_pack_rects(&context, pending.data(), pending.size());
+
+		pages.push_back(AtlasPage());
+		AtlasPage& page = pages.back();
+
+		left.clear();
+		for (std::vector<stbrp_rect>::const_iterator it = pending.begin(); it != pending.end(); ++it)
+		{
+			if (it->was_packed)
+			{
+				page.width = std::max(page.width, (uint)(it->x + it->w) * 4);
+				page.height = std::max(page.height, (uint)(it->y + it->h) * 4);
+			}
+			else
+			{
+				left.push_back(*it);
+			}
+		}
+
+		if (page.width == 0)
+		{
+			pages.pop_back();
+			break;
+		}
+
+		page.pixels.resize(page.width * page.height * 4, 0);
+
+		for (std::vector<stbrp_rect>::const_iterator it = pending.begin(); it != pending.end(); ++it)
+		{
+			if (!it->was_packed)
+				continue;
+
+			const AtlasImage& image = images[it->id];
+			const uint x = it->x * 4;
+			const uint y = it->y * 4;
+
+			//The padding repeats the closest edge pixel
+			for (uint dy = 0; dy < (uint)it->h * 4; ++dy)
+			{
+				uint sy = (uint)std::min(std::max((int)dy - (int)pad, 0), (int)image.height - 1);
+				uchar* dst = &page.pixels[((y + dy) * page.width + x) * 4];
+				for (uint dx = 0; dx < (uint)it->w * 4; ++dx, dst += 4)
+				{
+					uint sx = (uint)std::min(std::max((int)dx - (int)pad, 0), (int)image.width - 1);
+					memcpy(dst, &image.pixels[(sy * image.width + sx) * 4], 4);
+				}
+			}
+
+			AtlasRegion region;
+			region.offset[0] = (float)(x + pad) / page.width;
+			region.offset[1] = (float)(y + pad) / page.height;
+			region.scale[0] = (float)image.width / page.width;
+			region.scale[1] = (float)image.height / page.height;
+
+			page.textures.push_back(image.texture);
+			page.regions.push_back(region);
+		}
+
+		pending.swap(left);
+	}
+}
+
+/** TextureAtlas - GetMaxLevels: Mip levels of an atlas that still keep a pixel of padding between the images. */
+uint TextureAtlas::GetMaxLevels(uint padding)
+{
+	const uint pad = (padding + 3) & ~3u;
+
+	uint ret = 1;
+	while ((pad >> ret) > 0)
+		++ret;
+	return ret;
+}
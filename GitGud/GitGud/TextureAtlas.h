@@ -0,0 +1,47 @@
+#ifndef __TEXTURE_ATLAS_H__
+#define __TEXTURE_ATLAS_H__
+
+#include "Globals.h"
+#include <vector>
+
+/** Where a texture lies in its atlas, as the transform of its UVs: atlasUV = uv * scale + offset. */
+struct AtlasRegion
+{
+	UID atlas = 0; //0 if the texture is not in an atlas.
+	float offset[2] = { 0.f, 0.f };
+	float scale[2] = { 1.f, 1.f };
+};
+
+/** RGBA8 image to pack. */
+struct AtlasImage
+{
+	UID texture = 0;
+	uint width = 0;
+	uint height = 0;
+	std::vector<uchar> pixels;
+};
+
+/** An atlas built by the packer: its RGBA8 pixels and the region of every image packed in it. The atlas UID of the regions is set
+	once it is saved. */
+struct AtlasPage
+{
+	uint width = 0;
+	uint height = 0;
+	std::vector<uchar> pixels;
+	std::vector<UID> textures;
+	std::vector<AtlasRegion> regions;
+};
+
+/**
+*	- Packs small textures into shared atlases with stb_rect_pack, so the objects using them can share a texture bind.
+*	- Rectangles are packed in 4x4 blocks, so no compressed block is shared by two images.
+*	- Every image is surrounded by a copy of its edges, the padding. Mips only go as far as the padding keeps the images apart.
+*/
+class TextureAtlas
+{
+public:
+	static void Pack(const std::vector<AtlasImage>& images, uint size, uint padding, std::vector<AtlasPage>& pages);
+	static uint GetMaxLevels(uint padding);
+};
+
+#endif // !__TEXTURE_ATLAS_H__
@@ -0,0 +1,528 @@
+#include "TextureCompression.h"
+
+#include "JobSystem.h"
+
+#include <math.h>
+#include <string.h>
+#include <float.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <algorithm>
+
+/** sRGB conversion tables, built on the first use. */
+struct GammaTables
+{
+	float toLinear[256];
+	uchar toSRGB[4096];
+
+	GammaTables()
+	{
+		for (uint i = 0; i < 256; ++i)
+		{
+			float c = i / 255.f;
+			toLinear[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+		}
+
+		for (uint i = 0; i < 4096; ++i)
+		{
+			float l = i / 4095.f;
+			float s = l <= 0.0031308f ? l * 12.92f : 1.055f * powf(l, 1.f / 2.4f) - 0.055f;
+			toSRGB[i] = (uchar)std::min(255.f, s * 255.f + 0.5f);
+		}
+	}
+};
+
+static const GammaTables& GetGammaTables()
+{
+	static GammaTables tables;
+	return tables;
+}
+
+static inline float Clamp(float v, float min, float max)
+{
+	return v < min ? min : (v > max ? max : v);
+}
+
+uint TextureCompression::GetNumLevels(uint width, uint height)
+{
+	uint ret = 1;
+	while (width > 1 || height > 1)
+	{
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+		++ret;
+	}
+
+	return ret;
+}
+
+uint TextureCompression::GetLevelSize(uint width, uint height, DDSFormat format)
+{
+	return ((width + 3) / 4) * ((height + 3) / 4) * GetDDSBlockBytes(format);
+}
+
+/** TextureCompression - Downsample: Fills dst with the next mip of the RGBA8 image, half its size. The fast preset averages 2x2 pixels,
+									  the others filter 4x4 with a [1 3 3 1] tent. Color is filtered in linear space and alpha as is,
+									  normal maps are averaged as vectors and renormalized. */
+void TextureCompression::Downsample(const uchar * src, uint width, uint height, uchar * dst, TextureQuality quality, bool normalMap)
+{
+	const uint dstWidth = width > 1 ? width / 2 : 1;
+	const uint dstHeight = height > 1 ? height / 2 : 1;
+	const uint rowsPerJob = TEXTURE_TILE_BLOCK_ROWS * 4;
+
+	static const float box[2] = { 0.5f, 0.5f };
+	static const float tent[4] = { 0.125f, 0.375f, 0.375f, 0.125f };
+
+	const float* weights = quality == TEX_QUALITY_FAST ? box : tent;
+	const int taps = quality == TEX_QUALITY_FAST ? 2 : 4;
+	const int first = quality == TEX_QUALITY_FAST ? 0 : -1;
+
+	const GammaTables& gamma = GetGammaTables();
+
+	JobSystem::ParallelFor((dstHeight + rowsPerJob - 1) / rowsPerJob, [&](uint tile)
+	{
+		uint endY = std::min(dstHeight, (tile + 1) * rowsPerJob);
+		for (uint y = tile * rowsPerJob; y < endY; ++y)
+		{
+			for (uint x = 0; x < dstWidth; ++x)
+			{
+				float acc[4] = { 0.f, 0.f, 0.f, 0.f };
+
+				for (int ty = 0; ty < taps; ++ty)
+				{
+					int sy = std::min(std::max((int)y * 2 + first + ty, 0), (int)height - 1);
+					for (int tx = 0; tx < taps; ++tx)
+					{
+						int sx = std::min(std::max((int)x * 2 + first + tx, 0), (int)width - 1);
+						float w = weights[tx] * weights[ty];
+						const uchar* p = src + (sy * width + sx) * 4;
+
+						if (normalMap)
+						{
+							for (uint c = 0; c < 3; ++c)
+								acc[c] += w * (p[c] / 127.5f - 1.f);
+						}
+						else
+						{
+							for (uint c = 0; c < 3; ++c)
+								acc[c] += w * gamma.toLinear[p[c]];
+						}
+						acc[3] += w * p[3];
+					}
+				}
+
+				uchar* out = dst + (y * dstWidth + x) * 4;
+
+				if (normalMap)
+				{
+					float length = sqrtf(acc[0] * acc[0] + acc[1] * acc[1] + acc[2] * acc[2]);
+					float scale = length > 1e-6f ? 1.f / length : 0.f;
+					for (uint c = 0; c < 3; ++c)
+						out[c] = (uchar)Clamp((acc[c] * scale + 1.f) * 127.5f + 0.5f, 0.f, 255.f);
+				}
+				else
+				{
+					for (uint c = 0; c < 3; ++c)
+						out[c] = gamma.toSRGB[(uint)(Clamp(acc[c], 0.f, 1.f) * 4095.f + 0.5f)];
+				}
+				out[3] = (uchar)Clamp(acc[3] + 0.5f, 0.f, 255.f);
+			}
+		}
+	});
+}
+
+/** TextureCompression - CompressLevel: Compresses the RGBA8 image into dst, GetLevelSize bytes. The blocks over the edges repeat the
+										 last row and column. */
+void TextureCompression::CompressLevel(const uchar * rgba, uint width, uint height, DDSFormat format, TextureQuality quality, uchar * dst)
+{
+	const uint blocksX = (width + 3) / 4;
+	const uint blocksY = (height + 3) / 4;
+	const uint blockBytes = GetDDSBlockBytes(format);
+
+	JobSystem::ParallelFor((blocksY + TEXTURE_TILE_BLOCK_ROWS - 1) / TEXTURE_TILE_BLOCK_ROWS, [&](uint tile)
+	{
+		uchar block[64];
+
+		uint endY = std::min(blocksY, (tile + 1) * TEXTURE_TILE_BLOCK_ROWS);
+		for (uint by = tile * TEXTURE_TILE_BLOCK_ROWS; by < endY; ++by)
+		{
+			for (uint bx = 0; bx < blocksX; ++bx)
+			{
+				for (uint py = 0; py < 4; ++py)
+				{
+					uint sy = std::min(by * 4 + py, height - 1);
+					for (uint px = 0; px < 4; ++px)
+					{
+						uint sx = std::min(bx * 4 + px, width - 1);
+						memcpy(block + (py * 4 + px) * 4, rgba + (sy * width + sx) * 4, 4);
+					}
+				}
+
+				uchar* out = dst + (by * blocksX + bx) * blockBytes;
+				switch (format)
+				{
+				case DDS_BC1:
+					EncodeBC1(block, out, quality);
+					break;
+				case DDS_BC3:
+					EncodeBC3(block, out, quality);
+					break;
+				case DDS_BC4:
+					EncodeBC4(block, 0, out, quality);
+					break;
+				case DDS_BC5:
+					EncodeBC5(block, out, quality);
+					break;
+				default:
+					memset(out, 0, blockBytes);
+					break;
+				}
+			}
+		}
+	});
+}
+
+// BC1 ---------------------------------------------------------------------------------------------------------
+
+static inline uint16 To565(const float c[3])
+{
+	uint r = (uint)(Clamp(c[0], 0.f, 255.f) * 31.f / 255.f + 0.5f);
+	uint g = (uint)(Clamp(c[1], 0.f, 255.f) * 63.f / 255.f + 0.5f);
+	uint b = (uint)(Clamp(c[2], 0.f, 255.f) * 31.f / 255.f + 0.5f);
+	return (uint16)((r << 11) | (g << 5) | b);
+}
+
+static inline void From565(uint16 value, float c[3])
+{
+	uint r = (value >> 11) & 31;
+	uint g = (value >> 5) & 63;
+	uint b = value & 31;
+	c[0] = (float)((r << 3) | (r >> 2));
+	c[1] = (float)((g << 2) | (g >> 4));
+	c[2] = (float)((b << 3) | (b >> 2));
+}
+
+/** Indices of the pixels in the four color palette of the endpoints, returning the squared error. */
+static float FindColorIndices(const float pixels[16][3], uint16 c0, uint16 c1, uchar indices[16])
+{
+	float palette[4][3];
+	From565(c0, palette[0]);
+	From565(c1, palette[1]);
+	for (uint c = 0; c < 3; ++c)
+	{
+		palette[2][c] = (2.f * palette[0][c] + palette[1][c]) / 3.f;
+		palette[3][c] = (palette[0][c] + 2.f * palette[1][c]) / 3.f;
+	}
+
+	float error = 0.f;
+	for (uint i = 0; i < 16; ++i)
+	{
+		float best = FLT_MAX;
+		for (uint p = 0; p < 4; ++p)
+		{
+			float dr = pixels[i][0] - palette[p][0];
+			float dg = pixels[i][1] - palette[p][1];
+			float db = pixels[i][2] - palette[p][2];
+			float d = dr * dr + dg * dg + db * db;
+			if (d < best)
+			{
+				best = d;
+				indices[i] = (uchar)p;
+			}
+		}
+		error += best;
+	}
+
+	return error;
+}
+
+/** Endpoints of a color block: the bounding box corners on the fast preset, the extremes along the principal axis otherwise. Both inset a bit. */
+static void FindColorEndpoints(const float pixels[16][3], TextureQuality quality, float e0[3], float e1[3])
+{
+	float minC[3] = { 255.f, 255.f, 255.f };
+	float maxC[3] = { 0.f, 0.f, 0.f };
+	float mean[3] = { 0.f, 0.f, 0.f };
+
+	for (uint i = 0; i < 16; ++i)
+	{
+		for (uint c = 0; c < 3; ++c)
+		{
+			minC[c] = std::min(minC[c], pixels[i][c]);
+			maxC[c] = std::max(maxC[c], pixels[i][c]);
+			mean[c] += pixels[i][c] / 16.f;
+		}
+	}
+
+	//The box diagonal along the colors: the channels going against the one with the widest range get their ends swapped
+	memcpy(e0, maxC, sizeof(maxC));
+	memcpy(e1, minC, sizeof(minC));
+
+	uint dominant = 0;
+	for (uint c = 1; c < 3; ++c)
+	{
+		if (maxC[c] - minC[c] > maxC[dominant] - minC[dominant])
+			dominant = c;
+	}
+
+	for (uint c = 0; c < 3; ++c)
+	{
+		if (c == dominant)
+			continue;
+
+		float cov = 0.f;
+		for (uint i = 0; i < 16; ++i)
+			cov += (pixels[i][dominant] - mean[dominant]) * (pixels[i][c] - mean[c]);
+
+		if (cov < 0.f)
+			std::swap(e0[c], e1[c]);
+	}
+
+	if (quality != TEX_QUALITY_FAST)
+	{
+		float cov[6] = { 0.f, 0.f, 0.f, 0.f, 0.f, 0.f }; //xx xy xz yy yz zz
+		for (uint i = 0; i < 16; ++i)
+		{
+			float d[3] = { pixels[i][0] - mean[0], pixels[i][1] - mean[1], pixels[i][2] - mean[2] };
+			cov[0] += d[0] * d[0]; cov[1] += d[0] * d[1]; cov[2] += d[0] * d[2];
+			cov[3] += d[1] * d[1]; cov[4] += d[1] * d[2]; cov[5] += d[2] * d[2];
+		}
+
+		//Power iteration from the box diagonal, the unswapped one is orthogonal to the axis of anti correlated channels
+		float axis[3] = { e0[0] - e1[0], e0[1] - e1[1], e0[2] - e1[2] };
+		for (uint it = 0; it < 8; ++it)
+		{
+			float v[3] =
+			{
+				cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2],
+				cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2],
+				cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2]
+			};
+			float norm = std::max(fabsf(v[0]), std::max(fabsf(v[1]), fabsf(v[2])));
+			if (norm < 1e-6f)
+				break;
+			for (uint c = 0; c < 3; ++c)
+				axis[c] = v[c] / norm;
+		}
+
+		float length = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+		if (length < 1e-6f)
+		{
+			memcpy(e0, mean, sizeof(mean));
+			memcpy(e1, mean, sizeof(mean));
+			return;
+		}
+		for (uint c = 0; c < 3; ++c)
+			axis[c] /= length;
+
+		float tMin = FLT_MAX, tMax = -FLT_MAX;
+		for (uint i = 0; i < 16; ++i)
+		{
+			float t = (pixels[i][0] - mean[0]) * axis[0] + (pixels[i][1] - mean[1]) * axis[1] + (pixels[i][2] - mean[2]) * axis[2];
+			tMin = std::min(tMin, t);
+			tMax = std::max(tMax, t);
+		}
+
+		for (uint c = 0; c < 3; ++c)
+		{
+			e0[c] = mean[c] + axis[c] * tMax;
+			e1[c] = mean[c] + axis[c] * tMin;
+		}
+	}
+
+	for (uint c = 0; c < 3; ++c)
+	{
+		float inset = (e0[c] - e1[c]) / 16.f;
+		e0[c] -= inset;
+		e1[c] += inset;
+	}
+}
+
+/** TextureCompression - EncodeBC1: Encodes the 4x4 RGBA8 block (alpha ignored) into 8 bytes. The high preset refines the endpoints
+									 by least squares over the chosen indices. */
+void TextureCompression::EncodeBC1(const uchar * block, uchar * dst, TextureQuality quality)
+{
+	float pixels[16][3];
+	for (uint i = 0; i < 16; ++i)
+		for (uint c = 0; c < 3; ++c)
+			pixels[i][c] = block[i * 4 + c];
+
+	float e0[3], e1[3];
+	FindColorEndpoints(pixels, quality, e0, e1);
+
+	uint16 c0 = To565(e0);
+	uint16 c1 = To565(e1);
+	uchar indices[16];
+	float error = FindColorIndices(pixels, c0, c1, indices);
+
+	if (quality == TEX_QUALITY_HIGH)
+	{
+		static const float weights[4] = { 1.f, 0.f, 2.f / 3.f, 1.f / 3.f }; //Of the first endpoint per index
+
+		for (uint it = 0; it < 2 && error > 0.f; ++it)
+		{
+			float a = 0.f, b = 0.f, c = 0.f;
+			float x[3] = { 0.f, 0.f, 0.f }, y[3] = { 0.f, 0.f, 0.f };
+			for (uint i = 0; i < 16; ++i)
+			{
+				float w0 = weights[indices[i]];
+				float w1 = 1.f - w0;
+				a += w0 * w0;
+				b += w0 * w1;
+				c += w1 * w1;
+				for (uint k = 0; k < 3; ++k)
+				{
+					x[k] += w0 * pixels[i][k];
+					y[k] += w1 * pixels[i][k];
+				}
+			}
+
+			float det = a * c - b * b;
+			if (fabsf(det) < 1e-6f)
+				break;
+
+			float r0[3], r1[3];
+			for (uint k = 0; k < 3; ++k)
+			{
+				r0[k] = (c * x[k] - b * y[k]) / det;
+				r1[k] = (a * y[k] - b * x[k]) / det;
+			}
+
+			uint16 n0 = To565(r0);
+			uint16 n1 = To565(r1);
+			uchar newIndices[16];
+			float newError = FindColorIndices(pixels, n0, n1, newIndices);
+			if (newError >= error)
+				break;
+
+			c0 = n0;
+			c1 = n1;
+			error = newError;
+			memcpy(indices, newIndices, sizeof(indices));
+		}
+	}
+
+	//The four color mode needs c0 > c1, swapping them swaps the indices 0-1 and 2-3
+	if (c0 < c1)
+	{
+		std::swap(c0, c1);
+		for (uint i = 0; i < 16; ++i)
+			indices[i] ^= 1;
+	}
+	else if (c0 == c1)
+	{
+		memset(indices, 0, sizeof(indices));
+	}
+
+	uint bits = 0;
+	for (uint i = 0; i < 16; ++i)
+		bits |= (uint)indices[i] << (i * 2);
+
+	dst[0] = c0 & 0xFF;
+	dst[1] = c0 >> 8;
+	dst[2] = c1 & 0xFF;
+	dst[3] = c1 >> 8;
+	for (uint i = 0; i < 4; ++i)
+		dst[4 + i] = (bits >> (i * 8)) & 0xFF;
+}
+
+// BC4 ---------------------------------------------------------------------------------------------------------
+
+/** Encodes the values with the endpoints, 8 interpolated values if a0 > a1, 6 and 0 and 255 otherwise. Returns the squared error. */
+static uint EncodeChannelEndpoints(const uchar values[16], uchar a0, uchar a1, uchar* dst)
+{
+	int palette[8];
+	palette[0] = a0;
+	palette[1] = a1;
+
+	if (a0 > a1)
+	{
+		for (int i = 2; i < 8; ++i)
+			palette[i] = ((8 - i) * a0 + (i - 1) * a1) / 7;
+	}
+	else
+	{
+		for (int i = 2; i < 6; ++i)
+			palette[i] = ((6 - i) * a0 + (i - 1) * a1) / 5;
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+
+	uint error = 0;
+	uint64 bits = 0;
+	for (uint i = 0; i < 16; ++i)
+	{
+		uint bestIndex = 0;
+		int best = INT_MAX;
+		for (uint p = 0; p < 8; ++p)
+		{
+			int d = abs((int)values[i] - palette[p]);
+			if (d < best)
+			{
+				best = d;
+				bestIndex = p;
+			}
+		}
+		error += best * best;
+		bits |= (uint64)bestIndex << (i * 3);
+	}
+
+	dst[0] = a0;
+	dst[1] = a1;
+	for (uint i = 0; i < 6; ++i)
+		dst[2 + i] = (bits >> (i * 8)) & 0xFF;
+
+	return error;
+}
+
+/** TextureCompression - EncodeBC4: Encodes one channel of the 4x4 RGBA8 block into 8 bytes. The high preset also tries the mode
+									 with exact 0 and 255, better for blocks with cutouts. */
+void TextureCompression::EncodeBC4(const uchar * block, uint channel, uchar * dst, TextureQuality quality)
+{
+	uchar values[16];
+	uchar minV = 255, maxV = 0;
+	uchar minInner = 255, maxInner = 0; //Without the 0 and 255 values
+
+	for (uint i = 0; i < 16; ++i)
+	{
+		values[i] = block[i * 4 + channel];
+		minV = std::min(minV, values[i]);
+		maxV = std::max(maxV, values[i]);
+		if (values[i] != 0 && values[i] != 255)
+		{
+			minInner = std::min(minInner, values[i]);
+			maxInner = std::max(maxInner, values[i]);
+		}
+	}
+
+	if (minV == maxV)
+	{
+		EncodeChannelEndpoints(values, minV, maxV, dst);
+		return;
+	}
+
+	uint error = EncodeChannelEndpoints(values, maxV, minV, dst);
+
+	if (quality == TEX_QUALITY_HIGH && error > 0)
+	{
+		if (minInner > maxInner)
+			minInner = maxInner = 0;
+
+		uchar alt[8];
+		if (EncodeChannelEndpoints(values, minInner, maxInner, alt) < error)
+			memcpy(dst, alt, sizeof(alt));
+	}
+}
+
+/** TextureCompression - EncodeBC3: Encodes the 4x4 RGBA8 block into 16 bytes, the alpha as BC4 and the color as BC1. */
+void TextureCompression::EncodeBC3(const uchar * block, uchar * dst, TextureQuality quality)
+{
+	EncodeBC4(block, 3, dst, quality);
+	EncodeBC1(block, dst + 8, quality);
+}
+
+/** TextureCompression - EncodeBC5: Encodes the red and green of the 4x4 RGBA8 block into 16 bytes, two BC4 blocks. For normal maps. */
+void TextureCompression::EncodeBC5(const uchar * block, uchar * dst, TextureQuality quality)
+{
+	EncodeBC4(block, 0, dst, quality);
+	EncodeBC4(block, 1, dst + 8, quality);
+}
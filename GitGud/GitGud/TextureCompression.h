@@ -0,0 +1,37 @@
+#ifndef __TEXTURE_COMPRESSION_H__
+#define __TEXTURE_COMPRESSION_H__
+
+#include "Globals.h"
+#include "DDS.h"
+
+#define TEXTURE_TILE_BLOCK_ROWS 8 //Block rows compressed by each job.
+
+/** Import presets, trading quality for speed. */
+enum TextureQuality
+{
+	TEX_QUALITY_FAST = 0,	//Box filtered mips, color endpoints from the block bounding box.
+	TEX_QUALITY_NORMAL,		//Tent filtered mips in linear space, color endpoints along the principal axis.
+	TEX_QUALITY_HIGH		//As normal, refining the color endpoints and trying both alpha modes.
+};
+
+/**
+*	- Texture processing of the import: mip generation and BC1, BC3 and BC5 block compression of RGBA8 images.
+*	- The levels are split in rows of tiles processed in parallel with the job system.
+*	- Color mips are filtered in linear space (the pixels are sRGB), normal map mips are renormalized.
+*/
+class TextureCompression
+{
+public:
+	static uint GetNumLevels(uint width, uint height);
+	static uint GetLevelSize(uint width, uint height, DDSFormat format);
+
+	static void Downsample(const uchar* src, uint width, uint height, uchar* dst, TextureQuality quality, bool normalMap);
+	static void CompressLevel(const uchar* rgba, uint width, uint height, DDSFormat format, TextureQuality quality, uchar* dst);
+
+	static void EncodeBC1(const uchar* block, uchar* dst, TextureQuality quality);
+	static void EncodeBC3(const uchar* block, uchar* dst, TextureQuality quality);
+	static void EncodeBC4(const uchar* block, uint channel, uchar* dst, TextureQuality quality);
+	static void EncodeBC5(const uchar* block, uchar* dst, TextureQuality quality);
+};
+
+#endif // !__TEXTURE_COMPRESSION_H__
@@ -7,6 +7,8 @@
 // https://github.com/ocornut/imgui
 
 struct SDL_Window;
+struct ImDrawData;
+struct ImVec2;
 typedef union SDL_Event SDL_Event;
 
 IMGUI_API bool        ImGui_ImplSdlGL3_Init(SDL_Window* window);
@@ -17,3 +19,6 @@ IMGUI_API bool        ImGui_ImplSdlGL3_ProcessEvent(SDL_Event* event);
 // Use if you want to reset your rendering device without losing ImGui state.
 IMGUI_API void        ImGui_ImplSdlGL3_InvalidateDeviceObjects();
 IMGUI_API bool        ImGui_ImplSdlGL3_CreateDeviceObjects();
+
+// Draws ImGui draw data with an explicit display size, for draw data copied out of ImGui (render thread)
+IMGUI_API void        ImGui_ImplSdlGL3_RenderDrawData(ImDrawData* draw_data, const ImVec2& display_size, const ImVec2& framebuffer_scale);